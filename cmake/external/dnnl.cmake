@@ -2,7 +2,7 @@ include (ExternalProject)
 
 set(DNNL_URL https://github.com/intel/mkl-dnn.git)
 # If DNNL_TAG is updated, check if platform.cmake.patch need to be updated.
-set(DNNL_TAG v1.1.1)
+set(DNNL_TAG v1.2.2)
 
 if(WIN32)
   set(MKLML_OS_VERSION_STR "win")
@@ -85,6 +85,15 @@ class IExecutionProvider {
   GetCapability(const onnxruntime::GraphViewer& graph_viewer,
                 const std::vector<const KernelRegistry*>& kernel_registries) const;
 
+  /**
+     Get the estimated latency in microseconds of running <node> with <*this> execution provider.
+     It's used by the cost based partitioning (see kOrtSessionOptionsConfigCostBasedPartitioning) to decide
+     whether the sub-graphs returned by GetCapability are worth taking over the CPU execution provider.
+     Return false if there is no estimate, in which case the partitioner makes its own.
+  */
+  virtual bool GetNodeCostEstimate(const onnxruntime::GraphViewer& graph_viewer, const onnxruntime::Node& node,
+                                   double& cost_us) const;
+
   /**
      Get kernel registry per execution provider type.
      The KernelRegistry share pointer returned is shared across sessions.
@@ -36,6 +36,11 @@ struct OrtValue {
     return data_ && type_;
   }
 
+  // true if no other OrtValue shares the data of this one, so it can be modified without affecting other values.
+  bool IsUniquelyOwned() const {
+    return data_.use_count() == 1;
+  }
+
   template <typename T>
   const T& Get() const {
     ORT_ENFORCE(onnxruntime::DataTypeImpl::GetType<T>() == type_, onnxruntime::DataTypeImpl::GetType<T>(), " != ", type_);
@@ -26,6 +26,12 @@ struct OrtRunOptions {
   // So it is possible that only some of the nodes are executed.
   bool only_execute_path_to_fetches = false;
 
+  // Scheduling priority of the work the Run() calls submit to the thread pools.
+  OrtRunPriority run_priority = ORT_RUN_PRIORITY_NORMAL;
+
+  // Deadline of each Run() call in milliseconds from its start. 0 means no deadline.
+  int64_t run_deadline_ms = 0;
+
 #ifdef ENABLE_TRAINING
   // Set to 'true' to run in training mode.
   bool training_mode = true;
@@ -9,6 +9,7 @@
 
 /* Modifications Copyright (c) Microsoft. */
 
+#include <algorithm>
 #include <type_traits>
 
 #pragma once
@@ -37,6 +38,7 @@
 #include "core/common/spin_pause.h"
 #include "core/platform/ort_mutex.h"
 #include "core/platform/Barrier.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
@@ -359,6 +361,17 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
  public:
   typedef typename Environment::Task Task;
 
+  // A queued work item.  Work submitted under a non-default scheduling hint carries the
+  // hint and the time it was queued alongside the task, so that the thread running it can
+  // re-install the hint and account for the queueing delay without wrapping the task in
+  // another closure.  Work submitted under the default hint carries neither.
+  struct Work {
+    Task task;
+    onnxruntime::concurrency::SchedulingHint hint;
+    int64_t enqueue_ns{0};  // 0 if the work does not carry its hint
+    unsigned pri{0};
+  };
+
   struct Tag {
     constexpr Tag() : v_(0) {
     }
@@ -396,7 +409,7 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     return Tag(next_tag++);
   }
 
-  typedef RunQueue<Task, Tag, 1024> Queue;
+  typedef RunQueue<Work, Tag, 1024> Queue;
 #ifdef _WIN32
   using CHAR_TYPE = wchar_t;
 #else
@@ -407,6 +420,8 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
       : env_(env),
         num_threads_(num_threads),
         allow_spinning_(allow_spinning),
+        adaptive_spinning_(thread_options.adaptive_spinning),
+        collect_stats_(thread_options.collect_stats),
         set_denormal_as_zero_(thread_options.set_denormal_as_zero),
         worker_data_(num_threads),
         all_coprimes_(num_threads),
@@ -450,7 +465,9 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
       // Since we were cancelled, there might be entries in the queues.
       // Empty them to prevent their destructor from asserting.
       for (size_t i = 0; i < worker_data_.size(); i++) {
-        worker_data_[i].queue.Flush();
+        for (auto& q : worker_data_[i].queues) {
+          q.Flush();
+        }
       }
     }
     // Join threads explicitly (by destroying) to avoid destruction order within
@@ -464,28 +481,31 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
   // reject work if the queue of pending work is full.
 
   void Schedule(std::function<void()> fn) override {
-    Task t = env_.CreateTask(std::move(fn));
+    RecordArrival();
+    const auto& hint = onnxruntime::concurrency::SchedulingHint::Current();
+    const unsigned pri = PriorityIndex(hint);
+    Work t = MakeWork(std::move(fn), hint, pri);
     PerThread* pt = GetPerThread();
     if (pt->pool == this) {
       // Worker thread of this pool, push onto the thread's queue.
-      Queue& q = worker_data_[pt->thread_id].queue;
+      Queue& q = worker_data_[pt->thread_id].queues[pri];
       t = q.PushFront(std::move(t));
     } else {
       // A free-standing thread (or worker of another pool), push onto a random
       // queue.
       int q_idx = Rand(&pt->rand) % num_threads_;
       WorkerData &td = worker_data_[q_idx];
-      Queue& q = td.queue;
+      Queue& q = td.queues[pri];
       t = q.PushBack(std::move(t));
-      if (!t.f) {
+      if (!t.task.f) {
         // The queue accepted the work; ensure that the thread will pick it up
         td.EnsureAwake();
       }
     }
 
     // Run the work directly if the queue rejected the work
-    if (t.f) {
-      env_.ExecuteTask(t);
+    if (t.task.f) {
+      env_.ExecuteTask(t.task);
     }
   }
 
@@ -563,18 +583,24 @@ void RunInParallel(std::function<void()> fn, unsigned n) override {
     Barrier b(n, allow_spinning_);
 
     my_pt->in_parallel = true;
+    num_parallel_sections_++;
+    RecordArrival();
     if (!my_pt->tag.Get()) {
       my_pt->tag = Tag::GetNext();
     }
 
+    // All copies of the work item go into the queues for the caller's priority class
+    const auto& hint = onnxruntime::concurrency::SchedulingHint::Current();
+    const unsigned pri = PriorityIndex(hint);
+
     // Push up to n-1 copies of the work item into the queues
     std::vector<unsigned> good_hints, alt_hints;
     GetGoodWorkerHints(n - 1, good_hints, alt_hints);
     for (unsigned i = 0; i < n - 1; i++) {
-      Task t = env_.CreateTask([&b, &fn]() {
+      Work t = MakeWork([&b, &fn]() {
         fn();
         b.Notify(1);
-      });
+      }, hint, pri);
       int q_idx;
       if (i < good_hints.size()) {
         q_idx = good_hints[i];
@@ -587,10 +613,10 @@ void RunInParallel(std::function<void()> fn, unsigned n) override {
         }
       }
       WorkerData& td = worker_data_[q_idx];
-      Queue& q = td.queue;
+      Queue& q = td.queues[pri];
       unsigned w_idx;
       t = q.PushBackWithTag(std::move(t), my_pt->tag, w_idx);
-      if (t.f) {
+      if (t.task.f) {
         // The queue rejected the work.  Account for the missing capacity for work
         // on the synchronization barrier.  The semantics for RunInParallel are that
         // the function is called with up to n-way parallelism, and so the
@@ -611,7 +637,7 @@ void RunInParallel(std::function<void()> fn, unsigned n) override {
     // revoke from the work queues
     int notifications_needed = 1;
     for (auto& item : pending_items) {
-      Queue& q = worker_data_[item.first].queue;
+      Queue& q = worker_data_[item.first].queues[pri];
       if (q.RevokeWithTag(my_pt->tag, item.second)) {
         notifications_needed++;
       }
@@ -620,6 +646,7 @@ void RunInParallel(std::function<void()> fn, unsigned n) override {
 
     // Synchronize with any work items that are still running
     b.Wait();
+    num_parallel_sections_--;
     my_pt->in_parallel = false;
   }
 }
@@ -653,6 +680,42 @@ int CurrentThreadId() const EIGEN_FINAL {
   return -1;
 }
 
+onnxruntime::concurrency::QueueingDelayStats GetQueueingDelayStats(
+    onnxruntime::concurrency::WorkPriority priority) const {
+  onnxruntime::concurrency::QueueingDelayStats stats;
+  for (const auto& td : worker_data_) {
+    const QueueingDelayCounters& c = td.queueing_delay[static_cast<unsigned>(priority)];
+    stats.num_tasks += c.num_tasks.load(std::memory_order_relaxed);
+    stats.total_delay_ns += c.total_delay_ns.load(std::memory_order_relaxed);
+    stats.max_delay_ns = std::max(stats.max_delay_ns, c.max_delay_ns.load(std::memory_order_relaxed));
+  }
+  return stats;
+}
+
+int GetQueueDepth() const {
+  unsigned queued = 0;
+  for (const auto& td : worker_data_) {
+    for (const auto& q : td.queues) {
+      queued += q.Size();
+    }
+  }
+  return static_cast<int>(queued) + num_parallel_sections_.load(std::memory_order_relaxed);
+}
+
+onnxruntime::concurrency::SpinStats GetSpinStats() const {
+  onnxruntime::concurrency::SpinStats stats;
+  for (const auto& td : worker_data_) {
+    const SpinCounters& c = td.spin_counters;
+    stats.num_spin_episodes += c.num_spin_episodes.load(std::memory_order_relaxed);
+    stats.num_productive_spin_episodes += c.num_productive_spin_episodes.load(std::memory_order_relaxed);
+    stats.num_denied_spin_episodes += c.num_denied_spin_episodes.load(std::memory_order_relaxed);
+    stats.spin_ns += c.spin_ns.load(std::memory_order_relaxed);
+    stats.productive_spin_ns += c.productive_spin_ns.load(std::memory_order_relaxed);
+    stats.busy_ns += c.busy_ns.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
  private:
 
 #ifdef NDEBUG
@@ -685,6 +748,30 @@ int CurrentThreadId() const EIGEN_FINAL {
   typedef typename Environment::EnvThread Thread;
   struct WorkerData;
 
+  // Per-worker statistics counters.  Only the owning worker updates them, so the updates
+  // need no read-modify-write operations; readers sum them across workers.
+  static void IncrementCounter(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  // Queueing delay of the work one worker ran for one priority class.
+  struct QueueingDelayCounters {
+    std::atomic<uint64_t> num_tasks{0};
+    std::atomic<uint64_t> total_delay_ns{0};
+    std::atomic<uint64_t> max_delay_ns{0};
+  };
+
+  // Spin and busy-time accounting of one worker, recorded only if the pool collects
+  // statistics (ThreadOptions::collect_stats) and reported through GetSpinStats.
+  struct SpinCounters {
+    std::atomic<uint64_t> num_spin_episodes{0};
+    std::atomic<uint64_t> num_productive_spin_episodes{0};
+    std::atomic<uint64_t> num_denied_spin_episodes{0};
+    std::atomic<uint64_t> spin_ns{0};
+    std::atomic<uint64_t> productive_spin_ns{0};
+    std::atomic<uint64_t> busy_ns{0};
+  };
+
   // PerThread objects are allocated in thread-local storage and allocated
   // on the thread's first call to GetPerThread.  The object should
   // remain trivially-destructable, with other state placed in the
@@ -710,10 +797,18 @@ int CurrentThreadId() const EIGEN_FINAL {
   static_assert(std::is_trivially_destructible<PerThread>::value, "Per-thread state should be trivially destructible");
 
   struct WorkerData {
-    constexpr WorkerData() : thread(), queue() {
+    constexpr WorkerData() : thread(), queues(), queueing_delay(), spin_counters() {
     }
     std::unique_ptr<Thread> thread;
-    Queue queue;
+
+    // One queue per WorkPriority, indexed by the priority value.  Lower indices are
+    // serviced first, both by the owning thread and by threads stealing work.
+    Queue queues[onnxruntime::concurrency::kNumWorkPriorities];
+
+    // Queueing delay of the work this thread ran, indexed by priority class.
+    QueueingDelayCounters queueing_delay[onnxruntime::concurrency::kNumWorkPriorities];
+
+    SpinCounters spin_counters;
 
     // Each thread has a status, available read-only without locking, and protected
     // by the mutex field below for updates.  The status is used for three
@@ -804,10 +899,13 @@ int CurrentThreadId() const EIGEN_FINAL {
   Environment& env_;
   const int num_threads_;
   const bool allow_spinning_;
+  const bool adaptive_spinning_;
+  const bool collect_stats_;
   const bool set_denormal_as_zero_;
   Eigen::MaxSizeVector<WorkerData> worker_data_;
   Eigen::MaxSizeVector<Eigen::MaxSizeVector<unsigned>> all_coprimes_;
   std::atomic<unsigned> blocked_;  // Count of blocked workers, used as a termination condition
+  std::atomic<int> num_parallel_sections_{0};  // Count of RunInParallel calls in progress, see GetQueueDepth
   std::atomic<bool> done_;
   std::atomic<bool> cancelled_;
 
@@ -821,6 +919,174 @@ int CurrentThreadId() const EIGEN_FINAL {
   int num_hint_words_;
   std::unique_ptr<std::atomic<uint64_t>[]> good_worker_hints_;
 
+  // Work carrying a deadline closer than this is queued as WorkPriority::High
+  // regardless of the priority class of the request it belongs to.
+  static constexpr int64_t deadline_promotion_window_ns_ = 5 * 1000 * 1000;
+
+
+  // Map a scheduling hint to the index of the queue its work should be placed in.
+  static unsigned PriorityIndex(const onnxruntime::concurrency::SchedulingHint& hint) {
+    if (hint.deadline_ns != 0 &&
+        hint.deadline_ns - onnxruntime::concurrency::SchedulingHint::NowNs() < deadline_promotion_window_ns_) {
+      return static_cast<unsigned>(onnxruntime::concurrency::WorkPriority::High);
+    }
+    return static_cast<unsigned>(hint.priority);
+  }
+
+  // Build the work item for fn.  Work submitted under a non-default hint (a priority class
+  // other than Normal, or a deadline) carries the hint so that work scheduled from within fn
+  // inherits the priority and deadline of the original request, and records when it was
+  // queued.  Work under the default hint is passed through untouched, without reading the
+  // clock, as workers run with the default hint installed anyway.
+  Work MakeWork(std::function<void()> fn,
+                const onnxruntime::concurrency::SchedulingHint& hint,
+                unsigned pri) {
+    Work w;
+    w.task = env_.CreateTask(std::move(fn));
+    if (hint.deadline_ns != 0 || hint.priority != onnxruntime::concurrency::WorkPriority::Normal) {
+      w.hint = hint;
+      w.pri = pri;
+      w.enqueue_ns = onnxruntime::concurrency::SchedulingHint::NowNs();
+    }
+    return w;
+  }
+
+  // Run a work item on worker td, with the hint it carries (if any) installed.
+  void ExecuteWork(WorkerData& td, const Work& w) {
+    if (w.enqueue_ns == 0) {
+      env_.ExecuteTask(w.task);
+      return;
+    }
+    RecordQueueingDelay(td, w.pri, onnxruntime::concurrency::SchedulingHint::NowNs() - w.enqueue_ns);
+    onnxruntime::concurrency::ScopedSchedulingHint scoped_hint(w.hint);
+    env_.ExecuteTask(w.task);
+  }
+
+  static void RecordQueueingDelay(WorkerData& td, unsigned pri, int64_t delay_ns) {
+    const uint64_t delay = delay_ns > 0 ? static_cast<uint64_t>(delay_ns) : 0;
+    QueueingDelayCounters& c = td.queueing_delay[pri];
+    IncrementCounter(c.num_tasks, 1);
+    IncrementCounter(c.total_delay_ns, delay);
+    if (delay > c.max_delay_ns.load(std::memory_order_relaxed)) {
+      c.max_delay_ns.store(delay, std::memory_order_relaxed);
+    }
+  }
+
+  // Adaptive spinning.  Each arrival of new work (a call to Schedule or RunInParallel) updates
+  // an exponentially weighted moving average of the interval between arrivals.  When the
+  // average interval is short, an idle worker spins for a small multiple of it, expecting the
+  // next parallel section to arrive before it would otherwise have finished blocking.  When
+  // the interval is long, spinning would mostly waste a core, so the worker spins only
+  // briefly before blocking.  The updates race benignly: the average is only a heuristic.
+
+  static constexpr int64_t min_adaptive_spin_ns_ = 10 * 1000;
+  static constexpr int64_t max_adaptive_spin_ns_ = 2 * 1000 * 1000;
+  static constexpr int adaptive_spin_clock_interval_ = 64;     // Spin iterations between clock reads
+  static constexpr int adaptive_spin_steal_interval_ = 1024;   // Spin iterations between steal attempts
+  std::atomic<int64_t> last_arrival_ns_{0};
+  std::atomic<int64_t> mean_interarrival_ns_{max_adaptive_spin_ns_};
+
+  void RecordArrival() {
+    if (!adaptive_spinning_) {
+      return;
+    }
+    const int64_t now = onnxruntime::concurrency::SchedulingHint::NowNs();
+    const int64_t last = last_arrival_ns_.exchange(now, std::memory_order_relaxed);
+    if (last != 0 && now > last) {
+      const int64_t mean = mean_interarrival_ns_.load(std::memory_order_relaxed);
+      mean_interarrival_ns_.store(mean + (now - last - mean) / 8, std::memory_order_relaxed);
+    }
+  }
+
+  int64_t AdaptiveSpinBudgetNs() const {
+    const int64_t mean = mean_interarrival_ns_.load(std::memory_order_relaxed);
+    if (mean > max_adaptive_spin_ns_) {
+      return min_adaptive_spin_ns_;
+    }
+    int64_t budget_ns = 2 * mean;
+    if (budget_ns > max_adaptive_spin_ns_) {
+      budget_ns = max_adaptive_spin_ns_;
+    } else if (budget_ns < min_adaptive_spin_ns_) {
+      budget_ns = min_adaptive_spin_ns_;
+    }
+    return budget_ns;
+  }
+
+  // Spin waiting for work.  We indicate, via SetGoodWorkerHint that we are
+  // spinning.  This will bias other threads toward pushing work to our queue.
+  // In addition, periodically make a best-effort attempt to steal from other
+  // threads which are not themselves spinning.
+  Work SpinForWork(WorkerData& td, int thread_id, int spin_count, int steal_count) {
+    Work t;
+    if (spin_count == 0) {
+      return t;
+    }
+    bool spin_slot_taken = false;
+    if (!onnxruntime::concurrency::SpinLimiter::TryAcquire(spin_slot_taken)) {
+      if (collect_stats_) {
+        IncrementCounter(td.spin_counters.num_denied_spin_episodes, 1);
+      }
+      return t;
+    }
+
+    const int64_t spin_start_ns =
+        (adaptive_spinning_ || collect_stats_) ? onnxruntime::concurrency::SchedulingHint::NowNs() : 0;
+    SetGoodWorkerHint(thread_id, true);
+    if (adaptive_spinning_) {
+      const int64_t budget_ns = AdaptiveSpinBudgetNs();
+      for (int i = 1; !t.task.f && !cancelled_ && !done_; i++) {
+        t = (i % adaptive_spin_steal_interval_ == 0) ? TrySteal() : PopFrontAnyPriority(td);
+        if (!t.task.f && (i % adaptive_spin_clock_interval_ == 0) &&
+            onnxruntime::concurrency::SchedulingHint::NowNs() - spin_start_ns >= budget_ns) {
+          break;
+        }
+        onnxruntime::concurrency::SpinPause();
+      }
+    } else {
+      for (int i = 0; i < spin_count && !t.task.f && !cancelled_ && !done_; i++) {
+        t = ((i+1)%steal_count == 0) ? TrySteal() : PopFrontAnyPriority(td);
+        onnxruntime::concurrency::SpinPause();
+      }
+    }
+    SetGoodWorkerHint(thread_id, false);
+    if (spin_slot_taken) {
+      onnxruntime::concurrency::SpinLimiter::Release();
+    }
+
+    if (collect_stats_) {
+      const uint64_t spin_ns = static_cast<uint64_t>(onnxruntime::concurrency::SchedulingHint::NowNs() - spin_start_ns);
+      IncrementCounter(td.spin_counters.num_spin_episodes, 1);
+      IncrementCounter(td.spin_counters.spin_ns, spin_ns);
+      if (t.task.f) {
+        IncrementCounter(td.spin_counters.num_productive_spin_episodes, 1);
+        IncrementCounter(td.spin_counters.productive_spin_ns, spin_ns);
+      }
+    }
+    return t;
+  }
+
+  // Pop work from the front of thread_id's queues, highest priority first.
+  Work PopFrontAnyPriority(WorkerData& td) {
+    for (auto& q : td.queues) {
+      Work t = q.PopFront();
+      if (t.task.f) {
+        return t;
+      }
+    }
+    return Work();
+  }
+
+  // Pop work from the back of a victim's queues, highest priority first.
+  Work PopBackAnyPriority(WorkerData& td) {
+    for (auto& q : td.queues) {
+      Work t = q.PopBack();
+      if (t.task.f) {
+        return t;
+      }
+    }
+    return Work();
+  }
+
   // Wake any blocked workers so that they can cleanly exit WorkerLoop().  For an
   // abrupt exit, cancelled_==true and threads will exit their worker loops.  For
   // a clean exit, each thread will observe (1) done_ set, indicating that the
@@ -837,7 +1103,6 @@ int CurrentThreadId() const EIGEN_FINAL {
   void WorkerLoop(int thread_id) {
     PerThread* pt = GetPerThread();
     WorkerData& td = worker_data_[thread_id];
-    Queue& q = td.queue;
     bool should_exit = false;
     pt->pool = this;
     pt->rand = GlobalThreadIdHash();
@@ -853,27 +1118,17 @@ int CurrentThreadId() const EIGEN_FINAL {
     SetDenormalAsZero(set_denormal_as_zero_);
 
     while (!cancelled_ && !should_exit) {
-        Task t = q.PopFront();
-        if (!t.f) {
-          // Spin waiting for work.  We indicate, via SetGOodWorkerHint that we are
-          // spinning.  This will bias other threads toward pushing work to our queue.
-          // In addition, priodically make a best-effort attempt to steal from other
-          // threads which are not themselves spinning.
-
-          SetGoodWorkerHint(thread_id, true);
-          for (int i = 0; i < spin_count && !t.f && !cancelled_ && !done_; i++) {
-            t = ((i+1)%steal_count == 0) ? TrySteal() : q.PopFront();
-            onnxruntime::concurrency::SpinPause();
-          }
-          SetGoodWorkerHint(thread_id, false);
+        Work t = PopFrontAnyPriority(td);
+        if (!t.task.f) {
+          t = SpinForWork(td, thread_id, spin_count, steal_count);
 
-          if (!t.f) {
+          if (!t.task.f) {
             // No work passed to us while spinning; make a further full attempt to
             // steal work from other threads prior to blocking.
             if (num_threads_ != 1) {
               t = Steal(true /* true => check all queues */);
             }
-            if (!t.f) {
+            if (!t.task.f) {
               td.SetBlocked(
                   // Pre-block test
                   [&]() -> bool {
@@ -884,7 +1139,7 @@ int CurrentThreadId() const EIGEN_FINAL {
                     if (victim != -1) {
                       should_block = false;
                       if (!cancelled_) {
-                        t = worker_data_[victim].queue.PopBack();
+                        t = PopBackAnyPriority(worker_data_[victim]);
                       }
                     }
                     // Number of blocked threads is used as termination condition.
@@ -921,9 +1176,16 @@ int CurrentThreadId() const EIGEN_FINAL {
             }
           }
         }
-        if (t.f) {
+        if (t.task.f) {
           td.SetActive();
-          env_.ExecuteTask(t);
+          if (collect_stats_) {
+            const int64_t start_ns = onnxruntime::concurrency::SchedulingHint::NowNs();
+            ExecuteWork(td, t);
+            IncrementCounter(td.spin_counters.busy_ns,
+                             static_cast<uint64_t>(onnxruntime::concurrency::SchedulingHint::NowNs() - start_ns));
+          } else {
+            ExecuteWork(td, t);
+          }
           td.SetSpinning();
         }
       }
@@ -948,7 +1210,7 @@ int CurrentThreadId() const EIGEN_FINAL {
   //   to be spinning.  In these cases, even though the victim thread is
   //   looking for work itself, it may have been pre-empted.
 
-  Task Steal(bool check_all) {
+  Work Steal(bool check_all) {
     PerThread* pt = GetPerThread();
     unsigned size = static_cast<unsigned>(num_threads_);
     unsigned r = Rand(&pt->rand);
@@ -960,13 +1222,13 @@ int CurrentThreadId() const EIGEN_FINAL {
         assert(victim < size);
         if (round == 1 ||
             worker_data_[victim].GetStatus() == WorkerData::ThreadStatus::Active) {
-          Task t = worker_data_[victim].queue.PopBack();
-          if (t.f) {
+          Work t = PopBackAnyPriority(worker_data_[victim]);
+          if (t.task.f) {
             return t;
           }
         }
         if (!check_all) {
-          return Task();
+          return Work();
         }
         victim += inc;
         if (victim >= size) {
@@ -975,10 +1237,10 @@ int CurrentThreadId() const EIGEN_FINAL {
       }
     }
 
-    return Task();
+    return Work();
   }
 
-  Task TrySteal() {
+  Work TrySteal() {
     return Steal(false);
   }
 
@@ -989,8 +1251,10 @@ int CurrentThreadId() const EIGEN_FINAL {
     unsigned inc = all_coprimes_[size - 1][r % all_coprimes_[size - 1].size()];
     unsigned victim = r % size;
     for (unsigned i = 0; i < size; i++) {
-      if (!worker_data_[victim].queue.Empty()) {
-        return victim;
+      for (const auto& q : worker_data_[victim].queues) {
+        if (!q.Empty()) {
+          return victim;
+        }
       }
       victim += inc;
       if (victim >= size) {
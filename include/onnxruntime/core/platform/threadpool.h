@@ -26,6 +26,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <atomic>
 
 // This file use PIMPL to avoid having eigen headers here
 
@@ -50,6 +51,91 @@ namespace concurrency {
 class ExtendedThreadPoolInterface;
 class LoopCounter;
 
+// Scheduling priority of work submitted to a thread pool.  Each worker keeps one
+// run queue per priority class and services the classes in the order below, so
+// latency-critical requests are not queued behind batch work sharing the pool.
+enum class WorkPriority : uint8_t {
+  High = 0,
+  Normal = 1,
+  Low = 2,
+};
+
+constexpr int kNumWorkPriorities = 3;
+
+// Scheduling information attached to the work a thread submits to a thread pool.
+// The hint is held in thread-local storage: InferenceSession::Run installs one for
+// the duration of a call, and work items carry it to the threads that run them so
+// nested submissions (e.g. from the inter-op pool) inherit it.
+struct SchedulingHint {
+  WorkPriority priority = WorkPriority::Normal;
+
+  // Absolute deadline in nanoseconds on the steady clock (see NowNs), or 0 if none.
+  // Work whose deadline is close is promoted to WorkPriority::High when queued.
+  int64_t deadline_ns = 0;
+
+  // Returns the hint installed on the calling thread.
+  static const SchedulingHint& Current();
+
+  // Returns the current time in nanoseconds on the clock used for deadlines.
+  static int64_t NowNs();
+
+  // Returns true if a deadline is set and has passed.  Long-running work checks this at
+  // convenient points (between nodes, loop iterations and parallel loop chunks) so that
+  // an expired request releases its threads promptly.  A parallel loop that stops early
+  // returns normally, so code that needs its complete results checks this after the loop.
+  bool DeadlineExpired() const {
+    return deadline_ns != 0 && NowNs() >= deadline_ns;
+  }
+};
+
+// Installs a scheduling hint on the calling thread, restoring the previous one on destruction.
+class ScopedSchedulingHint {
+ public:
+  explicit ScopedSchedulingHint(const SchedulingHint& hint);
+  ~ScopedSchedulingHint();
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ScopedSchedulingHint);
+
+ private:
+  SchedulingHint saved_;
+};
+
+// Cumulative time that work items of one priority class spent queued in a pool
+// before a thread started running them.
+struct QueueingDelayStats {
+  uint64_t num_tasks = 0;
+  uint64_t total_delay_ns = 0;
+  uint64_t max_delay_ns = 0;
+};
+
+// Cumulative statistics on how a pool's threads spent their time: spin-waiting for
+// work, or running work items.  A spin episode is "productive" if it ends because
+// the thread found work, as opposed to giving up and blocking.
+struct SpinStats {
+  uint64_t num_spin_episodes = 0;
+  uint64_t num_productive_spin_episodes = 0;
+  uint64_t num_denied_spin_episodes = 0;  // Skipped because of the process-wide spinning limit
+  uint64_t spin_ns = 0;
+  uint64_t productive_spin_ns = 0;
+  uint64_t busy_ns = 0;
+};
+
+// Process-wide limit on the number of threads, across all thread pools, that may
+// spin-wait for work at the same time.  Threads that cannot obtain a spin slot
+// block immediately instead, leaving the cores to other work on the machine.
+class SpinLimiter {
+ public:
+  // Set the maximum number of concurrently spinning threads.  0 means no limit (the default).
+  static void SetMaxSpinningThreads(int max_spinning_threads);
+  static int GetMaxSpinningThreads();
+
+  // Try to obtain a spin slot, returning false if the thread must not spin.  Without a limit,
+  // no slot is counted.  slot_taken records whether one was, in which case it must be returned
+  // with a call to Release, even if the limit has been changed in the meantime.
+  static bool TryAcquire(bool& slot_taken);
+  static void Release();
+};
+
 class ThreadPool {
  public:
 #ifdef _WIN32
@@ -233,6 +319,30 @@ class ThreadPool {
   // working in combination with the thread initiating the loop.
   static int DegreeOfParallelism(const ThreadPool* tp);
 
+  // Return the queueing delay observed so far for work of the given priority class.  Only
+  // work submitted under a non-default scheduling hint (see SchedulingHint) is timed.
+  // Returns all-zero statistics if tp is nullptr or the pool has no threads of its own.
+  static QueueingDelayStats GetQueueingDelayStats(const ThreadPool* tp, WorkPriority priority);
+
+  // Return statistics on spin-waiting versus useful work by the threads in the pool.
+  // Returns all-zero statistics if tp is nullptr, the pool has no threads of its own, or
+  // the pool was created without ThreadOptions::collect_stats.
+  static SpinStats GetSpinStats(const ThreadPool* tp);
+
+  // Limit the degree of parallelism of this pool to dop, clamped to [1, MaxDegreeOfParallelism].
+  // Threads beyond the limit stay idle.  DegreeOfParallelism reflects the new value, so parallel
+  // loops (including MLAS partitioning) started after the call use the new degree of parallelism.
+  // The pool cannot grow beyond the number of threads it was created with.
+  void SetDegreeOfParallelism(int dop);
+
+  // Return the largest degree of parallelism the pool supports: the threads it created, plus
+  // the thread entering a loop.
+  static int MaxDegreeOfParallelism(const ThreadPool* tp);
+
+  // Return the current demand on the pool: the number of work items queued plus the number
+  // of parallel sections in progress.  This is a racy snapshot intended for load balancing.
+  static int GetQueueDepth(const ThreadPool* tp);
+
   ORT_DISALLOW_COPY_AND_ASSIGNMENT(ThreadPool);
 
  private:
@@ -291,6 +401,9 @@ class ThreadPool {
 
   // If used, underlying_threadpool_ is instantiated and owned by the ThreadPool.
   std::unique_ptr<ThreadPoolTempl<Env> > extended_eigen_threadpool_;
+
+  // Current degree of parallelism, between 1 and NumThreads() + 1.  See SetDegreeOfParallelism.
+  std::atomic<int> degree_of_parallelism_{1};
 };
 
 }  // namespace concurrency
@@ -13,12 +13,18 @@
 
 struct OrtThreadingOptions;
 namespace onnxruntime {
+namespace concurrency {
+class ThreadPoolGovernor;
+}  // namespace concurrency
+
 /** TODO: remove this class
    Provides the runtime environment for onnxruntime.
    Create one instance for the duration of execution.
 */
 class Environment {
  public:
+  ~Environment();
+
   /**
      Create and initialize the runtime environment.
     @param logging manager instance that will enable per session logger output using
@@ -51,6 +57,14 @@ class Environment {
     return inter_op_thread_pool_.get();
   }
 
+  /**
+   * Returns the governor sharing the env's core budget between intra-op thread pools, or nullptr if the env was
+   * not created with a core budget.
+  */
+  onnxruntime::concurrency::ThreadPoolGovernor* GetThreadPoolGovernor() const {
+    return thread_pool_governor_.get();
+  }
+
   bool EnvCreatedWithGlobalThreadPools() const {
     return create_global_thread_pools_;
   }
@@ -71,7 +85,7 @@ class Environment {
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Environment);
 
-  Environment() = default;
+  Environment();
   Status Initialize(std::unique_ptr<logging::LoggingManager> logging_manager,
                     const OrtThreadingOptions* tp_options = nullptr,
                     bool create_global_thread_pools = false);
@@ -79,6 +93,8 @@ class Environment {
   std::unique_ptr<logging::LoggingManager> logging_manager_;
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> intra_op_thread_pool_;
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> inter_op_thread_pool_;
+  // Declared after the thread pools so that it is destroyed, and stops adjusting them, first.
+  std::unique_ptr<onnxruntime::concurrency::ThreadPoolGovernor> thread_pool_governor_;
   bool create_global_thread_pools_{false};
   std::vector<AllocatorPtr> shared_allocators_;
 };
@@ -225,6 +225,14 @@ typedef enum ExecutionMode {
   ORT_PARALLEL = 1,
 } ExecutionMode;
 
+// Scheduling priority of the work a Run() call submits to the thread pools.
+// Thread pool workers service higher priority classes first.
+typedef enum OrtRunPriority {
+  ORT_RUN_PRIORITY_HIGH = 0,
+  ORT_RUN_PRIORITY_NORMAL = 1,
+  ORT_RUN_PRIORITY_LOW = 2,
+} OrtRunPriority;
+
 // Set the language projection, default is C, which means it will classify the language not in the list to C also.
 typedef enum OrtLanguageProjection {
   ORT_PROJECTION_C = 0,  // default
@@ -1103,6 +1111,60 @@ struct OrtApi {
    * and that's recommended because turning this option on may hurt model accuracy.
    */
   ORT_API2_STATUS(SetGlobalDenormalAsZero, _Inout_ OrtThreadingOptions* tp_options);
+
+  /**
+   * Set the scheduling priority of Run() calls made with these run options.
+   * When several sessions share the global thread pools, work from higher priority runs is
+   * serviced before work from lower priority runs. Default is ORT_RUN_PRIORITY_NORMAL.
+   */
+  ORT_API2_STATUS(RunOptionsSetRunPriority, _Inout_ OrtRunOptions* options, OrtRunPriority priority);
+  ORT_API2_STATUS(RunOptionsGetRunPriority, _In_ const OrtRunOptions* options, _Out_ OrtRunPriority* out);
+
+  /**
+   * Set a deadline for Run() calls made with these run options, in milliseconds from the start of each call.
+   * Thread pool work of a run nearing its deadline is serviced ahead of other work.
+   * \param deadline_ms 0 means no deadline (the default). Must not be negative.
+   */
+  ORT_API2_STATUS(RunOptionsSetRunDeadline, _Inout_ OrtRunOptions* options, int64_t deadline_ms);
+  ORT_API2_STATUS(RunOptionsGetRunDeadline, _In_ const OrtRunOptions* options, _Out_ int64_t* out);
+
+  /**
+   * Use this API to configure the global thread pool options to be used in the call to CreateEnvWithGlobalThreadPools.
+   * When spinning is allowed, let idle threads spin for a duration derived from how frequently parallel work arrives,
+   * instead of for a fixed number of iterations. This API will set the value for both inter_op and intra_op threadpools.
+   * \param adaptive_spinning valid values are 1 and 0.
+   */
+  ORT_API2_STATUS(SetGlobalAdaptiveSpinning, _Inout_ OrtThreadingOptions* tp_options, int adaptive_spinning);
+
+  /**
+   * Use this API to limit the number of threads that may spin waiting for work at the same time, across all the
+   * thread pools in the process (global and per-session). The limit is applied when the env is created.
+   * Threads that would exceed the limit block instead of spinning.
+   * \param max_spinning_threads 0 means no limit.
+   */
+  ORT_API2_STATUS(SetGlobalMaxSpinningThreads, _Inout_ OrtThreadingOptions* tp_options, int max_spinning_threads);
+
+  /**
+   * Use this API to configure the global thread pool options to be used in the call to CreateEnvWithGlobalThreadPools.
+   * Share a budget of cores between the global intra-op thread pool and the per session intra-op thread pools of
+   * sessions that opt in via the "session.use_env_core_budget" config entry. The budget is periodically divided
+   * between the pools according to how much work is queued on each.
+   * \param core_budget 0 means no sharing (the default).
+   */
+  ORT_API2_STATUS(SetGlobalCoreBudget, _Inout_ OrtThreadingOptions* tp_options, int core_budget);
+
+  /**
+   * Change the number of threads used to parallelize the execution within nodes of a session, at runtime.
+   * The session must use per session thread pools, and cannot use more threads than it was created with.
+   * \param intra_op_num_threads 1 means work is only run on the calling thread.
+   */
+  ORT_API2_STATUS(SessionSetIntraOpNumThreads, _Inout_ OrtSession* sess, int intra_op_num_threads);
+
+  /**
+   * Change the number of threads used by the global intra-op thread pool of an env, at runtime.
+   * The pool cannot use more threads than it was created with.
+   */
+  ORT_API2_STATUS(EnvSetGlobalIntraOpNumThreads, _Inout_ OrtEnv* env, int intra_op_num_threads);
 };
 
 /*
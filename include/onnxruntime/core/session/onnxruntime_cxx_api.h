@@ -216,6 +216,13 @@ struct RunOptions : Base<OrtRunOptions> {
   RunOptions& SetTerminate();
   // unset the terminate flag so this RunOptions instance can be used in a new Session::Run call
   RunOptions& UnsetTerminate();
+
+  RunOptions& SetRunPriority(OrtRunPriority priority);
+  OrtRunPriority GetRunPriority() const;
+
+  // deadline of each Session::Run call in milliseconds from its start. 0 means no deadline.
+  RunOptions& SetRunDeadline(int64_t deadline_ms);
+  int64_t GetRunDeadline() const;
 };
 
 struct SessionOptions : Base<OrtSessionOptions> {
@@ -282,6 +289,8 @@ struct Session : Base<OrtSession> {
 
   void Run(const RunOptions& run_options, const struct IoBinding&);
 
+  void SetIntraOpNumThreads(int intra_op_num_threads);
+
   size_t GetInputCount() const;
   size_t GetOutputCount() const;
   size_t GetOverridableInitializerCount() const;
@@ -387,6 +387,28 @@ inline RunOptions& RunOptions::UnsetTerminate() {
   return *this;
 }
 
+inline RunOptions& RunOptions::SetRunPriority(OrtRunPriority priority) {
+  ThrowOnError(GetApi().RunOptionsSetRunPriority(p_, priority));
+  return *this;
+}
+
+inline OrtRunPriority RunOptions::GetRunPriority() const {
+  OrtRunPriority out;
+  ThrowOnError(GetApi().RunOptionsGetRunPriority(p_, &out));
+  return out;
+}
+
+inline RunOptions& RunOptions::SetRunDeadline(int64_t deadline_ms) {
+  ThrowOnError(GetApi().RunOptionsSetRunDeadline(p_, deadline_ms));
+  return *this;
+}
+
+inline int64_t RunOptions::GetRunDeadline() const {
+  int64_t out;
+  ThrowOnError(GetApi().RunOptionsGetRunDeadline(p_, &out));
+  return out;
+}
+
 inline SessionOptions::SessionOptions() {
   ThrowOnError(GetApi().CreateSessionOptions(&p_));
 }
@@ -547,6 +569,10 @@ inline char* Session::GetOverridableInitializerName(size_t index, OrtAllocator*
   return out;
 }
 
+inline void Session::SetIntraOpNumThreads(int intra_op_num_threads) {
+  ThrowOnError(GetApi().SessionSetIntraOpNumThreads(p_, intra_op_num_threads));
+}
+
 inline char* Session::EndProfiling(OrtAllocator* allocator) const {
   char* out;
   ThrowOnError(GetApi().SessionEndProfiling(p_, allocator, &out));
@@ -40,3 +40,54 @@ static const char* const kOrtSessionOptionsConfigSaveModelFormat = "session.save
 // Note that an alternative way not using this option at runtime is to train and export a model without denormals
 // and that's recommended because turning this option on may hurt model accuracy.
 static const char* const kOrtSessionOptionsConfigSetDenormalAsZero = "session.set_denormal_as_zero";
+
+// If a value is "1", the spin duration of idle threads in the session's thread pools adapts to how frequently
+// parallel work arrives, instead of spinning for a fixed number of iterations. The default is "0".
+// This only applies when the session uses per session thread pools with spinning allowed.
+static const char* const kOrtSessionOptionsConfigAdaptiveSpinning = "session.adaptive_spinning";
+
+// If a value is "1", the session's per session intra-op thread pool shares the core budget of the env it is created
+// in (see SetGlobalCoreBudget), growing and shrinking with its share of the queued work. The default is "0".
+static const char* const kOrtSessionOptionsConfigUseEnvCoreBudget = "session.use_env_core_budget";
+
+// If a value is "1", the graph partitioner only gives a node to an execution provider other than the CPU execution
+// provider if it's estimated to run faster there once the cost of copying the values that cross the partition
+// boundaries is counted. Small or slow partitions are left to the providers that come later in the order of
+// preference. The default is "0". The placement of each node and the reason for it are logged at INFO level.
+static const char* const kOrtSessionOptionsConfigCostBasedPartitioning = "session.partitioning.cost_based";
+
+// Path of a profile written by a previous run of the model with profiling enabled, used to get the cost of
+// the nodes for the cost based partitioning. The nodes missing from the profile use estimated costs.
+static const char* const kOrtSessionOptionsConfigPartitioningProfileFile = "session.partitioning.profile_file";
+
+// Comma separated names of graph inputs that change slowly across runs, e.g. the embedding of a user.
+// The nodes that only depend on these inputs and on constant initializers are memoized: their outputs are cached,
+// keyed by the values of the inputs, and the runs that feed the same values skip them. Only the nodes assigned to
+// the CPU execution provider are memoized, and only with the sequential execution mode. The hits and misses of each
+// run are reported by the profiler.
+static const char* const kOrtSessionOptionsConfigMemoizationStableInputs = "session.memoization.stable_inputs";
+
+// Max number of bytes used by the cached outputs of the memoized nodes, see
+// kOrtSessionOptionsConfigMemoizationStableInputs. The least recently used outputs are evicted beyond it.
+// The default is 67108864 (64MB).
+static const char* const kOrtSessionOptionsConfigMemoizationByteBudget = "session.memoization.byte_budget";
+
+// Directory of an on disk cache of compiled sessions. If set, Initialize looks up the session in the cache by a hash
+// of the model, the session options, the execution providers, the instruction sets of the CPU and the version of
+// ORT. On a hit the optimized and partitioned graph and the session state are loaded from the cache, skipping the
+// graph optimizations and the partitioning. On a miss they're added to the cache once the session is initialized.
+// Only the sessions that run on the CPU execution provider alone, without custom ops, custom graph transformers or
+// shared initializers, are cached. A failure to read or write the cache is logged and the session is compiled as if it wasn't set.
+static const char* const kOrtSessionOptionsConfigCompilationCacheDir = "session.compilation_cache.dir";
+
+// Max number of bytes used by the files of the compilation cache, see kOrtSessionOptionsConfigCompilationCacheDir.
+// The least recently added files are deleted beyond it. The default is 1073741824 (1GB).
+static const char* const kOrtSessionOptionsConfigCompilationCacheMaxBytes = "session.compilation_cache.max_bytes";
+
+// Set to "float16", "bfloat16" or "int8" to store the float embedding tables of the model in that format, which
+// reduces their memory and the memory bandwidth of looking them up at the cost of some accuracy. A table is
+// compressed when it's a 2D constant initializer only used as the data of Gather nodes on axis 0 or as the word
+// embedding of EmbedLayerNormalization nodes, all assigned to the CPU execution provider. With "int8" each row is
+// quantized with its own scale and zero point. The rows are converted back to float as they're looked up.
+// Unset by default, which leaves the tables as they are.
+static const char* const kOrtSessionOptionsConfigEmbeddingTableFormat = "session.embedding_table_format";
@@ -3,6 +3,7 @@
 
 #include "embed_layer_norm.h"
 #include "embed_layer_norm_helper.h"
+#include "contrib_ops/cpu/quantization/embedding_table.h"
 #include "core/util/math_cpuonly.h"
 #include "core/platform/threadpool.h"
 
@@ -11,15 +12,21 @@
 namespace onnxruntime {
 namespace contrib {
 // These ops are internal-only, so register outside of onnx
-#define REGISTER_KERNEL_TYPED(T)                                  \
-  ONNX_OPERATOR_TYPED_KERNEL_EX(                                  \
-      EmbedLayerNormalization,                                    \
-      kMSDomain,                                                  \
-      1,                                                          \
-      T,                                                          \
-      kCpuExecutionProvider,                                      \
-      KernelDefBuilder()                                          \
-          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>()), \
+// The word embedding may be compressed to float16, bfloat16 or per row int8/uint8, see EmbeddingTable.
+#define REGISTER_KERNEL_TYPED(T)                                                      \
+  ONNX_OPERATOR_TYPED_KERNEL_EX(                                                      \
+      EmbedLayerNormalization,                                                        \
+      kMSDomain,                                                                      \
+      1,                                                                              \
+      T,                                                                              \
+      kCpuExecutionProvider,                                                          \
+      KernelDefBuilder()                                                              \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())                      \
+          .TypeConstraint("T2", {DataTypeImpl::GetTensorType<T>(),                    \
+                                 DataTypeImpl::GetTensorType<MLFloat16>(),            \
+                                 DataTypeImpl::GetTensorType<BFloat16>(),             \
+                                 DataTypeImpl::GetTensorType<int8_t>(),               \
+                                 DataTypeImpl::GetTensorType<uint8_t>()}),            \
       EmbedLayerNorm<T>);
 
 REGISTER_KERNEL_TYPED(float)
@@ -42,6 +49,9 @@ Status EmbedLayerNorm<T>::Compute(OpKernelContext* context) const {
   const Tensor* beta = context->Input<Tensor>(6);
   const Tensor* mask = context->Input<Tensor>(7);  // optional. nullptr if not provided
 
+  EmbeddingTable word_embedding_table;
+  ORT_RETURN_IF_ERROR(word_embedding_table.Init(*word_embedding, context->Input<Tensor>(8), context->Input<Tensor>(9)));
+
   const auto& input_dims = input_ids->Shape().GetDims();
   int64_t hidden_size = word_embedding->Shape()[1];
 
@@ -54,13 +64,12 @@ Status EmbedLayerNorm<T>::Compute(OpKernelContext* context) const {
   int batch_size = static_cast<int>(input_dims[0]);
   int sequence_length = static_cast<int>(input_dims[1]);
 
-  int word_embedding_length = static_cast<int>(word_embedding->Shape()[0]);
+  int word_embedding_length = static_cast<int>(word_embedding_table.RowCount());
   int position_embedding_length = static_cast<int>(position_embedding->Shape()[0]);
   int segment_embedding_length = (nullptr == segment_embedding) ? 0 : static_cast<int>(segment_embedding->Shape()[0]);
 
   const int32_t* input_ids_data = input_ids->template Data<int32_t>();
   const int32_t* segment_ids_data = (nullptr == segment_ids) ? nullptr : segment_ids->template Data<int32_t>();
-  const T* word_embedding_data = word_embedding->template Data<T>();
   const T* position_embedding_data = position_embedding->template Data<T>();
   const T* segment_embedding_data = (nullptr == segment_embedding) ? nullptr : segment_embedding->template Data<T>();
   const T* gamma_data = gamma->template Data<T>();
@@ -72,7 +81,7 @@ Status EmbedLayerNorm<T>::Compute(OpKernelContext* context) const {
     std::atomic_bool failed{false};
 
     int n = batch_size * sequence_length;
-    concurrency::ThreadPool::TryBatchParallelFor(context->GetOperatorThreadPool(), n, [=, &failed](ptrdiff_t index) {
+    concurrency::ThreadPool::TryBatchParallelFor(context->GetOperatorThreadPool(), n, [=, &word_embedding_table, &failed](ptrdiff_t index) {
       int word_col_index = input_ids_data[index];
       if (word_col_index < 0 || word_col_index >= word_embedding_length) {
         failed.store(true, std::memory_order_release);
@@ -93,13 +102,15 @@ Status EmbedLayerNorm<T>::Compute(OpKernelContext* context) const {
       }
 
       T* y = output_data + index * hidden_size;
-      const T* input_word_embedding = word_embedding_data + word_col_index * hidden_size;
       const T* input_position_embedding = position_embedding_data + position_col_index * hidden_size;
       const T* input_segment_embedding = (nullptr == segment_embedding_data) ? nullptr : segment_embedding_data + segment_col_index * hidden_size;
 
+      // the word embedding row is converted to float straight into y, then the other embeddings are added to it
+      word_embedding_table.GetRow(word_col_index, y);
+
       T sum = static_cast<T>(0);
       for (int i = 0; i < hidden_size; i++) {
-        T subtotal = input_word_embedding[i] + input_position_embedding[i];
+        T subtotal = y[i] + input_position_embedding[i];
         if (nullptr != segment_embedding_data)
           subtotal += input_segment_embedding[i];
         y[i] = subtotal;
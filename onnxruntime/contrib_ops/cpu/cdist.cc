@@ -2,8 +2,13 @@
 // Licensed under the MIT License.
 
 #include "cdist.h"
+
+#include <algorithm>
+#include <cmath>
+
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "core/mlas/inc/mlas.h"
@@ -17,78 +22,114 @@ namespace contrib {
 DEFINE_KERNEL(float);
 DEFINE_KERNEL(double);
 
+namespace {
+
+// The output is computed in tiles of kTileRows rows of A by a block of rows of B, one GEMM per tile, with the block
+// of B sized so it fits in the L2 cache along with the rows of A and the tile.
+// Each tile is converted to distances (and selected from for top-k) while it is still in the cache,
+// instead of in separate passes over the whole output.
+constexpr int64_t kTileRows = 64;
+constexpr int64_t kBlockOfBBytes = 128 * 1024;
+constexpr int64_t kMinTileCols = 16;
+constexpr int64_t kMaxTileCols = 1024;
+
 template <typename T>
-static void CalculateSqeuclidean(const Tensor& a, const Tensor& b, Tensor& c, concurrency::ThreadPool* threadpool) {
-  // input shapes have already been validated
-  const auto& shape_a = a.Shape().GetDims();  // {m, k}
-  const auto& shape_b = b.Shape().GetDims();  // {n, k}
-  int64_t m = shape_a[0];
-  int64_t n = shape_b[0];
-  int64_t k = shape_a[1];
+struct Candidate {
+  T value;
+  int64_t index;
+};
 
-  // https://github.com/droyed/eucl_dist/wiki/Main-Article
-  // dist(Xi,Yj) = sum_k(Xik**2) + sum_k(Yjk**2) - 2*sum_k(Xik*Yjk)
+// Orders the candidates nearest first: by value, ascending or descending, then by index. NaNs are the farthest.
+template <typename T>
+struct IsNearer {
+  bool largest;
+
+  bool operator()(const Candidate<T>& a, const Candidate<T>& b) const {
+    const bool a_is_nan = std::isnan(a.value);
+    const bool b_is_nan = std::isnan(b.value);
+    if (a_is_nan != b_is_nan) {
+      return b_is_nan;
+    }
+
+    if (!a_is_nan && a.value != b.value) {
+      return largest ? a.value > b.value : a.value < b.value;
+    }
 
-  const auto* a_data = a.Data<T>();
-  const auto* b_data = b.Data<T>();
-  auto* c_data = c.MutableData<T>();
-
-  // ReduceSumSquare for A
-  std::vector<T> a_ss;
-  a_ss.resize(m);
-  const auto* cur_a = a_data;
-  for (int64_t i = 0; i < m; ++i) {
-    a_ss[i] = ConstEigenVectorMap<T>(cur_a, k).squaredNorm();
-    cur_a += k;
+    return a.index < b.index;
   }
+};
 
-  // ReduceSumSquare for B
-  std::vector<T> b_ss;
-  b_ss.resize(n);
-  const auto* cur_b = b_data;
-  for (int64_t i = 0; i < n; ++i) {
-    b_ss[i] = ConstEigenVectorMap<T>(cur_b, k).squaredNorm();
-    cur_b += k;
+// Adds candidate to heap, which holds the up to k nearest candidates seen so far with the farthest on top.
+template <typename T>
+void AddCandidate(Candidate<T>* heap, int64_t& size, int64_t k, const Candidate<T>& candidate,
+                  const IsNearer<T>& is_nearer) {
+  if (size < k) {
+    heap[size++] = candidate;
+    std::push_heap(heap, heap + size, is_nearer);
+  } else if (is_nearer(candidate, heap[0])) {
+    std::pop_heap(heap, heap + size, is_nearer);
+    heap[size - 1] = candidate;
+    std::push_heap(heap, heap + size, is_nearer);
   }
+}
 
-  // NOTE: We want to avoid subtracting two numbers that are very close to each other as that can lead to
-  // 'catastrophic cancellation'. (sum_k(Xik**2) + sum_k(Yjk**2)) would be close to 2*sum_k(Xik*Yjk) if the values
-  // in Xij and Yjk are very similar, so subtracting can be problematic.
-  // Due to that we calculate -2*sum_k(Xik*Yjk) using GEMM, add sum_k(Xik**2) next, and add sum_k(Yjk**2) last.
+// Squared L2 norms of the rows for the euclidean metrics, their inverse L2 norms for cosine.
+template <typename T>
+std::vector<T> RowNorms(const T* data, int64_t rows, int64_t cols, bool inverse,
+                        concurrency::ThreadPool* threadpool) {
+  std::vector<T> norms(static_cast<size_t>(rows));
+  const TensorOpCost cost{static_cast<double>(cols * sizeof(T)), static_cast<double>(sizeof(T)),
+                          static_cast<double>(cols * 2)};
+  concurrency::ThreadPool::TryParallelFor(
+      threadpool, static_cast<std::ptrdiff_t>(rows), cost, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          const T squared_norm = ConstEigenVectorMap<T>(data + i * cols, cols).squaredNorm();
+          // a zero row has no direction, so its cosine distances are NaN as in scipy
+          norms[i] = inverse ? static_cast<T>(1) / std::sqrt(squared_norm) : squared_norm;
+        }
+      });
 
-// use MLAS on 64-bit (no 32-bit dgemm)
-#if defined(_M_AMD64) || defined(__x86_64__)
-  // Use GEMM of A and B^T with -2 as alpha to calculate -2*sum_k(Xik*Yjk)
-  math::Gemm<T>(CBLAS_TRANSPOSE::CblasNoTrans, CBLAS_TRANSPOSE::CblasTrans,
-                m, n, k,
-                static_cast<T>(-2.), a_data, b_data, static_cast<T>(0.),
-                c_data,
-                threadpool);
-#else
-  // the performance of this isn't great as the eigen matmul is single threaded by default
-  // if you're on x86 and care about performance try MKL first. if there's a good enough argument for optimising this
-  // we can look into it in the future.
-  ORT_UNUSED_PARAMETER(threadpool);
-
-  // https://eigen.tuxfamily.org/dox/TopicWritingEfficientProductExpression.html
-  auto out_map = EigenMatrixMapRowMajor<T>(c_data, m, n);
-  out_map.noalias() = static_cast<T>(-2.) *
-                      (ConstEigenMatrixMapRowMajor<T>(a_data, m, k) *
-                       ConstEigenMatrixMapRowMajor<T>(b_data, n, k).transpose());
-#endif
-
-  // add a_ss and b_ss, with broadcast
-  // output shape is {m, n}
-  auto* cur_out = c_data;
-  for (int64_t i = 0; i < m; ++i) {
-    T a_val = a_ss[i];
-    for (int64_t j = 0; j < n; ++j) {
-      *cur_out = (*cur_out + a_val) + b_ss[j];
-      ++cur_out;
+  return norms;
+}
+
+// Converts the tile of dot products of rows of A and B, computed with the alpha of the metric, to distances.
+// a_norms and b_norms point to the norms of the first row of A and B of the tile.
+template <typename T>
+void ToDistances(typename CDist<T>::Mode mode, const T* products, int64_t rows, int64_t cols, const T* a_norms,
+                 const T* b_norms, T* distances, int64_t ld_distances) {
+  using Mode = typename CDist<T>::Mode;
+  for (int64_t i = 0; i < rows; ++i) {
+    const T* row_products = products + i * cols;
+    T* row_distances = distances + i * ld_distances;
+    switch (mode) {
+      // because of the GEMM there's a slight chance a number extremely close to zero could be negative,
+      // so abs() is needed to avoid NaNs in the results.
+      case Mode::SQEUCLIDEAN:
+        for (int64_t j = 0; j < cols; ++j) {
+          row_distances[j] = std::abs((row_products[j] + a_norms[i]) + b_norms[j]);
+        }
+        break;
+      case Mode::EUCLIDEAN:
+        for (int64_t j = 0; j < cols; ++j) {
+          row_distances[j] = std::sqrt(std::abs((row_products[j] + a_norms[i]) + b_norms[j]));
+        }
+        break;
+      case Mode::COSINE:
+        for (int64_t j = 0; j < cols; ++j) {
+          row_distances[j] = static_cast<T>(1) - row_products[j] * a_norms[i] * b_norms[j];
+        }
+        break;
+      case Mode::INNER_PRODUCT:
+        if (row_distances != row_products) {
+          std::copy_n(row_products, cols, row_distances);
+        }
+        break;
     }
   }
 }
 
+}  // namespace
+
 template <typename T>
 common::Status CDist<T>::Compute(OpKernelContext* context) const {
   concurrency::ThreadPool* tp = context->GetOperatorThreadPool();
@@ -109,21 +150,131 @@ common::Status CDist<T>::Compute(OpKernelContext* context) const {
     return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Input shape dimensions mismatch:", shape_a, " and ", shape_b);
   }
 
-  TensorShape output_shape = {shape_a[0], shape_b[0]};
-  Tensor* C = context->Output(0, output_shape);
-  T* output = C->MutableData<T>();
+  const int64_t m = shape_a[0];
+  const int64_t n = shape_b[0];
+  const int64_t k = shape_a[1];
+  if (top_k_ > n) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "k (", top_k_, ") is larger than the number of rows of B (",
+                           n, ")");
+  }
+
+  const T* a_data = A->Data<T>();
+  const T* b_data = B->Data<T>();
+
+  // https://github.com/droyed/eucl_dist/wiki/Main-Article
+  // dist(Xi,Yj) = sum_k(Xik**2) + sum_k(Yjk**2) - 2*sum_k(Xik*Yjk)
+  //
+  // NOTE: We want to avoid subtracting two numbers that are very close to each other as that can lead to
+  // 'catastrophic cancellation'. (sum_k(Xik**2) + sum_k(Yjk**2)) would be close to 2*sum_k(Xik*Yjk) if the values
+  // in Xij and Yjk are very similar, so subtracting can be problematic.
+  // Due to that we calculate -2*sum_k(Xik*Yjk) using GEMM, add sum_k(Xik**2) next, and add sum_k(Yjk**2) last.
+  //
+  // The cosine distance is 1 - sum_k(Xik*Yjk) / (|Xi| * |Yj|), and the inner product is the GEMM alone.
+  const bool is_euclidean = mode_ == Mode::EUCLIDEAN || mode_ == Mode::SQEUCLIDEAN;
+  const T alpha = static_cast<T>(is_euclidean ? -2. : 1.);
+  std::vector<T> a_norms;
+  std::vector<T> b_norms;
+  if (mode_ != Mode::INNER_PRODUCT) {
+    a_norms = RowNorms(a_data, m, k, mode_ == Mode::COSINE, tp);
+    b_norms = RowNorms(b_data, n, k, mode_ == Mode::COSINE, tp);
+  }
+
+  // The tasks are the row blocks of A, times partitions of the rows of B when there are fewer row blocks than
+  // threads. Each task runs its GEMMs single threaded.
+  const int64_t tile_cols = std::min(kMaxTileCols,
+                                     std::max(kMinTileCols, kBlockOfBBytes / static_cast<int64_t>(k * sizeof(T))));
+  const int64_t row_blocks = (m + kTileRows - 1) / kTileRows;
+  const int64_t col_blocks = (n + tile_cols - 1) / tile_cols;
+  const int64_t threads = concurrency::ThreadPool::DegreeOfParallelism(tp);
+  const int64_t col_partitions =
+      std::max<int64_t>(1, std::min(col_blocks, row_blocks == 0 ? 1 : (threads + row_blocks - 1) / row_blocks));
+
+  // Calls fn(row, rows, col, cols, tile) with the distances of each tile of the task, stored contiguously in tile.
+  auto for_each_tile = [&](std::ptrdiff_t task, auto&& fn) {
+    const int64_t row = (task / col_partitions) * kTileRows;
+    const int64_t rows = std::min(kTileRows, m - row);
+    // partition whole blocks of B, so a task doesn't end with a sliver of a tile
+    const auto blocks = concurrency::ThreadPool::PartitionWork(task % col_partitions, col_partitions, col_blocks);
+    const int64_t col_end = std::min(n, blocks.end * tile_cols);
+    std::vector<T> tile(static_cast<size_t>(rows * tile_cols));
+    for (int64_t col = blocks.start * tile_cols; col < col_end; col += tile_cols) {
+      const int64_t cols = std::min(tile_cols, col_end - col);
+      math::Gemm<T>(CBLAS_TRANSPOSE::CblasNoTrans, CBLAS_TRANSPOSE::CblasTrans,
+                    rows, cols, k,
+                    alpha, a_data + row * k, b_data + col * k, static_cast<T>(0.),
+                    tile.data(),
+                    nullptr);
+      fn(row, rows, col, cols, tile.data());
+    }
+  };
 
-  CalculateSqeuclidean<T>(*A, *B, *C, tp);
-  auto map_out = EigenVectorArrayMap<T>(output, output_shape.Size());
+  const T* a_norms_data = a_norms.data();
+  const T* b_norms_data = b_norms.data();
+  const std::ptrdiff_t num_tasks = static_cast<std::ptrdiff_t>(row_blocks * col_partitions);
 
-  // because we use GEMM in CalculateSqeuclidean there's a slight chance a number extremely close to zero
-  // could be negative, so we need to run abs() to avoid NaN's in the results.
-  if (mode_ == Mode::EUCLIDEAN) {
-    map_out = map_out.abs().sqrt();  // do both abs and sqrt in one call so Eigen has a chance to combine
-  } else if (mode_ == Mode::SQEUCLIDEAN) {
-    map_out = map_out.abs();
+  if (top_k_ == 0) {
+    Tensor* C = context->Output(0, {m, n});
+    T* output = C->MutableData<T>();
+    concurrency::ThreadPool::TrySimpleParallelFor(tp, num_tasks, [&](std::ptrdiff_t task) {
+      for_each_tile(task, [&](int64_t row, int64_t rows, int64_t col, int64_t cols, T* tile) {
+        ToDistances<T>(mode_, tile, rows, cols, a_norms_data + row, b_norms_data + col, output + row * n + col, n);
+      });
+    });
+
+    // the indices are only meaningful with k, but an unused optional output may still be wired up
+    context->Output(1, {m, 0});
+    return Status::OK();
   }
 
+  // Each task keeps the k nearest rows of its partition of B to each of its rows of A in a heap.
+  // The heaps of the partitions are merged at the end.
+  const IsNearer<T> is_nearer{mode_ == Mode::INNER_PRODUCT};
+  std::vector<Candidate<T>> heaps(static_cast<size_t>(col_partitions * m * top_k_));
+  std::vector<int64_t> heap_sizes(static_cast<size_t>(col_partitions * m), 0);
+  concurrency::ThreadPool::TrySimpleParallelFor(tp, num_tasks, [&](std::ptrdiff_t task) {
+    const int64_t partition = task % col_partitions;
+    for_each_tile(task, [&](int64_t row, int64_t rows, int64_t col, int64_t cols, T* tile) {
+      ToDistances<T>(mode_, tile, rows, cols, a_norms_data + row, b_norms_data + col, tile, cols);
+      for (int64_t i = 0; i < rows; ++i) {
+        const int64_t heap_index = partition * m + row + i;
+        Candidate<T>* heap = heaps.data() + heap_index * top_k_;
+        int64_t& heap_size = heap_sizes[heap_index];
+        const T* distances = tile + i * cols;
+        for (int64_t j = 0; j < cols; ++j) {
+          AddCandidate(heap, heap_size, top_k_, Candidate<T>{distances[j], col + j}, is_nearer);
+        }
+      }
+    });
+  });
+
+  Tensor* C = context->Output(0, {m, top_k_});
+  Tensor* indices = context->Output(1, {m, top_k_});
+  T* output = C->MutableData<T>();
+  int64_t* output_indices = indices != nullptr ? indices->MutableData<int64_t>() : nullptr;
+  const TensorOpCost merge_cost{0, static_cast<double>(top_k_ * (sizeof(T) + sizeof(int64_t))),
+                                static_cast<double>(col_partitions * top_k_ * 8)};
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(m), merge_cost, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        std::vector<Candidate<T>> candidates;
+        candidates.reserve(static_cast<size_t>(col_partitions * top_k_));
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          candidates.clear();
+          for (int64_t partition = 0; partition < col_partitions; ++partition) {
+            const int64_t heap_index = partition * m + i;
+            const Candidate<T>* heap = heaps.data() + heap_index * top_k_;
+            candidates.insert(candidates.end(), heap, heap + heap_sizes[heap_index]);
+          }
+
+          std::partial_sort(candidates.begin(), candidates.begin() + top_k_, candidates.end(), is_nearer);
+          for (int64_t j = 0; j < top_k_; ++j) {
+            output[i * top_k_ + j] = candidates[j].value;
+            if (output_indices != nullptr) {
+              output_indices[i * top_k_ + j] = candidates[j].index;
+            }
+          }
+        }
+      });
+
   return Status::OK();
 }
 
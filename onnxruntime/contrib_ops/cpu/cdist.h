@@ -11,13 +11,12 @@ namespace contrib {
 
 template <typename T>
 class CDist final : public OpKernel {
- private:
-  typedef void (*DistFunc)(const T* a, const T* b, T* dest, size_t ma, size_t mb, size_t n,
-                           concurrency::ThreadPool* tp);
+ public:
   enum class Mode { EUCLIDEAN,
-                    SQEUCLIDEAN } mode_;
+                    SQEUCLIDEAN,
+                    COSINE,
+                    INNER_PRODUCT };
 
- public:
   CDist(const OpKernelInfo& info) : OpKernel(info) {
     std::string metric;
     ORT_ENFORCE(info.GetAttr<std::string>("metric", &metric).IsOK());
@@ -25,11 +24,22 @@ class CDist final : public OpKernel {
       mode_ = Mode::SQEUCLIDEAN;
     else if (metric.compare("euclidean") == 0) {
       mode_ = Mode::EUCLIDEAN;
+    } else if (metric.compare("cosine") == 0) {
+      mode_ = Mode::COSINE;
+    } else if (metric.compare("inner_product") == 0) {
+      mode_ = Mode::INNER_PRODUCT;
     } else
       ORT_NOT_IMPLEMENTED();
+
+    top_k_ = info.GetAttrOrDefault<int64_t>("k", 0);
+    ORT_ENFORCE(top_k_ >= 0, "k must not be negative: ", top_k_);
   }
 
   common::Status Compute(OpKernelContext* context) const override;
+
+ private:
+  Mode mode_;
+  int64_t top_k_;  // 0 for the full distance matrix
 };
 
 }  // namespace contrib
@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/quantization/embedding_table.h"
+#include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+class DequantizeGather final : public OpKernel {
+ public:
+  explicit DequantizeGather(const OpKernelInfo& info) : OpKernel(info) {}
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+ONNX_OPERATOR_KERNEL_EX(
+    DequantizeGather,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T1", {DataTypeImpl::GetTensorType<MLFloat16>(),
+                               DataTypeImpl::GetTensorType<BFloat16>(),
+                               DataTypeImpl::GetTensorType<int8_t>(),
+                               DataTypeImpl::GetTensorType<uint8_t>()})
+        .TypeConstraint("Tind", {DataTypeImpl::GetTensorType<int32_t>(),
+                                 DataTypeImpl::GetTensorType<int64_t>()}),
+    DequantizeGather);
+
+template <typename Tind>
+static Status GatherRows(const EmbeddingTable& table, const Tensor& indices, float* output,
+                         concurrency::ThreadPool* thread_pool) {
+  const Tind* indices_data = indices.Data<Tind>();
+  const int64_t count = indices.Shape().Size();
+  const int64_t row_count = table.RowCount();
+  const int64_t row_size = table.RowSize();
+
+  // negative indices count from the end, as with Gather
+  for (int64_t i = 0; i < count; ++i) {
+    const int64_t index = static_cast<int64_t>(indices_data[i]);
+    if (index < -row_count || index >= row_count) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "indices element out of data bounds, idx=", index,
+                             " must be within the inclusive range [", -row_count, ",", row_count - 1, "]");
+    }
+  }
+
+  const TensorOpCost cost{static_cast<double>(row_size), static_cast<double>(row_size * sizeof(float)),
+                          static_cast<double>(row_size)};
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(count), cost, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          const int64_t index = static_cast<int64_t>(indices_data[i]);
+          table.GetRow(index < 0 ? index + row_count : index, output + i * row_size);
+        }
+      });
+
+  return Status::OK();
+}
+
+Status DequantizeGather::Compute(OpKernelContext* context) const {
+  const Tensor& data = *context->Input<Tensor>(0);
+  const Tensor& indices = *context->Input<Tensor>(1);
+  const Tensor* scale = context->Input<Tensor>(2);
+  const Tensor* zero_point = context->Input<Tensor>(3);
+
+  EmbeddingTable table;
+  ORT_RETURN_IF_ERROR(table.Init(data, scale, zero_point));
+
+  std::vector<int64_t> output_dims = indices.Shape().GetDims();
+  output_dims.push_back(table.RowSize());
+  Tensor* output = context->Output(0, TensorShape(output_dims));
+  float* output_data = output->MutableData<float>();
+
+  if (indices.IsDataType<int32_t>()) {
+    return GatherRows<int32_t>(table, indices, output_data, context->GetOperatorThreadPool());
+  }
+
+  return GatherRows<int64_t>(table, indices, output_data, context->GetOperatorThreadPool());
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/quantization/embedding_table.h"
+
+#include <cstring>
+
+#include "core/mlas/inc/mlas.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+template <typename T>
+static void DequantizeRow(const T* row, float scale, T zero_point, float* output, int64_t size) {
+  const int32_t zero = static_cast<int32_t>(zero_point);
+  for (int64_t i = 0; i < size; ++i) {
+    output[i] = static_cast<float>(static_cast<int32_t>(row[i]) - zero) * scale;
+  }
+}
+
+Status EmbeddingTable::Init(const Tensor& table, const Tensor* scale, const Tensor* zero_point) {
+  const auto& dims = table.Shape().GetDims();
+  if (dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "embedding table is expected to have 2 dimensions, got ", dims.size());
+  }
+
+  table_ = &table;
+  row_count_ = dims[0];
+  row_size_ = dims[1];
+  scale_ = nullptr;
+  zero_point_ = nullptr;
+
+  const bool is_quantized = table.IsDataType<int8_t>() || table.IsDataType<uint8_t>();
+  if (!is_quantized) {
+    if (nullptr != scale || nullptr != zero_point) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "scale and zero point are only supported with an 8-bit integer embedding table");
+    }
+
+    return Status::OK();
+  }
+
+  if (nullptr == scale) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "8-bit integer embedding table requires a scale");
+  }
+
+  if (scale->Shape().NumDimensions() != 1 || scale->Shape()[0] != row_count_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "scale of embedding table is expected to have shape (", row_count_, "), got ",
+                           scale->Shape());
+  }
+
+  if (nullptr != zero_point &&
+      (zero_point->DataType() != table.DataType() || zero_point->Shape() != scale->Shape())) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "zero point of embedding table is expected to have the type of the table and shape (",
+                           row_count_, ")");
+  }
+
+  scale_ = scale->Data<float>();
+  zero_point_ = zero_point;
+  return Status::OK();
+}
+
+void EmbeddingTable::GetRow(int64_t index, float* output) const {
+  const int64_t offset = index * row_size_;
+  if (table_->IsDataType<float>()) {
+    memcpy(output, table_->Data<float>() + offset, row_size_ * sizeof(float));
+  } else if (table_->IsDataType<MLFloat16>()) {
+    MlasConvertHalfToFloatBuffer(reinterpret_cast<const unsigned short*>(table_->Data<MLFloat16>() + offset), output,
+                                 static_cast<size_t>(row_size_));
+  } else if (table_->IsDataType<BFloat16>()) {
+    BFloat16ToFloat(table_->Data<BFloat16>() + offset, output, static_cast<size_t>(row_size_));
+  } else if (table_->IsDataType<int8_t>()) {
+    DequantizeRow(table_->Data<int8_t>() + offset, scale_[index],
+                  nullptr == zero_point_ ? int8_t{0} : zero_point_->Data<int8_t>()[index], output, row_size_);
+  } else {
+    DequantizeRow(table_->Data<uint8_t>() + offset, scale_[index],
+                  nullptr == zero_point_ ? uint8_t{0} : zero_point_->Data<uint8_t>()[index], output, row_size_);
+  }
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+/**
+ * Read only view of a 2D embedding table whose rows are converted to float as they're looked up.
+ * The table is a float, float16 or bfloat16 tensor, or an int8/uint8 tensor quantized per row with a scale and
+ * an optional zero point: row i is (table[i] - zero_point[i]) * scale[i].
+ */
+class EmbeddingTable {
+ public:
+  /**
+   * Checks the table and its quantization parameters. scale and zero_point are nullptr if not provided.
+   */
+  Status Init(const Tensor& table, const Tensor* scale, const Tensor* zero_point);
+
+  int64_t RowCount() const { return row_count_; }
+
+  int64_t RowSize() const { return row_size_; }
+
+  /**
+   * Writes the RowSize() values of row index to output as float.
+   */
+  void GetRow(int64_t index, float* output) const;
+
+ private:
+  const Tensor* table_ = nullptr;
+  const float* scale_ = nullptr;
+  const Tensor* zero_point_ = nullptr;
+  int64_t row_count_ = 0;
+  int64_t row_size_ = 0;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
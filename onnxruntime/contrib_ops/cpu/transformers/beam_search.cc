@@ -0,0 +1,894 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/transformers/beam_search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "contrib_ops/cpu/transformers/logits_processor.h"
+#include "core/common/safeint.h"
+#include "core/framework/allocator.h"
+#include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/session_state.h"
+#include "core/framework/utils.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+using namespace ONNX_NAMESPACE;
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_OPERATOR_KERNEL_EX(
+    BeamSearch,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("I", DataTypeImpl::GetTensorType<int32_t>()),
+    BeamSearch);
+
+ONNX_OPERATOR_KERNEL_EX(
+    GreedySearch,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("I", DataTypeImpl::GetTensorType<int32_t>()),
+    GreedySearch);
+
+// decoder subgraph inputs: input_ids, position_ids, attention_mask, past_0, ..., past_{L-1}
+// decoder subgraph outputs: logits, present_0, ..., present_{L-1}
+static constexpr int kFirstPastInputIndex = 3;
+static constexpr int kFirstPresentOutputIndex = 1;
+
+struct GenerationBase::DecoderInfo {
+  DecoderInfo(const onnxruntime::Node& node, const GraphViewer& subgraph_in)
+      : subgraph(subgraph_in) {
+    num_implicit_inputs = static_cast<int>(node.ImplicitInputDefs().size());
+
+    auto& subgraph_inputs = subgraph.GetInputs();
+    auto& subgraph_outputs = subgraph.GetOutputs();
+
+    num_subgraph_inputs = static_cast<int>(subgraph_inputs.size());
+    ORT_ENFORCE(num_subgraph_inputs > kFirstPastInputIndex,
+                "Graph in 'decoder' attribute should have input_ids, position_ids, attention_mask and at least "
+                "one past state input. Found ", num_subgraph_inputs, " inputs.");
+
+    num_layers = num_subgraph_inputs - kFirstPastInputIndex;
+    ORT_ENFORCE(static_cast<int>(subgraph_outputs.size()) == kFirstPresentOutputIndex + num_layers,
+                "Graph in 'decoder' attribute has ", num_layers, " past state inputs so requires ",
+                kFirstPresentOutputIndex + num_layers, " outputs but has ", subgraph_outputs.size());
+
+    for (const auto* input : subgraph_inputs) {
+      subgraph_input_names.push_back(input->Name());
+    }
+
+    for (const auto* output : subgraph_outputs) {
+      subgraph_output_names.push_back(output->Name());
+    }
+
+    input_ids_type = ElementType(*subgraph_inputs[0]);
+    position_ids_type = ElementType(*subgraph_inputs[1]);
+    attention_mask_type = ElementType(*subgraph_inputs[2]);
+    ORT_ENFORCE(input_ids_type == TensorProto::INT32 || input_ids_type == TensorProto::INT64,
+                "'decoder' input_ids must be int32 or int64");
+    ORT_ENFORCE(position_ids_type == TensorProto::INT32 || position_ids_type == TensorProto::INT64,
+                "'decoder' position_ids must be int32 or int64");
+    ORT_ENFORCE(attention_mask_type == TensorProto::FLOAT || attention_mask_type == TensorProto::INT32 ||
+                    attention_mask_type == TensorProto::INT64,
+                "'decoder' attention_mask must be float, int32 or int64");
+
+    // the empty past state of the first step needs the number of heads and the head size.
+    const auto* past_shape = subgraph_inputs[kFirstPastInputIndex]->Shape();
+    ORT_ENFORCE(past_shape != nullptr && past_shape->dim_size() == 5 &&
+                    past_shape->dim(2).has_dim_value() && past_shape->dim(4).has_dim_value(),
+                "'decoder' past state inputs must have shape (2, batch_size, num_heads, past_sequence_length, "
+                "head_size) with fixed num_heads and head_size.");
+    num_heads = past_shape->dim(2).dim_value();
+    head_size = past_shape->dim(4).dim_value();
+  }
+
+  static int32_t ElementType(const NodeArg& node_arg) {
+    const auto* type = node_arg.TypeAsProto();
+    return type && type->has_tensor_type() ? type->tensor_type().elem_type() : TensorProto::UNDEFINED;
+  }
+
+  const GraphViewer& subgraph;
+
+  int num_implicit_inputs;
+  int num_subgraph_inputs;
+  int num_layers;
+
+  int32_t input_ids_type;
+  int32_t position_ids_type;
+  int32_t attention_mask_type;
+
+  int64_t num_heads;
+  int64_t head_size;
+
+  std::vector<std::string> subgraph_input_names;
+  std::vector<std::string> subgraph_output_names;
+};
+
+GenerationBase::GenerationBase(const OpKernelInfo& info) : IControlFlowKernel(info) {
+  // make sure the attribute was present even though we don't need it here.
+  // The GraphProto is loaded as a Graph instance by main Graph::Resolve,
+  // and a SessionState instance for executing the subgraph is created by InferenceSession.
+  ONNX_NAMESPACE::GraphProto proto;
+  ORT_ENFORCE(info.GetAttr<ONNX_NAMESPACE::GraphProto>("decoder", &proto).IsOK());
+  ORT_IGNORE_RETURN_VALUE(proto);
+
+  int64_t eos_token_id = 0;
+  int64_t pad_token_id = 0;
+  ORT_ENFORCE(info.GetAttr<int64_t>("eos_token_id", &eos_token_id).IsOK());
+  ORT_ENFORCE(info.GetAttr<int64_t>("pad_token_id", &pad_token_id).IsOK());
+  eos_token_id_ = gsl::narrow<int32_t>(eos_token_id);
+  pad_token_id_ = gsl::narrow<int32_t>(pad_token_id);
+}
+
+// we need this to be in the .cc so 'unique_ptr<DecoderInfo> decoder_info_' can be handled
+GenerationBase::~GenerationBase() = default;
+
+common::Status GenerationBase::SetupSubgraphExecutionInfo(const SessionState& session_state,
+                                                          const std::string& attribute_name,
+                                                          const SessionState& subgraph_session_state) {
+  ORT_ENFORCE(decoder_info_ == nullptr, "SetupSubgraphExecutionInfo should only be called once for each subgraph.");
+  ORT_UNUSED_PARAMETER(attribute_name);
+
+  const auto& node = Node();
+  decoder_info_ = onnxruntime::make_unique<DecoderInfo>(node, subgraph_session_state.GetGraphViewer());
+
+  // the decoder inputs are created on CPU by the operator. implicit inputs come from the outer scope.
+  std::vector<std::string> feed_names = decoder_info_->subgraph_input_names;
+  for (auto& entry : node.ImplicitInputDefs()) {
+    feed_names.push_back(entry->Name());
+  }
+
+  std::vector<OrtDevice> feed_locations;
+  ORT_RETURN_IF_ERROR(controlflow::detail::FindDevicesForValues(session_state, feed_names, feed_locations,
+                                                                decoder_info_->num_subgraph_inputs));
+
+  std::unique_ptr<FeedsFetchesManager> ffm;
+  ORT_RETURN_IF_ERROR(FeedsFetchesManager::Create(feed_names, decoder_info_->subgraph_output_names,
+                                                  subgraph_session_state.GetOrtValueNameIdxMap(), ffm));
+  ORT_RETURN_IF_ERROR(utils::InitializeFeedFetchCopyInfo(subgraph_session_state, *ffm));
+
+  // the logits are processed and the present state is reordered on CPU.
+  const auto& cpu_allocator_info = session_state.GetExecutionProviders()
+                                       .Get(onnxruntime::kCpuExecutionProvider)
+                                       ->GetAllocator(0, OrtMemTypeDefault)
+                                       ->Info();
+  std::vector<const OrtMemoryInfo*> fetch_locations(decoder_info_->subgraph_output_names.size(),
+                                                    &cpu_allocator_info);
+
+  utils::FinalizeFeedFetchCopyInfo(*ffm, feed_locations, fetch_locations);
+
+  feeds_fetches_manager_ = std::move(ffm);
+
+  return Status::OK();
+}
+
+namespace {
+
+struct GenerationParameters {
+  int batch_size = 0;
+  int prompt_length = 0;
+  int max_length = 0;
+  int min_length = 0;
+  int num_beams = 1;
+  int num_return_sequences = 1;
+  float length_penalty = 1.0f;
+  float repetition_penalty = 1.0f;
+};
+
+// Reads an optional scalar input, leaving 'value' unchanged if the input is missing.
+template <typename T>
+Status ReadScalarInput(const OpKernelContext& context, int index, const char* name, T& value) {
+  const auto* tensor = context.Input<Tensor>(index);
+  if (tensor == nullptr) {
+    return Status::OK();
+  }
+
+  if (tensor->Shape().Size() != 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input '", name, "' should be a scalar. Got shape of ",
+                           tensor->Shape());
+  }
+
+  value = *tensor->Data<T>();
+  return Status::OK();
+}
+
+Status ValidatePrompt(const Tensor& input_ids, const Tensor* attention_mask, GenerationParameters& parameters) {
+  const auto& dims = input_ids.Shape().GetDims();
+  if (dims.size() != 2 || dims[0] <= 0 || dims[1] <= 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'input_ids' should have shape (batch_size, sequence_length). Got shape of ",
+                           input_ids.Shape());
+  }
+
+  if (attention_mask != nullptr && attention_mask->Shape() != input_ids.Shape()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'attention_mask' should have the same shape as 'input_ids'. Got shape of ",
+                           attention_mask->Shape());
+  }
+
+  parameters.batch_size = gsl::narrow<int>(dims[0]);
+  parameters.prompt_length = gsl::narrow<int>(dims[1]);
+
+  if (parameters.max_length <= parameters.prompt_length) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "'max_length' of ", parameters.max_length,
+                           " must be greater than the sequence length of 'input_ids' (", parameters.prompt_length, ")");
+  }
+
+  return Status::OK();
+}
+
+OrtValue MakeTensorValue(std::unique_ptr<Tensor> tensor) {
+  auto ml_tensor = DataTypeImpl::GetType<Tensor>();
+  return OrtValue{tensor.release(), ml_tensor, ml_tensor->GetDeleteFunc()};
+}
+
+template <typename T>
+void ConvertTo(const int32_t* src, T* dst, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = static_cast<T>(src[i]);
+  }
+}
+
+// Runs the decoder subgraph for each generation step. The feeds of the next step are created from the
+// chosen tokens, and the present state of the decoder is turned into the past state of the next step,
+// reordered by beam if needed, without leaving the operator.
+class DecoderRunner {
+ public:
+  DecoderRunner(OpKernelContextInternal& context,
+                const SessionState& session_state,
+                const GenerationBase::DecoderInfo& info,
+                const FeedsFetchesManager& ffm);
+
+  // Creates the feeds of the first step from the prompt, repeating each batch entry num_beams times.
+  Status Initialize(const Tensor& input_ids, const Tensor* attention_mask, int num_beams, int max_length);
+
+  // Runs the decoder for the current step.
+  Status Run();
+
+  int VocabSize() const { return vocab_size_; }
+
+  // Logits of the next token for the given sequence, valid until Advance is called.
+  gsl::span<const float> NextTokenLogits(int sequence_index) const;
+
+  // Creates the feeds of the next step. Sequence i continues with next_tokens[i] from sequence beam_indices[i],
+  // or from itself if beam_indices is empty.
+  Status Advance(gsl::span<const int32_t> next_tokens, gsl::span<const int32_t> beam_indices);
+
+ private:
+  OrtValue MakeIntTensor(int32_t element_type, const TensorShape& shape, const std::vector<int32_t>& values) const;
+  OrtValue MakePastTensor(int layer, int64_t past_length) const;
+  Status ReorderPresent(int layer, gsl::span<const int32_t> beam_indices);
+
+  OpKernelContextInternal& context_;
+  const SessionState& session_state_;
+  const GenerationBase::DecoderInfo& info_;
+  const FeedsFetchesManager& ffm_;
+
+  AllocatorPtr cpu_allocator_;
+
+  int num_sequences_ = 0;
+  int max_length_ = 0;
+  int current_length_ = 0;  // number of tokens in each sequence, and in the present state after Run
+  int vocab_size_ = 0;
+  int logits_sequence_length_ = 0;
+
+  // the attention mask of every sequence, for max_length tokens, and the position of each sequence's next token.
+  std::vector<int32_t> attention_mask_;
+  std::vector<int32_t> next_position_;
+
+  // past state buffers allocated once for max_length tokens, into which the present state is reordered.
+  std::vector<BufferUniquePtr> past_buffers_;
+
+  std::vector<OrtValue> feeds_;
+  std::vector<OrtValue> fetches_;
+};
+
+DecoderRunner::DecoderRunner(OpKernelContextInternal& context,
+                             const SessionState& session_state,
+                             const GenerationBase::DecoderInfo& info,
+                             const FeedsFetchesManager& ffm)
+    : context_(context), session_state_(session_state), info_(info), ffm_(ffm) {
+  cpu_allocator_ = session_state_.GetExecutionProviders()
+                       .Get(onnxruntime::kCpuExecutionProvider)
+                       ->GetAllocator(0, OrtMemTypeDefault);
+}
+
+OrtValue DecoderRunner::MakeIntTensor(int32_t element_type, const TensorShape& shape,
+                                      const std::vector<int32_t>& values) const {
+  MLDataType data_type = element_type == TensorProto::INT64
+                             ? DataTypeImpl::GetType<int64_t>()
+                             : element_type == TensorProto::FLOAT ? DataTypeImpl::GetType<float>()
+                                                                  : DataTypeImpl::GetType<int32_t>();
+  auto tensor = onnxruntime::make_unique<Tensor>(data_type, shape, cpu_allocator_);
+  const auto count = static_cast<size_t>(shape.Size());
+  switch (element_type) {
+    case TensorProto::INT64:
+      ConvertTo(values.data(), tensor->MutableData<int64_t>(), count);
+      break;
+    case TensorProto::FLOAT:
+      ConvertTo(values.data(), tensor->MutableData<float>(), count);
+      break;
+    default:
+      std::copy_n(values.data(), count, tensor->MutableData<int32_t>());
+      break;
+  }
+
+  return MakeTensorValue(std::move(tensor));
+}
+
+OrtValue DecoderRunner::MakePastTensor(int layer, int64_t past_length) const {
+  TensorShape shape{2, num_sequences_, info_.num_heads, past_length, info_.head_size};
+  auto tensor = onnxruntime::make_unique<Tensor>(DataTypeImpl::GetType<float>(), shape, past_buffers_[layer].get(),
+                                                 cpu_allocator_->Info());
+  return MakeTensorValue(std::move(tensor));
+}
+
+Status DecoderRunner::Initialize(const Tensor& input_ids, const Tensor* attention_mask, int num_beams,
+                                 int max_length) {
+  const auto& dims = input_ids.Shape().GetDims();
+  const int batch_size = gsl::narrow<int>(dims[0]);
+  const int prompt_length = gsl::narrow<int>(dims[1]);
+
+  num_sequences_ = batch_size * num_beams;
+  max_length_ = max_length;
+  current_length_ = prompt_length;
+
+  const int32_t* ids = input_ids.Data<int32_t>();
+  const int32_t* mask = attention_mask ? attention_mask->Data<int32_t>() : nullptr;
+
+  // positions skip the (left) padding of the prompt, so that every sequence starts at position 0.
+  std::vector<int32_t> step_ids(static_cast<size_t>(num_sequences_) * prompt_length);
+  std::vector<int32_t> step_positions(step_ids.size());
+  std::vector<int32_t> step_mask(step_ids.size());
+  attention_mask_.assign(static_cast<size_t>(num_sequences_) * max_length_, 1);
+  next_position_.resize(num_sequences_);
+
+  for (int i = 0; i < num_sequences_; ++i) {
+    const int batch = i / num_beams;
+    int32_t position = 0;
+    for (int j = 0; j < prompt_length; ++j) {
+      const size_t src = static_cast<size_t>(batch) * prompt_length + j;
+      const size_t dst = static_cast<size_t>(i) * prompt_length + j;
+      const int32_t mask_value = mask ? (mask[src] != 0 ? 1 : 0) : 1;
+      step_ids[dst] = ids[src];
+      step_mask[dst] = mask_value;
+      step_positions[dst] = mask_value ? position++ : 0;
+      attention_mask_[static_cast<size_t>(i) * max_length_ + j] = mask_value;
+    }
+    next_position_[i] = position;
+  }
+
+  const TensorShape step_shape{num_sequences_, prompt_length};
+  feeds_.clear();
+  feeds_.reserve(info_.num_subgraph_inputs + info_.num_implicit_inputs);
+  feeds_.push_back(MakeIntTensor(info_.input_ids_type, step_shape, step_ids));
+  feeds_.push_back(MakeIntTensor(info_.position_ids_type, step_shape, step_positions));
+  feeds_.push_back(MakeIntTensor(info_.attention_mask_type, step_shape, step_mask));
+
+  // the past state of each layer has room for max_length tokens of every sequence, and starts out empty.
+  const size_t past_buffer_bytes = SafeInt<size_t>(2) * num_sequences_ * info_.num_heads * max_length_ *
+                                   info_.head_size * sizeof(float);
+  past_buffers_.clear();
+  for (int layer = 0; layer < info_.num_layers; ++layer) {
+    past_buffers_.emplace_back(cpu_allocator_->Alloc(past_buffer_bytes), BufferDeleter(cpu_allocator_));
+    feeds_.push_back(MakePastTensor(layer, 0));
+  }
+
+  // pass in implicit inputs as feeds. order matches
+  for (const auto* entry : context_.GetImplicitInputs()) {
+    feeds_.push_back(*entry);
+  }
+
+  return Status::OK();
+}
+
+Status DecoderRunner::Run() {
+  if (concurrency::SchedulingHint::Current().DeadlineExpired()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Generation stopped at length ", current_length_,
+                           " due to the run deadline being exceeded.");
+  }
+
+  fetches_.clear();
+  ORT_RETURN_IF_ERROR(utils::ExecuteSubgraph(session_state_, ffm_, feeds_, fetches_, {},
+                                             ExecutionMode::ORT_SEQUENTIAL, context_.GetTerminateFlag(),
+                                             context_.Logger()));
+
+  const auto& logits = fetches_[0].Get<Tensor>();
+  const auto& dims = logits.Shape().GetDims();
+  if (dims.size() != 3 || dims[0] != num_sequences_ || dims[1] <= 0 || dims[2] <= 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL,
+                           "'decoder' logits should have shape (batch_size * num_beams, sequence_length, "
+                           "vocab_size) with batch_size * num_beams of ", num_sequences_, ". Got shape of ",
+                           logits.Shape());
+  }
+
+  logits_sequence_length_ = gsl::narrow<int>(dims[1]);
+  vocab_size_ = gsl::narrow<int>(dims[2]);
+  return Status::OK();
+}
+
+gsl::span<const float> DecoderRunner::NextTokenLogits(int sequence_index) const {
+  const float* logits = fetches_[0].Get<Tensor>().Data<float>();
+  const size_t offset = (static_cast<size_t>(sequence_index) * logits_sequence_length_ + logits_sequence_length_ - 1) *
+                        vocab_size_;
+  return gsl::make_span(logits + offset, vocab_size_);
+}
+
+Status DecoderRunner::ReorderPresent(int layer, gsl::span<const int32_t> beam_indices) {
+  const auto& present = fetches_[kFirstPresentOutputIndex + layer].Get<Tensor>();
+  const std::vector<int64_t> expected_dims{2, num_sequences_, info_.num_heads, current_length_, info_.head_size};
+  if (present.Shape().GetDims() != expected_dims) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "'decoder' present state output ", layer, " should have shape ",
+                           TensorShape(expected_dims), ". Got shape of ", present.Shape());
+  }
+
+  // each sequence's state for keys and values is a contiguous block, so reordering copies whole blocks.
+  const size_t block_size = static_cast<size_t>(info_.num_heads) * current_length_ * info_.head_size;
+  const float* src = present.Data<float>();
+  float* dst = static_cast<float*>(past_buffers_[layer].get());
+
+  // a decoder may pass the past state through to the present state, in which case a copy is needed to
+  // avoid overwriting blocks that are still to be read.
+  std::vector<float> src_copy;
+  if (src == dst) {
+    src_copy.assign(src, src + 2 * num_sequences_ * block_size);
+    src = src_copy.data();
+  }
+
+  const double bytes_per_block = static_cast<double>(block_size * sizeof(float));
+  ThreadPool::TryParallelFor(
+      context_.GetOperatorThreadPool(), 2 * num_sequences_, TensorOpCost{bytes_per_block, bytes_per_block, 0},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t block = first; block < last; ++block) {
+          const std::ptrdiff_t kv = block / num_sequences_;
+          const std::ptrdiff_t sequence = block % num_sequences_;
+          const float* block_src = src + (kv * num_sequences_ + beam_indices[sequence]) * block_size;
+          std::memcpy(dst + block * block_size, block_src, block_size * sizeof(float));
+        }
+      });
+
+  feeds_[kFirstPastInputIndex + layer] = MakePastTensor(layer, current_length_);
+  return Status::OK();
+}
+
+Status DecoderRunner::Advance(gsl::span<const int32_t> next_tokens, gsl::span<const int32_t> beam_indices) {
+  // the present state of every layer becomes the past state of the next step. if sequences continue
+  // themselves the present state is fed back as is, otherwise it is reordered into the past buffers.
+  for (int layer = 0; layer < info_.num_layers; ++layer) {
+    if (beam_indices.empty()) {
+      feeds_[kFirstPastInputIndex + layer] = fetches_[kFirstPresentOutputIndex + layer];
+    } else {
+      ORT_RETURN_IF_ERROR(ReorderPresent(layer, beam_indices));
+    }
+  }
+
+  // the attention mask and positions of the beams of a batch entry are the same, so need no reordering.
+  ++current_length_;
+  ORT_ENFORCE(current_length_ <= max_length_, "Generation advanced beyond max_length");
+
+  std::vector<int32_t> step_positions(num_sequences_);
+  std::vector<int32_t> step_mask(static_cast<size_t>(num_sequences_) * current_length_);
+  for (int i = 0; i < num_sequences_; ++i) {
+    step_positions[i] = next_position_[i]++;
+    const auto* row = attention_mask_.data() + static_cast<size_t>(i) * max_length_;
+    std::copy_n(row, current_length_, step_mask.data() + static_cast<size_t>(i) * current_length_);
+  }
+
+  const TensorShape step_shape{num_sequences_, 1};
+  feeds_[0] = MakeIntTensor(info_.input_ids_type, step_shape,
+                            std::vector<int32_t>(next_tokens.begin(), next_tokens.end()));
+  feeds_[1] = MakeIntTensor(info_.position_ids_type, step_shape, step_positions);
+  feeds_[2] = MakeIntTensor(info_.attention_mask_type, TensorShape{num_sequences_, current_length_}, step_mask);
+
+  return Status::OK();
+}
+
+// Copies the next token logits of every sequence into 'scores' and applies the repetition penalty and
+// minimum length to them.
+void ProcessLogits(const DecoderRunner& decoder, const GenerationParameters& parameters, int32_t eos_token_id,
+                   int current_length, const std::vector<int32_t>& sequences, int num_sequences,
+                   std::vector<float>& scores, ThreadPool* tp) {
+  const int vocab_size = decoder.VocabSize();
+  scores.resize(static_cast<size_t>(num_sequences) * vocab_size);
+
+  ThreadPool::TryParallelFor(
+      tp, num_sequences, static_cast<double>(vocab_size) * 2.0,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          auto logits = decoder.NextTokenLogits(static_cast<int>(i));
+          auto row = gsl::make_span(scores.data() + i * vocab_size, vocab_size);
+          std::copy(logits.begin(), logits.end(), row.begin());
+
+          transformers::ApplyRepetitionPenalty(
+              row, gsl::make_span(sequences.data() + i * parameters.max_length, current_length),
+              parameters.repetition_penalty);
+
+          if (current_length < parameters.min_length) {
+            transformers::SuppressToken(row, eos_token_id);
+          }
+        }
+      });
+}
+
+// The finished hypotheses of a batch entry, keeping the num_beams best by length normalized score.
+class BeamHypotheses {
+ public:
+  BeamHypotheses(int num_beams, float length_penalty, bool early_stopping)
+      : num_beams_(num_beams), length_penalty_(length_penalty), early_stopping_(early_stopping) {}
+
+  void Add(gsl::span<const int32_t> tokens, float sum_logprobs, int length) {
+    const float score = sum_logprobs / std::pow(static_cast<float>(length), length_penalty_);
+    if (static_cast<int>(hypotheses_.size()) < num_beams_ || score > worst_score_) {
+      hypotheses_.push_back({std::vector<int32_t>(tokens.begin(), tokens.end()), score});
+      if (static_cast<int>(hypotheses_.size()) > num_beams_) {
+        auto worst = std::min_element(hypotheses_.begin(), hypotheses_.end(),
+                                      [](const Hypothesis& a, const Hypothesis& b) { return a.score < b.score; });
+        hypotheses_.erase(worst);
+      }
+
+      worst_score_ = std::min_element(hypotheses_.begin(), hypotheses_.end(),
+                                      [](const Hypothesis& a, const Hypothesis& b) { return a.score < b.score; })
+                         ->score;
+    }
+  }
+
+  // Whether no beam can produce a better hypothesis than the ones found, given the best score of the beams.
+  bool IsDone(float best_sum_logprobs, int current_length) const {
+    if (static_cast<int>(hypotheses_.size()) < num_beams_) {
+      return false;
+    }
+
+    if (early_stopping_) {
+      return true;
+    }
+
+    return worst_score_ >= best_sum_logprobs / std::pow(static_cast<float>(current_length), length_penalty_);
+  }
+
+  // Writes the best num_return_sequences hypotheses, padded to max_length.
+  void Output(int num_return_sequences, int max_length, int32_t pad_token_id,
+              int32_t* sequences, float* sequences_scores) {
+    std::stable_sort(hypotheses_.begin(), hypotheses_.end(),
+                     [](const Hypothesis& a, const Hypothesis& b) { return a.score > b.score; });
+
+    for (int r = 0; r < num_return_sequences; ++r) {
+      const auto& hypothesis = hypotheses_[r];
+      int32_t* sequence = sequences + static_cast<size_t>(r) * max_length;
+      auto length = std::min(hypothesis.tokens.size(), static_cast<size_t>(max_length));
+      std::copy_n(hypothesis.tokens.data(), length, sequence);
+      std::fill(sequence + length, sequence + max_length, pad_token_id);
+      if (sequences_scores) {
+        sequences_scores[r] = hypothesis.score;
+      }
+    }
+  }
+
+ private:
+  struct Hypothesis {
+    std::vector<int32_t> tokens;
+    float score;
+  };
+
+  int num_beams_;
+  float length_penalty_;
+  bool early_stopping_;
+  float worst_score_ = 1e9f;
+  std::vector<Hypothesis> hypotheses_;
+};
+
+}  // namespace
+
+BeamSearch::BeamSearch(const OpKernelInfo& info) : GenerationBase(info) {
+  early_stopping_ = info.GetAttrOrDefault<int64_t>("early_stopping", 0) != 0;
+}
+
+Status BeamSearch::Compute(OpKernelContext* ctx) const {
+  auto* ctx_internal = static_cast<OpKernelContextInternal*>(ctx);
+  auto* session_state = ctx_internal->SubgraphSessionState("decoder");
+  ORT_ENFORCE(session_state, "Subgraph SessionState was not found for 'decoder' attribute.");
+  ORT_ENFORCE(feeds_fetches_manager_, "CreateFeedsFetchesManager must be called prior to execution of graph.");
+
+  GenerationParameters parameters;
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 1, "max_length", parameters.max_length));
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 2, "min_length", parameters.min_length));
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 3, "num_beams", parameters.num_beams));
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 4, "num_return_sequences", parameters.num_return_sequences));
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 5, "length_penalty", parameters.length_penalty));
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 6, "repetition_penalty", parameters.repetition_penalty));
+
+  const auto* input_ids = ctx->Input<Tensor>(0);
+  const auto* attention_mask = ctx->Input<Tensor>(7);
+  ORT_RETURN_IF_ERROR(ValidatePrompt(*input_ids, attention_mask, parameters));
+
+  if (parameters.num_beams < 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "'num_beams' must be at least 1. Got ",
+                           parameters.num_beams);
+  }
+
+  if (parameters.num_return_sequences < 1 || parameters.num_return_sequences > parameters.num_beams) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "'num_return_sequences' must be between 1 and 'num_beams'. Got ",
+                           parameters.num_return_sequences);
+  }
+
+  const int batch_size = parameters.batch_size;
+  const int num_beams = parameters.num_beams;
+  const int num_sequences = batch_size * num_beams;
+  const int max_length = parameters.max_length;
+  const size_t num_candidates = 2 * static_cast<size_t>(num_beams);
+  auto* tp = ctx->GetOperatorThreadPool();
+
+  DecoderRunner decoder{*ctx_internal, *session_state, *decoder_info_, *feeds_fetches_manager_};
+  ORT_RETURN_IF_ERROR(decoder.Initialize(*input_ids, attention_mask, num_beams, max_length));
+
+  // the tokens of each beam. reordering by beam copies into next_sequences, which is then swapped in.
+  int current_length = parameters.prompt_length;
+  std::vector<int32_t> sequences(static_cast<size_t>(num_sequences) * max_length, pad_token_id_);
+  std::vector<int32_t> next_sequences(sequences.size(), pad_token_id_);
+  const int32_t* prompt = input_ids->Data<int32_t>();
+  for (int i = 0; i < num_sequences; ++i) {
+    std::copy_n(prompt + static_cast<size_t>(i / num_beams) * current_length, current_length,
+                sequences.data() + static_cast<size_t>(i) * max_length);
+  }
+
+  // only the first beam of each batch entry is live initially, as all beams start from the same prompt.
+  std::vector<float> beam_scores(num_sequences, 0.0f);
+  for (int i = 0; i < num_sequences; ++i) {
+    if (i % num_beams != 0) {
+      beam_scores[i] = -1e9f;
+    }
+  }
+
+  std::vector<BeamHypotheses> hypotheses(batch_size,
+                                         BeamHypotheses(num_beams, parameters.length_penalty, early_stopping_));
+  std::vector<bool> done(batch_size, false);
+
+  std::vector<float> scores;
+  std::vector<std::vector<int32_t>> sequence_top_tokens(num_sequences);
+  std::vector<float> next_scores(num_sequences);
+  std::vector<int32_t> next_tokens(num_sequences);
+  std::vector<int32_t> next_indices(num_sequences);
+
+  struct Candidate {
+    float score;
+    int32_t token;
+    int32_t sequence;
+  };
+  std::vector<Candidate> candidates;
+
+  while (current_length < max_length) {
+    ORT_RETURN_IF_ERROR(decoder.Run());
+    const int vocab_size = decoder.VocabSize();
+
+    ProcessLogits(decoder, parameters, eos_token_id_, current_length, sequences, num_sequences, scores, tp);
+    MlasComputeSoftmax(scores.data(), scores.data(), num_sequences, vocab_size, true, tp);
+
+    // each beam contributes at most num_candidates tokens to the best num_candidates of its batch entry.
+    // adding the beam score does not change the order within a beam so is done for the selected tokens only.
+    ThreadPool::TryParallelFor(
+        tp, num_sequences, static_cast<double>(vocab_size) * 2.0,
+        [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            transformers::TopK(gsl::make_span(scores.data() + i * vocab_size, vocab_size), num_candidates,
+                               sequence_top_tokens[i]);
+          }
+        });
+
+    bool all_done = true;
+    for (int batch = 0; batch < batch_size; ++batch) {
+      const int first_beam = batch * num_beams;
+      if (done[batch]) {
+        for (int k = 0; k < num_beams; ++k) {
+          next_scores[first_beam + k] = 0.0f;
+          next_tokens[first_beam + k] = pad_token_id_;
+          next_indices[first_beam + k] = first_beam + k;
+        }
+        continue;
+      }
+
+      candidates.clear();
+      for (int i = first_beam; i < first_beam + num_beams; ++i) {
+        for (int32_t token : sequence_top_tokens[i]) {
+          candidates.push_back({scores[static_cast<size_t>(i) * vocab_size + token] + beam_scores[i], token, i});
+        }
+      }
+      std::stable_sort(candidates.begin(), candidates.end(),
+                       [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+      int num_added = 0;
+      for (size_t rank = 0; rank < candidates.size() && num_added < num_beams; ++rank) {
+        const auto& candidate = candidates[rank];
+        if (candidate.token == eos_token_id_) {
+          // only end-of-sequence tokens ranking among the best num_beams finish a hypothesis.
+          if (rank >= static_cast<size_t>(num_beams)) {
+            continue;
+          }
+
+          std::vector<int32_t> tokens(sequences.begin() + static_cast<size_t>(candidate.sequence) * max_length,
+                                      sequences.begin() + static_cast<size_t>(candidate.sequence) * max_length +
+                                          current_length);
+          tokens.push_back(eos_token_id_);
+          hypotheses[batch].Add(tokens, candidate.score, current_length);
+        } else {
+          next_scores[first_beam + num_added] = candidate.score;
+          next_tokens[first_beam + num_added] = candidate.token;
+          next_indices[first_beam + num_added] = candidate.sequence;
+          ++num_added;
+        }
+      }
+
+      ORT_ENFORCE(num_added == num_beams, "Beam search found ", num_added, " of ", num_beams, " beams to continue.");
+      done[batch] = hypotheses[batch].IsDone(candidates.front().score, current_length);
+      all_done = all_done && done[batch];
+    }
+
+    if (all_done) {
+      break;
+    }
+
+    // reorder the sequences by beam and append the chosen tokens.
+    bool reordered = false;
+    for (int i = 0; i < num_sequences; ++i) {
+      const int32_t source = next_indices[i];
+      reordered = reordered || source != i;
+      std::copy_n(sequences.data() + static_cast<size_t>(source) * max_length, current_length,
+                  next_sequences.data() + static_cast<size_t>(i) * max_length);
+      next_sequences[static_cast<size_t>(i) * max_length + current_length] = next_tokens[i];
+    }
+    sequences.swap(next_sequences);
+    beam_scores = next_scores;
+    ++current_length;
+
+    if (current_length < max_length) {
+      ORT_RETURN_IF_ERROR(decoder.Advance(next_tokens, reordered ? gsl::span<const int32_t>(next_indices)
+                                                                 : gsl::span<const int32_t>()));
+    }
+  }
+
+  // beams of batch entries that did not finish are hypotheses too.
+  for (int batch = 0; batch < batch_size; ++batch) {
+    if (done[batch]) {
+      continue;
+    }
+
+    for (int i = batch * num_beams; i < (batch + 1) * num_beams; ++i) {
+      hypotheses[batch].Add(gsl::make_span(sequences.data() + static_cast<size_t>(i) * max_length, current_length),
+                            beam_scores[i], current_length);
+    }
+  }
+
+  const int num_return_sequences = parameters.num_return_sequences;
+  auto* output_sequences = ctx->Output(0, TensorShape{batch_size, num_return_sequences, max_length});
+  auto* output_scores = ctx->Output(1, TensorShape{batch_size, num_return_sequences});
+  for (int batch = 0; batch < batch_size; ++batch) {
+    const size_t first = static_cast<size_t>(batch) * num_return_sequences;
+    hypotheses[batch].Output(num_return_sequences, max_length, pad_token_id_,
+                             output_sequences->MutableData<int32_t>() + first * max_length,
+                             output_scores ? output_scores->MutableData<float>() + first : nullptr);
+  }
+
+  return Status::OK();
+}
+
+GreedySearch::GreedySearch(const OpKernelInfo& info) : GenerationBase(info) {
+  do_sample_ = info.GetAttrOrDefault<int64_t>("do_sample", 0) != 0;
+  top_k_ = gsl::narrow<int>(info.GetAttrOrDefault<int64_t>("top_k", 0));
+  top_p_ = info.GetAttrOrDefault<float>("top_p", 1.0f);
+  ORT_ENFORCE(top_p_ > 0.0f && top_p_ <= 1.0f, "top_p must be in the range (0, 1]");
+
+  int64_t seed = info.GetAttrOrDefault<int64_t>("seed", 0);
+  if (seed != 0) {
+    generator_ = std::default_random_engine{gsl::narrow_cast<uint32_t>(seed)};
+  } else {
+    generator_ = std::default_random_engine{
+        gsl::narrow_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count())};
+  }
+}
+
+Status GreedySearch::Compute(OpKernelContext* ctx) const {
+  auto* ctx_internal = static_cast<OpKernelContextInternal*>(ctx);
+  auto* session_state = ctx_internal->SubgraphSessionState("decoder");
+  ORT_ENFORCE(session_state, "Subgraph SessionState was not found for 'decoder' attribute.");
+  ORT_ENFORCE(feeds_fetches_manager_, "CreateFeedsFetchesManager must be called prior to execution of graph.");
+
+  GenerationParameters parameters;
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 1, "max_length", parameters.max_length));
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 2, "min_length", parameters.min_length));
+  ORT_RETURN_IF_ERROR(ReadScalarInput(*ctx, 3, "repetition_penalty", parameters.repetition_penalty));
+
+  const auto* input_ids = ctx->Input<Tensor>(0);
+  const auto* attention_mask = ctx->Input<Tensor>(4);
+  ORT_RETURN_IF_ERROR(ValidatePrompt(*input_ids, attention_mask, parameters));
+
+  const int batch_size = parameters.batch_size;
+  const int max_length = parameters.max_length;
+  auto* tp = ctx->GetOperatorThreadPool();
+
+  DecoderRunner decoder{*ctx_internal, *session_state, *decoder_info_, *feeds_fetches_manager_};
+  ORT_RETURN_IF_ERROR(decoder.Initialize(*input_ids, attention_mask, 1, max_length));
+
+  int current_length = parameters.prompt_length;
+  std::vector<int32_t> sequences(static_cast<size_t>(batch_size) * max_length, pad_token_id_);
+  const int32_t* prompt = input_ids->Data<int32_t>();
+  for (int batch = 0; batch < batch_size; ++batch) {
+    std::copy_n(prompt + static_cast<size_t>(batch) * current_length, current_length,
+                sequences.data() + static_cast<size_t>(batch) * max_length);
+  }
+
+  std::vector<float> scores;
+  std::vector<float> draws(do_sample_ ? batch_size : 0);
+  std::vector<int32_t> next_tokens(batch_size);
+  std::vector<bool> done(batch_size, false);
+
+  while (current_length < max_length) {
+    ORT_RETURN_IF_ERROR(decoder.Run());
+    const int vocab_size = decoder.VocabSize();
+
+    ProcessLogits(decoder, parameters, eos_token_id_, current_length, sequences, batch_size, scores, tp);
+
+    if (do_sample_) {
+      MlasComputeSoftmax(scores.data(), scores.data(), batch_size, vocab_size, false, tp);
+      {
+        // the generator is shared by concurrent calls to Compute(), so only hold the lock while drawing.
+        std::lock_guard<OrtMutex> lock(generator_mutex_);
+        std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+        for (auto& draw : draws) {
+          draw = distribution(generator_);
+        }
+      }
+      for (int batch = 0; batch < batch_size; ++batch) {
+        next_tokens[batch] = transformers::SampleToken(
+            gsl::make_span(scores.data() + static_cast<size_t>(batch) * vocab_size, vocab_size), top_k_, top_p_,
+            draws[batch]);
+      }
+    } else {
+      ThreadPool::TryParallelFor(
+          tp, batch_size, static_cast<double>(vocab_size),
+          [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t batch = first; batch < last; ++batch) {
+              next_tokens[batch] = transformers::ArgMax(
+                  gsl::make_span(scores.data() + batch * vocab_size, vocab_size));
+            }
+          });
+    }
+
+    // finished sequences are padded, and keep being fed to the decoder until all are finished.
+    bool all_done = true;
+    for (int batch = 0; batch < batch_size; ++batch) {
+      if (done[batch]) {
+        next_tokens[batch] = pad_token_id_;
+      } else if (next_tokens[batch] == eos_token_id_) {
+        done[batch] = true;
+      }
+      all_done = all_done && done[batch];
+      sequences[static_cast<size_t>(batch) * max_length + current_length] = next_tokens[batch];
+    }
+    ++current_length;
+
+    if (all_done || current_length == max_length) {
+      break;
+    }
+
+    ORT_RETURN_IF_ERROR(decoder.Advance(next_tokens, gsl::span<const int32_t>()));
+  }
+
+  auto* output = ctx->Output(0, TensorShape{batch_size, max_length});
+  std::copy(sequences.begin(), sequences.end(), output->MutableData<int32_t>());
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
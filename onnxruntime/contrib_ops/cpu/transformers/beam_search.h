@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <random>
+
+#include "core/common/common.h"
+#include "core/framework/feeds_fetches_manager.h"
+#include "core/framework/op_kernel.h"
+#include "core/platform/ort_mutex.h"
+#include "core/providers/cpu/controlflow/utils.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Base class of the operators generating token sequences by running a GPT-2 style decoder subgraph
+// ('decoder' attribute) once per token. The generation loop runs natively so the key/value cache of the
+// decoder (its 'past' inputs and 'present' outputs) never leaves the operator.
+class GenerationBase : public controlflow::IControlFlowKernel {
+ public:
+  explicit GenerationBase(const OpKernelInfo& info);
+  ~GenerationBase() override;
+
+  common::Status SetupSubgraphExecutionInfo(const SessionState& session_state,
+                                            const std::string& attribute_name,
+                                            const SessionState& subgraph_session_state) override;
+
+  // hide internal implementation details via forward declaration.
+  struct DecoderInfo;
+
+ protected:
+  int32_t eos_token_id_;
+  int32_t pad_token_id_;
+
+  // Info and FeedsFetchesManager re-used for each decoder execution.
+  std::unique_ptr<DecoderInfo> decoder_info_;
+  std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager_;
+};
+
+class BeamSearch final : public GenerationBase {
+ public:
+  explicit BeamSearch(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* ctx) const override;
+
+ private:
+  bool early_stopping_;
+};
+
+class GreedySearch final : public GenerationBase {
+ public:
+  explicit GreedySearch(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* ctx) const override;
+
+ private:
+  bool do_sample_;
+  int top_k_;
+  float top_p_;
+
+  // generator_ is updated with every call to Compute() that samples.
+  // generator_mutex_ guards the draws so that Compute() can be called concurrently.
+  mutable std::default_random_engine generator_;
+  mutable onnxruntime::OrtMutex generator_mutex_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
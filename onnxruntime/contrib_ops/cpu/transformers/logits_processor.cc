@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/transformers/logits_processor.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "core/util/math_cpuonly.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+void ApplyRepetitionPenalty(gsl::span<float> scores, gsl::span<const int32_t> sequence, float penalty) {
+  if (penalty == 1.0f || sequence.empty()) {
+    return;
+  }
+
+  // the sequence is short compared to the vocabulary, so de-duplicate it rather than tracking the
+  // penalized tokens in a vocabulary sized mask.
+  std::vector<int32_t> tokens(sequence.begin(), sequence.end());
+  std::sort(tokens.begin(), tokens.end());
+  tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+  const auto vocab_size = static_cast<int32_t>(scores.size());
+  for (int32_t token : tokens) {
+    if (token < 0 || token >= vocab_size) {
+      continue;
+    }
+    float& score = scores[token];
+    score = score < 0 ? score * penalty : score / penalty;
+  }
+}
+
+void SuppressToken(gsl::span<float> scores, int32_t token_id) {
+  if (token_id >= 0 && token_id < static_cast<int32_t>(scores.size())) {
+    // lowest() rather than -infinity so that the MLAS softmax and additions of beam scores stay finite.
+    scores[token_id] = std::numeric_limits<float>::lowest();
+  }
+}
+
+void TopK(gsl::span<const float> scores, size_t k, std::vector<int32_t>& indices) {
+  indices.clear();
+  k = std::min(k, scores.size());
+  if (k == 0) {
+    return;
+  }
+
+  // min-heap of the k largest scores seen so far. k is small (typically 2 * num_beams) compared to the
+  // vocabulary, so most scores are rejected by a single comparison against the top of the heap.
+  // ties are resolved in favor of the smaller index.
+  using Entry = std::pair<float, int32_t>;
+  auto greater = [](const Entry& a, const Entry& b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  };
+  std::vector<Entry> heap;
+  heap.reserve(k);
+
+  const auto num_scores = static_cast<int32_t>(scores.size());
+  for (int32_t i = 0; i < num_scores; ++i) {
+    const float score = scores[i];
+    if (heap.size() < k) {
+      heap.emplace_back(score, i);
+      std::push_heap(heap.begin(), heap.end(), greater);
+    } else if (score > heap.front().first) {
+      std::pop_heap(heap.begin(), heap.end(), greater);
+      heap.back() = Entry(score, i);
+      std::push_heap(heap.begin(), heap.end(), greater);
+    }
+  }
+
+  std::sort_heap(heap.begin(), heap.end(), greater);
+  indices.reserve(k);
+  for (const auto& entry : heap) {
+    indices.push_back(entry.second);
+  }
+}
+
+int32_t ArgMax(gsl::span<const float> scores) {
+  Eigen::Index index = 0;
+  ConstEigenVectorArrayMap<float>(scores.data(), static_cast<Eigen::Index>(scores.size())).maxCoeff(&index);
+  return static_cast<int32_t>(index);
+}
+
+int32_t SampleToken(gsl::span<const float> probs, int top_k, float top_p, float uniform) {
+  std::vector<int32_t> candidates;
+  if (top_k > 0 && static_cast<size_t>(top_k) < probs.size()) {
+    TopK(probs, static_cast<size_t>(top_k), candidates);
+  } else {
+    candidates.resize(probs.size());
+    std::iota(candidates.begin(), candidates.end(), 0);
+    if (top_p < 1.0f) {
+      std::sort(candidates.begin(), candidates.end(),
+                [&probs](int32_t a, int32_t b) { return probs[a] > probs[b]; });
+    }
+  }
+
+  // candidates are ordered from the most likely token if top_p is applied.
+  // keep the most likely token even if it alone exceeds top_p.
+  if (top_p < 1.0f) {
+    float cumulative = 0.0f;
+    size_t num_kept = 0;
+    while (num_kept < candidates.size()) {
+      cumulative += probs[candidates[num_kept++]];
+      if (cumulative >= top_p) {
+        break;
+      }
+    }
+    candidates.resize(num_kept);
+  }
+
+  float total = 0.0f;
+  for (int32_t token : candidates) {
+    total += probs[token];
+  }
+
+  float target = uniform * total;
+  for (int32_t token : candidates) {
+    target -= probs[token];
+    if (target <= 0.0f) {
+      return token;
+    }
+  }
+
+  // rounding error in the running sum. return the least likely candidate.
+  return candidates.back();
+}
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <vector>
+
+#include "gsl/gsl"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+// Processing of the next token scores (logits) of one sequence, shared by the generation operators.
+
+// Makes the tokens already present in 'sequence' less likely to be generated again by dividing their positive
+// scores, and multiplying their negative scores, by 'penalty'. Each distinct token is penalized once.
+void ApplyRepetitionPenalty(gsl::span<float> scores, gsl::span<const int32_t> sequence, float penalty);
+
+// Prevents 'token_id' from being selected, e.g. the end-of-sequence token before the minimum length is reached.
+void SuppressToken(gsl::span<float> scores, int32_t token_id);
+
+// Finds the indices of the 'k' largest scores. 'indices' is ordered from the largest to the smallest score.
+void TopK(gsl::span<const float> scores, size_t k, std::vector<int32_t>& indices);
+
+// Returns the index of the largest score.
+int32_t ArgMax(gsl::span<const float> scores);
+
+// Samples a token from the probability distribution 'probs', restricted to the 'top_k' most likely tokens
+// if top_k > 0, and to the smallest set of most likely tokens with a cumulative probability of at least 'top_p'
+// if top_p < 1. 'uniform' is a random draw from [0, 1) that selects the token.
+int32_t SampleToken(gsl::span<const float> probs, int top_k, float top_p, float uniform);
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -3,6 +3,9 @@
 
 #include "word_conv_embedding.h"
 
+#include <algorithm>
+
+#include "core/platform/threadpool.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "core/mlas/inc/mlas.h"
@@ -10,110 +13,83 @@
 namespace onnxruntime {
 namespace contrib {
 
-void WordConvEmbedding::CharEmbeddingLookup(
+// Gathers the char embeddings of all the conv windows of all the words into one im2col buffer:
+// [total windows, filter_width * char_embedding_size], with the windows of word i starting at window_offsets_ptr[i].
+void WordConvEmbedding::UnfoldCharEmbeddings(
     const int* seq_ptr,
     const float* char_embedding_weight_p,
-    size_t seq_len,
-    size_t word_len,
-    size_t char_embedding_size,
-    size_t filter_width,
-    const int* words_len_ptr,
-    float* dst) const {
-  for (size_t word_inx = 0; word_inx < seq_len; word_inx++) {
-    if (words_len_ptr[word_inx] > 0) {
-      const int* cur_seq_ptr = seq_ptr + word_inx * word_len;
-      float* cur_dst_ptr = dst + word_inx * word_len * char_embedding_size;
-      size_t char_length_to_lookup = std::max<size_t>(words_len_ptr[word_inx], filter_width);
-      for (size_t char_inx = 0; char_inx < char_length_to_lookup; char_inx++) {
-        memcpy(cur_dst_ptr, char_embedding_weight_p + (*cur_seq_ptr) * char_embedding_size, sizeof(float) * char_embedding_size);
-        cur_dst_ptr += char_embedding_size;
-        cur_seq_ptr++;
-      }
-    }
-  }
-}
-
-//input : [sequence_length, word_length, char_embedding_size]
-void WordConvEmbedding::ComputeConvMaxPoolWithActivation(
-    AllocatorPtr allocator,
-    const float* input,
-    const float* weights,
-    const float* bias,
-    const int* words_len_ptr,
+    const int64_t* window_offsets_ptr,
     int64_t seq_len,
     int64_t word_len,
     int64_t char_embedding_size,
     int64_t filter_width,
-    int64_t num_filters,
-    float* output, concurrency::ThreadPool* tp) const {
-  int64_t input_word_size = word_len * char_embedding_size;
-  int64_t unfolded_width = word_len - filter_width + 1;
+    float* dst,
+    concurrency::ThreadPool* tp) const {
   int64_t unfolded_kernal_size = filter_width * char_embedding_size;
-  int64_t unfolded_segment_size = unfolded_width * unfolded_kernal_size;
-  int64_t conv_res_segment_size = unfolded_width * num_filters;
-  int64_t memcpy_size = unfolded_kernal_size * sizeof(float);
-
-  auto unfolded_buffer_p = IAllocator::MakeUniquePtr<float>(allocator, seq_len * unfolded_segment_size);
-  auto conv_result_p = IAllocator::MakeUniquePtr<float>(allocator, seq_len * conv_res_segment_size);
-  auto conv_activation_result_p = IAllocator::MakeUniquePtr<float>(allocator, seq_len * conv_res_segment_size);
-
-  int64_t word_inx = 0;
-  while (word_inx < seq_len) {
-    if (words_len_ptr[word_inx] <= 0) {
-      word_inx++;
-      continue;
-    }
-
-    float* words_unfolded_buffer_p = unfolded_buffer_p.get();
-    int64_t words_unfolded_width = 0;
-    int64_t tmp_word_inx = word_inx;
-    float* conv_buf_p = conv_result_p.get();
-    float* pactivationbuf = conv_activation_result_p.get();
-
-    // unfolding buffer
-    while (tmp_word_inx < seq_len && words_len_ptr[tmp_word_inx] > 0) {
-      const float* current_word_input = input + tmp_word_inx * input_word_size;
-      int64_t word_unfolded_width = std::max<int64_t>(words_len_ptr[tmp_word_inx], filter_width) - filter_width + 1;
-      words_unfolded_width += word_unfolded_width;
-      for (int64_t unfolded_inx = 0; unfolded_inx < word_unfolded_width; unfolded_inx++) {
-        memcpy(words_unfolded_buffer_p, current_word_input, memcpy_size);
-        current_word_input += char_embedding_size;
-        words_unfolded_buffer_p += unfolded_kernal_size;
-      }
-      tmp_word_inx++;
-    }
-
-    math::GemmEx<float>(
-        CblasNoTrans, CblasTrans,
-        static_cast<int>(words_unfolded_width), static_cast<int>(num_filters), static_cast<int>(unfolded_kernal_size), 1.0f,
-        unfolded_buffer_p.get(), static_cast<int>(unfolded_kernal_size),
-        weights, static_cast<int>(unfolded_kernal_size), 0.0f,
-        conv_buf_p, static_cast<int>(num_filters), tp);
-
-    for (int64_t unfolded_inx = 0; unfolded_inx < words_unfolded_width; unfolded_inx++)
-      for (int64_t filter_inx = 0; filter_inx < num_filters; filter_inx++) {
-        conv_buf_p[unfolded_inx * num_filters + filter_inx] += bias[filter_inx];
-      }
-    MlasComputeTanh(conv_buf_p, pactivationbuf, words_unfolded_width * num_filters);
-
-    float* activationbuf_cur_ptr = pactivationbuf;
-    for (int64_t pool_word_inx = word_inx; pool_word_inx < tmp_word_inx; pool_word_inx++) {
-      float* result_ptr = output + pool_word_inx * num_filters;
-      for (int64_t filter_inx = 0; filter_inx < num_filters; filter_inx++) {
-        result_ptr[filter_inx] = -1.0f * 1e12f;
-      }
+  size_t memcpy_size = char_embedding_size * sizeof(float);
+
+  const TensorOpCost cost{static_cast<double>(word_len * memcpy_size),
+                          static_cast<double>(word_len * filter_width * memcpy_size),
+                          static_cast<double>(word_len * filter_width)};
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(seq_len), cost, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t word_inx = first; word_inx < last; word_inx++) {
+          const int* cur_seq_ptr = seq_ptr + word_inx * word_len;
+          float* cur_dst_ptr = dst + window_offsets_ptr[word_inx] * unfolded_kernal_size;
+          int64_t word_unfolded_width = window_offsets_ptr[word_inx + 1] - window_offsets_ptr[word_inx];
+          for (int64_t unfolded_inx = 0; unfolded_inx < word_unfolded_width; unfolded_inx++) {
+            for (int64_t char_inx = 0; char_inx < filter_width; char_inx++) {
+              memcpy(cur_dst_ptr, char_embedding_weight_p + cur_seq_ptr[unfolded_inx + char_inx] * char_embedding_size,
+                     memcpy_size);
+              cur_dst_ptr += char_embedding_size;
+            }
+          }
+        }
+      });
+}
 
-      int64_t word_unfolded_width = std::max<int64_t>(words_len_ptr[pool_word_inx], filter_width) - filter_width + 1;
-      for (int64_t unfolded_inx = 0; unfolded_inx < word_unfolded_width; unfolded_inx++) {
-        for (int64_t filter_inx = 0; filter_inx < num_filters; filter_inx++) {
-          result_ptr[filter_inx] = std::max(activationbuf_cur_ptr[filter_inx], result_ptr[filter_inx]);
+// conv_result : [total windows, num_filters]
+// tanh is monotonic, so the max over the windows is taken before the bias and the activation,
+// which are then applied once per word instead of once per window.
+void WordConvEmbedding::ComputeMaxPoolWithActivation(
+    const float* conv_result,
+    const float* bias,
+    const int64_t* window_offsets_ptr,
+    int64_t seq_len,
+    int64_t num_filters,
+    float* output,
+    concurrency::ThreadPool* tp) const {
+  const double average_windows = seq_len > 0 ? static_cast<double>(window_offsets_ptr[seq_len]) / seq_len : 0.0;
+  const TensorOpCost cost{average_windows * num_filters * sizeof(float), static_cast<double>(num_filters * sizeof(float)),
+                          (average_windows + 8.0) * num_filters};
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(seq_len), cost, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t word_inx = first; word_inx < last; word_inx++) {
+          float* result_ptr = output + word_inx * num_filters;
+          int64_t word_unfolded_width = window_offsets_ptr[word_inx + 1] - window_offsets_ptr[word_inx];
+          // empty words have no windows
+          if (word_unfolded_width == 0) {
+            std::fill_n(result_ptr, num_filters, 0.0f);
+            continue;
+          }
+
+          const float* conv_cur_ptr = conv_result + window_offsets_ptr[word_inx] * num_filters;
+          std::copy_n(conv_cur_ptr, num_filters, result_ptr);
+          for (int64_t unfolded_inx = 1; unfolded_inx < word_unfolded_width; unfolded_inx++) {
+            conv_cur_ptr += num_filters;
+            for (int64_t filter_inx = 0; filter_inx < num_filters; filter_inx++) {
+              result_ptr[filter_inx] = std::max(conv_cur_ptr[filter_inx], result_ptr[filter_inx]);
+            }
+          }
+
+          for (int64_t filter_inx = 0; filter_inx < num_filters; filter_inx++) {
+            result_ptr[filter_inx] += bias[filter_inx];
+          }
+          MlasComputeTanh(result_ptr, result_ptr, num_filters);
         }
-        activationbuf_cur_ptr += num_filters;
-      }
-    }
-    word_inx = tmp_word_inx;
-  }
+      });
 }
+
 void WordConvEmbedding::CalculateLengthOfEachWordInSequence(
     const int* seq_ptr,
     int* words_len_ptr,
@@ -186,38 +162,56 @@ Status WordConvEmbedding::Compute(OpKernelContext* ctx) const {
   AllocatorPtr alloc;
   ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&alloc));
 
-  // allocate memory for char look up
-  // seq_len * word_len * char_embedding_size
-  size_t chars_embeddings_size = seq_len * word_len * char_embedding_size;
-  auto chars_embeddings_ptr = IAllocator::MakeUniquePtr<float>(alloc, chars_embeddings_size);
   auto words_length_ptr = IAllocator::MakeUniquePtr<int>(alloc, seq_len);
-  std::memset(chars_embeddings_ptr.get(), 0, chars_embeddings_size * sizeof(float));
   std::memset(words_length_ptr.get(), 0, seq_len * sizeof(int));
 
   CalculateLengthOfEachWordInSequence(seq_ptr, words_length_ptr.get(), seq_len, word_len);
 
-  CharEmbeddingLookup(seq_ptr,
-                      w_char_embedding.Data<float>(),
-                      seq_len,
-                      word_len,
-                      char_embedding_size,
-                      filter_width,
-                      words_length_ptr.get(),
-                      chars_embeddings_ptr.get());
-
-  ComputeConvMaxPoolWithActivation(
-      alloc,
-      chars_embeddings_ptr.get(),
-      w_conv.Data<float>(),
+  // the conv is applied to max(word length, filter width) chars of each non empty word, so a word shorter
+  // than the filter still has one window
+  auto window_offsets_ptr = IAllocator::MakeUniquePtr<int64_t>(alloc, seq_len + 1);
+  int64_t* window_offsets = window_offsets_ptr.get();
+  window_offsets[0] = 0;
+  for (int64_t word_inx = 0; word_inx < seq_len; word_inx++) {
+    int64_t word_length = words_length_ptr.get()[word_inx];
+    int64_t word_unfolded_width = word_length > 0 ? std::max<int64_t>(word_length, filter_width) - filter_width + 1 : 0;
+    window_offsets[word_inx + 1] = window_offsets[word_inx] + word_unfolded_width;
+  }
+
+  // all the windows of all the words are unfolded into one buffer, so the conv of the whole sequence is a single GEMM
+  int64_t total_windows = window_offsets[seq_len];
+  int64_t unfolded_kernal_size = filter_width * char_embedding_size;
+  auto unfolded_buffer_ptr = IAllocator::MakeUniquePtr<float>(alloc, total_windows * unfolded_kernal_size);
+  auto conv_result_ptr = IAllocator::MakeUniquePtr<float>(alloc, total_windows * filter_size);
+  concurrency::ThreadPool* tp = ctx->GetOperatorThreadPool();
+
+  UnfoldCharEmbeddings(seq_ptr,
+                       w_char_embedding.Data<float>(),
+                       window_offsets,
+                       seq_len,
+                       word_len,
+                       char_embedding_size,
+                       filter_width,
+                       unfolded_buffer_ptr.get(),
+                       tp);
+
+  if (total_windows > 0) {
+    math::GemmEx<float>(
+        CblasNoTrans, CblasTrans,
+        static_cast<int>(total_windows), static_cast<int>(filter_size), static_cast<int>(unfolded_kernal_size), 1.0f,
+        unfolded_buffer_ptr.get(), static_cast<int>(unfolded_kernal_size),
+        w_conv.Data<float>(), static_cast<int>(unfolded_kernal_size), 0.0f,
+        conv_result_ptr.get(), static_cast<int>(filter_size), tp);
+  }
+
+  ComputeMaxPoolWithActivation(
+      conv_result_ptr.get(),
       b_conv.Data<float>(),
-      words_length_ptr.get(),
+      window_offsets,
       seq_len,
-      word_len,
-      char_embedding_size,
-      filter_width,
       filter_size,
       Y->MutableData<float>(),
-      ctx->GetOperatorThreadPool());
+      tp);
 
   return Status::OK();
 }
@@ -21,27 +21,24 @@ class WordConvEmbedding final : public OpKernel {
   Status Compute(OpKernelContext* context) const override;
 
  private:
-  void CharEmbeddingLookup(
+  void UnfoldCharEmbeddings(
       const int* seq_ptr,
       const float* char_embedding_weight_p,
-      size_t seq_len,
-      size_t word_len,
-      size_t char_embedding_size,
-      size_t filter_width,
-      const int* words_len_ptr,
-      float* dst) const;
-  void ComputeConvMaxPoolWithActivation(
-      AllocatorPtr allocator,
-      const float* input,
-      const float* weights,
-      const float* bias,
-      const int* words_len_ptr,
+      const int64_t* window_offsets_ptr,
       int64_t seq_len,
       int64_t word_len,
       int64_t char_embedding_size,
       int64_t filter_width,
+      float* dst,
+      onnxruntime::concurrency::ThreadPool* tp) const;
+  void ComputeMaxPoolWithActivation(
+      const float* conv_result,
+      const float* bias,
+      const int64_t* window_offsets_ptr,
+      int64_t seq_len,
       int64_t num_filters,
-      float* output, onnxruntime::concurrency::ThreadPool* tp) const;
+      float* output,
+      onnxruntime::concurrency::ThreadPool* tp) const;
   void CalculateLengthOfEachWordInSequence(
       const int* seq_ptr,
       int* words_len_ptr,
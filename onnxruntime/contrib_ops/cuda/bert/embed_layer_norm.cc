@@ -12,15 +12,16 @@ namespace onnxruntime {
 namespace contrib {
 namespace cuda {
 
-#define REGISTER_KERNEL_TYPED(T)                                  \
-  ONNX_OPERATOR_TYPED_KERNEL_EX(                                  \
-      EmbedLayerNormalization,                                    \
-      kMSDomain,                                                  \
-      1,                                                          \
-      T,                                                          \
-      kCudaExecutionProvider,                                     \
-      KernelDefBuilder()                                          \
-          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>()), \
+#define REGISTER_KERNEL_TYPED(T)                                    \
+  ONNX_OPERATOR_TYPED_KERNEL_EX(                                    \
+      EmbedLayerNormalization,                                      \
+      kMSDomain,                                                    \
+      1,                                                            \
+      T,                                                            \
+      kCudaExecutionProvider,                                       \
+      KernelDefBuilder()                                            \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())    \
+          .TypeConstraint("T2", DataTypeImpl::GetTensorType<T>()),  \
       EmbedLayerNorm<T>);
 
 REGISTER_KERNEL_TYPED(float)
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 
 #include "core/platform/threadpool.h"
@@ -25,6 +27,61 @@ namespace onnxruntime {
 
 namespace concurrency {
 
+static SchedulingHint& CurrentSchedulingHintRef() {
+  static thread_local SchedulingHint hint;
+  return hint;
+}
+
+const SchedulingHint& SchedulingHint::Current() {
+  return CurrentSchedulingHintRef();
+}
+
+int64_t SchedulingHint::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+ScopedSchedulingHint::ScopedSchedulingHint(const SchedulingHint& hint) : saved_(CurrentSchedulingHintRef()) {
+  CurrentSchedulingHintRef() = hint;
+}
+
+ScopedSchedulingHint::~ScopedSchedulingHint() {
+  CurrentSchedulingHintRef() = saved_;
+}
+
+static std::atomic<int> max_spinning_threads{0};
+static std::atomic<int> num_spinning_threads{0};
+
+void SpinLimiter::SetMaxSpinningThreads(int max_spinning_threads_value) {
+  ORT_ENFORCE(max_spinning_threads_value >= 0, "Maximum number of spinning threads must not be negative");
+  max_spinning_threads = max_spinning_threads_value;
+}
+
+int SpinLimiter::GetMaxSpinningThreads() {
+  return max_spinning_threads;
+}
+
+bool SpinLimiter::TryAcquire(bool& slot_taken) {
+  slot_taken = false;
+  const int limit = max_spinning_threads.load(std::memory_order_relaxed);
+  if (limit == 0) {
+    return true;
+  }
+  int seen = num_spinning_threads.load(std::memory_order_relaxed);
+  do {
+    if (seen >= limit) {
+      return false;
+    }
+  } while (!num_spinning_threads.compare_exchange_weak(seen, seen + 1, std::memory_order_relaxed));
+  slot_taken = true;
+  return true;
+}
+
+void SpinLimiter::Release() {
+  num_spinning_threads.fetch_sub(1, std::memory_order_relaxed);
+}
+
 // A sharded loop counter distributes loop iterations between a set of worker threads.  The iteration space of
 // the loop is divided (perhaps unevenly) between the shards.  Each thread has a home shard (perhaps not uniquely
 // to it), and it claims iterations via atomic operations on its home shard.  It then proceeds through the other
@@ -146,6 +203,22 @@ ThreadPool::ThreadPool(Env* env,
                                                        thread_options_);
     underlying_threadpool_ = extended_eigen_threadpool_.get();
   }
+  degree_of_parallelism_ = degree_of_parallelism;
+}
+
+void ThreadPool::SetDegreeOfParallelism(int dop) {
+  degree_of_parallelism_ = std::max(1, std::min(dop, NumThreads() + 1));
+}
+
+int ThreadPool::MaxDegreeOfParallelism(const concurrency::ThreadPool* tp) {
+  return tp ? (tp->NumThreads() + 1) : 1;
+}
+
+int ThreadPool::GetQueueDepth(const concurrency::ThreadPool* tp) {
+  if (tp == nullptr || !tp->extended_eigen_threadpool_) {
+    return 0;
+  }
+  return tp->extended_eigen_threadpool_->GetQueueDepth();
 }
 
 ThreadPool::~ThreadPool() = default;
@@ -170,12 +243,18 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
   int num_work_items = static_cast<int>(std::min(static_cast<std::ptrdiff_t>(d_of_p), total));
   assert(num_work_items > 0);
 
+  // If the request issuing the loop has a deadline, threads stop claiming iterations once it has
+  // passed, leaving the loop incomplete.  The loop returns normally: the executor finds the
+  // deadline expired once the kernel returns, and fails the run without using its outputs.
+  const int64_t deadline_ns = SchedulingHint::Current().deadline_ns;
+
   LoopCounter lc(*this, total, block_size);
   std::function<void()> run_work = [&]() {
     int my_home_shard = lc.GetHomeShard();
     int my_shard = my_home_shard;
     uint64_t my_iter_start, my_iter_end;
-    while (lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end)) {
+    while ((deadline_ns == 0 || SchedulingHint::NowNs() < deadline_ns) &&
+           lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end)) {
       fn(static_cast<std::ptrdiff_t>(my_iter_start),
          static_cast<std::ptrdiff_t>(my_iter_end));
     }
@@ -224,8 +303,10 @@ bool ThreadPool::ShouldParallelizeLoop(const std::ptrdiff_t num_iterations,
   // caller is outside the current pool (ID == -1) then we parallelize
   // if the pool has any threads.  If the caller is inside the current pool
   // (ID != -1) then we require at least one additional thread in the pool.
+  // The pool may also have been limited to a degree of parallelism of 1.
   if ((CurrentThreadId() == -1 && NumThreads() == 0) ||
-      (CurrentThreadId() != -1 && NumThreads() == 1)) {
+      (CurrentThreadId() != -1 && NumThreads() == 1) ||
+      DegreeOfParallelism(this) == 1) {
     return false;
   }
 
@@ -328,11 +409,26 @@ int ThreadPool::DegreeOfParallelism(const concurrency::ThreadPool* tp) {
   return (omp_get_num_threads() == 1) ? omp_get_max_threads() : 1;
 #else
   // When not using OpenMP, we parallelise over the N threads created by the pool
-  // tp, plus 1 for the thread entering a loop.
-  return tp ? (tp->NumThreads()+1) : 1;
+  // tp, plus 1 for the thread entering a loop, unless the pool has been limited to
+  // a lower degree of parallelism via SetDegreeOfParallelism.
+  return tp ? tp->degree_of_parallelism_.load(std::memory_order_relaxed) : 1;
 #endif
 }
 
+QueueingDelayStats ThreadPool::GetQueueingDelayStats(const concurrency::ThreadPool* tp, WorkPriority priority) {
+  if (tp == nullptr || !tp->extended_eigen_threadpool_) {
+    return QueueingDelayStats();
+  }
+  return tp->extended_eigen_threadpool_->GetQueueingDelayStats(priority);
+}
+
+SpinStats ThreadPool::GetSpinStats(const concurrency::ThreadPool* tp) {
+  if (tp == nullptr || !tp->extended_eigen_threadpool_) {
+    return SpinStats();
+  }
+  return tp->extended_eigen_threadpool_->GetSpinStats();
+}
+
 // Return the number of threads created by the pool.
 int ThreadPool::NumThreads() const {
   if (underlying_threadpool_) {
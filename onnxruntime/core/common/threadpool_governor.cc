@@ -0,0 +1,160 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/threadpool_governor.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace onnxruntime {
+namespace concurrency {
+
+// Weight of the latest sample in the moving average of each pool's queue depth.
+static constexpr double kDemandSmoothing = 0.25;
+
+// Minimum weight of a pool when dividing the budget, so idle pools share any spare cores evenly.
+static constexpr double kMinDemand = 0.01;
+
+// Smoothed queue depth from which a pool counts as busy when there are more pools than cores.
+static constexpr double kBusyDemand = 0.5;
+
+ThreadPoolGovernor::ThreadPoolGovernor(int core_budget, std::chrono::milliseconds rebalance_interval)
+    : core_budget_(core_budget), rebalance_interval_(rebalance_interval) {
+  ORT_ENFORCE(core_budget_ >= 1, "Core budget must be at least 1");
+  if (rebalance_interval_.count() > 0) {
+    governor_thread_ = std::thread([this]() { GovernorLoop(); });
+  }
+}
+
+ThreadPoolGovernor::~ThreadPoolGovernor() {
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  if (governor_thread_.joinable()) {
+    governor_thread_.join();
+  }
+}
+
+void ThreadPoolGovernor::Register(ThreadPool* tp) {
+  if (tp == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    pools_.push_back({tp, 0.0});
+  }
+  Rebalance();
+}
+
+void ThreadPoolGovernor::Unregister(ThreadPool* tp) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto it = std::find_if(pools_.begin(), pools_.end(), [tp](const PoolInfo& info) { return info.tp == tp; });
+  if (it != pools_.end()) {
+    // Hand back all of its threads, as the pool may outlive the governor's interest in it.
+    tp->SetDegreeOfParallelism(ThreadPool::MaxDegreeOfParallelism(tp));
+    pools_.erase(it);
+  }
+}
+
+void ThreadPoolGovernor::Rebalance() {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  const size_t num_pools = pools_.size();
+  if (num_pools == 0) {
+    return;
+  }
+
+  // Every pool keeps at least one degree of parallelism: the thread calling into it.
+  std::vector<int> allocation(num_pools, 1);
+  std::vector<int> capacity(num_pools);
+  std::vector<double> weight(num_pools);
+  for (size_t i = 0; i < num_pools; ++i) {
+    auto& info = pools_[i];
+    int depth = ThreadPool::GetQueueDepth(info.tp);
+    info.demand = (1.0 - kDemandSmoothing) * info.demand + kDemandSmoothing * depth;
+    capacity[i] = ThreadPool::MaxDegreeOfParallelism(info.tp) - 1;
+    weight[i] = std::max(info.demand, kMinDemand);
+  }
+
+  // With more pools than cores, the busiest pools keep a core each, up to one less than the budget,
+  // and all the other pools share the last one.  Those get no threads beyond their caller.
+  int reserved = static_cast<int>(num_pools);
+  if (reserved > core_budget_) {
+    std::vector<size_t> by_demand(num_pools);
+    std::iota(by_demand.begin(), by_demand.end(), size_t{0});
+    std::stable_sort(by_demand.begin(), by_demand.end(),
+                     [this](size_t a, size_t b) { return pools_[a].demand > pools_[b].demand; });
+    int owners = 0;
+    for (size_t i : by_demand) {
+      if (owners < core_budget_ - 1 && pools_[i].demand >= kBusyDemand) {
+        ++owners;
+      } else {
+        capacity[i] = 0;
+      }
+    }
+    reserved = owners + 1;
+  }
+
+  // Divide the remaining budget in proportion to demand, capping each pool at the number of threads
+  // it has.  Repeat to hand out what capped pools could not use.  If rounding leaves cores that the
+  // proportional split cannot place, give them one at a time to the most loaded pool per core.
+  int remaining = core_budget_ - reserved;
+  while (remaining > 0) {
+    double total_weight = 0.0;
+    for (size_t i = 0; i < num_pools; ++i) {
+      if (capacity[i] > 0) {
+        total_weight += weight[i];
+      }
+    }
+    if (total_weight == 0.0) {
+      break;  // All pools are saturated
+    }
+
+    int distributed = 0;
+    for (size_t i = 0; i < num_pools; ++i) {
+      if (capacity[i] > 0) {
+        int share = static_cast<int>(remaining * weight[i] / total_weight);
+        int give = std::min(share, capacity[i]);
+        allocation[i] += give;
+        capacity[i] -= give;
+        distributed += give;
+      }
+    }
+
+    if (distributed == 0) {
+      size_t best = num_pools;
+      for (size_t i = 0; i < num_pools; ++i) {
+        if (capacity[i] > 0 &&
+            (best == num_pools || weight[i] / allocation[i] > weight[best] / allocation[best])) {
+          best = i;
+        }
+      }
+      allocation[best] += 1;
+      capacity[best] -= 1;
+      distributed = 1;
+    }
+
+    remaining -= distributed;
+  }
+
+  for (size_t i = 0; i < num_pools; ++i) {
+    pools_[i].tp->SetDegreeOfParallelism(allocation[i]);
+  }
+}
+
+void ThreadPoolGovernor::GovernorLoop() {
+  for (;;) {
+    {
+      std::unique_lock<OrtMutex> lock(mutex_);
+      cv_.wait_for(lock, rebalance_interval_);
+      if (shutdown_) {
+        return;
+      }
+    }
+    Rebalance();
+  }
+}
+
+}  // namespace concurrency
+}  // namespace onnxruntime
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/platform/ort_mutex.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+namespace concurrency {
+
+// ThreadPoolGovernor shares a fixed budget of cores between a set of thread pools, typically the
+// intra-op pools of several sessions colocated in one process.  A background thread periodically
+// samples the queue depth of each registered pool and re-divides the budget in proportion to the
+// (smoothed) demand, applying the result through ThreadPool::SetDegreeOfParallelism.  Every pool
+// keeps a degree of parallelism of at least 1, and no pool is given more than it has threads for.
+//
+// The degree of parallelism of 1 is the thread calling into the pool, which counts against the
+// budget.  When there are more pools than the budget, the busiest pools keep a core each for their
+// calling thread, up to one less than the budget, and the others share the last core: they get no
+// threads beyond their caller, and the busy pools divide what is left of the budget.
+//
+// Pools must be unregistered before they are destroyed.
+class ThreadPoolGovernor {
+ public:
+  // core_budget is the total degree of parallelism shared by the registered pools.  If
+  // rebalance_interval is zero no background thread is started and the owner is expected to call
+  // Rebalance itself.
+  ThreadPoolGovernor(int core_budget, std::chrono::milliseconds rebalance_interval);
+  ~ThreadPoolGovernor();
+
+  void Register(ThreadPool* tp);
+  void Unregister(ThreadPool* tp);
+
+  int CoreBudget() const {
+    return core_budget_;
+  }
+
+  // Sample the demand on the registered pools and redistribute the core budget.
+  void Rebalance();
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ThreadPoolGovernor);
+
+ private:
+  struct PoolInfo {
+    ThreadPool* tp;
+    double demand;  // Exponentially weighted moving average of the queue depth
+  };
+
+  void GovernorLoop();
+
+  const int core_budget_;
+  const std::chrono::milliseconds rebalance_interval_;
+
+  OrtMutex mutex_;
+  OrtCondVar cv_;
+  bool shutdown_ = false;
+  std::vector<PoolInfo> pools_;
+  std::thread governor_thread_;
+};
+
+}  // namespace concurrency
+}  // namespace onnxruntime
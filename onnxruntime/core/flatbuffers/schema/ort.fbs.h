@@ -66,6 +66,18 @@ struct KernelCreateInfosBuilder;
 struct SubGraphSessionState;
 struct SubGraphSessionStateBuilder;
 
+struct MemoryInfo;
+struct MemoryInfoBuilder;
+
+struct MemoryPattern;
+struct MemoryPatternBuilder;
+
+struct MemoryPatternGroup;
+struct MemoryPatternGroupBuilder;
+
+struct ExecutionPlan;
+struct ExecutionPlanBuilder;
+
 struct SessionState;
 struct SessionStateBuilder;
 
@@ -2089,11 +2101,538 @@ inline flatbuffers::Offset<SubGraphSessionState> CreateSubGraphSessionStateDirec
       session_state);
 }
 
+struct MemoryInfo FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef MemoryInfoBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_NAME = 4,
+    VT_ID = 6,
+    VT_MEM_TYPE = 8,
+    VT_ALLOC_TYPE = 10,
+    VT_DEVICE_TYPE = 12,
+    VT_DEVICE_MEM_TYPE = 14,
+    VT_DEVICE_ID = 16
+  };
+  const flatbuffers::String *name() const {
+    return GetPointer<const flatbuffers::String *>(VT_NAME);
+  }
+  int32_t id() const {
+    return GetField<int32_t>(VT_ID, 0);
+  }
+  int32_t mem_type() const {
+    return GetField<int32_t>(VT_MEM_TYPE, 0);
+  }
+  int32_t alloc_type() const {
+    return GetField<int32_t>(VT_ALLOC_TYPE, 0);
+  }
+  int8_t device_type() const {
+    return GetField<int8_t>(VT_DEVICE_TYPE, 0);
+  }
+  int8_t device_mem_type() const {
+    return GetField<int8_t>(VT_DEVICE_MEM_TYPE, 0);
+  }
+  int16_t device_id() const {
+    return GetField<int16_t>(VT_DEVICE_ID, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_NAME) &&
+           verifier.VerifyString(name()) &&
+           VerifyField<int32_t>(verifier, VT_ID) &&
+           VerifyField<int32_t>(verifier, VT_MEM_TYPE) &&
+           VerifyField<int32_t>(verifier, VT_ALLOC_TYPE) &&
+           VerifyField<int8_t>(verifier, VT_DEVICE_TYPE) &&
+           VerifyField<int8_t>(verifier, VT_DEVICE_MEM_TYPE) &&
+           VerifyField<int16_t>(verifier, VT_DEVICE_ID) &&
+           verifier.EndTable();
+  }
+};
+
+struct MemoryInfoBuilder {
+  typedef MemoryInfo Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_name(flatbuffers::Offset<flatbuffers::String> name) {
+    fbb_.AddOffset(MemoryInfo::VT_NAME, name);
+  }
+  void add_id(int32_t id) {
+    fbb_.AddElement<int32_t>(MemoryInfo::VT_ID, id, 0);
+  }
+  void add_mem_type(int32_t mem_type) {
+    fbb_.AddElement<int32_t>(MemoryInfo::VT_MEM_TYPE, mem_type, 0);
+  }
+  void add_alloc_type(int32_t alloc_type) {
+    fbb_.AddElement<int32_t>(MemoryInfo::VT_ALLOC_TYPE, alloc_type, 0);
+  }
+  void add_device_type(int8_t device_type) {
+    fbb_.AddElement<int8_t>(MemoryInfo::VT_DEVICE_TYPE, device_type, 0);
+  }
+  void add_device_mem_type(int8_t device_mem_type) {
+    fbb_.AddElement<int8_t>(MemoryInfo::VT_DEVICE_MEM_TYPE, device_mem_type, 0);
+  }
+  void add_device_id(int16_t device_id) {
+    fbb_.AddElement<int16_t>(MemoryInfo::VT_DEVICE_ID, device_id, 0);
+  }
+  explicit MemoryInfoBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  MemoryInfoBuilder &operator=(const MemoryInfoBuilder &);
+  flatbuffers::Offset<MemoryInfo> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<MemoryInfo>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<MemoryInfo> CreateMemoryInfo(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::String> name = 0,
+    int32_t id = 0,
+    int32_t mem_type = 0,
+    int32_t alloc_type = 0,
+    int8_t device_type = 0,
+    int8_t device_mem_type = 0,
+    int16_t device_id = 0) {
+  MemoryInfoBuilder builder_(_fbb);
+  builder_.add_alloc_type(alloc_type);
+  builder_.add_mem_type(mem_type);
+  builder_.add_id(id);
+  builder_.add_name(name);
+  builder_.add_device_id(device_id);
+  builder_.add_device_mem_type(device_mem_type);
+  builder_.add_device_type(device_type);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<MemoryInfo> CreateMemoryInfoDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const char *name = nullptr,
+    int32_t id = 0,
+    int32_t mem_type = 0,
+    int32_t alloc_type = 0,
+    int8_t device_type = 0,
+    int8_t device_mem_type = 0,
+    int16_t device_id = 0) {
+  auto name__ = name ? _fbb.CreateString(name) : 0;
+  return onnxruntime::experimental::fbs::CreateMemoryInfo(
+      _fbb,
+      name__,
+      id,
+      mem_type,
+      alloc_type,
+      device_type,
+      device_mem_type,
+      device_id);
+}
+
+struct MemoryPattern FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef MemoryPatternBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_LOCATION = 4,
+    VT_PEAK_SIZE = 6,
+    VT_VALUE_INDICES = 8,
+    VT_OFFSETS = 10,
+    VT_SIZES = 12
+  };
+  uint32_t location() const {
+    return GetField<uint32_t>(VT_LOCATION, 0);
+  }
+  uint64_t peak_size() const {
+    return GetField<uint64_t>(VT_PEAK_SIZE, 0);
+  }
+  const flatbuffers::Vector<int32_t> *value_indices() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_VALUE_INDICES);
+  }
+  const flatbuffers::Vector<uint64_t> *offsets() const {
+    return GetPointer<const flatbuffers::Vector<uint64_t> *>(VT_OFFSETS);
+  }
+  const flatbuffers::Vector<uint64_t> *sizes() const {
+    return GetPointer<const flatbuffers::Vector<uint64_t> *>(VT_SIZES);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_LOCATION) &&
+           VerifyField<uint64_t>(verifier, VT_PEAK_SIZE) &&
+           VerifyOffset(verifier, VT_VALUE_INDICES) &&
+           verifier.VerifyVector(value_indices()) &&
+           VerifyOffset(verifier, VT_OFFSETS) &&
+           verifier.VerifyVector(offsets()) &&
+           VerifyOffset(verifier, VT_SIZES) &&
+           verifier.VerifyVector(sizes()) &&
+           verifier.EndTable();
+  }
+};
+
+struct MemoryPatternBuilder {
+  typedef MemoryPattern Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_location(uint32_t location) {
+    fbb_.AddElement<uint32_t>(MemoryPattern::VT_LOCATION, location, 0);
+  }
+  void add_peak_size(uint64_t peak_size) {
+    fbb_.AddElement<uint64_t>(MemoryPattern::VT_PEAK_SIZE, peak_size, 0);
+  }
+  void add_value_indices(flatbuffers::Offset<flatbuffers::Vector<int32_t>> value_indices) {
+    fbb_.AddOffset(MemoryPattern::VT_VALUE_INDICES, value_indices);
+  }
+  void add_offsets(flatbuffers::Offset<flatbuffers::Vector<uint64_t>> offsets) {
+    fbb_.AddOffset(MemoryPattern::VT_OFFSETS, offsets);
+  }
+  void add_sizes(flatbuffers::Offset<flatbuffers::Vector<uint64_t>> sizes) {
+    fbb_.AddOffset(MemoryPattern::VT_SIZES, sizes);
+  }
+  explicit MemoryPatternBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  MemoryPatternBuilder &operator=(const MemoryPatternBuilder &);
+  flatbuffers::Offset<MemoryPattern> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<MemoryPattern>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<MemoryPattern> CreateMemoryPattern(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t location = 0,
+    uint64_t peak_size = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> value_indices = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint64_t>> offsets = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint64_t>> sizes = 0) {
+  MemoryPatternBuilder builder_(_fbb);
+  builder_.add_peak_size(peak_size);
+  builder_.add_sizes(sizes);
+  builder_.add_offsets(offsets);
+  builder_.add_value_indices(value_indices);
+  builder_.add_location(location);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<MemoryPattern> CreateMemoryPatternDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t location = 0,
+    uint64_t peak_size = 0,
+    const std::vector<int32_t> *value_indices = nullptr,
+    const std::vector<uint64_t> *offsets = nullptr,
+    const std::vector<uint64_t> *sizes = nullptr) {
+  auto value_indices__ = value_indices ? _fbb.CreateVector<int32_t>(*value_indices) : 0;
+  auto offsets__ = offsets ? _fbb.CreateVector<uint64_t>(*offsets) : 0;
+  auto sizes__ = sizes ? _fbb.CreateVector<uint64_t>(*sizes) : 0;
+  return onnxruntime::experimental::fbs::CreateMemoryPattern(
+      _fbb,
+      location,
+      peak_size,
+      value_indices__,
+      offsets__,
+      sizes__);
+}
+
+struct MemoryPatternGroup FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef MemoryPatternGroupBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_INPUT_SHAPES_KEY = 4,
+    VT_PATTERNS = 6
+  };
+  int64_t input_shapes_key() const {
+    return GetField<int64_t>(VT_INPUT_SHAPES_KEY, 0);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPattern>> *patterns() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPattern>> *>(VT_PATTERNS);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<int64_t>(verifier, VT_INPUT_SHAPES_KEY) &&
+           VerifyOffset(verifier, VT_PATTERNS) &&
+           verifier.VerifyVector(patterns()) &&
+           verifier.VerifyVectorOfTables(patterns()) &&
+           verifier.EndTable();
+  }
+};
+
+struct MemoryPatternGroupBuilder {
+  typedef MemoryPatternGroup Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_input_shapes_key(int64_t input_shapes_key) {
+    fbb_.AddElement<int64_t>(MemoryPatternGroup::VT_INPUT_SHAPES_KEY, input_shapes_key, 0);
+  }
+  void add_patterns(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPattern>>> patterns) {
+    fbb_.AddOffset(MemoryPatternGroup::VT_PATTERNS, patterns);
+  }
+  explicit MemoryPatternGroupBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  MemoryPatternGroupBuilder &operator=(const MemoryPatternGroupBuilder &);
+  flatbuffers::Offset<MemoryPatternGroup> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<MemoryPatternGroup>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<MemoryPatternGroup> CreateMemoryPatternGroup(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    int64_t input_shapes_key = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPattern>>> patterns = 0) {
+  MemoryPatternGroupBuilder builder_(_fbb);
+  builder_.add_input_shapes_key(input_shapes_key);
+  builder_.add_patterns(patterns);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<MemoryPatternGroup> CreateMemoryPatternGroupDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    int64_t input_shapes_key = 0,
+    const std::vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPattern>> *patterns = nullptr) {
+  auto patterns__ = patterns ? _fbb.CreateVector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPattern>>(*patterns) : 0;
+  return onnxruntime::experimental::fbs::CreateMemoryPatternGroup(
+      _fbb,
+      input_shapes_key,
+      patterns__);
+}
+
+struct ExecutionPlan FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef ExecutionPlanBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_EXECUTION_MODE = 4,
+    VT_EXECUTION_ORDER = 6,
+    VT_ORT_VALUE_NAMES = 8,
+    VT_LOCATIONS = 10,
+    VT_ALLOC_KINDS = 12,
+    VT_VALUE_LOCATIONS = 14,
+    VT_REUSED_BUFFERS = 16,
+    VT_CREATE_FENCE_IF_ASYNC = 18,
+    VT_NODE_INDICES = 20,
+    VT_FREE_FROM_INDICES = 22,
+    VT_FREE_TO_INDICES = 24,
+    VT_TO_BE_FREED = 26,
+    VT_NODE_HAS_FENCE = 28,
+    VT_MEMORY_PATTERN_GROUPS = 30
+  };
+  int32_t execution_mode() const {
+    return GetField<int32_t>(VT_EXECUTION_MODE, 0);
+  }
+  int32_t execution_order() const {
+    return GetField<int32_t>(VT_EXECUTION_ORDER, 0);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *ort_value_names() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *>(VT_ORT_VALUE_NAMES);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryInfo>> *locations() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryInfo>> *>(VT_LOCATIONS);
+  }
+  const flatbuffers::Vector<int32_t> *alloc_kinds() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_ALLOC_KINDS);
+  }
+  const flatbuffers::Vector<uint32_t> *value_locations() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_VALUE_LOCATIONS);
+  }
+  const flatbuffers::Vector<int32_t> *reused_buffers() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_REUSED_BUFFERS);
+  }
+  const flatbuffers::Vector<uint8_t> *create_fence_if_async() const {
+    return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_CREATE_FENCE_IF_ASYNC);
+  }
+  const flatbuffers::Vector<uint32_t> *node_indices() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_NODE_INDICES);
+  }
+  const flatbuffers::Vector<int32_t> *free_from_indices() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_FREE_FROM_INDICES);
+  }
+  const flatbuffers::Vector<int32_t> *free_to_indices() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_FREE_TO_INDICES);
+  }
+  const flatbuffers::Vector<int32_t> *to_be_freed() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_TO_BE_FREED);
+  }
+  const flatbuffers::Vector<uint8_t> *node_has_fence() const {
+    return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_NODE_HAS_FENCE);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPatternGroup>> *memory_pattern_groups() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPatternGroup>> *>(VT_MEMORY_PATTERN_GROUPS);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<int32_t>(verifier, VT_EXECUTION_MODE) &&
+           VerifyField<int32_t>(verifier, VT_EXECUTION_ORDER) &&
+           VerifyOffset(verifier, VT_ORT_VALUE_NAMES) &&
+           verifier.VerifyVector(ort_value_names()) &&
+           verifier.VerifyVectorOfStrings(ort_value_names()) &&
+           VerifyOffset(verifier, VT_LOCATIONS) &&
+           verifier.VerifyVector(locations()) &&
+           verifier.VerifyVectorOfTables(locations()) &&
+           VerifyOffset(verifier, VT_ALLOC_KINDS) &&
+           verifier.VerifyVector(alloc_kinds()) &&
+           VerifyOffset(verifier, VT_VALUE_LOCATIONS) &&
+           verifier.VerifyVector(value_locations()) &&
+           VerifyOffset(verifier, VT_REUSED_BUFFERS) &&
+           verifier.VerifyVector(reused_buffers()) &&
+           VerifyOffset(verifier, VT_CREATE_FENCE_IF_ASYNC) &&
+           verifier.VerifyVector(create_fence_if_async()) &&
+           VerifyOffset(verifier, VT_NODE_INDICES) &&
+           verifier.VerifyVector(node_indices()) &&
+           VerifyOffset(verifier, VT_FREE_FROM_INDICES) &&
+           verifier.VerifyVector(free_from_indices()) &&
+           VerifyOffset(verifier, VT_FREE_TO_INDICES) &&
+           verifier.VerifyVector(free_to_indices()) &&
+           VerifyOffset(verifier, VT_TO_BE_FREED) &&
+           verifier.VerifyVector(to_be_freed()) &&
+           VerifyOffset(verifier, VT_NODE_HAS_FENCE) &&
+           verifier.VerifyVector(node_has_fence()) &&
+           VerifyOffset(verifier, VT_MEMORY_PATTERN_GROUPS) &&
+           verifier.VerifyVector(memory_pattern_groups()) &&
+           verifier.VerifyVectorOfTables(memory_pattern_groups()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ExecutionPlanBuilder {
+  typedef ExecutionPlan Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_execution_mode(int32_t execution_mode) {
+    fbb_.AddElement<int32_t>(ExecutionPlan::VT_EXECUTION_MODE, execution_mode, 0);
+  }
+  void add_execution_order(int32_t execution_order) {
+    fbb_.AddElement<int32_t>(ExecutionPlan::VT_EXECUTION_ORDER, execution_order, 0);
+  }
+  void add_ort_value_names(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> ort_value_names) {
+    fbb_.AddOffset(ExecutionPlan::VT_ORT_VALUE_NAMES, ort_value_names);
+  }
+  void add_locations(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryInfo>>> locations) {
+    fbb_.AddOffset(ExecutionPlan::VT_LOCATIONS, locations);
+  }
+  void add_alloc_kinds(flatbuffers::Offset<flatbuffers::Vector<int32_t>> alloc_kinds) {
+    fbb_.AddOffset(ExecutionPlan::VT_ALLOC_KINDS, alloc_kinds);
+  }
+  void add_value_locations(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> value_locations) {
+    fbb_.AddOffset(ExecutionPlan::VT_VALUE_LOCATIONS, value_locations);
+  }
+  void add_reused_buffers(flatbuffers::Offset<flatbuffers::Vector<int32_t>> reused_buffers) {
+    fbb_.AddOffset(ExecutionPlan::VT_REUSED_BUFFERS, reused_buffers);
+  }
+  void add_create_fence_if_async(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> create_fence_if_async) {
+    fbb_.AddOffset(ExecutionPlan::VT_CREATE_FENCE_IF_ASYNC, create_fence_if_async);
+  }
+  void add_node_indices(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> node_indices) {
+    fbb_.AddOffset(ExecutionPlan::VT_NODE_INDICES, node_indices);
+  }
+  void add_free_from_indices(flatbuffers::Offset<flatbuffers::Vector<int32_t>> free_from_indices) {
+    fbb_.AddOffset(ExecutionPlan::VT_FREE_FROM_INDICES, free_from_indices);
+  }
+  void add_free_to_indices(flatbuffers::Offset<flatbuffers::Vector<int32_t>> free_to_indices) {
+    fbb_.AddOffset(ExecutionPlan::VT_FREE_TO_INDICES, free_to_indices);
+  }
+  void add_to_be_freed(flatbuffers::Offset<flatbuffers::Vector<int32_t>> to_be_freed) {
+    fbb_.AddOffset(ExecutionPlan::VT_TO_BE_FREED, to_be_freed);
+  }
+  void add_node_has_fence(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> node_has_fence) {
+    fbb_.AddOffset(ExecutionPlan::VT_NODE_HAS_FENCE, node_has_fence);
+  }
+  void add_memory_pattern_groups(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPatternGroup>>> memory_pattern_groups) {
+    fbb_.AddOffset(ExecutionPlan::VT_MEMORY_PATTERN_GROUPS, memory_pattern_groups);
+  }
+  explicit ExecutionPlanBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ExecutionPlanBuilder &operator=(const ExecutionPlanBuilder &);
+  flatbuffers::Offset<ExecutionPlan> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ExecutionPlan>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ExecutionPlan> CreateExecutionPlan(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    int32_t execution_mode = 0,
+    int32_t execution_order = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> ort_value_names = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryInfo>>> locations = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> alloc_kinds = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> value_locations = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> reused_buffers = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> create_fence_if_async = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> node_indices = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> free_from_indices = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> free_to_indices = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> to_be_freed = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> node_has_fence = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPatternGroup>>> memory_pattern_groups = 0) {
+  ExecutionPlanBuilder builder_(_fbb);
+  builder_.add_memory_pattern_groups(memory_pattern_groups);
+  builder_.add_node_has_fence(node_has_fence);
+  builder_.add_to_be_freed(to_be_freed);
+  builder_.add_free_to_indices(free_to_indices);
+  builder_.add_free_from_indices(free_from_indices);
+  builder_.add_node_indices(node_indices);
+  builder_.add_create_fence_if_async(create_fence_if_async);
+  builder_.add_reused_buffers(reused_buffers);
+  builder_.add_value_locations(value_locations);
+  builder_.add_alloc_kinds(alloc_kinds);
+  builder_.add_locations(locations);
+  builder_.add_ort_value_names(ort_value_names);
+  builder_.add_execution_order(execution_order);
+  builder_.add_execution_mode(execution_mode);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ExecutionPlan> CreateExecutionPlanDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    int32_t execution_mode = 0,
+    int32_t execution_order = 0,
+    const std::vector<flatbuffers::Offset<flatbuffers::String>> *ort_value_names = nullptr,
+    const std::vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryInfo>> *locations = nullptr,
+    const std::vector<int32_t> *alloc_kinds = nullptr,
+    const std::vector<uint32_t> *value_locations = nullptr,
+    const std::vector<int32_t> *reused_buffers = nullptr,
+    const std::vector<uint8_t> *create_fence_if_async = nullptr,
+    const std::vector<uint32_t> *node_indices = nullptr,
+    const std::vector<int32_t> *free_from_indices = nullptr,
+    const std::vector<int32_t> *free_to_indices = nullptr,
+    const std::vector<int32_t> *to_be_freed = nullptr,
+    const std::vector<uint8_t> *node_has_fence = nullptr,
+    const std::vector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPatternGroup>> *memory_pattern_groups = nullptr) {
+  auto ort_value_names__ = ort_value_names ? _fbb.CreateVector<flatbuffers::Offset<flatbuffers::String>>(*ort_value_names) : 0;
+  auto locations__ = locations ? _fbb.CreateVector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryInfo>>(*locations) : 0;
+  auto alloc_kinds__ = alloc_kinds ? _fbb.CreateVector<int32_t>(*alloc_kinds) : 0;
+  auto value_locations__ = value_locations ? _fbb.CreateVector<uint32_t>(*value_locations) : 0;
+  auto reused_buffers__ = reused_buffers ? _fbb.CreateVector<int32_t>(*reused_buffers) : 0;
+  auto create_fence_if_async__ = create_fence_if_async ? _fbb.CreateVector<uint8_t>(*create_fence_if_async) : 0;
+  auto node_indices__ = node_indices ? _fbb.CreateVector<uint32_t>(*node_indices) : 0;
+  auto free_from_indices__ = free_from_indices ? _fbb.CreateVector<int32_t>(*free_from_indices) : 0;
+  auto free_to_indices__ = free_to_indices ? _fbb.CreateVector<int32_t>(*free_to_indices) : 0;
+  auto to_be_freed__ = to_be_freed ? _fbb.CreateVector<int32_t>(*to_be_freed) : 0;
+  auto node_has_fence__ = node_has_fence ? _fbb.CreateVector<uint8_t>(*node_has_fence) : 0;
+  auto memory_pattern_groups__ = memory_pattern_groups ? _fbb.CreateVector<flatbuffers::Offset<onnxruntime::experimental::fbs::MemoryPatternGroup>>(*memory_pattern_groups) : 0;
+  return onnxruntime::experimental::fbs::CreateExecutionPlan(
+      _fbb,
+      execution_mode,
+      execution_order,
+      ort_value_names__,
+      locations__,
+      alloc_kinds__,
+      value_locations__,
+      reused_buffers__,
+      create_fence_if_async__,
+      node_indices__,
+      free_from_indices__,
+      free_to_indices__,
+      to_be_freed__,
+      node_has_fence__,
+      memory_pattern_groups__);
+}
+
 struct SessionState FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef SessionStateBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_KERNELS = 4,
-    VT_SUB_GRAPH_SESSION_STATES = 6
+    VT_SUB_GRAPH_SESSION_STATES = 6,
+    VT_EXECUTION_PLAN = 8
   };
   const onnxruntime::experimental::fbs::KernelCreateInfos *kernels() const {
     return GetPointer<const onnxruntime::experimental::fbs::KernelCreateInfos *>(VT_KERNELS);
@@ -2101,6 +2640,9 @@ struct SessionState FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::SubGraphSessionState>> *sub_graph_session_states() const {
     return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::SubGraphSessionState>> *>(VT_SUB_GRAPH_SESSION_STATES);
   }
+  const onnxruntime::experimental::fbs::ExecutionPlan *execution_plan() const {
+    return GetPointer<const onnxruntime::experimental::fbs::ExecutionPlan *>(VT_EXECUTION_PLAN);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_KERNELS) &&
@@ -2108,6 +2650,8 @@ struct SessionState FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyOffset(verifier, VT_SUB_GRAPH_SESSION_STATES) &&
            verifier.VerifyVector(sub_graph_session_states()) &&
            verifier.VerifyVectorOfTables(sub_graph_session_states()) &&
+           VerifyOffset(verifier, VT_EXECUTION_PLAN) &&
+           verifier.VerifyTable(execution_plan()) &&
            verifier.EndTable();
   }
 };
@@ -2122,6 +2666,9 @@ struct SessionStateBuilder {
   void add_sub_graph_session_states(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::SubGraphSessionState>>> sub_graph_session_states) {
     fbb_.AddOffset(SessionState::VT_SUB_GRAPH_SESSION_STATES, sub_graph_session_states);
   }
+  void add_execution_plan(flatbuffers::Offset<onnxruntime::experimental::fbs::ExecutionPlan> execution_plan) {
+    fbb_.AddOffset(SessionState::VT_EXECUTION_PLAN, execution_plan);
+  }
   explicit SessionStateBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -2137,8 +2684,10 @@ struct SessionStateBuilder {
 inline flatbuffers::Offset<SessionState> CreateSessionState(
     flatbuffers::FlatBufferBuilder &_fbb,
     flatbuffers::Offset<onnxruntime::experimental::fbs::KernelCreateInfos> kernels = 0,
-    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::SubGraphSessionState>>> sub_graph_session_states = 0) {
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<onnxruntime::experimental::fbs::SubGraphSessionState>>> sub_graph_session_states = 0,
+    flatbuffers::Offset<onnxruntime::experimental::fbs::ExecutionPlan> execution_plan = 0) {
   SessionStateBuilder builder_(_fbb);
+  builder_.add_execution_plan(execution_plan);
   builder_.add_sub_graph_session_states(sub_graph_session_states);
   builder_.add_kernels(kernels);
   return builder_.Finish();
@@ -2147,12 +2696,14 @@ inline flatbuffers::Offset<SessionState> CreateSessionState(
 inline flatbuffers::Offset<SessionState> CreateSessionStateDirect(
     flatbuffers::FlatBufferBuilder &_fbb,
     flatbuffers::Offset<onnxruntime::experimental::fbs::KernelCreateInfos> kernels = 0,
-    std::vector<flatbuffers::Offset<onnxruntime::experimental::fbs::SubGraphSessionState>> *sub_graph_session_states = nullptr) {
+    std::vector<flatbuffers::Offset<onnxruntime::experimental::fbs::SubGraphSessionState>> *sub_graph_session_states = nullptr,
+    flatbuffers::Offset<onnxruntime::experimental::fbs::ExecutionPlan> execution_plan = 0) {
   auto sub_graph_session_states__ = sub_graph_session_states ? _fbb.CreateVectorOfSortedTables<onnxruntime::experimental::fbs::SubGraphSessionState>(sub_graph_session_states) : 0;
   return onnxruntime::experimental::fbs::CreateSessionState(
       _fbb,
       kernels,
-      sub_graph_session_states__);
+      sub_graph_session_states__,
+      execution_plan);
 }
 
 struct InferenceSession FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
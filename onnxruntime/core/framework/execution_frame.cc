@@ -114,8 +114,8 @@ void IExecutionFrame::Init(const std::vector<int>& feed_mlvalue_idxs, const std:
   ORT_ENFORCE(feeds.size() == feed_mlvalue_idxs.size());
   ORT_ENFORCE(fetches.empty() || fetches.size() == fetch_mlvalue_idxs_.size());
 
-  // 1. resize the all_value_ vector
-  all_values_.resize(all_values_size_);
+  // 1. resize the all_value_ vector. any values left from a previous execution of a reused frame are released.
+  all_values_.assign(all_values_size_, OrtValue());
 
   // 2. Handle non-empty output vector
   if (!fetches.empty()) {
@@ -204,29 +204,20 @@ bool IExecutionFrame::IsOutput(int ort_value_idx) const {
 ExecutionFrame::ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs, const std::vector<OrtValue>& feeds,
                                const std::vector<int>& fetch_mlvalue_idxs, const std::vector<OrtValue>& fetches,
                                const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
-                               const SessionState& session_state)
+                               const SessionState& session_state, bool retain_values)
     : IExecutionFrame(session_state.GetOrtValueNameIdxMap(), session_state.GetNodeIndexInfo(), fetch_mlvalue_idxs),
       session_state_(session_state),
+      retain_values_(retain_values),
       mem_patterns_(nullptr),
       planner_(nullptr) {
   Init(feed_mlvalue_idxs, feeds, session_state.GetInitializedTensors(), fetches);
-
-  // map the custom allocators to ort_value_idx entries
-  if (!fetch_allocators.empty()) {
-    for (size_t idx = 0, end = fetch_mlvalue_idxs.size(); idx < end; ++idx) {
-      int ort_value_idx = fetch_mlvalue_idxs[idx];
-
-      auto custom_alloc_entry = fetch_allocators.find(idx);
-      if (custom_alloc_entry != fetch_allocators.cend()) {
-        custom_allocators_[ort_value_idx] = custom_alloc_entry->second;
-      }
-    }
-  }
+  SetCustomAllocators(fetch_allocators);
 
   // If the session enable memory pattern optimization
   // and we have execution plan generated, try to setup
   // memory pattern optimization.
-  if (session_state.GetEnableMemoryPattern() && session_state.GetExecutionPlan()) {
+  // the buffers of a memory pattern are shared by values with disjoint lifetimes, so retained values can't use them.
+  if (!retain_values_ && session_state.GetEnableMemoryPattern() && session_state.GetExecutionPlan()) {
     std::vector<std::reference_wrapper<const TensorShape>> input_shapes;
     bool all_tensors = true;
     // Reserve mem to avoid re-allocation.
@@ -303,6 +294,47 @@ ExecutionFrame::ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs, const
 
 ExecutionFrame::~ExecutionFrame() = default;
 
+void ExecutionFrame::Reset(const std::vector<int>& feed_mlvalue_idxs, const std::vector<OrtValue>& feeds,
+                           const std::vector<OrtValue>& fetches,
+                           const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) {
+  ORT_ENFORCE(planner_ == nullptr, "A frame that is tracing allocations for a memory pattern can't be reused.");
+
+  Init(feed_mlvalue_idxs, feeds, session_state_.GetInitializedTensors(), fetches);
+  SetCustomAllocators(fetch_allocators);
+}
+
+void ExecutionFrame::ResetStaleValues(const std::vector<int>& feed_mlvalue_idxs, const std::vector<OrtValue>& feeds,
+                                      const std::vector<int>& stale_value_idxs) {
+  ORT_ENFORCE(retain_values_, "Only a frame that retains its values can be reused with stale values.");
+  ORT_ENFORCE(feeds.size() == feed_mlvalue_idxs.size());
+
+  for (int ort_value_idx : stale_value_idxs) {
+    GetMutableMLValue(ort_value_idx) = OrtValue();
+  }
+
+  for (size_t idx = 0, end = feed_mlvalue_idxs.size(); idx < end; ++idx) {
+    GetMutableMLValue(feed_mlvalue_idxs[idx]) = feeds[idx];
+  }
+}
+
+void ExecutionFrame::SetCustomAllocators(
+    const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) {
+  custom_allocators_.clear();
+
+  // map the custom allocators to ort_value_idx entries
+  if (!fetch_allocators.empty()) {
+    const auto& fetch_mlvalue_idxs = GetFetchMLValueIdxs();
+    for (size_t idx = 0, end = fetch_mlvalue_idxs.size(); idx < end; ++idx) {
+      int ort_value_idx = fetch_mlvalue_idxs[idx];
+
+      auto custom_alloc_entry = fetch_allocators.find(idx);
+      if (custom_alloc_entry != fetch_allocators.cend()) {
+        custom_allocators_[ort_value_idx] = custom_alloc_entry->second;
+      }
+    }
+  }
+}
+
 Status ExecutionFrame::CopyTensor(const Tensor& src, Tensor& dest) const {
   return session_state_.GetDataTransferMgr().CopyTensor(src, dest);
 }
@@ -540,6 +572,13 @@ Status ExecutionFrame::AllocateAsPerAllocationPlan(OrtValue& ort_value, int ort_
         break;
       }
       case AllocKind::kReuse: {
+        // the value whose buffer would be reused is kept for later executions, so it can't be overwritten.
+        if (retain_values_) {
+          ORT_RETURN_IF_ERROR(AllocateMLValueTensorSelfOwnBuffer(ort_value, ort_value_index, ml_data_type, alloc_info,
+                                                                 *shape, per_alloc_plan.create_fence_if_async));
+          break;
+        }
+
         int reuse_mlvalue_index = per_alloc_plan.reused_buffer;
 
         // In case OrtRunOptions.only_execute_path_to_fetches == true, it is possible that 'reuse_value'
@@ -589,6 +628,10 @@ Status ExecutionFrame::CreateNodeOutputMLValueImpl(OrtValue& ort_value, int ort_
 }
 
 Status ExecutionFrame::ReleaseMLValueImpl(int ort_value_idx) {
+  if (retain_values_) {
+    return Status::OK();
+  }
+
   ORT_RETURN_IF_ERROR(IExecutionFrame::ReleaseMLValueImpl(ort_value_idx));
   TraceFree(ort_value_idx);
   return Status::OK();
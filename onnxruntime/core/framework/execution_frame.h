@@ -69,6 +69,9 @@ class IExecutionFrame {
 
   Status ReleaseMLValue(int ort_value_idx);
 
+  // Get the value at ort_value_idx, e.g. a feed. It's not allocated if it hasn't been produced yet.
+  const OrtValue& GetOrtValue(int ort_value_idx) const { return GetMLValue(ort_value_idx); }
+
  protected:
   // get the ort_value_idx from NodeIndexInfo
   int GetNodeIdxToMLValueIdx(int index) const;
@@ -80,6 +83,8 @@ class IExecutionFrame {
   // returns true if the ort_value_idx is an output from the graph
   bool IsOutput(int ort_value_idx) const;
 
+  const std::vector<int>& GetFetchMLValueIdxs() const { return fetch_mlvalue_idxs_; }
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(IExecutionFrame);
 
@@ -113,10 +118,25 @@ class ExecutionFrame final : public IExecutionFrame {
                  const std::vector<int>& fetch_mlvalue_idxs, const std::vector<OrtValue>& fetches,
                  // optional custom allocators. key is index in fetches
                  const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
-                 const SessionState& session_state);
+                 const SessionState& session_state,
+                 // keep all the values after they're used so they are available to later executions.
+                 // no memory pattern is used and values don't reuse the buffers of other values.
+                 bool retain_values = false);
 
   ~ExecutionFrame() override;
 
+  // Prepare the frame to execute the graph again with new feeds and fetches. The buffers allocated for the memory
+  // pattern are kept, so the feeds must have the same shapes as the feeds the frame was created with.
+  // Not valid if the frame has a memory pattern planner, as the patterns it traced are generated after execution.
+  void Reset(const std::vector<int>& feed_mlvalue_idxs, const std::vector<OrtValue>& feeds,
+             const std::vector<OrtValue>& fetches,
+             const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators);
+
+  // Prepare a frame that retains its values to execute the graph again. The values in stale_value_idxs are released
+  // so the nodes producing them can run again, the feeds replace the previous feeds and all other values are kept.
+  void ResetStaleValues(const std::vector<int>& feed_mlvalue_idxs, const std::vector<OrtValue>& feeds,
+                        const std::vector<int>& stale_value_idxs);
+
   // TODO: These two AllocateMLValue... methods are in the API purely for unit test usage.
   // Fix the unit tests so they set an execution plan that results in these methods being called by
   // GetOrCreateNodeOutputMLValue instead
@@ -162,6 +182,8 @@ class ExecutionFrame final : public IExecutionFrame {
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ExecutionFrame);
 
+  void SetCustomAllocators(const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators);
+
   AllocatorPtr GetAllocatorImpl(const OrtMemoryInfo& info) const override;
   Status ReleaseMLValueImpl(int ort_value_idx) override;
   Status CreateNodeOutputMLValueImpl(OrtValue& ort_value, int ort_value_idx, const TensorShape* shape, size_t nnz) override;
@@ -184,6 +206,8 @@ class ExecutionFrame final : public IExecutionFrame {
 
   const SessionState& session_state_;
 
+  const bool retain_values_;
+
   // map of index to custom allocator
   std::unordered_map<int, IExecutor::CustomAllocator> custom_allocators_;
 
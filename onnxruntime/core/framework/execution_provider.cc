@@ -49,6 +49,14 @@ IExecutionProvider::GetCapability(const onnxruntime::GraphViewer& graph,
 #endif
 }
 
+bool IExecutionProvider::GetNodeCostEstimate(const onnxruntime::GraphViewer& graph_viewer,
+                                             const onnxruntime::Node& node, double& cost_us) const {
+  ORT_UNUSED_PARAMETER(graph_viewer);
+  ORT_UNUSED_PARAMETER(node);
+  ORT_UNUSED_PARAMETER(cost_us);
+  return false;
+}
+
 common::Status IExecutionProvider::Sync() const { return Status::OK(); };
 
 common::Status IExecutionProvider::OnRunStart() { return Status::OK(); }
@@ -4,6 +4,7 @@
 #include "core/framework/graph_partitioner.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/graph/function.h"
+#include "core/graph/graph_utils.h"
 #include "core/graph/graph_viewer.h"
 #include "core/framework/compute_capability.h"
 #include "core/framework/kernel_registry_manager.h"
@@ -11,6 +12,13 @@
 #include "core/framework/kernel_registry.h"
 #include "core/framework/func_kernel.h"
 
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <unordered_set>
+
 // uncomment this line to count non-CUDA ops in ONNX domain
 //#define COUNT_NON_CUDA_OPS
 
@@ -50,6 +58,154 @@ KernelDefBuilder& BuildFusedKernelDef(KernelDefBuilder& builder, const onnxrunti
   return builder;
 }
 
+namespace {
+
+size_t ElementSize(const NodeArg& node_arg) {
+  const auto* type = node_arg.TypeAsProto();
+  if (type == nullptr || !type->has_tensor_type()) {
+    return sizeof(float);
+  }
+
+  switch (type->tensor_type().elem_type()) {
+    case ONNX_NAMESPACE::TensorProto_DataType_BOOL:
+    case ONNX_NAMESPACE::TensorProto_DataType_INT8:
+    case ONNX_NAMESPACE::TensorProto_DataType_UINT8:
+      return 1;
+    case ONNX_NAMESPACE::TensorProto_DataType_FLOAT16:
+    case ONNX_NAMESPACE::TensorProto_DataType_BFLOAT16:
+    case ONNX_NAMESPACE::TensorProto_DataType_INT16:
+    case ONNX_NAMESPACE::TensorProto_DataType_UINT16:
+      return 2;
+    case ONNX_NAMESPACE::TensorProto_DataType_DOUBLE:
+    case ONNX_NAMESPACE::TensorProto_DataType_INT64:
+    case ONNX_NAMESPACE::TensorProto_DataType_UINT64:
+      return 8;
+    default:
+      return 4;
+  }
+}
+
+// Symbolic and unknown dims count as 1, so values of unknown shape are assumed to be small.
+int64_t DimValue(const NodeArg& node_arg, int index) {
+  const auto* shape = node_arg.Shape();
+  if (shape == nullptr) {
+    return 1;
+  }
+
+  index = index < 0 ? index + shape->dim_size() : index;
+  if (index < 0 || index >= shape->dim_size()) {
+    return 1;
+  }
+
+  const auto& dim = shape->dim(index);
+  return dim.has_dim_value() && dim.dim_value() > 0 ? dim.dim_value() : 1;
+}
+
+double NumElements(const NodeArg& node_arg) {
+  const auto* shape = node_arg.Shape();
+  double num_elements = 1;
+  for (int i = 0, end = shape != nullptr ? shape->dim_size() : 0; i < end; ++i) {
+    num_elements *= DimValue(node_arg, i);
+  }
+  return num_elements;
+}
+
+double NumBytes(const NodeArg& node_arg) {
+  return NumElements(node_arg) * ElementSize(node_arg);
+}
+
+OrtDevice GetDevice(const IExecutionProvider& provider) {
+  auto allocator = provider.GetAllocator(provider.GetDeviceId() < 0 ? 0 : provider.GetDeviceId(), OrtMemTypeDefault);
+  return allocator != nullptr ? allocator->Info().device : OrtDevice();
+}
+
+// the name of the node in the events of the profiler, see SequentialExecutor::Execute
+std::string ProfiledNodeName(const Node& node) {
+  return node.Name().empty() ? MakeString(node.OpType(), "_", node.Index()) : node.Name();
+}
+
+}  // namespace
+
+constexpr double PartitioningCostModel::kNodeOverheadUs;
+constexpr double PartitioningCostModel::kFusedNodeOverheadUs;
+constexpr double PartitioningCostModel::kCopyOverheadUs;
+constexpr double PartitioningCostModel::kProviderSwitchUs;
+constexpr double PartitioningCostModel::kCopyBytesPerUs;
+constexpr double PartitioningCostModel::kMemoryBytesPerUs;
+constexpr double PartitioningCostModel::kCpuFlopsPerUs;
+constexpr double PartitioningCostModel::kDefaultProviderSpeedup;
+
+void PartitioningCostModel::AddProfiledCost(const std::string& provider_type, const std::string& node_name,
+                                            double cost_us) {
+  profiled_costs_[provider_type][node_name] = cost_us;
+}
+
+double PartitioningCostModel::NodeCost(const GraphViewer& graph_viewer, const Node& node,
+                                       const IExecutionProvider& provider) const {
+  auto provider_costs = profiled_costs_.find(provider.Type());
+  if (provider_costs != profiled_costs_.end()) {
+    auto cost = provider_costs->second.find(ProfiledNodeName(node));
+    if (cost != provider_costs->second.end()) {
+      return cost->second;
+    }
+  }
+
+  double cost_us = 0;
+  if (provider.GetNodeCostEstimate(graph_viewer, node, cost_us)) {
+    return cost_us;
+  }
+
+  cost_us = DefaultNodeCost(node);
+  return provider.Type() == kCpuExecutionProvider ? cost_us : cost_us / kDefaultProviderSpeedup;
+}
+
+double PartitioningCostModel::TransferCost(const NodeArg& node_arg, const IExecutionProvider& from,
+                                           const IExecutionProvider& to) const {
+  if (from.Type() == to.Type()) {
+    return 0;
+  }
+
+  if (GetDevice(from) == GetDevice(to)) {
+    return kProviderSwitchUs;
+  }
+
+  return kCopyOverheadUs + NumBytes(node_arg) / kCopyBytesPerUs;
+}
+
+double PartitioningCostModel::DefaultNodeCost(const Node& node) {
+  double bytes = 0;
+  for (const auto* def : node.InputDefs()) {
+    if (def->Exists()) {
+      bytes += NumBytes(*def);
+    }
+  }
+  for (const auto* def : node.OutputDefs()) {
+    if (def->Exists()) {
+      bytes += NumBytes(*def);
+    }
+  }
+
+  // only the ops dominated by their arithmetic are worth the detail
+  double flops = 0;
+  const auto& inputs = node.InputDefs();
+  const auto& outputs = node.OutputDefs();
+  if (!outputs.empty() && inputs.size() >= 2) {
+    const auto& op_type = node.OpType();
+    if (op_type == "MatMul" || op_type == "FusedMatMul" || op_type == "MatMulInteger") {
+      flops = 2 * NumElements(*outputs[0]) * DimValue(*inputs[0], -1);
+    } else if (op_type == "Gemm") {
+      const auto* trans_a = graph_utils::GetNodeAttribute(node, "transA");
+      const bool transposed = trans_a != nullptr && trans_a->i() != 0;
+      flops = 2 * NumElements(*outputs[0]) * DimValue(*inputs[0], transposed ? 0 : 1);
+    } else if (op_type == "Conv" || op_type == "FusedConv" || op_type == "ConvInteger") {
+      // each output element is a dot product over the channels of its group and the kernel
+      flops = 2 * NumElements(*outputs[0]) * NumElements(*inputs[1]) / DimValue(*inputs[1], 0);
+    }
+  }
+
+  return kNodeOverheadUs + bytes / kMemoryBytesPerUs + flops / kCpuFlopsPerUs;
+}
+
 /**
  * Check if a node can be placed on a specific provider.
  * Do nothing if the node is already assigned
@@ -105,7 +261,169 @@ static Node* PlaceNode(Graph& graph, std::unique_ptr<IndexedSubGraph> capability
   return nullptr;
 }
 
-Status GraphPartitioner::Partition(Graph& graph, bool export_dll, FuncManager& func_mgr) const {
+void GraphPartitioner::DeclineCostlyCapabilities(const GraphViewer& graph_viewer, const IExecutionProvider& provider,
+                                                 const IExecutionProvider& cpu_provider,
+                                                 std::vector<std::unique_ptr<ComputeCapability>>& capabilities,
+                                                 std::unordered_map<NodeIndex, PartitioningDecision>* decisions) const {
+  auto is_available = [&graph_viewer](NodeIndex node_index) {
+    const auto* node = graph_viewer.GetNode(node_index);
+    return node != nullptr && node->GetExecutionProviderType().empty();
+  };
+
+  // union-find over the capabilities to group the connected single node capabilities
+  std::vector<size_t> parents(capabilities.size());
+  std::iota(parents.begin(), parents.end(), size_t{0});
+  auto find_root = [&parents](size_t i) {
+    while (parents[i] != i) {
+      parents[i] = parents[parents[i]];
+      i = parents[i];
+    }
+    return i;
+  };
+
+  std::unordered_map<NodeIndex, size_t> single_node_capabilities;
+  for (size_t i = 0; i < capabilities.size(); ++i) {
+    const auto* sub_graph = capabilities[i]->sub_graph.get();
+    if (sub_graph != nullptr && sub_graph->GetMetaDef() == nullptr && is_available(sub_graph->nodes[0])) {
+      single_node_capabilities.emplace(sub_graph->nodes[0], i);
+    }
+  }
+
+  for (const auto& entry : single_node_capabilities) {
+    const auto* node = graph_viewer.GetNode(entry.first);
+    for (auto it = node->OutputNodesBegin(), end = node->OutputNodesEnd(); it != end; ++it) {
+      auto consumer = single_node_capabilities.find(it->Index());
+      if (consumer != single_node_capabilities.end()) {
+        parents[find_root(consumer->second)] = find_root(entry.second);
+      }
+    }
+  }
+
+  std::unordered_map<size_t, std::vector<size_t>> groups;
+  for (size_t i = 0; i < capabilities.size(); ++i) {
+    const auto* sub_graph = capabilities[i]->sub_graph.get();
+    if (sub_graph == nullptr) {
+      continue;
+    }
+
+    if (sub_graph->GetMetaDef() != nullptr) {
+      // PlaceNode ignores the fused sub-graphs that overlap an assigned node
+      if (std::all_of(sub_graph->nodes.cbegin(), sub_graph->nodes.cend(), is_available)) {
+        groups[i].push_back(i);
+      }
+    } else if (single_node_capabilities.count(sub_graph->nodes[0]) != 0) {
+      groups[find_root(i)].push_back(i);
+    }
+  }
+
+  std::unordered_set<const NodeArg*> graph_outputs(graph_viewer.GetOutputs().cbegin(),
+                                                   graph_viewer.GetOutputs().cend());
+  const auto& initializers = graph_viewer.GetAllInitializedTensors();
+  std::vector<bool> declined(capabilities.size(), false);
+
+  for (const auto& group : groups) {
+    std::unordered_set<NodeIndex> nodes;
+    bool fused = false;
+    for (auto i : group.second) {
+      const auto& sub_graph = *capabilities[i]->sub_graph;
+      nodes.insert(sub_graph.nodes.cbegin(), sub_graph.nodes.cend());
+      fused = fused || sub_graph.GetMetaDef() != nullptr;
+    }
+
+    // The nodes outside of the group are assumed to run on the CPU execution provider, which is where they go if
+    // nobody else claims them. Initializers are copied once when the session is initialized so they are free.
+    std::unordered_set<const NodeArg*> boundary_inputs;
+    std::unordered_set<const NodeArg*> boundary_outputs;
+    double provider_cost = fused ? PartitioningCostModel::kFusedNodeOverheadUs : 0;
+    double cpu_cost = 0;
+    for (auto node_index : nodes) {
+      const auto& node = *graph_viewer.GetNode(node_index);
+      provider_cost += cost_model_->NodeCost(graph_viewer, node, provider);
+      cpu_cost += cost_model_->NodeCost(graph_viewer, node, cpu_provider);
+
+      auto add_boundary_input = [&](const NodeArg* def) {
+        if (!def->Exists() || initializers.count(def->Name()) != 0) {
+          return;
+        }
+        const auto* producer = graph_viewer.GetProducerNode(def->Name());
+        if (producer == nullptr || nodes.count(producer->Index()) == 0) {
+          boundary_inputs.insert(def);
+        }
+      };
+      std::for_each(node.InputDefs().cbegin(), node.InputDefs().cend(), add_boundary_input);
+      std::for_each(node.ImplicitInputDefs().cbegin(), node.ImplicitInputDefs().cend(), add_boundary_input);
+
+      for (const auto* def : node.OutputDefs()) {
+        if (!def->Exists()) {
+          continue;
+        }
+        const auto consumers = graph_viewer.GetConsumerNodes(def->Name());
+        if (graph_outputs.count(def) != 0 ||
+            std::any_of(consumers.cbegin(), consumers.cend(),
+                        [&nodes](const Node* consumer) { return nodes.count(consumer->Index()) == 0; })) {
+          boundary_outputs.insert(def);
+        }
+      }
+    }
+
+    double boundary_cost = 0;
+    for (const auto* def : boundary_inputs) {
+      boundary_cost += cost_model_->TransferCost(*def, cpu_provider, provider);
+    }
+    for (const auto* def : boundary_outputs) {
+      boundary_cost += cost_model_->TransferCost(*def, provider, cpu_provider);
+    }
+    provider_cost += boundary_cost;
+
+    // a group is only declined if the CPU execution provider can take all of its nodes, as otherwise the nodes
+    // that only provider can run would be left unassigned
+    const bool has_fallback = std::all_of(nodes.cbegin(), nodes.cend(), [&](NodeIndex node_index) {
+      return KernelRegistryManager::HasImplementationOf(kernel_registry_mgr_, *graph_viewer.GetNode(node_index),
+                                                        kCpuExecutionProvider);
+    });
+    const bool accepted = provider_cost < cpu_cost || !has_fallback;
+    if (!accepted) {
+      for (auto i : group.second) {
+        declined[i] = true;
+      }
+    }
+
+    if (decisions == nullptr) {
+      continue;
+    }
+
+    std::ostringstream reason;
+    reason << (accepted ? "claimed by " : "declined by ") << provider.Type() << " with " << nodes.size()
+           << " node(s) estimated at " << provider_cost << "us, including " << boundary_cost << "us for "
+           << boundary_inputs.size() + boundary_outputs.size() << " value(s) crossing the partition boundary, vs "
+           << cpu_cost << "us on " << cpu_provider.Type();
+    if (!has_fallback) {
+      reason << ", and kept as " << cpu_provider.Type() << " has no kernel for some of them";
+    }
+
+    for (auto node_index : nodes) {
+      auto& decision = (*decisions)[node_index];
+      if (!decision.reason.empty()) {
+        decision.reason += "; ";
+      }
+      decision.reason += reason.str();
+      if (accepted) {
+        decision.provider = provider.Type();
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<ComputeCapability>> accepted_capabilities;
+  for (size_t i = 0; i < capabilities.size(); ++i) {
+    if (!declined[i]) {
+      accepted_capabilities.push_back(std::move(capabilities[i]));
+    }
+  }
+  capabilities = std::move(accepted_capabilities);
+}
+
+Status GraphPartitioner::Partition(Graph& graph, bool export_dll, FuncManager& func_mgr,
+                                   std::vector<PartitioningDecision>* report) const {
   // It is a greedy partitioning algorithm per provider preferences user provided when calling ONNX RUNTIME right now.
   // 1. Execution providers' capabilities are checked one by one.
   // 2. All sub-graphs that an execution provider returns will be assigned to it if it's not assigned yet.
@@ -114,6 +432,8 @@ Status GraphPartitioner::Partition(Graph& graph, bool export_dll, FuncManager& f
   //          but are completely separate Graph instances and not a subset of nodes within a single Graph instance.
   // 3. CPU execution provider is expected to be able to run any node and is the last one in execution provider
   //    preference.
+  // With a cost model, step 2 first declines the sub-graphs that are not estimated to be faster than on the CPU
+  // execution provider, leaving them to the providers that come later in the preference order.
   if (providers_.Empty()) {
     return Status(ONNXRUNTIME, INVALID_ARGUMENT, "No provider specified.");
   }
@@ -128,7 +448,7 @@ Status GraphPartitioner::Partition(Graph& graph, bool export_dll, FuncManager& f
     for (auto& entry : node.GetAttributeNameToMutableSubgraphMap()) {
       Graph* subgraph = entry.second;
       // we pass through the export_dll value and FuncManager from the top level graph
-      ORT_RETURN_IF_ERROR(Partition(*subgraph, export_dll, func_mgr));
+      ORT_RETURN_IF_ERROR(Partition(*subgraph, export_dll, func_mgr, report));
     }
   }
 
@@ -148,16 +468,62 @@ Status GraphPartitioner::Partition(Graph& graph, bool export_dll, FuncManager& f
   // TODO: when the graph contain a function node, and user pass in the dll which could
   // run the function by SessionOption, we should create a function kernel for it and
   // delegate the compute to the functions inside the dlls.
+  const IExecutionProvider* cpu_provider = providers_.Get(kCpuExecutionProvider);
+  const bool is_cost_based = cost_model_ != nullptr && cpu_provider != nullptr;
+
+  // the decisions for the nodes that are not assigned yet
+  std::unordered_map<NodeIndex, PartitioningDecision> decisions;
+  if (report != nullptr && cost_model_ != nullptr) {
+    for (const auto& node : graph.Nodes()) {
+      if (node.GetExecutionProviderType().empty()) {
+        auto& decision = decisions[node.Index()];
+        decision.node_name = node.Name();
+        decision.op_type = node.OpType();
+      }
+    }
+  }
+
   for (auto& provider : providers_) {
     int count = 0;
     std::vector<Node*> nodes_need_compile;
     std::vector<std::unique_ptr<ComputeCapability>> capabilities =
         provider->GetCapability(graph_viewer, kernel_registry_mgr_.GetKernelRegistriesByProviderType(provider->Type()));
+    const bool is_evaluated = is_cost_based && provider->Type() != kCpuExecutionProvider;
+    if (is_evaluated) {
+      DeclineCostlyCapabilities(graph_viewer, *provider, *cpu_provider, capabilities,
+                                report != nullptr ? &decisions : nullptr);
+    }
+
     for (auto& capability : capabilities) {
+      std::vector<NodeIndex> capability_nodes;
+      if (!decisions.empty() && capability->sub_graph != nullptr) {
+        capability_nodes = capability->sub_graph->nodes;
+      }
+
       Node* n = PlaceNode(graph, std::move(capability->sub_graph), kernel_registry_mgr_, provider->Type(), count);
       if (n != nullptr) {
         nodes_need_compile.push_back(n);
       }
+
+      for (auto node_index : capability_nodes) {
+        auto decision = decisions.find(node_index);
+        if (decision == decisions.end() || !decision->second.provider.empty()) {
+          continue;
+        }
+
+        // a node that no longer exists was fused into the sub-graph
+        const auto* node = graph.GetNode(node_index);
+        if (node == nullptr || node->GetExecutionProviderType() == provider->Type()) {
+          decision->second.provider = provider->Type();
+          if (!is_evaluated) {
+            if (!decision->second.reason.empty()) {
+              decision->second.reason += "; ";
+            }
+            decision->second.reason += "claimed by " + provider->Type() +
+                                       ", the first execution provider in order of preference that can run it";
+          }
+        }
+      }
     }
 
     if (!nodes_need_compile.empty()) {
@@ -207,10 +573,29 @@ Status GraphPartitioner::Partition(Graph& graph, bool export_dll, FuncManager& f
     ORT_RETURN_IF_ERROR(graph.InlineFunction(*node));
   }
 
+  if (report != nullptr && !decisions.empty()) {
+    std::map<NodeIndex, PartitioningDecision> ordered_decisions(std::make_move_iterator(decisions.begin()),
+                                                                std::make_move_iterator(decisions.end()));
+    for (auto& entry : ordered_decisions) {
+      auto& decision = entry.second;
+      if (decision.provider.empty()) {
+        // the nodes left behind are reported by the rerun after inlining
+        if (!nodes_need_inline.empty()) {
+          continue;
+        }
+        if (!decision.reason.empty()) {
+          decision.reason += "; ";
+        }
+        decision.reason += "not claimed by any execution provider";
+      }
+      report->push_back(std::move(decision));
+    }
+  }
+
   // Resolve and rerun graph partition
   if (!nodes_need_inline.empty()) {
     ORT_RETURN_IF_ERROR(graph.Resolve());
-    ORT_RETURN_IF_ERROR(Partition(graph, export_dll, func_mgr));
+    ORT_RETURN_IF_ERROR(Partition(graph, export_dll, func_mgr, report));
   }
 
   //For some cases, like fp16 on cpu, right now we don't have any kernel support that.
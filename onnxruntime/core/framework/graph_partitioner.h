@@ -8,11 +8,62 @@
 #include "core/framework/op_kernel.h"
 #include "core/framework/fuse_nodes_funcs.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace onnxruntime {
 
 class ExecutionProviders;
+struct ComputeCapability;
+class IExecutionProvider;
 class KernelRegistryManager;
 
+// Why a node was placed where it was by the cost based partitioning.
+struct PartitioningDecision {
+  std::string node_name;
+  std::string op_type;
+  // the provider the node was assigned to, empty if none
+  std::string provider;
+  std::string reason;
+};
+
+// Estimates the latency of the nodes of a graph on the registered execution providers.
+// The cost of a node comes, in order of preference, from a profile of a previous run, from the execution provider
+// (see IExecutionProvider::GetNodeCostEstimate), or from a rough roofline estimate based on the shapes of the node.
+// All the costs are in microseconds.
+class PartitioningCostModel {
+ public:
+  // Fixed cost of running a node, e.g. the kernel launch and the allocation of its outputs.
+  static constexpr double kNodeOverheadUs = 2.0;
+  // Fixed cost of a node fused by an execution provider.
+  static constexpr double kFusedNodeOverheadUs = 10.0;
+  // Fixed cost of every copy between devices.
+  static constexpr double kCopyOverheadUs = 10.0;
+  // Cost of a value crossing between 2 execution providers on the same device, e.g. to convert the memory layout.
+  static constexpr double kProviderSwitchUs = 2.0;
+  static constexpr double kCopyBytesPerUs = 8.0 * 1024;
+  static constexpr double kMemoryBytesPerUs = 16.0 * 1024;
+  static constexpr double kCpuFlopsPerUs = 50.0 * 1000;
+  // How much faster than the CPU execution provider the other execution providers are assumed to be when neither a
+  // profile nor the execution provider has an estimate.
+  static constexpr double kDefaultProviderSpeedup = 2.0;
+
+  void AddProfiledCost(const std::string& provider_type, const std::string& node_name, double cost_us);
+
+  double NodeCost(const GraphViewer& graph_viewer, const Node& node, const IExecutionProvider& provider) const;
+
+  // Cost of moving the value of node_arg from the device and execution provider it was produced on to another one.
+  double TransferCost(const NodeArg& node_arg, const IExecutionProvider& from, const IExecutionProvider& to) const;
+
+  // Shape based estimate of the latency of the node on the CPU execution provider.
+  static double DefaultNodeCost(const Node& node);
+
+ private:
+  // provider type -> node name -> cost
+  std::unordered_map<std::string, std::unordered_map<std::string, double>> profiled_costs_;
+};
+
 class GraphPartitioner {
  public:
   //The order of providers represents the user preference.
@@ -20,12 +71,34 @@ class GraphPartitioner {
       : kernel_registry_mgr_(kernel_registry_mgr),
         providers_(providers) {}
 
-  Status Partition(Graph& graph, bool export_dll, FuncManager& func_mgr) const;
+  // With a cost model the capabilities of the execution providers other than the CPU execution provider are only
+  // taken if they are estimated to be faster than the CPU execution provider once the cost of copying the values
+  // that cross the partition boundaries is counted. The providers are still asked in the order of preference.
+  GraphPartitioner(KernelRegistryManager& kernel_registry_mgr, const ExecutionProviders& providers,
+                   const PartitioningCostModel* cost_model)
+      : kernel_registry_mgr_(kernel_registry_mgr),
+        providers_(providers),
+        cost_model_(cost_model) {}
+
+  // If report is not null and there is a cost model, it's filled with a decision for each node of the graph and
+  // its subgraphs.
+  Status Partition(Graph& graph, bool export_dll, FuncManager& func_mgr,
+                   std::vector<PartitioningDecision>* report = nullptr) const;
 
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(GraphPartitioner);
 
+  // Removes the capabilities of provider that are not estimated to be faster than cpu_provider, if cpu_provider
+  // has kernels for all their nodes. The single node capabilities are evaluated together per connected group,
+  // so an edge between 2 nodes of a group is free and small islands of the provider are declined in favor of
+  // larger ones. If decisions is not null, the evaluation is recorded in the decision of each node.
+  void DeclineCostlyCapabilities(const GraphViewer& graph_viewer, const IExecutionProvider& provider,
+                                 const IExecutionProvider& cpu_provider,
+                                 std::vector<std::unique_ptr<ComputeCapability>>& capabilities,
+                                 std::unordered_map<NodeIndex, PartitioningDecision>* decisions) const;
+
   KernelRegistryManager& kernel_registry_mgr_;
   const ExecutionProviders& providers_;
+  const PartitioningCostModel* cost_model_ = nullptr;
 };
 }  // namespace onnxruntime
@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/incremental_execution_context.h"
+
+#include <algorithm>
+
+#include "core/framework/execution_frame.h"
+#include "core/framework/feeds_fetches_manager.h"
+#include "core/framework/sequential_executor.h"
+#include "core/framework/session_state.h"
+#include "core/framework/utils.h"
+
+namespace onnxruntime {
+
+Status IncrementalExecutionContext::Create(const SessionState& session_state,
+                                           const std::vector<std::string>& feed_names,
+                                           const std::vector<std::string>& output_names,
+                                           std::unique_ptr<IncrementalExecutionContext>& context) {
+  context.reset();
+
+  std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager;
+  ORT_RETURN_IF_ERROR(FeedsFetchesManager::Create(feed_names, output_names, session_state.GetOrtValueNameIdxMap(),
+                                                  feeds_fetches_manager));
+  ORT_RETURN_IF_ERROR(utils::InitializeFeedFetchCopyInfo(session_state, *feeds_fetches_manager));
+
+  context.reset(new IncrementalExecutionContext(session_state, std::move(feeds_fetches_manager)));
+  return Status::OK();
+}
+
+IncrementalExecutionContext::IncrementalExecutionContext(const SessionState& session_state,
+                                                         std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager)
+    : session_state_(session_state),
+      feeds_fetches_manager_(std::move(feeds_fetches_manager)) {
+}
+
+IncrementalExecutionContext::~IncrementalExecutionContext() = default;
+
+bool IncrementalExecutionContext::Matches(const std::vector<std::string>& feed_names,
+                                          const std::vector<std::string>& output_names) const {
+  const auto& feeds_fetches_info = feeds_fetches_manager_->GetFeedsFetchesInfo();
+  return feeds_fetches_info.feed_names == feed_names && feeds_fetches_info.output_names == output_names;
+}
+
+Status IncrementalExecutionContext::SelectNodesToExecute(const std::vector<OrtValue>& feeds,
+                                                         const std::vector<std::string>& changed_feed_names,
+                                                         std::vector<int>& stale_values) {
+  const auto& feeds_fetches_info = feeds_fetches_manager_->GetFeedsFetchesInfo();
+  const auto& feed_names = feeds_fetches_info.feed_names;
+  const auto& feed_idxs = feeds_fetches_info.feeds_mlvalue_idxs;
+  const auto& ort_value_name_idx_map = session_state_.GetOrtValueNameIdxMap();
+  const auto& graph_viewer = session_state_.GetGraphViewer();
+  const auto& execution_plan = session_state_.GetExecutionPlan()->execution_plan;
+
+  nodes_to_execute_.clear();
+  stale_values.clear();
+
+  if (!frame_) {
+    for (const auto& node_exec_plan : execution_plan) {
+      nodes_to_execute_.insert(node_exec_plan.node_index);
+    }
+
+    return Status::OK();
+  }
+
+  std::unordered_set<int> stale_value_set;
+  for (const auto& name : changed_feed_names) {
+    auto entry = std::find(feed_names.cbegin(), feed_names.cend(), name);
+    if (entry == feed_names.cend()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Changed feed '", name, "' is not one of the feeds.");
+    }
+
+    stale_value_set.insert(feed_idxs[entry - feed_names.cbegin()]);
+  }
+
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+    const OrtValue& feed = feeds[i];
+    const OrtValue& previous_feed = frame_->GetOrtValue(feed_idxs[i]);
+    if (feed.Type() != previous_feed.Type() ||
+        (feed.IsTensor() && feed.Get<Tensor>().Shape() != previous_feed.Get<Tensor>().Shape())) {
+      stale_value_set.insert(feed_idxs[i]);
+    }
+  }
+
+  auto is_stale = [&](const NodeArg* def) {
+    int ort_value_idx = -1;
+    return def->Exists() && ort_value_name_idx_map.GetIdx(def->Name(), ort_value_idx).IsOK() &&
+           stale_value_set.count(ort_value_idx) != 0;
+  };
+
+  // the execution plan is in topological order, so the outputs of a node are marked stale before they're consumed.
+  for (const auto& node_exec_plan : execution_plan) {
+    const auto& node = *graph_viewer.GetNode(node_exec_plan.node_index);
+    const auto& input_defs = node.InputDefs();
+    const auto& implicit_input_defs = node.ImplicitInputDefs();
+    if (std::none_of(input_defs.begin(), input_defs.end(), is_stale) &&
+        std::none_of(implicit_input_defs.begin(), implicit_input_defs.end(), is_stale)) {
+      continue;
+    }
+
+    nodes_to_execute_.insert(node_exec_plan.node_index);
+    for (const auto* def : node.OutputDefs()) {
+      if (!def->Exists()) {
+        continue;
+      }
+
+      int ort_value_idx = -1;
+      ORT_RETURN_IF_ERROR(ort_value_name_idx_map.GetIdx(def->Name(), ort_value_idx));
+      stale_value_set.insert(ort_value_idx);
+      stale_values.push_back(ort_value_idx);
+    }
+  }
+
+  return Status::OK();
+}
+
+Status IncrementalExecutionContext::Execute(const std::vector<OrtValue>& feeds,
+                                            const std::vector<std::string>& changed_feed_names,
+                                            std::vector<OrtValue>& fetches, const bool& terminate_flag,
+                                            const logging::Logger& logger) {
+  const auto& feeds_fetches_info = feeds_fetches_manager_->GetFeedsFetchesInfo();
+  if (feeds.size() != feeds_fetches_info.feeds_mlvalue_idxs.size()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Expected ", feeds_fetches_info.feeds_mlvalue_idxs.size(),
+                           " feeds but got ", feeds.size());
+  }
+
+  if (!fetches.empty()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "The fetches of an incremental execution are produced by it and must be empty.");
+  }
+
+  // the values are kept where the graph produces them, so the feeds and fetches must not need copying.
+  std::vector<OrtDevice> feed_locations(feeds.size());
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+    if (feeds[i].IsTensor()) {
+      feed_locations[i] = feeds[i].Get<Tensor>().Location().device;
+    }
+  }
+
+  std::vector<const OrtMemoryInfo*> fetch_alloc_info(feeds_fetches_info.output_names.size(), nullptr);
+  utils::FinalizeFeedFetchCopyInfo(*feeds_fetches_manager_, feed_locations, fetch_alloc_info);
+  if (feeds_fetches_manager_->GetDeviceCopyChecks().status != DeviceCopyCheck::NoCopy) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                           "Incremental execution requires feeds and fetches that don't need copying between devices.");
+  }
+
+  std::vector<int> stale_values;
+  ORT_RETURN_IF_ERROR(SelectNodesToExecute(feeds, changed_feed_names, stale_values));
+  VLOGS(logger, 1) << "Incremental execution of " << nodes_to_execute_.size() << " nodes";
+
+  if (frame_) {
+    frame_->ResetStaleValues(feeds_fetches_info.feeds_mlvalue_idxs, feeds, stale_values);
+  } else {
+    const std::unordered_map<size_t, IExecutor::CustomAllocator> fetch_allocators;
+    frame_ = onnxruntime::make_unique<ExecutionFrame>(feeds_fetches_info.feeds_mlvalue_idxs, feeds,
+                                                      feeds_fetches_info.fetches_mlvalue_idxs, fetches,
+                                                      fetch_allocators, session_state_, true);
+  }
+
+  SequentialExecutor executor(terminate_flag);
+  auto status = executor.Execute(session_state_, *frame_, feeds, feeds_fetches_info.fetches_mlvalue_idxs, fetches,
+                                 logger, &nodes_to_execute_);
+
+  if (!status.IsOK()) {
+    // the frame may be missing values the nodes that did run would have produced, so the next execution starts over.
+    frame_.reset();
+  }
+
+  return status;
+}
+
+}  // namespace onnxruntime
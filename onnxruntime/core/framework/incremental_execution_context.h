@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/framework/ml_value.h"
+#include "core/graph/basic_types.h"
+
+namespace onnxruntime {
+
+class ExecutionFrame;
+class FeedsFetchesManager;
+class SessionState;
+
+namespace logging {
+class Logger;
+}
+
+/**
+Executes the main graph repeatedly with feeds that only partially change between executions, e.g. when one input
+is changed at a time for interactive use or feature ablation.
+
+The values produced by an execution are kept in an ExecutionFrame. The next execution only runs the nodes that
+consume a changed feed, directly or through the outputs of other nodes that run, and the values produced by all
+other nodes are reused without copying.
+
+As any value may be kept for the next execution, the frame doesn't use memory patterns and values don't reuse the
+buffers of other values, so an incremental execution needs more memory than a normal one. A node that doesn't
+consume a changed value isn't run again, so e.g. the output of a random generator with no inputs stays the same.
+*/
+class IncrementalExecutionContext {
+ public:
+  static common::Status Create(const SessionState& session_state, const std::vector<std::string>& feed_names,
+                               const std::vector<std::string>& output_names,
+                               std::unique_ptr<IncrementalExecutionContext>& context);
+
+  ~IncrementalExecutionContext();
+
+  // Returns true if the context executes the graph with these feeds and outputs.
+  bool Matches(const std::vector<std::string>& feed_names, const std::vector<std::string>& output_names) const;
+
+  // changed_feed_names are the feeds whose contents changed since the previous execution. A feed with a different
+  // type or shape than in the previous execution is treated as changed as well. The first execution, and the one
+  // after a failed execution, runs all the nodes.
+  // The fetches are produced by the execution, so must be empty.
+  common::Status Execute(const std::vector<OrtValue>& feeds, const std::vector<std::string>& changed_feed_names,
+                         std::vector<OrtValue>& fetches, const bool& terminate_flag, const logging::Logger& logger);
+
+  // Number of nodes run by the last execution.
+  size_t NumExecutedNodes() const { return nodes_to_execute_.size(); }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(IncrementalExecutionContext);
+
+  IncrementalExecutionContext(const SessionState& session_state,
+                              std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager);
+
+  // Selects the nodes to run into nodes_to_execute_ and the values they produce into stale_values.
+  common::Status SelectNodesToExecute(const std::vector<OrtValue>& feeds,
+                                      const std::vector<std::string>& changed_feed_names,
+                                      std::vector<int>& stale_values);
+
+  const SessionState& session_state_;
+  std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager_;
+
+  // holds the values of the previous execution. null before the first execution and after a failed one.
+  std::unique_ptr<ExecutionFrame> frame_;
+
+  std::unordered_set<NodeIndex> nodes_to_execute_;
+};
+
+}  // namespace onnxruntime
@@ -20,6 +20,11 @@ class MemoryPattern {
  public:
   MemoryPattern() = default;
 
+  // create from blocks that were planned previously, e.g. a pattern loaded from an ORT format model
+  MemoryPattern(std::unordered_map<int, MemoryBlock> blocks, size_t peak_size)
+      : patterns_{std::move(blocks)},
+        peak_size_{peak_size} {}
+
   MemoryPattern(MemoryPattern&& rhs) noexcept
       : patterns_{std::move(rhs.patterns_)},
         peak_size_{std::move(rhs.peak_size_)} {}
@@ -42,6 +47,11 @@ class MemoryPattern {
     return &it->second;
   }
 
+  // blocks by OrtValue index
+  const std::unordered_map<int, MemoryBlock>& GetBlocks() const {
+    return patterns_;
+  }
+
  private:
   // allow move
   ORT_DISALLOW_COPY_AND_ASSIGNMENT(MemoryPattern);
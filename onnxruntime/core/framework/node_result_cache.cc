@@ -0,0 +1,332 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/node_result_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <unordered_set>
+
+#include "core/framework/execution_frame.h"
+#include "core/framework/op_kernel.h"
+#include "core/framework/ort_value_name_idx_map.h"
+#include "core/framework/tensor.h"
+#include "core/graph/constants.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+
+namespace {
+
+// ops whose outputs are not a function of their inputs
+const std::unordered_set<std::string> kNonDeterministicOps = {
+    "Dropout", "Multinomial", "RandomNormal", "RandomNormalLike", "RandomUniform", "RandomUniformLike"};
+
+bool IsTensor(const NodeArg& node_arg, bool allow_strings) {
+  const auto* type = node_arg.TypeAsProto();
+  return type != nullptr && type->has_tensor_type() &&
+         (allow_strings || type->tensor_type().elem_type() != ONNX_NAMESPACE::TensorProto_DataType_STRING);
+}
+
+template <typename T>
+void AppendPod(std::string& key, T value) {
+  key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void AppendValue(const OrtValue& value, std::string& key) {
+  // a missing optional input
+  if (!value.IsAllocated() || !value.IsTensor()) {
+    key.push_back('\0');
+    return;
+  }
+
+  const auto& tensor = value.Get<Tensor>();
+  key.push_back('\1');
+  AppendPod(key, tensor.GetElementType());
+  const auto& dims = tensor.Shape().GetDims();
+  AppendPod(key, dims.size());
+  for (auto dim : dims) {
+    AppendPod(key, dim);
+  }
+
+  if (tensor.IsDataTypeString()) {
+    for (const auto& str : tensor.DataAsSpan<std::string>()) {
+      AppendPod(key, str.size());
+      key.append(str);
+    }
+  } else {
+    key.append(static_cast<const char*>(tensor.DataRaw()), tensor.SizeInBytes());
+  }
+}
+
+}  // namespace
+
+constexpr size_t NodeResultCache::kDefaultByteBudget;
+
+Status NodeResultCache::Create(const GraphViewer& graph_viewer, const OrtValueNameIdxMap& ort_value_idx_map,
+                               const std::vector<std::string>& stable_inputs, size_t byte_budget,
+                               AllocatorPtr allocator, std::unique_ptr<NodeResultCache>& cache) {
+  cache.reset();
+  std::unique_ptr<NodeResultCache> result(new NodeResultCache(byte_budget, std::move(allocator)));
+  result->max_node_index_ = static_cast<size_t>(graph_viewer.MaxNodeIndex());
+
+  // value name -> indexes of the stable inputs it depends on, for the values that only depend on stable inputs and
+  // constant initializers.
+  std::unordered_map<std::string, std::vector<size_t>> memoizable_values;
+  const auto& graph_inputs = graph_viewer.GetInputsIncludingInitializers();
+  for (const auto& name : stable_inputs) {
+    auto input = std::find_if(graph_inputs.cbegin(), graph_inputs.cend(),
+                              [&name](const NodeArg* graph_input) { return graph_input->Name() == name; });
+    if (input == graph_inputs.cend() || !IsTensor(**input, true)) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Stable input '", name,
+                             "' for the node result cache is not a tensor input of the graph.");
+    }
+
+    int ort_value_idx = -1;
+    ORT_RETURN_IF_ERROR(ort_value_idx_map.GetIdx(name, ort_value_idx));
+    memoizable_values[name] = {result->stable_input_idxs_.size()};
+    result->stable_input_idxs_.push_back(ort_value_idx);
+  }
+
+  std::unordered_map<NodeIndex, size_t> memoized_node_positions;
+  for (auto node_index : graph_viewer.GetNodesInTopologicalOrder()) {
+    const auto& node = *graph_viewer.GetNode(node_index);
+    if (node.GetExecutionProviderType() != kCpuExecutionProvider || node.ContainsSubgraph() ||
+        kNonDeterministicOps.count(node.OpType()) != 0) {
+      continue;
+    }
+
+    const auto& output_defs = node.OutputDefs();
+    if (!std::all_of(output_defs.cbegin(), output_defs.cend(),
+                     [](const NodeArg* def) { return !def->Exists() || IsTensor(*def, false); })) {
+      continue;
+    }
+
+    bool is_memoizable = true;
+    std::vector<size_t> dependencies;
+    for (const auto* def : node.InputDefs()) {
+      if (!def->Exists() || graph_viewer.IsConstantInitializer(def->Name(), false)) {
+        continue;
+      }
+
+      auto value = memoizable_values.find(def->Name());
+      if (value == memoizable_values.end()) {
+        is_memoizable = false;
+        break;
+      }
+      dependencies.insert(dependencies.end(), value->second.cbegin(), value->second.cend());
+    }
+
+    if (!is_memoizable) {
+      continue;
+    }
+
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    for (const auto* def : output_defs) {
+      if (def->Exists()) {
+        memoizable_values[def->Name()] = dependencies;
+      }
+    }
+
+    memoized_node_positions[node_index] = result->memoized_nodes_.size();
+    MemoizedNode memoized_node;
+    memoized_node.index = node_index;
+    memoized_node.stable_inputs = std::move(dependencies);
+    result->memoized_nodes_.push_back(std::move(memoized_node));
+  }
+
+  if (result->memoized_nodes_.empty()) {
+    return Status::OK();
+  }
+
+  // a memoized node is on the frontier if the rest of the graph consumes one of its outputs
+  auto add_consumer = [&](const NodeArg& def, const Node& consumer) {
+    const auto* producer = graph_viewer.GetProducerNode(def.Name());
+    auto producer_position = producer != nullptr ? memoized_node_positions.find(producer->Index())
+                                                 : memoized_node_positions.end();
+    if (producer_position == memoized_node_positions.end()) {
+      return;
+    }
+
+    auto& memoized_producer = result->memoized_nodes_[producer_position->second];
+    if (memoized_node_positions.count(consumer.Index()) == 0) {
+      memoized_producer.is_frontier = true;
+    } else if (std::find(memoized_producer.consumers.cbegin(), memoized_producer.consumers.cend(),
+                         consumer.Index()) == memoized_producer.consumers.cend()) {
+      memoized_producer.consumers.push_back(consumer.Index());
+    }
+  };
+
+  for (const auto& node : graph_viewer.Nodes()) {
+    for (const auto* def : node.InputDefs()) {
+      if (def->Exists()) {
+        add_consumer(*def, node);
+      }
+    }
+    for (const auto* def : node.ImplicitInputDefs()) {
+      add_consumer(*def, node);
+    }
+  }
+
+  for (const auto* def : graph_viewer.GetOutputs()) {
+    const auto* producer = graph_viewer.GetProducerNode(def->Name());
+    auto producer_position = producer != nullptr ? memoized_node_positions.find(producer->Index())
+                                                 : memoized_node_positions.end();
+    if (producer_position != memoized_node_positions.end()) {
+      result->memoized_nodes_[producer_position->second].is_frontier = true;
+    }
+  }
+
+  cache = std::move(result);
+  return Status::OK();
+}
+
+void NodeResultCache::Plan(const IExecutionFrame& frame, RunPlan& plan) {
+  plan.actions.assign(max_node_index_, NodeAction::kCompute);
+  plan.keys.clear();
+  plan.entries.clear();
+  plan.stats = Stats();
+
+  std::vector<std::string> values(stable_input_idxs_.size());
+  for (size_t i = 0; i < stable_input_idxs_.size(); ++i) {
+    AppendValue(frame.GetOrtValue(stable_input_idxs_[i]), values[i]);
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    for (const auto& memoized_node : memoized_nodes_) {
+      if (!memoized_node.is_frontier) {
+        continue;
+      }
+
+      std::string key;
+      AppendPod(key, memoized_node.index);
+      for (auto i : memoized_node.stable_inputs) {
+        key.append(values[i]);
+      }
+
+      auto entry = index_.find(key);
+      if (entry != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, entry->second);
+        plan.entries[memoized_node.index] = entry->second->second;
+        plan.actions[memoized_node.index] = NodeAction::kRestore;
+        ++plan.stats.hits;
+      } else {
+        plan.keys[memoized_node.index] = std::move(key);
+        plan.actions[memoized_node.index] = NodeAction::kComputeAndStore;
+        ++plan.stats.misses;
+      }
+    }
+
+    stats_.hits += plan.stats.hits;
+    stats_.misses += plan.stats.misses;
+  }
+
+  // the other memoized nodes only run if a node that computes needs their outputs
+  for (auto memoized_node = memoized_nodes_.crbegin(); memoized_node != memoized_nodes_.crend(); ++memoized_node) {
+    if (memoized_node->is_frontier) {
+      continue;
+    }
+
+    const bool is_needed = std::any_of(memoized_node->consumers.cbegin(), memoized_node->consumers.cend(),
+                                       [&plan](NodeIndex consumer) {
+                                         return plan.actions[consumer] == NodeAction::kCompute ||
+                                                plan.actions[consumer] == NodeAction::kComputeAndStore;
+                                       });
+    if (!is_needed) {
+      plan.actions[memoized_node->index] = NodeAction::kSkip;
+      ++plan.stats.skipped_nodes;
+    }
+  }
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  stats_.skipped_nodes += plan.stats.skipped_nodes;
+}
+
+Status NodeResultCache::Restore(const RunPlan& plan, const Node& node, OpKernelContext& context) const {
+  auto entry = plan.entries.find(node.Index());
+  ORT_RETURN_IF(entry == plan.entries.end(), "No cached outputs for node ", node.Name());
+
+  const auto& outputs = entry->second->outputs;
+  for (int i = 0, end = context.OutputCount(); i < end; ++i) {
+    if (static_cast<size_t>(i) >= outputs.size() || !outputs[i].IsAllocated()) {
+      continue;
+    }
+
+    const auto& cached = outputs[i].Get<Tensor>();
+    auto* output = context.Output(i, cached.Shape());
+    ORT_RETURN_IF(output == nullptr, "Failed to allocate output ", i, " of node ", node.Name());
+    if (cached.SizeInBytes() > 0) {
+      memcpy(output->MutableDataRaw(), cached.DataRaw(), cached.SizeInBytes());
+    }
+  }
+
+  return Status::OK();
+}
+
+void NodeResultCache::Store(const RunPlan& plan, const Node& node, OpKernelContext& context) {
+  auto key = plan.keys.find(node.Index());
+  if (key == plan.keys.end()) {
+    return;
+  }
+
+  auto entry = std::make_shared<Entry>();
+  // the key is held by both the LRU list and the index
+  entry->num_bytes = 2 * key->second.size();
+  const auto& output_defs = node.OutputDefs();
+  entry->outputs.resize(output_defs.size());
+  for (int i = 0, end = context.OutputCount(); i < end; ++i) {
+    const auto* tensor = output_defs[i]->Exists() ? context.Output<Tensor>(i) : nullptr;
+    if (tensor == nullptr) {
+      continue;
+    }
+
+    auto copy = onnxruntime::make_unique<Tensor>(tensor->DataType(), tensor->Shape(), allocator_);
+    if (tensor->SizeInBytes() > 0) {
+      memcpy(copy->MutableDataRaw(), tensor->DataRaw(), tensor->SizeInBytes());
+    }
+    entry->num_bytes += copy->SizeInBytes();
+    auto ml_tensor = DataTypeImpl::GetType<Tensor>();
+    entry->outputs[i].Init(copy.release(), ml_tensor, ml_tensor->GetDeleteFunc());
+  }
+
+  if (entry->num_bytes > byte_budget_) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<const Entry>> evicted;
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    // a concurrent run may have stored the same outputs already
+    if (index_.count(key->second) != 0) {
+      return;
+    }
+
+    lru_.emplace_front(key->second, std::move(entry));
+    index_.emplace(key->second, lru_.begin());
+    stats_.num_bytes += lru_.front().second->num_bytes;
+    EvictToBudget(evicted);
+  }
+}
+
+NodeResultCache::Stats NodeResultCache::GetStats() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.num_entries = lru_.size();
+  return stats;
+}
+
+void NodeResultCache::EvictToBudget(std::vector<std::shared_ptr<const Entry>>& evicted) {
+  while (stats_.num_bytes > byte_budget_) {
+    auto last = std::prev(lru_.end());
+    stats_.num_bytes -= last->second->num_bytes;
+    index_.erase(last->first);
+    evicted.push_back(std::move(last->second));
+    lru_.erase(last);
+    ++stats_.evictions;
+  }
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ml_value.h"
+#include "core/graph/basic_types.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+class GraphViewer;
+class IExecutionFrame;
+class Node;
+class OpKernelContext;
+class OrtValueNameIdxMap;
+
+/**
+Caches the outputs of the nodes of a graph that only depend on slowly changing graph inputs ("stable inputs") and
+on constant initializers, so the runs that feed the same values for those inputs skip the nodes.
+
+The memoized nodes are inferred from the stable inputs. Only the outputs of the memoized nodes that are consumed by
+the rest of the graph (the "frontier") are cached, keyed by the values of the stable inputs they depend on.
+In a run where all the frontier nodes downstream of a memoized node hit the cache, the node is not run at all.
+
+Only the deterministic nodes assigned to the CPU execution provider, without subgraphs and with tensor outputs
+other than strings are memoized. The cache is a LRU bounded by a byte budget, in memory from the given allocator.
+Plan, Store and GetStats may be called concurrently.
+*/
+class NodeResultCache {
+ public:
+  static constexpr size_t kDefaultByteBudget = 64 * 1024 * 1024;
+
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    // memoized nodes that were not run because nothing needed their outputs
+    size_t skipped_nodes = 0;
+    size_t num_entries = 0;
+    size_t num_bytes = 0;
+  };
+
+  enum class NodeAction : uint8_t {
+    kCompute,
+    // compute a frontier node that missed the cache, then Store its outputs
+    kComputeAndStore,
+    // Restore the outputs of a frontier node that hit the cache instead of computing it
+    kRestore,
+    kSkip,
+  };
+
+  struct Entry {
+    // aligned with the output defs of the node, a missing optional output is not allocated
+    std::vector<OrtValue> outputs;
+    size_t num_bytes = 0;
+  };
+
+  // The actions for the nodes of one run.
+  struct RunPlan {
+    // indexed by NodeIndex
+    std::vector<NodeAction> actions;
+    std::unordered_map<NodeIndex, std::string> keys;
+    std::unordered_map<NodeIndex, std::shared_ptr<const Entry>> entries;
+    Stats stats;
+  };
+
+  // Fails if a stable input is not a tensor input of the graph. cache is null if no node can be memoized.
+  static Status Create(const GraphViewer& graph_viewer, const OrtValueNameIdxMap& ort_value_idx_map,
+                       const std::vector<std::string>& stable_inputs, size_t byte_budget, AllocatorPtr allocator,
+                       std::unique_ptr<NodeResultCache>& cache);
+
+  size_t NumMemoizedNodes() const noexcept { return memoized_nodes_.size(); }
+
+  // Looks up the frontier nodes for the values of the stable inputs in frame, which must hold the feeds of the run.
+  void Plan(const IExecutionFrame& frame, RunPlan& plan);
+
+  // Writes the cached outputs of a node planned as kRestore to context.
+  Status Restore(const RunPlan& plan, const Node& node, OpKernelContext& context) const;
+
+  // Caches the outputs of a node planned as kComputeAndStore after it's computed.
+  void Store(const RunPlan& plan, const Node& node, OpKernelContext& context);
+
+  Stats GetStats() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(NodeResultCache);
+
+  struct MemoizedNode {
+    NodeIndex index;
+    bool is_frontier = false;
+    // indexes in stable_input_idxs_ of the stable inputs the node depends on, sorted
+    std::vector<size_t> stable_inputs;
+    // the memoized nodes consuming the outputs of the node
+    std::vector<NodeIndex> consumers;
+  };
+
+  using LruList = std::list<std::pair<std::string, std::shared_ptr<const Entry>>>;
+
+  NodeResultCache(size_t byte_budget, AllocatorPtr allocator)
+      : byte_budget_(byte_budget), allocator_(std::move(allocator)) {}
+
+  // Moves the least recently used entries out of the cache until it's within the budget. mutex_ must be held.
+  // The entries are destroyed by the caller after releasing it.
+  void EvictToBudget(std::vector<std::shared_ptr<const Entry>>& evicted);
+
+  const size_t byte_budget_;
+  const AllocatorPtr allocator_;
+  size_t max_node_index_ = 0;
+  std::vector<int> stable_input_idxs_;
+  // in topological order
+  std::vector<MemoizedNode> memoized_nodes_;
+
+  mutable OrtMutex mutex_;
+  // most recently used first
+  LruList lru_;
+  std::unordered_map<std::string, LruList::iterator> index_;
+  Stats stats_;
+};
+
+}  // namespace onnxruntime
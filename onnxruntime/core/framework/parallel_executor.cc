@@ -13,6 +13,7 @@
 #include "core/framework/execution_frame.h"
 #include "core/framework/session_state.h"
 #include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/tensor_statistics_collector.h"
 #include "core/framework/utils.h"
 #include "core/platform/threadpool.h"
 
@@ -131,6 +132,12 @@ Status ParallelExecutor::RunNodeAsync(size_t p_node_index,
       ORT_THROW("Exiting due to terminate flag being set to true.");
     }
 
+    // The scheduling hint of the run is carried to the inter-op threads executing its nodes.
+    if (concurrency::SchedulingHint::Current().DeadlineExpired()) {
+      LOGS(logger, WARNING) << "Exiting due to the run deadline being exceeded.";
+      ORT_THROW("Exiting due to the run deadline being exceeded.");
+    }
+
     const auto* p_op_kernel = session_state.GetKernel(node_index);
     const auto& node = *graph_viewer.GetNode(node_index);
 
@@ -199,6 +206,11 @@ Status ParallelExecutor::RunNodeAsync(size_t p_node_index,
       });
     }
 
+    // the parallel loops of the kernel stop early once the deadline has passed, so its outputs may be incomplete
+    if (status.IsOK() && concurrency::SchedulingHint::Current().DeadlineExpired()) {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to the run deadline being exceeded.");
+    }
+
     if (!status.IsOK()) {
       std::ostringstream ss;
       ss << "Non-zero status code returned while running " << node.OpType() << " node. Name:'" << node.Name()
@@ -247,6 +259,11 @@ Status ParallelExecutor::RunNodeAsync(size_t p_node_index,
                                                      {{"op_name", p_op_kernel->KernelDef().OpName()}});
     }
 
+    auto* statistics_collector = session_state.GetTensorStatisticsCollector();
+    if (statistics_collector != nullptr) {
+      statistics_collector->ObserveNodeOutputs(op_kernel_context, node, session_state.GetThreadPool());
+    }
+
     //std::cout << "Run async node finish: " << p_node_index << std::endl;
 
     keep_running = false;
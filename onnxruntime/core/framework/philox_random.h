@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "core/framework/random_generator.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+
+/**
+ * Philox4x32-10 counter-based random number engine, from "Parallel Random Numbers: As Easy as 1, 2, 3"
+ * (Salmon et al., SC 2011). Each value of the 128-bit counter is mapped to a block of 4 random uint32 values,
+ * so any part of a stream can be generated without generating what precedes it.
+ */
+class PhiloxRandom {
+ public:
+  static constexpr int kResultElementCount = 4;
+  using ResultType = std::array<uint32_t, kResultElementCount>;
+
+  /**
+   * Creates the engine of the stream of seed, positioned at the block offset.
+   * These are the seed and offset pair returned by PhiloxGenerator::NextPhiloxSeeds.
+   */
+  PhiloxRandom(uint64_t seed, uint64_t offset)
+      : counter_{{static_cast<uint32_t>(offset), static_cast<uint32_t>(offset >> 32), 0, 0}},
+        key_{{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}} {}
+
+  /**
+   * Creates the engine from the raw counter and key.
+   */
+  PhiloxRandom(const ResultType& counter, const std::array<uint32_t, 2>& key) : counter_(counter), key_(key) {}
+
+  /**
+   * Gets the block at the current counter and advances the counter to the next block.
+   */
+  ResultType operator()() {
+    ResultType counter = counter_;
+    std::array<uint32_t, 2> key = key_;
+    for (int round = 0; round < 9; ++round) {
+      counter = ComputeSingleRound(counter, key);
+      key[0] += kPhiloxW32A;
+      key[1] += kPhiloxW32B;
+    }
+
+    counter = ComputeSingleRound(counter, key);
+    SkipOne();
+    return counter;
+  }
+
+ private:
+  static constexpr uint32_t kPhiloxW32A = 0x9E3779B9;
+  static constexpr uint32_t kPhiloxW32B = 0xBB67AE85;
+  static constexpr uint32_t kPhiloxM4x32A = 0xD2511F53;
+  static constexpr uint32_t kPhiloxM4x32B = 0xCD9E8D57;
+
+  static void MultiplyHighLow(uint32_t a, uint32_t b, uint32_t& result_low, uint32_t& result_high) {
+    const uint64_t product = static_cast<uint64_t>(a) * b;
+    result_low = static_cast<uint32_t>(product);
+    result_high = static_cast<uint32_t>(product >> 32);
+  }
+
+  static ResultType ComputeSingleRound(const ResultType& counter, const std::array<uint32_t, 2>& key) {
+    uint32_t lo0, hi0, lo1, hi1;
+    MultiplyHighLow(kPhiloxM4x32A, counter[0], lo0, hi0);
+    MultiplyHighLow(kPhiloxM4x32B, counter[2], lo1, hi1);
+    return {{hi1 ^ counter[1] ^ key[0], lo1, hi0 ^ counter[3] ^ key[1], lo0}};
+  }
+
+  void SkipOne() {
+    for (auto& word : counter_) {
+      if (++word != 0) {
+        break;
+      }
+    }
+  }
+
+  ResultType counter_;
+  std::array<uint32_t, 2> key_;
+};
+
+// Uniform value in [0, 1) from the top 24 bits of x.
+inline float Uint32ToFloat(uint32_t x) {
+  return static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+}
+
+// Uniform value in [0, 1) from the top 53 bits of the 64 bits of x0 and x1.
+inline double Uint64ToDouble(uint32_t x0, uint32_t x1) {
+  const uint64_t x = (static_cast<uint64_t>(x0) << 32) | x1;
+  return static_cast<double>(x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// The uniform values in [0, 1) of a block: 4 floats or 2 doubles.
+inline void ToUniform(const PhiloxRandom::ResultType& bits, float* values) {
+  for (int i = 0; i < PhiloxRandom::kResultElementCount; ++i) {
+    values[i] = Uint32ToFloat(bits[i]);
+  }
+}
+
+inline void ToUniform(const PhiloxRandom::ResultType& bits, double* values) {
+  values[0] = Uint64ToDouble(bits[0], bits[1]);
+  values[1] = Uint64ToDouble(bits[2], bits[3]);
+}
+
+/**
+ * The random distributions below produce a fixed number of values, kResultElementCount, from each block of
+ * a PhiloxRandom engine.
+ */
+template <typename T>
+class PhiloxUniformDistribution {
+ public:
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount * sizeof(uint32_t) / sizeof(T);
+
+  PhiloxUniformDistribution(T low, T high) : low_(low), range_(high - low) {}
+
+  void operator()(PhiloxRandom& generator, T* values) const {
+    ToUniform(generator(), values);
+    for (int i = 0; i < kResultElementCount; ++i) {
+      values[i] = low_ + range_ * values[i];
+    }
+  }
+
+ private:
+  T low_;
+  T range_;
+};
+
+template <typename T>
+class PhiloxNormalDistribution {
+ public:
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount * sizeof(uint32_t) / sizeof(T);
+
+  PhiloxNormalDistribution(T mean, T scale) : mean_(mean), scale_(scale) {}
+
+  void operator()(PhiloxRandom& generator, T* values) const {
+    static constexpr T kTwoPi = static_cast<T>(6.283185307179586);
+    ToUniform(generator(), values);
+    // Box-Muller transform of each pair of uniform values. 1 - u is in (0, 1], so the log is finite.
+    for (int i = 0; i < kResultElementCount; i += 2) {
+      const T radius = std::sqrt(static_cast<T>(-2) * std::log(static_cast<T>(1) - values[i]));
+      const T theta = kTwoPi * values[i + 1];
+      values[i] = mean_ + scale_ * radius * std::cos(theta);
+      values[i + 1] = mean_ + scale_ * radius * std::sin(theta);
+    }
+  }
+
+ private:
+  T mean_;
+  T scale_;
+};
+
+// true with the probability p
+class PhiloxBernoulliDistribution {
+ public:
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+
+  explicit PhiloxBernoulliDistribution(float p) : p_(p) {}
+
+  void operator()(PhiloxRandom& generator, bool* values) const {
+    const auto bits = generator();
+    for (int i = 0; i < kResultElementCount; ++i) {
+      values[i] = Uint32ToFloat(bits[i]) < p_;
+    }
+  }
+
+ private:
+  float p_;
+};
+
+/**
+ * Number of blocks to reserve from a PhiloxGenerator to generate count values of distribution.
+ */
+template <typename Distribution>
+uint64_t PhiloxBlockCount(int64_t count) {
+  return static_cast<uint64_t>((count + Distribution::kResultElementCount - 1) / Distribution::kResultElementCount);
+}
+
+/**
+ * Fills data with values of distribution, drawn from the next blocks of the stream of generator.
+ * The blocks are split over the thread pool. Value i always comes from the i / kResultElementCount'th block,
+ * so the values don't depend on the number of threads, only on the seed of generator and the values
+ * it generated before.
+ */
+template <typename T, typename Distribution>
+void FillPhiloxRandom(PhiloxGenerator& generator, const Distribution& distribution, T* data, int64_t count,
+                      concurrency::ThreadPool* thread_pool) {
+  constexpr int kResultElementCount = Distribution::kResultElementCount;
+  const uint64_t block_count = PhiloxBlockCount<Distribution>(count);
+  const auto seeds = generator.NextPhiloxSeeds(block_count);
+
+  // 10 rounds of 2 multiplications and a few xors per block, plus the conversion of its values
+  const TensorOpCost cost{0, static_cast<double>(sizeof(T) * kResultElementCount), 64.0};
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(block_count), cost,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        PhiloxRandom engine(seeds.first, seeds.second + first);
+        T values[kResultElementCount];
+        for (std::ptrdiff_t block = first; block < last; ++block) {
+          const int64_t begin = block * kResultElementCount;
+          distribution(engine, values);
+          std::copy_n(values, std::min<int64_t>(kResultElementCount, count - begin), data + begin);
+        }
+      });
+}
+
+}  // namespace onnxruntime
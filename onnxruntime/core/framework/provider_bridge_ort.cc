@@ -348,6 +348,14 @@ struct ProviderHostImpl : ProviderHost {
     return p->dim_param();
   }
 
+  bool Provider_TensorShapeProto_Dimension__has_dim_value(const Provider_TensorShapeProto_Dimension* p) override {
+    return p->has_dim_value();
+  }
+
+  int64_t Provider_TensorShapeProto_Dimension__dim_value(const Provider_TensorShapeProto_Dimension* p) override {
+    return p->dim_value();
+  }
+
   // Provider_TensorShapeProto_Dimensions
   std::unique_ptr<Provider_TensorShapeProto_Dimension_Iterator> Provider_TensorShapeProto_Dimensions__begin(const Provider_TensorShapeProto_Dimensions* p) override {
     return onnxruntime::make_unique<Provider_TensorShapeProto_Dimension_Iterator_Impl>(p->begin());
@@ -53,3 +53,29 @@ ORT_API_STATUS_IMPL(OrtApis::RunOptionsUnsetTerminate, _Inout_ OrtRunOptions* op
   options->terminate = false;
   return nullptr;
 }
+
+ORT_API_STATUS_IMPL(OrtApis::RunOptionsSetRunPriority, _Inout_ OrtRunOptions* options, OrtRunPriority priority) {
+  if (priority < ORT_RUN_PRIORITY_HIGH || priority > ORT_RUN_PRIORITY_LOW) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Invalid run priority.");
+  }
+  options->run_priority = priority;
+  return nullptr;
+}
+
+ORT_API_STATUS_IMPL(OrtApis::RunOptionsGetRunPriority, _In_ const OrtRunOptions* options, _Out_ OrtRunPriority* out) {
+  *out = options->run_priority;
+  return nullptr;
+}
+
+ORT_API_STATUS_IMPL(OrtApis::RunOptionsSetRunDeadline, _Inout_ OrtRunOptions* options, int64_t deadline_ms) {
+  if (deadline_ms < 0) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Run deadline must not be negative.");
+  }
+  options->run_deadline_ms = deadline_ms;
+  return nullptr;
+}
+
+ORT_API_STATUS_IMPL(OrtApis::RunOptionsGetRunDeadline, _In_ const OrtRunOptions* options, _Out_ int64_t* out) {
+  *out = options->run_deadline_ms;
+  return nullptr;
+}
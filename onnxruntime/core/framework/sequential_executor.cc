@@ -13,6 +13,9 @@
 #include "core/framework/execution_frame.h"
 #include "core/framework/session_state.h"
 #include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/node_result_cache.h"
+#include "core/framework/tensor_statistics_collector.h"
+#include "core/platform/threadpool.h"
 
 #if defined DEBUG_NODE_INPUTS_OUTPUTS
 #include "core/framework/debug_node_inputs_outputs_utils.h"
@@ -126,6 +129,14 @@ Status SequentialExecutor::Execute(const SessionState& session_state, const std:
                                    std::vector<OrtValue>& fetches,
                                    const std::unordered_map<size_t, CustomAllocator>& fetch_allocators,
                                    const logging::Logger& logger) {
+  ExecutionFrame frame{feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches, fetch_allocators, session_state};
+  return Execute(session_state, frame, feeds, fetch_mlvalue_idxs, fetches, logger);
+}
+
+Status SequentialExecutor::Execute(const SessionState& session_state, ExecutionFrame& frame,
+                                   const std::vector<OrtValue>& feeds, const std::vector<int>& fetch_mlvalue_idxs,
+                                   std::vector<OrtValue>& fetches, const logging::Logger& logger,
+                                   const std::unordered_set<NodeIndex>* nodes_to_execute) {
   const bool is_profiler_enabled = session_state.Profiler().IsEnabled();
   TimePoint tp;
   TimePoint sync_time_begin;
@@ -138,21 +149,22 @@ Status SequentialExecutor::Execute(const SessionState& session_state, const std:
     tp = session_state.Profiler().StartTime();
   }
 
-  ExecutionFrame frame{feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches, fetch_allocators, session_state};
-  const std::unordered_set<NodeIndex>* to_be_executed_nodes = nullptr;
+  const std::unordered_set<NodeIndex>* to_be_executed_nodes = nodes_to_execute;
+  bool only_execute_subset = to_be_executed_nodes != nullptr;
 
 #if !defined(ORT_MINIMAL_BUILD)
-  to_be_executed_nodes = session_state.GetToBeExecutedNodes(fetch_mlvalue_idxs);
-  const bool only_execute_path_to_fetches = only_execute_path_to_fetches_ && (to_be_executed_nodes != nullptr);
-
-  if (only_execute_path_to_fetches) {
-    VLOGS(logger, 1) << to_be_executed_nodes->size() << " nodes to be executed\n";
+  if (!only_execute_subset && only_execute_path_to_fetches_) {
+    to_be_executed_nodes = session_state.GetToBeExecutedNodes(fetch_mlvalue_idxs);
+    only_execute_subset = to_be_executed_nodes != nullptr;
   }
 #else
   ORT_UNUSED_PARAMETER(only_execute_path_to_fetches_);
-  const bool only_execute_path_to_fetches = false;
 #endif
 
+  if (only_execute_subset) {
+    VLOGS(logger, 1) << to_be_executed_nodes->size() << " nodes to be executed\n";
+  }
+
   LOGS(logger, INFO) << "Begin execution";
   const SequentialExecutionPlan& seq_exec_plan = *session_state.GetExecutionPlan();
   const auto& exec_plan_vec = seq_exec_plan.execution_plan;
@@ -165,6 +177,32 @@ Status SequentialExecutor::Execute(const SessionState& session_state, const std:
 
   const auto& graph_viewer = session_state.GetGraphViewer();
 
+  // the caller chose the nodes to execute from the values already in the frame, which the cache must not skip.
+  auto* result_cache = nodes_to_execute == nullptr ? session_state.GetNodeResultCache() : nullptr;
+  NodeResultCache::RunPlan result_cache_plan;
+  if (result_cache != nullptr) {
+    TimePoint lookup_begin;
+    if (is_profiler_enabled) {
+      lookup_begin = session_state.Profiler().StartTime();
+    }
+
+    result_cache->Plan(frame, result_cache_plan);
+
+    if (is_profiler_enabled) {
+      const auto stats = result_cache->GetStats();
+      const size_t lookups = stats.hits + stats.misses;
+      session_state.Profiler().EndTimeAndRecordEvent(
+          profiling::SESSION_EVENT, "node_result_cache_lookup", lookup_begin,
+          {{"hits", std::to_string(result_cache_plan.stats.hits)},
+           {"misses", std::to_string(result_cache_plan.stats.misses)},
+           {"skipped_nodes", std::to_string(result_cache_plan.stats.skipped_nodes)},
+           {"total_hit_rate", std::to_string(lookups > 0 ? static_cast<double>(stats.hits) / lookups : 0.0)},
+           {"evictions", std::to_string(stats.evictions)},
+           {"entries", std::to_string(stats.num_entries)},
+           {"bytes", std::to_string(stats.num_bytes)}});
+    }
+  }
+
 #ifdef CONCURRENCY_VISUALIZER
   // need unique name for the series. number of nodes should be good enough for a subgraph
   char series_name[MaxSeriesNameLengthInChars] = "MainGraph";
@@ -193,10 +231,23 @@ Status SequentialExecutor::Execute(const SessionState& session_state, const std:
       return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
     }
 
+    if (concurrency::SchedulingHint::Current().DeadlineExpired()) {
+      LOGS(logger, WARNING) << "Exiting due to the run deadline being exceeded.";
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to the run deadline being exceeded.");
+    }
+
     auto node_index = node_exec_plan.node_index;
 
     // If it is not necessary to execute the node.
-    if (only_execute_path_to_fetches && to_be_executed_nodes->count(node_index) == 0) {
+    if (only_execute_subset && to_be_executed_nodes->count(node_index) == 0) {
+      continue;
+    }
+
+    const auto result_cache_action = result_cache != nullptr ? result_cache_plan.actions[node_index]
+                                                             : NodeResultCache::NodeAction::kCompute;
+    // nothing needs the outputs of the node in this run
+    if (result_cache_action == NodeResultCache::NodeAction::kSkip) {
+      ORT_RETURN_IF_ERROR(ReleaseNodeMLValues(frame, seq_exec_plan, node_exec_plan, logger));
       continue;
     }
 
@@ -306,7 +357,11 @@ Status SequentialExecutor::Execute(const SessionState& session_state, const std:
       node_compute_range.Begin();
 #endif
       ORT_TRY {
-        compute_status = p_op_kernel->Compute(&op_kernel_context);
+        if (result_cache_action == NodeResultCache::NodeAction::kRestore) {
+          compute_status = result_cache->Restore(result_cache_plan, node, op_kernel_context);
+        } else {
+          compute_status = p_op_kernel->Compute(&op_kernel_context);
+        }
       }
       ORT_CATCH(const std::exception& ex) {
         ORT_HANDLE_EXCEPTION([&]() {
@@ -319,6 +374,11 @@ Status SequentialExecutor::Execute(const SessionState& session_state, const std:
 #endif
     }
 
+    // the parallel loops of the kernel stop early once the deadline has passed, so its outputs may be incomplete
+    if (compute_status.IsOK() && concurrency::SchedulingHint::Current().DeadlineExpired()) {
+      compute_status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to the run deadline being exceeded.");
+    }
+
     if (!compute_status.IsOK()) {
       std::ostringstream ss;
       ss << "Non-zero status code returned while running " << node.OpType() << " node. Name:'" << node.Name()
@@ -328,6 +388,10 @@ Status SequentialExecutor::Execute(const SessionState& session_state, const std:
       return Status(compute_status.Category(), compute_status.Code(), msg_string);
     }
 
+    if (result_cache_action == NodeResultCache::NodeAction::kComputeAndStore) {
+      result_cache->Store(result_cache_plan, node, op_kernel_context);
+    }
+
     if (is_profiler_enabled) {
       // Calculate total output sizes for this operation.
       CalculateTotalOutputSizes(&op_kernel_context, total_output_sizes, node_name_for_profiling);
@@ -409,6 +473,11 @@ Status SequentialExecutor::Execute(const SessionState& session_state, const std:
     utils::DumpNodeOutputs(op_kernel_context, p_op_kernel->Node(), session_state);
 #endif
 
+    auto* statistics_collector = session_state.GetTensorStatisticsCollector();
+    if (statistics_collector != nullptr) {
+      statistics_collector->ObserveNodeOutputs(op_kernel_context, p_op_kernel->Node(), session_state.GetThreadPool());
+    }
+
     // free ml-values corresponding to this node
     VLOGS(logger, 1) << "Releasing node ML values.";
     ORT_RETURN_IF_ERROR(ReleaseNodeMLValues(frame, seq_exec_plan, node_exec_plan, logger));
@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include "core/common/common.h"
 #include "core/common/status.h"
 #include "core/common/logging/logging.h"
@@ -16,6 +17,8 @@
 #include "core/framework/op_kernel_context_internal.h"
 
 namespace onnxruntime {
+class ExecutionFrame;
+
 class SequentialExecutor : public IExecutor {
  public:
   SequentialExecutor(const bool& terminate_flag = false, const bool only_execute_path_to_fetches = false)
@@ -27,6 +30,15 @@ class SequentialExecutor : public IExecutor {
                          const std::unordered_map<size_t, CustomAllocator>& fetch_allocators,
                          const logging::Logger& logger) override;
 
+  // Execute using a frame owned by the caller, which must have been created or reset with the feeds and fetches.
+  // Allows a frame to be reused across executions of a subgraph. See SubgraphExecutionContext.
+  // If nodes_to_execute is provided only those nodes are executed, and the frame must already hold the values the
+  // other nodes produce. See IncrementalExecutionContext.
+  common::Status Execute(const SessionState& session_state, ExecutionFrame& frame,
+                         const std::vector<OrtValue>& feeds, const std::vector<int>& fetch_mlvalue_idxs,
+                         std::vector<OrtValue>& fetches, const logging::Logger& logger,
+                         const std::unordered_set<NodeIndex>* nodes_to_execute = nullptr);
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SequentialExecutor);
   const bool& terminate_flag_;
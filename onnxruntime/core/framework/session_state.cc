@@ -3,6 +3,7 @@
 
 #include "core/framework/session_state.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "core/common/logging/logging.h"
@@ -13,6 +14,7 @@
 #include "core/framework/op_kernel.h"
 #include "core/framework/ort_value_pattern_planner.h"
 #include "core/framework/session_state_utils.h"
+#include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/providers/cpu/controlflow/utils.h"
 
@@ -283,7 +285,7 @@ static int64_t CalculateMemoryPatternsKey(const std::vector<std::reference_wrapp
   return key;
 }
 
-#ifdef ENABLE_TRAINING
+#if defined(ENABLE_TRAINING) || !defined(ORT_MINIMAL_BUILD)
 namespace {
 Status ResolveDimParams(const GraphViewer& graph,
                         const std::map<std::string, TensorShape>& feeds,
@@ -359,7 +361,8 @@ Status ResolveSizeAndShape(
 Status SessionState::GeneratePatternGroupCache(const std::vector<std::reference_wrapper<const TensorShape>>& input_shape,
                                                const std::vector<int>& feed_mlvalue_idxs,
                                                MemoryPatternGroup* output,
-                                               std::unordered_map<int, TensorShape>& resolved_shapes) const {
+                                               std::unordered_map<int, TensorShape>& resolved_shapes,
+                                               bool* all_sizes_resolved) const {
   std::map<std::string, TensorShape> feeds;
   for (size_t i = 0, end = feed_mlvalue_idxs.size(); i < end; ++i) {
     std::string name;
@@ -372,6 +375,10 @@ Status SessionState::GeneratePatternGroupCache(const std::vector<std::reference_
   ORT_ENFORCE(exe_plan);
   OrtValuePatternPlanner mem_planner(*exe_plan);
   auto& node_index_info = GetNodeIndexInfo();
+  if (all_sizes_resolved) {
+    *all_sizes_resolved = true;
+  }
+
   for (auto& node_plan : exe_plan->execution_plan) {
     int node_index = node_index_info.GetNodeOffset(node_plan.node_index);
     auto* node = graph_viewer_->GetNode(node_plan.node_index);
@@ -398,8 +405,16 @@ Status SessionState::GeneratePatternGroupCache(const std::vector<std::reference_
       }
 
       // Plan memory if conditions are met.
-      if (exe_plan->allocation_plan[ml_value_idx].alloc_kind == AllocKind::kAllocate &&
-          ml_data_type != DataTypeImpl::GetType<std::string>() && size != 0) {
+      if (exe_plan->allocation_plan[ml_value_idx].alloc_kind != AllocKind::kAllocate ||
+          ml_data_type == DataTypeImpl::GetType<std::string>()) {
+        continue;
+      }
+
+      if (size == 0) {
+        if (all_sizes_resolved) {
+          *all_sizes_resolved = false;
+        }
+      } else {
         size_t aligned_size = 0;
         if (!IAllocator::CalcMemSizeForArrayWithAlignment<64>(size, ml_data_type->Size(), &aligned_size)) {
           return Status(ONNXRUNTIME, FAIL, "Size overflow");
@@ -668,6 +683,157 @@ static Status GetSubGraphSessionStatesOrtFormat(
   return Status::OK();
 }
 
+Status SessionState::GenerateStaticMemoryPatternGroup(std::unique_ptr<MemoryPatternGroup>& output,
+                                                      int64_t& key) const {
+  output = nullptr;
+
+  // the feeds of a subgraph include the outer scope values, whose shapes are only known at runtime
+  if (!enable_mem_pattern_ || parent_ != nullptr) {
+    return Status::OK();
+  }
+
+  std::vector<TensorShape> input_shapes;
+  std::vector<int> feed_mlvalue_idxs;
+  for (const auto* input : graph_viewer_->GetInputs()) {
+    const auto* type = input->TypeAsProto();
+    const auto* shape = input->Shape();
+    if (type == nullptr || !utils::HasTensorType(*type) || shape == nullptr) {
+      return Status::OK();
+    }
+
+    for (const auto& dim : shape->dim()) {
+      if (!utils::HasDimValue(dim)) {
+        return Status::OK();
+      }
+    }
+
+    int idx;
+    ORT_RETURN_IF_ERROR(ort_value_name_idx_map_.GetIdx(input->Name(), idx));
+    input_shapes.push_back(utils::GetTensorShapeFromTensorShapeProto(*shape));
+    feed_mlvalue_idxs.push_back(idx);
+  }
+
+  std::vector<std::reference_wrapper<const TensorShape>> input_shape_refs(input_shapes.cbegin(), input_shapes.cend());
+  auto mem_patterns = onnxruntime::make_unique<MemoryPatternGroup>();
+  std::unordered_map<int, TensorShape> inferred_shapes;
+  bool all_sizes_resolved = false;
+  auto status = GeneratePatternGroupCache(input_shape_refs, feed_mlvalue_idxs, mem_patterns.get(), inferred_shapes,
+                                          &all_sizes_resolved);
+  if (!status.IsOK()) {
+    LOGS(logger_, INFO) << "Memory patterns were not generated for the ORT format model. " << status.ErrorMessage();
+    return Status::OK();
+  }
+
+  if (all_sizes_resolved) {
+    key = CalculateMemoryPatternsKey(input_shape_refs);
+    output = std::move(mem_patterns);
+  }
+
+  return Status::OK();
+}
+
+Status SessionState::SaveExecutionPlanToOrtFormat(flatbuffers::FlatBufferBuilder& builder,
+                                                  flatbuffers::Offset<fbs::ExecutionPlan>& fbs_execution_plan) const {
+  ORT_RETURN_IF(p_seq_exec_plan_ == nullptr, "FinalizeSessionState must be called before saving the execution plan.");
+  const SequentialExecutionPlan& plan = *p_seq_exec_plan_;
+
+  std::vector<OrtMemoryInfo> unique_locations;
+  std::vector<flatbuffers::Offset<fbs::MemoryInfo>> locations;
+  auto get_location_index = [&builder, &unique_locations, &locations](const OrtMemoryInfo& location) {
+    auto entry = std::find(unique_locations.cbegin(), unique_locations.cend(), location);
+    if (entry != unique_locations.cend()) {
+      return gsl::narrow<uint32_t>(entry - unique_locations.cbegin());
+    }
+
+    unique_locations.push_back(location);
+    locations.push_back(fbs::CreateMemoryInfoDirect(builder, location.name, location.id,
+                                                    static_cast<int32_t>(location.mem_type),
+                                                    static_cast<int32_t>(location.alloc_type),
+                                                    location.device.Type(), location.device.MemType(),
+                                                    location.device.Id()));
+    return gsl::narrow<uint32_t>(locations.size() - 1);
+  };
+
+  const size_t num_values = plan.allocation_plan.size();
+  std::vector<flatbuffers::Offset<flatbuffers::String>> ort_value_names;
+  std::vector<int32_t> alloc_kinds;
+  std::vector<uint32_t> value_locations;
+  std::vector<int32_t> reused_buffers;
+  std::vector<uint8_t> create_fence_if_async;
+  ort_value_names.reserve(num_values);
+  alloc_kinds.reserve(num_values);
+  value_locations.reserve(num_values);
+  reused_buffers.reserve(num_values);
+  create_fence_if_async.reserve(num_values);
+
+  for (size_t i = 0; i < num_values; ++i) {
+    std::string name;
+    ORT_RETURN_IF_ERROR(ort_value_name_idx_map_.GetName(static_cast<int>(i), name));
+    ort_value_names.push_back(builder.CreateString(name));
+
+    const auto& alloc_plan = plan.allocation_plan[i];
+    alloc_kinds.push_back(static_cast<int32_t>(alloc_plan.alloc_kind));
+    value_locations.push_back(get_location_index(alloc_plan.location));
+    reused_buffers.push_back(alloc_plan.reused_buffer);
+    create_fence_if_async.push_back(alloc_plan.create_fence_if_async ? 1 : 0);
+  }
+
+  const size_t num_nodes = plan.execution_plan.size();
+  std::vector<uint32_t> node_indices;
+  std::vector<int32_t> free_from_indices;
+  std::vector<int32_t> free_to_indices;
+  node_indices.reserve(num_nodes);
+  free_from_indices.reserve(num_nodes);
+  free_to_indices.reserve(num_nodes);
+  for (const auto& step : plan.execution_plan) {
+    node_indices.push_back(gsl::narrow<uint32_t>(step.node_index));
+    free_from_indices.push_back(step.free_from_index);
+    free_to_indices.push_back(step.free_to_index);
+  }
+
+  std::vector<int32_t> to_be_freed(plan.to_be_freed.cbegin(), plan.to_be_freed.cend());
+  std::vector<uint8_t> node_has_fence;
+  node_has_fence.reserve(plan.node_has_fence.size());
+  for (bool has_fence : plan.node_has_fence) {
+    node_has_fence.push_back(has_fence ? 1 : 0);
+  }
+
+  std::vector<flatbuffers::Offset<fbs::MemoryPatternGroup>> memory_pattern_groups;
+  std::unique_ptr<MemoryPatternGroup> static_mem_patterns;
+  int64_t key = 0;
+  ORT_RETURN_IF_ERROR(GenerateStaticMemoryPatternGroup(static_mem_patterns, key));
+  if (static_mem_patterns) {
+    std::vector<flatbuffers::Offset<fbs::MemoryPattern>> patterns;
+    for (size_t i = 0, end = static_mem_patterns->locations.size(); i < end; ++i) {
+      const MemoryPattern& pattern = static_mem_patterns->patterns[i];
+
+      // sort the blocks by OrtValue index so the output is deterministic
+      std::map<int, MemoryBlock> blocks(pattern.GetBlocks().cbegin(), pattern.GetBlocks().cend());
+      std::vector<int32_t> value_indices;
+      std::vector<uint64_t> offsets;
+      std::vector<uint64_t> sizes;
+      for (const auto& entry : blocks) {
+        value_indices.push_back(entry.first);
+        offsets.push_back(entry.second.offset_);
+        sizes.push_back(entry.second.size_);
+      }
+
+      const auto location = get_location_index(static_mem_patterns->locations[i]);
+      patterns.push_back(fbs::CreateMemoryPatternDirect(builder, location, pattern.PeakSize(),
+                                                        &value_indices, &offsets, &sizes));
+    }
+
+    memory_pattern_groups.push_back(fbs::CreateMemoryPatternGroupDirect(builder, key, &patterns));
+  }
+
+  fbs_execution_plan = fbs::CreateExecutionPlanDirect(
+      builder, static_cast<int32_t>(plan_execution_mode_), static_cast<int32_t>(plan_execution_order_),
+      &ort_value_names, &locations, &alloc_kinds, &value_locations, &reused_buffers, &create_fence_if_async,
+      &node_indices, &free_from_indices, &free_to_indices, &to_be_freed, &node_has_fence, &memory_pattern_groups);
+
+  return Status::OK();
+}
+
 Status SessionState::SaveToOrtFormat(flatbuffers::FlatBufferBuilder& builder,
                                      flatbuffers::Offset<fbs::SessionState>& fbs_session_state) const {
   size_t size = kernel_create_info_map_.size();
@@ -687,7 +853,10 @@ Status SessionState::SaveToOrtFormat(flatbuffers::FlatBufferBuilder& builder,
   ORT_RETURN_IF_ERROR(
       GetSubGraphSessionStatesOrtFormat(builder, subgraph_session_states_, sub_graph_session_states));
 
-  fbs_session_state = fbs::CreateSessionStateDirect(builder, kernels, &sub_graph_session_states);
+  flatbuffers::Offset<fbs::ExecutionPlan> execution_plan;
+  ORT_RETURN_IF_ERROR(SaveExecutionPlanToOrtFormat(builder, execution_plan));
+
+  fbs_session_state = fbs::CreateSessionStateDirect(builder, kernels, &sub_graph_session_states, execution_plan);
   return Status::OK();
 }
 
@@ -778,6 +947,202 @@ Status SessionState::LoadFromOrtFormat(const fbs::SessionState& fbs_session_stat
     }
   }
 
+  // optional. FinalizeSessionStateImpl uses it if it matches the session.
+  serialized_execution_plan_ = fbs_session_state.execution_plan();
+
+  return Status::OK();
+}
+
+Status SessionState::LoadExecutionPlanFromOrtFormat(const fbs::ExecutionPlan& fbs_execution_plan,
+                                                    const std::vector<const NodeArg*>& outer_scope_node_args,
+                                                    const SessionOptions& session_options) {
+  ORT_RETURN_IF_NOT(fbs_execution_plan.execution_mode() == static_cast<int32_t>(session_options.execution_mode) &&
+                        fbs_execution_plan.execution_order() ==
+                            static_cast<int32_t>(session_options.execution_order),
+                    "The execution plan was created with a different execution mode or order.");
+
+  const auto* fbs_names = fbs_execution_plan.ort_value_names();
+  const auto* fbs_locations = fbs_execution_plan.locations();
+  const auto* fbs_alloc_kinds = fbs_execution_plan.alloc_kinds();
+  const auto* fbs_value_locations = fbs_execution_plan.value_locations();
+  const auto* fbs_reused_buffers = fbs_execution_plan.reused_buffers();
+  const auto* fbs_create_fence_if_async = fbs_execution_plan.create_fence_if_async();
+  const auto* fbs_node_indices = fbs_execution_plan.node_indices();
+  const auto* fbs_free_from_indices = fbs_execution_plan.free_from_indices();
+  const auto* fbs_free_to_indices = fbs_execution_plan.free_to_indices();
+  const auto* fbs_to_be_freed = fbs_execution_plan.to_be_freed();
+  const auto* fbs_node_has_fence = fbs_execution_plan.node_has_fence();
+  ORT_RETURN_IF(fbs_names == nullptr || fbs_locations == nullptr || fbs_alloc_kinds == nullptr ||
+                    fbs_value_locations == nullptr || fbs_reused_buffers == nullptr ||
+                    fbs_create_fence_if_async == nullptr || fbs_node_indices == nullptr ||
+                    fbs_free_from_indices == nullptr || fbs_free_to_indices == nullptr ||
+                    fbs_to_be_freed == nullptr || fbs_node_has_fence == nullptr,
+                "The execution plan is incomplete.");
+
+  // the plan is indexed by OrtValue index, so the OrtValues must have the same indexes as when it was saved
+  const size_t num_values = static_cast<size_t>(ort_value_name_idx_map_.MaxIdx() + 1);
+  ORT_RETURN_IF_NOT(fbs_names->size() == num_values && fbs_alloc_kinds->size() == num_values &&
+                        fbs_value_locations->size() == num_values && fbs_reused_buffers->size() == num_values &&
+                        fbs_create_fence_if_async->size() == num_values,
+                    "The execution plan has ", fbs_names->size(), " OrtValues but the graph has ", num_values);
+
+  for (flatbuffers::uoffset_t i = 0; i < num_values; ++i) {
+    int idx;
+    ORT_RETURN_IF_ERROR(ort_value_name_idx_map_.GetIdx(fbs_names->Get(i)->str(), idx));
+    ORT_RETURN_IF_NOT(static_cast<size_t>(idx) == i, "The execution plan has a different index for OrtValue ",
+                      fbs_names->Get(i)->str());
+  }
+
+  // the names of the locations need to outlive the plan, so use the ones from the allocators of this session
+  std::vector<OrtMemoryInfo> locations;
+  locations.reserve(fbs_locations->size());
+  for (flatbuffers::uoffset_t i = 0; i < fbs_locations->size(); ++i) {
+    const auto* fbs_location = fbs_locations->Get(i);
+    ORT_RETURN_IF(fbs_location->name() == nullptr, "The execution plan has a location without a name.");
+
+    const OrtDevice device(fbs_location->device_type(), fbs_location->device_mem_type(), fbs_location->device_id());
+    const OrtMemoryInfo location(fbs_location->name()->c_str(),
+                                 static_cast<OrtAllocatorType>(fbs_location->alloc_type()), device,
+                                 fbs_location->id(), static_cast<OrtMemType>(fbs_location->mem_type()));
+    auto entry = allocators_.find(location);
+    ORT_RETURN_IF(entry == allocators_.cend(), "No allocator for ", location.ToString(), " in the execution plan.");
+
+    locations.emplace_back(entry->first.name, location.alloc_type, device, location.id, location.mem_type);
+  }
+
+  auto plan = onnxruntime::make_unique<SequentialExecutionPlan>();
+  plan->allocation_plan.resize(num_values);
+  for (flatbuffers::uoffset_t i = 0; i < num_values; ++i) {
+    const auto alloc_kind = fbs_alloc_kinds->Get(i);
+    const auto location = fbs_value_locations->Get(i);
+    const auto reused_buffer = fbs_reused_buffers->Get(i);
+    ORT_RETURN_IF(alloc_kind < static_cast<int32_t>(AllocKind::kAllocate) ||
+                      alloc_kind > static_cast<int32_t>(AllocKind::kShare),
+                  "Invalid allocation kind in the execution plan: ", alloc_kind);
+    ORT_RETURN_IF_NOT(location < locations.size(), "Invalid location in the execution plan: ", location);
+    ORT_RETURN_IF(reused_buffer < 0 || static_cast<size_t>(reused_buffer) >= num_values,
+                  "Invalid reused buffer in the execution plan: ", reused_buffer);
+
+    AllocPlanPerValue& alloc_plan = plan->allocation_plan[i];
+    alloc_plan.alloc_kind = static_cast<AllocKind>(alloc_kind);
+    alloc_plan.location = locations[location];
+    alloc_plan.reused_buffer = reused_buffer;
+    alloc_plan.create_fence_if_async = fbs_create_fence_if_async->Get(i) != 0;
+  }
+
+  // the types are not saved. they come from the NodeArgs in the same way as in SequentialPlanner.
+  auto set_value_type = [this, &plan](const NodeArg& node_arg) {
+    int idx;
+    ORT_RETURN_IF_ERROR(ort_value_name_idx_map_.GetIdx(node_arg.Name(), idx));
+    plan->allocation_plan[idx].value_type = utils::GetMLDataType(node_arg);
+    return Status::OK();
+  };
+
+  for (const auto* input : graph_viewer_->GetInputs()) {
+    ORT_RETURN_IF_ERROR(set_value_type(*input));
+  }
+
+  for (const auto* node_arg : outer_scope_node_args) {
+    ORT_RETURN_IF_ERROR(set_value_type(*node_arg));
+  }
+
+  const size_t num_nodes = fbs_node_indices->size();
+  const size_t max_node_index = static_cast<size_t>(graph_viewer_->MaxNodeIndex());
+  const int num_to_be_freed = static_cast<int>(fbs_to_be_freed->size());
+  ORT_RETURN_IF_NOT(num_nodes == static_cast<size_t>(graph_viewer_->NumberOfNodes()) &&
+                        fbs_free_from_indices->size() == num_nodes && fbs_free_to_indices->size() == num_nodes &&
+                        fbs_node_has_fence->size() == max_node_index,
+                    "The execution plan has ", num_nodes, " nodes but the graph has ",
+                    graph_viewer_->NumberOfNodes());
+
+  std::vector<bool> planned_nodes(max_node_index, false);
+  plan->execution_plan.reserve(num_nodes);
+  for (flatbuffers::uoffset_t i = 0; i < num_nodes; ++i) {
+    const NodeIndex node_index = fbs_node_indices->Get(i);
+    const Node* node = node_index < max_node_index ? graph_viewer_->GetNode(node_index) : nullptr;
+    ORT_RETURN_IF(node == nullptr || planned_nodes[node_index],
+                  "Invalid node in the execution plan. Node index: ", node_index);
+    planned_nodes[node_index] = true;
+
+    for (const auto* output : node->OutputDefs()) {
+      if (output->Exists()) {
+        ORT_RETURN_IF_ERROR(set_value_type(*output));
+      }
+    }
+
+    plan->execution_plan.emplace_back(node_index);
+    auto& step = plan->execution_plan.back();
+    step.free_from_index = fbs_free_from_indices->Get(i);
+    step.free_to_index = fbs_free_to_indices->Get(i);
+    // the range is empty if free_from_index > free_to_index
+    ORT_RETURN_IF(step.free_from_index <= step.free_to_index &&
+                      (step.free_from_index < 0 || step.free_to_index >= num_to_be_freed),
+                  "Invalid range of values to free in the execution plan for node ", node_index);
+  }
+
+  plan->to_be_freed.reserve(fbs_to_be_freed->size());
+  for (const auto ort_value_idx : *fbs_to_be_freed) {
+    ORT_RETURN_IF(ort_value_idx < 0 || static_cast<size_t>(ort_value_idx) >= num_values,
+                  "Invalid value to free in the execution plan: ", ort_value_idx);
+    plan->to_be_freed.push_back(ort_value_idx);
+  }
+
+  plan->node_has_fence.reserve(max_node_index);
+  for (const auto has_fence : *fbs_node_has_fence) {
+    plan->node_has_fence.push_back(has_fence != 0);
+  }
+
+  // memory patterns for the shapes the graph inputs were declared with, so the first run doesn't need to trace one
+  std::vector<std::pair<int64_t, std::unique_ptr<MemoryPatternGroup>>> mem_pattern_groups;
+  const auto* fbs_mem_pattern_groups = fbs_execution_plan.memory_pattern_groups();
+  if (enable_mem_pattern_ && fbs_mem_pattern_groups != nullptr) {
+    for (flatbuffers::uoffset_t i = 0; i < fbs_mem_pattern_groups->size(); ++i) {
+      const auto* fbs_group = fbs_mem_pattern_groups->Get(i);
+      const auto* fbs_patterns = fbs_group->patterns();
+      ORT_RETURN_IF(fbs_patterns == nullptr, "Memory pattern group without patterns in the execution plan.");
+
+      auto group = onnxruntime::make_unique<MemoryPatternGroup>();
+      for (flatbuffers::uoffset_t j = 0; j < fbs_patterns->size(); ++j) {
+        const auto* fbs_pattern = fbs_patterns->Get(j);
+        const auto* value_indices = fbs_pattern->value_indices();
+        const auto* offsets = fbs_pattern->offsets();
+        const auto* sizes = fbs_pattern->sizes();
+        const uint64_t peak_size = fbs_pattern->peak_size();
+        ORT_RETURN_IF(value_indices == nullptr || offsets == nullptr || sizes == nullptr ||
+                          offsets->size() != value_indices->size() || sizes->size() != value_indices->size(),
+                      "Invalid memory pattern in the execution plan.");
+        ORT_RETURN_IF_NOT(fbs_pattern->location() < locations.size(),
+                          "Invalid memory pattern location in the execution plan: ", fbs_pattern->location());
+        ORT_RETURN_IF(static_cast<uint64_t>(static_cast<size_t>(peak_size)) != peak_size,
+                      "Memory pattern is too large: ", peak_size);
+
+        std::unordered_map<int, MemoryBlock> blocks;
+        blocks.reserve(value_indices->size());
+        for (flatbuffers::uoffset_t k = 0; k < value_indices->size(); ++k) {
+          const int ort_value_idx = value_indices->Get(k);
+          const uint64_t offset = offsets->Get(k);
+          const uint64_t size = sizes->Get(k);
+          ORT_RETURN_IF(ort_value_idx < 0 || static_cast<size_t>(ort_value_idx) >= num_values ||
+                            offset > peak_size || size > peak_size - offset,
+                        "Invalid memory pattern block in the execution plan for OrtValue ", ort_value_idx);
+          blocks.emplace(ort_value_idx, MemoryBlock(static_cast<size_t>(offset), static_cast<size_t>(size)));
+        }
+
+        group->locations.push_back(locations[fbs_pattern->location()]);
+        group->patterns.emplace_back(std::move(blocks), static_cast<size_t>(peak_size));
+      }
+
+      mem_pattern_groups.emplace_back(fbs_group->input_shapes_key(), std::move(group));
+    }
+  }
+
+  p_seq_exec_plan_ = std::move(plan);
+
+  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
+  for (auto& entry : mem_pattern_groups) {
+    mem_patterns_[entry.first] = std::move(entry.second);
+  }
+
   return Status::OK();
 }
 #endif
@@ -863,10 +1228,32 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
                   });
   }
 
-  SequentialPlannerContext context(session_options.execution_mode, session_options.execution_order);
-  ORT_RETURN_IF_ERROR(SequentialPlanner::CreatePlan(parent_node, *graph_viewer_, valid_outer_scope_node_args,
-                                                    execution_providers_, kernel_create_info_map_,
-                                                    ort_value_name_idx_map_, context, p_seq_exec_plan_));
+  plan_execution_mode_ = session_options.execution_mode;
+  plan_execution_order_ = session_options.execution_order;
+
+  bool plan_loaded = false;
+#if defined(ENABLE_ORT_FORMAT_LOAD)
+  if (serialized_execution_plan_) {
+    auto status = LoadExecutionPlanFromOrtFormat(*serialized_execution_plan_, valid_outer_scope_node_args,
+                                                 session_options);
+    // the plan points into the ORT format model bytes, which may be released once the session is initialized
+    serialized_execution_plan_ = nullptr;
+
+    if (status.IsOK()) {
+      plan_loaded = true;
+    } else {
+      LOGS(logger_, WARNING) << "The execution plan in the ORT format model can't be used with this session "
+                             << "and will be created again. " << status.ErrorMessage();
+    }
+  }
+#endif
+
+  if (!plan_loaded) {
+    SequentialPlannerContext context(session_options.execution_mode, session_options.execution_order);
+    ORT_RETURN_IF_ERROR(SequentialPlanner::CreatePlan(parent_node, *graph_viewer_, valid_outer_scope_node_args,
+                                                      execution_providers_, kernel_create_info_map_,
+                                                      ort_value_name_idx_map_, context, p_seq_exec_plan_));
+  }
 
   // Uncomment the below to dump the allocation plan to std::cout
   // LOGS(logger_, VERBOSE) << std::make_pair(p_seq_exec_plan_.get(), this);
@@ -42,6 +42,7 @@ namespace onnxruntime {
 
 namespace experimental {
 namespace fbs {
+struct ExecutionPlan;
 struct SessionState;
 }  // namespace fbs
 }  // namespace experimental
@@ -51,6 +52,8 @@ class KernelDef;
 class OpKernel;
 class NodeIndexInfo;
 struct SequentialExecutionPlan;
+class NodeResultCache;
+class TensorStatisticsCollector;
 struct MemoryPatternGroup;
 
 /**
@@ -249,6 +252,22 @@ class SessionState {
   concurrency::ThreadPool* GetThreadPool() const noexcept { return thread_pool_; }
   concurrency::ThreadPool* GetInterOpThreadPool() const noexcept { return inter_op_thread_pool_; }
 
+  /**
+  Set the collector observing the outputs of the nodes in this graph, or nullptr to stop observing them.
+  The collector is not owned, and must not be changed while the session is running.
+  */
+  void SetTensorStatisticsCollector(TensorStatisticsCollector* collector) noexcept {
+    tensor_statistics_collector_ = collector;
+  }
+  TensorStatisticsCollector* GetTensorStatisticsCollector() const noexcept { return tensor_statistics_collector_; }
+
+  /**
+  Set the cache of the results of the nodes that only depend on stable inputs, or nullptr to run them every time.
+  The cache is not owned, and must not be changed while the session is running.
+  */
+  void SetNodeResultCache(NodeResultCache* cache) noexcept { node_result_cache_ = cache; }
+  NodeResultCache* GetNodeResultCache() const noexcept { return node_result_cache_; }
+
   bool ExportDll() const noexcept { return export_fused_dll_; }
   void SetExportDllFlag(bool flag) noexcept { export_fused_dll_ = flag; }
 
@@ -313,6 +332,23 @@ class SessionState {
 
 #if !defined(ORT_MINIMAL_BUILD)
   Status PopulateKernelCreateInfo(KernelRegistryManager& kernel_registry_manager);
+
+  Status SaveExecutionPlanToOrtFormat(
+      flatbuffers::FlatBufferBuilder& builder,
+      flatbuffers::Offset<onnxruntime::experimental::fbs::ExecutionPlan>& fbs_execution_plan) const;
+
+  // Generate the memory patterns for the declared shapes of the graph inputs if they are all fixed and the size of
+  // every tensor allocated by the execution plan can be inferred from them. output is nullptr otherwise, as an
+  // incomplete pattern would stop the complete one from being traced during the first run.
+  Status GenerateStaticMemoryPatternGroup(std::unique_ptr<MemoryPatternGroup>& output, int64_t& key) const;
+#endif
+
+#if defined(ENABLE_ORT_FORMAT_LOAD)
+  // Use the execution plan and memory patterns saved in an ORT format model instead of creating them.
+  // Fails if the plan doesn't match this session, in which case p_seq_exec_plan_ is not changed.
+  Status LoadExecutionPlanFromOrtFormat(const onnxruntime::experimental::fbs::ExecutionPlan& fbs_execution_plan,
+                                        const std::vector<const NodeArg*>& outer_scope_node_args,
+                                        const SessionOptions& session_options);
 #endif
 
   Status FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_TYPE>& graph_loc,
@@ -322,12 +358,15 @@ class SessionState {
                                   bool remove_initializers,
                                   std::unordered_map<std::string, size_t>& constant_initializers_use_count);
 
-#ifdef ENABLE_TRAINING
+#if defined(ENABLE_TRAINING) || !defined(ORT_MINIMAL_BUILD)
+  // all_sizes_resolved is set to false if the size of any tensor allocated by the plan couldn't be inferred
+  // from the input shapes, so the tensor is missing from the generated pattern.
   Status GeneratePatternGroupCache(
       const std::vector<std::reference_wrapper<const TensorShape>>& input_shape,
       const std::vector<int>& feed_mlvalue_idxs,
       MemoryPatternGroup* output,
-      std::unordered_map<int, TensorShape>& inferred_shapes) const;
+      std::unordered_map<int, TensorShape>& inferred_shapes,
+      bool* all_sizes_resolved = nullptr) const;
 #endif
 
   // KernelCreateInfo for each node so we do kernel lookup once
@@ -387,6 +426,13 @@ class SessionState {
   std::vector<BufferUniquePtr> weights_buffers_;
   std::unique_ptr<SequentialExecutionPlan> p_seq_exec_plan_ = nullptr;
 
+  // options p_seq_exec_plan_ was created with, so they can be saved with it
+  ExecutionMode plan_execution_mode_ = ExecutionMode::ORT_SEQUENTIAL;
+  ExecutionOrder plan_execution_order_ = ExecutionOrder::DEFAULT;
+
+  // execution plan from an ORT format model. only valid during FinalizeSessionState.
+  const onnxruntime::experimental::fbs::ExecutionPlan* serialized_execution_plan_ = nullptr;
+
   const logging::Logger& logger_;
   profiling::Profiler& profiler_;
 
@@ -413,6 +459,9 @@ class SessionState {
   concurrency::ThreadPool* const thread_pool_{};
   concurrency::ThreadPool* const inter_op_thread_pool_{};
 
+  TensorStatisticsCollector* tensor_statistics_collector_ = nullptr;
+  NodeResultCache* node_result_cache_ = nullptr;
+
   bool export_fused_dll_ = false;
   FuncManager fused_funcs_mgr_;
   const DataTransferManager& data_transfer_mgr_;
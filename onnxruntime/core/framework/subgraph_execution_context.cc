@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/subgraph_execution_context.h"
+
+#include "core/framework/execution_frame.h"
+#include "core/framework/feeds_fetches_manager.h"
+#include "core/framework/session_state.h"
+#include "core/framework/utils.h"
+
+namespace onnxruntime {
+
+SubgraphExecutionContext::SubgraphExecutionContext(const SessionState& session_state,
+                                                   const FeedsFetchesManager& feeds_fetches_manager,
+                                                   const bool& terminate_flag, const logging::Logger& logger)
+    : session_state_(session_state),
+      feeds_fetches_manager_(feeds_fetches_manager),
+      terminate_flag_(terminate_flag),
+      logger_(logger),
+      executor_(terminate_flag) {
+}
+
+SubgraphExecutionContext::~SubgraphExecutionContext() = default;
+
+bool SubgraphExecutionContext::CanReuseFrame(const std::vector<OrtValue>& feeds) const {
+  // a frame tracing allocations for the memory pattern is replaced once the pattern is cached in the session state.
+  if (!frame_ || frame_->HasMemoryPatternPlanner() || feeds.size() != frame_feed_shapes_.size()) {
+    return false;
+  }
+
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+    const bool is_tensor = feeds[i].IsTensor();
+    if (is_tensor != frame_feed_is_tensor_[i] ||
+        (is_tensor && feeds[i].Get<Tensor>().Shape() != frame_feed_shapes_[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+common::Status SubgraphExecutionContext::Execute(
+    const std::vector<OrtValue>& feeds, std::vector<OrtValue>& fetches,
+    const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) {
+  if (feeds_fetches_manager_.GetDeviceCopyChecks().status != DeviceCopyCheck::NoCopy) {
+    return utils::ExecuteSubgraph(session_state_, feeds_fetches_manager_, feeds, fetches, fetch_allocators,
+                                  ExecutionMode::ORT_SEQUENTIAL, terminate_flag_, logger_);
+  }
+
+  const auto& feeds_fetches_info = feeds_fetches_manager_.GetFeedsFetchesInfo();
+
+  if (CanReuseFrame(feeds)) {
+    frame_->Reset(feeds_fetches_info.feeds_mlvalue_idxs, feeds, fetches, fetch_allocators);
+    ++num_frame_reuses_;
+  } else {
+    // release the previous frame and its buffers before creating the new one
+    frame_.reset();
+    frame_ = onnxruntime::make_unique<ExecutionFrame>(feeds_fetches_info.feeds_mlvalue_idxs, feeds,
+                                                      feeds_fetches_info.fetches_mlvalue_idxs, fetches,
+                                                      fetch_allocators, session_state_);
+
+    frame_feed_shapes_.clear();
+    frame_feed_is_tensor_.clear();
+    for (const auto& feed : feeds) {
+      const bool is_tensor = feed.IsTensor();
+      frame_feed_is_tensor_.push_back(is_tensor);
+      frame_feed_shapes_.push_back(is_tensor ? feed.Get<Tensor>().Shape() : TensorShape());
+    }
+  }
+
+  return executor_.Execute(session_state_, *frame_, feeds, feeds_fetches_info.fetches_mlvalue_idxs, fetches,
+                           logger_);
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/framework/iexecutor.h"
+#include "core/framework/ml_value.h"
+#include "core/framework/sequential_executor.h"
+#include "core/framework/tensor_shape.h"
+
+namespace onnxruntime {
+
+class ExecutionFrame;
+class FeedsFetchesManager;
+class SessionState;
+
+namespace logging {
+class Logger;
+}
+
+/**
+Executes a subgraph repeatedly for a single invocation of a control flow node such as Loop or Scan.
+
+Executing the subgraph with utils::ExecuteSubgraph creates a new ExecutionFrame each time, which allocates the
+buffers for the memory pattern of the subgraph and sets up the values of all the subgraph's nodes. This class keeps
+the frame alive between executions and resets it instead, as long as the shapes of the feeds don't change.
+
+If the feeds or fetches need copying between devices every execution goes through utils::ExecuteSubgraph.
+*/
+class SubgraphExecutionContext {
+ public:
+  // The feeds_fetches_manager must have been finalized. See IControlFlowKernel::SetupSubgraphExecutionInfo.
+  SubgraphExecutionContext(const SessionState& session_state, const FeedsFetchesManager& feeds_fetches_manager,
+                           const bool& terminate_flag, const logging::Logger& logger);
+
+  ~SubgraphExecutionContext();
+
+  common::Status Execute(const std::vector<OrtValue>& feeds, std::vector<OrtValue>& fetches,
+                         const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators = {});
+
+  // Number of executions that reused the frame of a previous execution.
+  size_t NumFrameReuses() const { return num_frame_reuses_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SubgraphExecutionContext);
+
+  bool CanReuseFrame(const std::vector<OrtValue>& feeds) const;
+
+  const SessionState& session_state_;
+  const FeedsFetchesManager& feeds_fetches_manager_;
+  const bool& terminate_flag_;
+  const logging::Logger& logger_;
+
+  SequentialExecutor executor_;
+  std::unique_ptr<ExecutionFrame> frame_;
+
+  // shapes of the feeds frame_ was created with. the shape is empty for feeds that are not tensors.
+  std::vector<TensorShape> frame_feed_shapes_;
+  std::vector<bool> frame_feed_is_tensor_;
+
+  size_t num_frame_reuses_ = 0;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,205 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/tensor_statistics_collector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/framework/op_kernel.h"
+#include "core/framework/tensor.h"
+#include "core/graph/graph.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+
+// Number of values below which splitting a tensor across threads costs more than it saves.
+static constexpr std::ptrdiff_t kMinValuesPerBlock = 16 * 1024;
+
+namespace {
+
+// Widen the histogram to cover [-range, range] by repeatedly doubling its range. Doubling maps each pair of bins
+// onto one bin in the middle half of the widened histogram, so no counts are smeared across bin boundaries.
+void WidenHistogram(TensorStatistics& statistics, float range) {
+  if (!(range > statistics.histogram_range) || !std::isfinite(range)) {
+    return;
+  }
+
+  // zero falls on the lower edge of the middle bin whatever the range, so values observed while the range was
+  // zero are already in the right bin.
+  if (statistics.histogram_range == 0.0f) {
+    statistics.histogram_range = range;
+    return;
+  }
+
+  const size_t num_bins = statistics.histogram.size();
+  std::vector<int64_t> widened(num_bins);
+  while (statistics.histogram_range < range) {
+    std::fill(widened.begin(), widened.end(), 0);
+    for (size_t i = 0; i < num_bins; ++i) {
+      widened[num_bins / 4 + i / 2] += statistics.histogram[i];
+    }
+    statistics.histogram.swap(widened);
+    statistics.histogram_range *= 2.0f;
+  }
+}
+
+}  // namespace
+
+float TensorStatistics::Percentile(double percentage) const {
+  if (num_values == 0 || histogram.empty()) {
+    return 0.0f;
+  }
+  if (percentage <= 0.0) {
+    return min;
+  }
+
+  const double target = percentage / 100.0 * static_cast<double>(num_values);
+  const size_t num_bins = histogram.size();
+  const double bin_width = 2.0 * histogram_range / num_bins;
+  int64_t cumulative = 0;
+  for (size_t i = 0; i < num_bins; ++i) {
+    cumulative += histogram[i];
+    if (static_cast<double>(cumulative) >= target) {
+      const auto upper_edge = static_cast<float>(-histogram_range + (i + 1) * bin_width);
+      return std::min(std::max(upper_edge, min), max);
+    }
+  }
+
+  return max;
+}
+
+TensorStatisticsCollector::TensorStatisticsCollector(std::unordered_set<std::string> tensor_names,
+                                                     size_t num_bins)
+    : tensor_names_(std::move(tensor_names)), num_bins_(num_bins) {
+  ORT_ENFORCE(num_bins_ > 0 && num_bins_ % 4 == 0, "Number of histogram bins must be a multiple of 4. Got ",
+              num_bins_);
+}
+
+TensorStatisticsCollector::Entry& TensorStatisticsCollector::GetEntry(const std::string& tensor_name) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto& entry = entries_[tensor_name];
+  if (!entry) {
+    entry = onnxruntime::make_unique<Entry>();
+    entry->statistics.histogram.assign(num_bins_, 0);
+  }
+
+  return *entry;
+}
+
+void TensorStatisticsCollector::Observe(const std::string& tensor_name, const Tensor& tensor,
+                                        concurrency::ThreadPool* tp) {
+  if (!tensor.IsDataType<float>() || tensor.Location().device.Type() != OrtDevice::CPU) {
+    return;
+  }
+
+  const std::ptrdiff_t num_values = tensor.Shape().Size();
+  if (num_values <= 0) {
+    return;
+  }
+
+  const float* data = tensor.Data<float>();
+  const std::ptrdiff_t num_blocks =
+      std::max<std::ptrdiff_t>(1, std::min<std::ptrdiff_t>(concurrency::ThreadPool::DegreeOfParallelism(tp),
+                                                           num_values / kMinValuesPerBlock));
+  const std::ptrdiff_t block_size = (num_values + num_blocks - 1) / num_blocks;
+  auto block_begin = [&](std::ptrdiff_t block) { return std::min(block * block_size, num_values); };
+
+  std::vector<float> block_min(num_blocks);
+  std::vector<float> block_max(num_blocks);
+  concurrency::ThreadPool::TrySimpleParallelFor(tp, num_blocks, [&](std::ptrdiff_t block) {
+    const std::ptrdiff_t begin = block_begin(block);
+    const std::ptrdiff_t end = block_begin(block + 1);
+    if (begin == end) {
+      block_min[block] = std::numeric_limits<float>::max();
+      block_max[block] = std::numeric_limits<float>::lowest();
+      return;
+    }
+    MlasFindMinMaxElement(data + begin, &block_min[block], &block_max[block], static_cast<size_t>(end - begin));
+  });
+  const float min = *std::min_element(block_min.begin(), block_min.end());
+  const float max = *std::max_element(block_max.begin(), block_max.end());
+
+  Entry& entry = GetEntry(tensor_name);
+  std::lock_guard<OrtMutex> lock(entry.mutex);
+  auto& statistics = entry.statistics;
+  if (statistics.num_values == 0) {
+    statistics.min = min;
+    statistics.max = max;
+  } else {
+    statistics.min = std::min(statistics.min, min);
+    statistics.max = std::max(statistics.max, max);
+  }
+  statistics.num_values += num_values;
+
+  WidenHistogram(statistics, std::max(std::abs(min), std::abs(max)));
+
+  const float range = statistics.histogram_range;
+  if (range == 0.0f) {
+    // all values so far are zero
+    statistics.histogram[num_bins_ / 2] += num_values;
+    return;
+  }
+
+  const float scale = num_bins_ / (2.0f * range);
+  const float last_bin = static_cast<float>(num_bins_ - 1);
+
+  // each block counts into its own histogram, which are summed afterwards to avoid contention.
+  std::vector<int64_t> block_histograms(num_blocks > 1 ? num_blocks * num_bins_ : 0);
+  concurrency::ThreadPool::TrySimpleParallelFor(tp, num_blocks, [&](std::ptrdiff_t block) {
+    int64_t* histogram = num_blocks > 1 ? block_histograms.data() + block * num_bins_
+                                        : statistics.histogram.data();
+    for (std::ptrdiff_t i = block_begin(block), end = block_begin(block + 1); i < end; ++i) {
+      // out of range and NaN values are counted in the first or last bin.
+      const float position = (data[i] + range) * scale;
+      const size_t bin = position >= last_bin ? num_bins_ - 1
+                                              : (position > 0.0f ? static_cast<size_t>(position) : 0);
+      ++histogram[bin];
+    }
+  });
+
+  if (num_blocks > 1) {
+    for (std::ptrdiff_t block = 0; block < num_blocks; ++block) {
+      const int64_t* histogram = block_histograms.data() + block * num_bins_;
+      for (size_t bin = 0; bin < num_bins_; ++bin) {
+        statistics.histogram[bin] += histogram[bin];
+      }
+    }
+  }
+}
+
+void TensorStatisticsCollector::ObserveNodeOutputs(OpKernelContext& context, const Node& node,
+                                                   concurrency::ThreadPool* tp) {
+  const auto& output_defs = node.OutputDefs();
+  for (int i = 0, end = context.OutputCount(); i < end; ++i) {
+    if (!output_defs[i]->Exists() || !IsObserved(output_defs[i]->Name())) {
+      continue;
+    }
+
+    // the type is null if the output was not produced.
+    const auto* type = context.OutputType(i);
+    if (type != nullptr && type->IsTensorType()) {
+      const auto* tensor = context.Output<Tensor>(i);
+      if (tensor != nullptr) {
+        Observe(output_defs[i]->Name(), *tensor, tp);
+      }
+    }
+  }
+}
+
+std::unordered_map<std::string, TensorStatistics> TensorStatisticsCollector::GetStatistics() const {
+  std::unordered_map<std::string, TensorStatistics> result;
+  std::lock_guard<OrtMutex> lock(mutex_);
+  for (const auto& entry : entries_) {
+    std::lock_guard<OrtMutex> entry_lock(entry.second->mutex);
+    if (entry.second->statistics.num_values > 0) {
+      result.emplace(entry.first, entry.second->statistics);
+    }
+  }
+
+  return result;
+}
+
+}  // namespace onnxruntime
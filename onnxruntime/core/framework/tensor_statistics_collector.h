@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+class Node;
+class OpKernelContext;
+class Tensor;
+
+namespace concurrency {
+class ThreadPool;
+}
+
+// Streaming statistics of the values of a float tensor across all the runs it was observed in.
+struct TensorStatistics {
+  float min = 0.0f;
+  float max = 0.0f;
+  int64_t num_values = 0;
+
+  // the histogram has equally sized bins covering [-histogram_range, histogram_range].
+  float histogram_range = 0.0f;
+  std::vector<int64_t> histogram;
+
+  // Value below which the given percentage (0 to 100) of the observed values lie,
+  // accurate to the width of a histogram bin.
+  float Percentile(double percentage) const;
+};
+
+/**
+Collects min/max and a histogram of float tensors produced while running a session, without the tensors having
+to be graph outputs. Used to calibrate models for static quantization in a single pass over the calibration data.
+
+Only tensors in CPU memory are observed. Observe may be called concurrently, including for the same tensor name.
+*/
+class TensorStatisticsCollector {
+ public:
+  static constexpr size_t kDefaultNumBins = 2048;
+
+  // Observe the tensors with the given names, or all float tensors if tensor_names is empty.
+  // num_bins must be a multiple of 4 so that histograms can be widened by merging bins.
+  explicit TensorStatisticsCollector(std::unordered_set<std::string> tensor_names,
+                                     size_t num_bins = kDefaultNumBins);
+
+  bool IsObserved(const std::string& tensor_name) const {
+    return tensor_names_.empty() || tensor_names_.count(tensor_name) > 0;
+  }
+
+  // Update the statistics of tensor_name with the values of tensor. tp is used to parallelize large tensors.
+  void Observe(const std::string& tensor_name, const Tensor& tensor, concurrency::ThreadPool* tp);
+
+  // Observe the outputs of a node that has just been computed.
+  void ObserveNodeOutputs(OpKernelContext& context, const Node& node, concurrency::ThreadPool* tp);
+
+  std::unordered_map<std::string, TensorStatistics> GetStatistics() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(TensorStatisticsCollector);
+
+  struct Entry {
+    OrtMutex mutex;
+    TensorStatistics statistics;
+  };
+
+  Entry& GetEntry(const std::string& tensor_name);
+
+  const std::unordered_set<std::string> tensor_names_;
+  const size_t num_bins_;
+
+  // entries are never removed, so a reference to one stays valid after releasing mutex_.
+  mutable OrtMutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+};
+
+}  // namespace onnxruntime
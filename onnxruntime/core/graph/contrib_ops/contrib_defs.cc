@@ -559,7 +559,9 @@ EmbedLayerNormalization is the fusion of embedding layer in BERT model, with opt
 The embedding layer takes input_ids (word IDs) and segment_ids (sentence IDs) to look up word_embedding, position_embedding,
 and segment_emedding; the embeddings are added then applied layer normalization using gamma and beta tensors.
 The last input mask is optional. If mask is provided, mask index (that is position of first 0 in mask, or number of words)
-will be calculated.)DOC";
+will be calculated.
+To save memory, the word_embedding may be a float16 or bfloat16 table, or an 8-bit integer table quantized per row with
+word_embedding_scale and word_embedding_zero_point. The rows are converted to float as they are looked up.)DOC";
 
   ONNX_CONTRIB_OPERATOR_SCHEMA(EmbedLayerNormalization)
       .SetDomain(kMSDomain)
@@ -568,18 +570,24 @@ will be calculated.)DOC";
       .Attr("epsilon", "The epsilon value to use to avoid division by zero.", AttributeProto::FLOAT, kDefaultEmbedLayerNormEpsilon)
       .Input(0, "input_ids", "2D words IDs with shape (batch_size, sequence_length)", "T1")
       .Input(1, "segment_ids", "2D segment IDs with shape (batch_size, sequence_length)", "T1", OpSchema::Optional)
-      .Input(2, "word_embedding", "2D with shape (,hidden_size)", "T")
+      .Input(2, "word_embedding", "2D with shape (,hidden_size)", "T2")
       .Input(3, "position_embedding", "2D with shape (, hidden_size)", "T")
       .Input(4, "segment_embedding", "2D with shape (, hidden_size)", "T", OpSchema::Optional)
       .Input(5, "gamma", "1D gamma tensor for layer normalization with shape (hidden_size)", "T")
       .Input(6, "beta", "1D beta tensor for layer normalization  with shape (hidden_size)", "T")
       .Input(7, "mask", "2D attention mask with shape (batch_size, sequence_length)", "T1", OpSchema::Optional)
+      .Input(8, "word_embedding_scale", "1D scale of each row of a quantized word_embedding", "tensor(float)",
+             OpSchema::Optional)
+      .Input(9, "word_embedding_zero_point", "1D zero point of each row of a quantized word_embedding. Default is 0.",
+             "T2", OpSchema::Optional)
       .Output(0, "output", "3D output tensor with shape (batch_size, sequence_length, hidden_size)", "T")
       .Output(1, "mask_index", "1D mask_index tensor with shape (batch_size)", "T1")
       .TypeConstraint("T1", {"tensor(int32)"}, "Constrain input and output integer tensors types")
       .TypeConstraint("T", {"tensor(float)", "tensor(float16)"}, "Constrain input and output float tensors types.")
+      .TypeConstraint("T2", {"tensor(float)", "tensor(float16)", "tensor(bfloat16)", "tensor(int8)", "tensor(uint8)"},
+                      "Constrain word_embedding to float, half precision or 8-bit integer tensors.")
       .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
-        propagateElemTypeFromInputToOutput(ctx, 2, 0);
+        propagateElemTypeFromInputToOutput(ctx, 5, 0);
         propagateElemTypeFromInputToOutput(ctx, 0, 1);
         if (!hasInputShape(ctx, 0))
           return;
@@ -1819,6 +1827,41 @@ Matrix product that behaves like numpy.matmul: https://docs.scipy.org/doc/numpy-
         ONNX_NAMESPACE::matmulShapeInference(ctx, 0, 1);
       });
 
+  static const char* DequantizeGather_ver1_doc = R"DOC(
+Gathers rows of a 2D embedding table and converts them to float, like a Gather on axis 0 of the float table.
+The table is a float16 or bfloat16 tensor, or an 8-bit integer tensor quantized per row: row i is
+(data[i] - zero_point[i]) * scale[i]. Only the gathered rows are converted.)DOC";
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(DequantizeGather)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(DequantizeGather_ver1_doc)
+      .Input(0, "data", "2D embedding table with shape (num_rows, row_size)", "T1")
+      .Input(1, "indices", "Tensor of the indices of the rows to gather", "Tind")
+      .Input(2, "scale", "1D scale of each row with shape (num_rows). Required if data is quantized.", "tensor(float)",
+             OpSchema::Optional)
+      .Input(3, "zero_point", "1D zero point of each row with shape (num_rows). Default is 0.", "T1",
+             OpSchema::Optional)
+      .Output(0, "output", "Tensor of shape indices.shape + (row_size)", "tensor(float)")
+      .TypeConstraint("T1", {"tensor(float16)", "tensor(bfloat16)", "tensor(int8)", "tensor(uint8)"},
+                      "Constrain the table to half precision or 8-bit integer tensors.")
+      .TypeConstraint("Tind", {"tensor(int32)", "tensor(int64)"}, "Constrain indices to integer types")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::updateOutputElemType(ctx, 0, ONNX_NAMESPACE::TensorProto::FLOAT);
+        if (!hasInputShape(ctx, 0) || !hasInputShape(ctx, 1)) {
+          return;
+        }
+
+        const auto& data_shape = getInputShape(ctx, 0);
+        if (data_shape.dim_size() != 2) {
+          fail_shape_inference("data must have 2 dimensions");
+        }
+
+        ONNX_NAMESPACE::TensorShapeProto output_shape = getInputShape(ctx, 1);
+        *output_shape.add_dim() = data_shape.dim(1);
+        updateOutputShape(ctx, 0, output_shape);
+      });
+
   ONNX_CONTRIB_OPERATOR_SCHEMA(MatMulIntegerToFloat)
       .SetDomain(kMSDomain)
       .SinceVersion(1)
@@ -2655,14 +2698,55 @@ Example 4:
             "The distance metric to use. If a string, the distance function can be \"braycurtis\", \"canberra\", "
             "\"chebyshev\", \"cityblock\", \"correlation\", \"cosine\", \"dice\", \"euclidean\", \"hamming\", \"jaccard\", "
             "\"jensenshannon\", \"kulsinski\", \"mahalanobis\", \"matching\", \"minkowski\", \"rogerstanimoto\", \"russellrao\", "
-            "\"seuclidean\", \"sokalmichener\", \"sokalsneath\", \"sqeuclidean\", \"wminkowski\", \"yule\".",
+            "\"seuclidean\", \"sokalmichener\", \"sokalsneath\", \"sqeuclidean\", \"wminkowski\", \"yule\", "
+            "or \"inner_product\", which is the dot product of the rows and so a similarity rather than a distance. "
+            "The CPU kernel supports \"euclidean\", \"sqeuclidean\", \"cosine\" and \"inner_product\".",
             AttributeProto::STRING, std::string("sqeuclidean"))
+      .Attr("k",
+            "If greater than 0, only the k nearest rows of B to each row of A are returned, nearest first, instead "
+            "of the full distance matrix. The nearest rows are those with the smallest distance, or the largest "
+            "value for \"inner_product\". Ties are broken by the lower row index. k can't be larger than K.",
+            AttributeProto::INT, static_cast<int64_t>(0))
       .Input(0, "A", "2D matrix with shape (M,N)", "T")
       .Input(1, "B", "2D matrix with shape (K,N)", "T")
       .Output(0, "C",
-              "A 2D Matrix that represents the distance between each pair of the two collections of inputs.",
+              "A 2D Matrix that represents the distance between each pair of the two collections of inputs. "
+              "Its shape is (M,K), or (M,k) with the distances of the k nearest rows of B if k is greater than 0.",
               "T")
-      .TypeConstraint("T", {"tensor(float)", "tensor(double)"}, "Constrains input to only numeric types.");
+      .Output(1, "indices",
+              "The row indices in B of the distances in C, with shape (M,k). Only produced if k is greater than 0.",
+              "tensor(int64)", OpSchema::Optional)
+      .TypeConstraint("T", {"tensor(float)", "tensor(double)"}, "Constrains input to only numeric types.")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        if (ctx.getNumOutputs() > 1) {
+          updateOutputElemType(ctx, 1, ONNX_NAMESPACE::TensorProto::INT64);
+        }
+
+        if (!hasInputShape(ctx, 0) || !hasInputShape(ctx, 1)) {
+          return;
+        }
+
+        const auto& a_shape = getInputShape(ctx, 0);
+        const auto& b_shape = getInputShape(ctx, 1);
+        if (a_shape.dim_size() != 2 || b_shape.dim_size() != 2) {
+          fail_shape_inference("Inputs A and B must be 2D matrices");
+        }
+
+        const int64_t k = getAttribute(ctx, "k", 0);
+        ONNX_NAMESPACE::TensorShapeProto output_shape;
+        *output_shape.add_dim() = a_shape.dim(0);
+        if (k > 0) {
+          output_shape.add_dim()->set_dim_value(k);
+          if (ctx.getNumOutputs() > 1) {
+            updateOutputShape(ctx, 1, output_shape);
+          }
+        } else {
+          *output_shape.add_dim() = b_shape.dim(0);
+        }
+
+        updateOutputShape(ctx, 0, output_shape);
+      });
 
   ONNX_CONTRIB_OPERATOR_SCHEMA(CropAndResize)
       .SetDomain(kMSDomain)
@@ -3052,6 +3136,139 @@ It's an extension of Gelu. It takes the sum of input A and bias input B as the i
           "Constrain input and output types to float tensors.")
       .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
 
+  static const char* BeamSearch_ver1_doc = R"DOC(
+Generates token sequences from a GPT-2 style decoder using beam search.
+
+The 'decoder' subgraph is run once per generated token. It has 3 + L inputs:
+(input_ids, position_ids, attention_mask, past_0, ..., past_{L-1}) and 1 + L outputs:
+(logits, present_0, ..., present_{L-1}), where L is the number of layers.
+input_ids and position_ids are int32 or int64 with shape (batch_size * num_beams, sequence_length),
+attention_mask is float, int32 or int64 with shape (batch_size * num_beams, past_sequence_length + sequence_length),
+past_i and present_i are float with shape (2, batch_size * num_beams, num_heads, past_sequence_length, head_size)
+and (2, batch_size * num_beams, num_heads, past_sequence_length + sequence_length, head_size) respectively, and
+logits is float with shape (batch_size * num_beams, sequence_length, vocab_size).
+The key/value cache is kept in buffers allocated once for max_length and reordered by beam in place
+between steps.
+)DOC";
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(BeamSearch)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(BeamSearch_ver1_doc)
+      .Attr("decoder", "The decoder subgraph run for each generated token.", AttributeProto::GRAPH)
+      .Attr("eos_token_id", "The id of the end-of-sequence token.", AttributeProto::INT)
+      .Attr("pad_token_id", "The id used to pad finished sequences up to max_length.", AttributeProto::INT)
+      .Attr("early_stopping",
+            "If 1, stop beam search for a batch entry as soon as num_beams finished hypotheses are found.",
+            AttributeProto::INT, static_cast<int64_t>(0))
+      .Input(0, "input_ids", "The prompt, with shape (batch_size, sequence_length).", "I")
+      .Input(1, "max_length", "The maximum length of the generated sequences, including the prompt. Scalar.", "I")
+      .Input(2, "min_length",
+             "The minimum length of the generated sequences, including the prompt. Scalar. "
+             "The end-of-sequence token is suppressed until it is reached.",
+             "I", OpSchema::Optional)
+      .Input(3, "num_beams", "The number of beams per batch entry. Scalar.", "I")
+      .Input(4, "num_return_sequences",
+             "The number of sequences returned per batch entry. Scalar, at most num_beams.", "I")
+      .Input(5, "length_penalty",
+             "Exponent of the length used to normalize the score of finished hypotheses. Scalar. Default 1.",
+             "T", OpSchema::Optional)
+      .Input(6, "repetition_penalty",
+             "Penalty applied to the logits of tokens already in a sequence. Scalar. Default 1 (no penalty).",
+             "T", OpSchema::Optional)
+      .Input(7, "attention_mask",
+             "Mask of the prompt with shape (batch_size, sequence_length). 0 marks (left) padding.",
+             "I", OpSchema::Optional)
+      .Output(0, "sequences", "The generated sequences with shape (batch_size, num_return_sequences, max_length).",
+              "I")
+      .Output(1, "sequences_scores", "The score of each sequence with shape (batch_size, num_return_sequences).",
+              "T", OpSchema::Optional)
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain scores to float tensors.")
+      .TypeConstraint("I", {"tensor(int32)"}, "Constrain token ids and sizes to int32 tensors.")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        updateOutputElemType(ctx, 0, ONNX_NAMESPACE::TensorProto::INT32);
+        if (ctx.getNumOutputs() > 1) {
+          updateOutputElemType(ctx, 1, ONNX_NAMESPACE::TensorProto::FLOAT);
+        }
+
+        // The number of sequences and their length depend on the values of the inputs,
+        // so only the batch dimension and the rank can be inferred.
+        if (!hasInputShape(ctx, 0)) {
+          return;
+        }
+        auto& input_ids_shape = getInputShape(ctx, 0);
+        if (input_ids_shape.dim_size() != 2) {
+          fail_shape_inference("input_ids shall be 2 dimensions");
+        }
+
+        ONNX_NAMESPACE::TensorShapeProto sequences_shape;
+        *sequences_shape.add_dim() = input_ids_shape.dim(0);
+        sequences_shape.add_dim();
+        sequences_shape.add_dim();
+        updateOutputShape(ctx, 0, sequences_shape);
+
+        if (ctx.getNumOutputs() > 1) {
+          ONNX_NAMESPACE::TensorShapeProto scores_shape;
+          *scores_shape.add_dim() = input_ids_shape.dim(0);
+          scores_shape.add_dim();
+          updateOutputShape(ctx, 1, scores_shape);
+        }
+      });
+
+  static const char* GreedySearch_ver1_doc = R"DOC(
+Generates token sequences from a GPT-2 style decoder by greedy decoding, or by sampling with optional top-k and
+top-p (nucleus) filtering.
+
+The 'decoder' subgraph has the same inputs and outputs as for BeamSearch, with one sequence per batch entry.
+)DOC";
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(GreedySearch)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(GreedySearch_ver1_doc)
+      .Attr("decoder", "The decoder subgraph run for each generated token.", AttributeProto::GRAPH)
+      .Attr("eos_token_id", "The id of the end-of-sequence token.", AttributeProto::INT)
+      .Attr("pad_token_id", "The id used to pad finished sequences up to max_length.", AttributeProto::INT)
+      .Attr("do_sample", "If 1, sample the next token instead of choosing the most likely one.",
+            AttributeProto::INT, static_cast<int64_t>(0))
+      .Attr("top_k", "If greater than 0, only sample from the top_k most likely tokens.",
+            AttributeProto::INT, static_cast<int64_t>(0))
+      .Attr("top_p",
+            "If less than 1, only sample from the most likely tokens whose cumulative probability reaches top_p.",
+            AttributeProto::FLOAT, 1.0f)
+      .Attr("seed", "Seed of the random number generator used for sampling. 0 to use a random seed.",
+            AttributeProto::INT, static_cast<int64_t>(0))
+      .Input(0, "input_ids", "The prompt, with shape (batch_size, sequence_length).", "I")
+      .Input(1, "max_length", "The maximum length of the generated sequences, including the prompt. Scalar.", "I")
+      .Input(2, "min_length",
+             "The minimum length of the generated sequences, including the prompt. Scalar. "
+             "The end-of-sequence token is suppressed until it is reached.",
+             "I", OpSchema::Optional)
+      .Input(3, "repetition_penalty",
+             "Penalty applied to the logits of tokens already in a sequence. Scalar. Default 1 (no penalty).",
+             "T", OpSchema::Optional)
+      .Input(4, "attention_mask",
+             "Mask of the prompt with shape (batch_size, sequence_length). 0 marks (left) padding.",
+             "I", OpSchema::Optional)
+      .Output(0, "sequences", "The generated sequences with shape (batch_size, max_length).", "I")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain scores to float tensors.")
+      .TypeConstraint("I", {"tensor(int32)"}, "Constrain token ids and sizes to int32 tensors.")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        updateOutputElemType(ctx, 0, ONNX_NAMESPACE::TensorProto::INT32);
+        if (!hasInputShape(ctx, 0)) {
+          return;
+        }
+        auto& input_ids_shape = getInputShape(ctx, 0);
+        if (input_ids_shape.dim_size() != 2) {
+          fail_shape_inference("input_ids shall be 2 dimensions");
+        }
+
+        ONNX_NAMESPACE::TensorShapeProto sequences_shape;
+        *sequences_shape.add_dim() = input_ids_shape.dim(0);
+        sequences_shape.add_dim();
+        updateOutputShape(ctx, 0, sequences_shape);
+      });
+
   RegisterBertSchemas();
 }
 }  // namespace contrib
@@ -0,0 +1,247 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/embedding_table_compression.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/graph/graph_utils.h"
+#include "core/graph/graph_viewer.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/optimizer/initializer.h"
+#include "core/util/math.h"
+
+namespace onnxruntime {
+
+namespace {
+constexpr int kGatherDataIndex = 0;
+constexpr int kEmbedLayerNormWordEmbeddingIndex = 2;
+constexpr int kEmbedLayerNormWordEmbeddingScaleIndex = 8;
+constexpr int kEmbedLayerNormWordEmbeddingZeroPointIndex = 9;
+
+// The input index of the table if node can look up the rows of a compressed table, or -1.
+int GetTableInputIndex(const Node& node) {
+  if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "Gather", {1, 11, 13})) {
+    const auto* axis = graph_utils::GetNodeAttribute(node, "axis");
+    if (axis != nullptr && axis->i() != 0 && axis->i() != -2) {
+      return -1;
+    }
+
+    return kGatherDataIndex;
+  }
+
+  // the scale and zero point inputs must be free
+  if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "EmbedLayerNormalization", {1}, kMSDomain) &&
+      node.InputDefs().size() <= static_cast<size_t>(kEmbedLayerNormWordEmbeddingScaleIndex)) {
+    return kEmbedLayerNormWordEmbeddingIndex;
+  }
+
+  return -1;
+}
+
+// Quantizes each row to int8 with the scale and zero point of the range of the row, extended to include 0.
+void QuantizeRows(const float* data, int64_t row_count, int64_t row_size, int8_t* quantized, float* scales,
+                  int8_t* zero_points) {
+  for (int64_t r = 0; r < row_count; ++r) {
+    const float* row = data + r * row_size;
+    const auto min_max = std::minmax_element(row, row + row_size);
+    const float min = std::min(*min_max.first, 0.0f);
+    const float max = std::max(*min_max.second, 0.0f);
+
+    const float scale = (max == min) ? 1.0f : (max - min) / 255.0f;
+    const float zero_point = std::round(-128.0f - min / scale);
+    scales[r] = scale;
+    zero_points[r] = static_cast<int8_t>(std::max(-128.0f, std::min(127.0f, zero_point)));
+    MlasQuantizeLinear(row, quantized + r * row_size, static_cast<size_t>(row_size), scale, zero_points[r]);
+  }
+}
+
+NodeArg& AddTensor(Graph& graph, const std::string& name, ONNX_NAMESPACE::TensorProto_DataType data_type,
+                   const std::vector<int64_t>& dims, const void* data, size_t byte_count) {
+  ONNX_NAMESPACE::TensorProto tensor_proto;
+  tensor_proto.set_name(graph.GenerateNodeArgName(name));
+  tensor_proto.set_data_type(data_type);
+  for (const auto dim : dims) {
+    tensor_proto.add_dims(dim);
+  }
+
+  tensor_proto.set_raw_data(data, byte_count);
+  return graph_utils::AddInitializer(graph, tensor_proto);
+}
+}  // namespace
+
+Status EmbeddingTableCompression::ParseFormat(const std::string& value, Format& format) {
+  if (value == "float16") {
+    format = Format::Float16;
+  } else if (value == "bfloat16") {
+    format = Format::BFloat16;
+  } else if (value == "int8") {
+    format = Format::Int8;
+  } else {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid embedding table format '", value,
+                           "'. Valid values are float16, bfloat16 and int8.");
+  }
+
+  return Status::OK();
+}
+
+bool EmbeddingTableCompression::IsCompressible(const Graph& graph, const ONNX_NAMESPACE::TensorProto& table) const {
+  const std::string& name = table.name();
+  if (table.data_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT || table.dims_size() != 2 ||
+      !graph_utils::IsConstantInitializer(graph, name, false)) {
+    return false;
+  }
+
+  const NodeArg* table_arg = graph.GetNodeArg(name);
+  if (table_arg == nullptr || graph.IsOutput(table_arg)) {
+    return false;
+  }
+
+  const auto consumers = graph.GetConsumerNodes(name);
+  if (consumers.empty()) {
+    return false;
+  }
+
+  for (const Node* consumer : consumers) {
+    if (!graph_utils::IsSupportedProvider(*consumer, GetCompatibleExecutionProviders())) {
+      return false;
+    }
+
+    const int table_index = GetTableInputIndex(*consumer);
+    if (table_index < 0) {
+      return false;
+    }
+
+    // the table can't be used by any other input of the node, nor by its subgraphs
+    const auto& input_defs = consumer->InputDefs();
+    for (int i = 0; i < static_cast<int>(input_defs.size()); ++i) {
+      if (input_defs[i] == table_arg && i != table_index) {
+        return false;
+      }
+    }
+
+    if (input_defs[table_index] != table_arg ||
+        std::find(consumer->ImplicitInputDefs().cbegin(), consumer->ImplicitInputDefs().cend(), table_arg) !=
+            consumer->ImplicitInputDefs().cend()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void EmbeddingTableCompression::Compress(Graph& graph, const std::string& name) const {
+  const ONNX_NAMESPACE::TensorProto* table = nullptr;
+  ORT_ENFORCE(graph.GetInitializedTensor(name, table));
+  Initializer initializer{*table, graph.ModelPath()};
+  const std::vector<int64_t> dims = initializer.dims();
+  const int64_t row_count = dims[0];
+  const int64_t row_size = dims[1];
+  const size_t size = static_cast<size_t>(initializer.size());
+  const float* data = initializer.data<float>();
+
+  NodeArg* table_arg = nullptr;
+  NodeArg* scale_arg = nullptr;
+  NodeArg* zero_point_arg = nullptr;
+  switch (format_) {
+    case Format::Float16: {
+      std::vector<MLFloat16> compressed(size);
+      std::transform(data, data + size, compressed.begin(),
+                     [](float value) { return MLFloat16(math::floatToHalf(value)); });
+      table_arg = &AddTensor(graph, name + "_float16", ONNX_NAMESPACE::TensorProto_DataType_FLOAT16, dims,
+                             compressed.data(), size * sizeof(MLFloat16));
+      break;
+    }
+    case Format::BFloat16: {
+      std::vector<BFloat16> compressed(size);
+      FloatToBFloat16(data, compressed.data(), size);
+      table_arg = &AddTensor(graph, name + "_bfloat16", ONNX_NAMESPACE::TensorProto_DataType_BFLOAT16, dims,
+                             compressed.data(), size * sizeof(BFloat16));
+      break;
+    }
+    case Format::Int8: {
+      std::vector<int8_t> compressed(size);
+      std::vector<float> scales(static_cast<size_t>(row_count));
+      std::vector<int8_t> zero_points(static_cast<size_t>(row_count));
+      QuantizeRows(data, row_count, row_size, compressed.data(), scales.data(), zero_points.data());
+      table_arg = &AddTensor(graph, name + "_quantized", ONNX_NAMESPACE::TensorProto_DataType_INT8, dims,
+                             compressed.data(), size * sizeof(int8_t));
+      scale_arg = &AddTensor(graph, name + "_scale", ONNX_NAMESPACE::TensorProto_DataType_FLOAT, {row_count},
+                             scales.data(), scales.size() * sizeof(float));
+      zero_point_arg = &AddTensor(graph, name + "_zero_point", ONNX_NAMESPACE::TensorProto_DataType_INT8,
+                                  {row_count}, zero_points.data(), zero_points.size() * sizeof(int8_t));
+      break;
+    }
+  }
+
+  std::vector<NodeIndex> consumer_indices;
+  for (const Node* consumer : graph.GetConsumerNodes(name)) {
+    consumer_indices.push_back(consumer->Index());
+  }
+
+  for (const NodeIndex index : consumer_indices) {
+    Node& node = *graph.GetNode(index);
+    if (node.OpType() == "Gather") {
+      std::vector<NodeArg*> input_defs{table_arg, node.MutableInputDefs()[1]};
+      if (scale_arg != nullptr) {
+        input_defs.push_back(scale_arg);
+        input_defs.push_back(zero_point_arg);
+      }
+
+      Node& dequantize_gather = graph.AddNode(graph.GenerateNodeName(node.Name() + "_DequantizeGather"),
+                                              "DequantizeGather",
+                                              "Gather from a compressed embedding table",
+                                              input_defs,
+                                              {},
+                                              nullptr,
+                                              kMSDomain);
+      dequantize_gather.SetExecutionProviderType(node.GetExecutionProviderType());
+      // moves the edge of the indices and the outputs, and removes the Gather
+      std::vector<std::reference_wrapper<Node>> nodes_to_replace{node};
+      graph_utils::FinalizeNodeFusion(graph, nodes_to_replace, dequantize_gather);
+    } else {
+      graph_utils::ReplaceNodeInput(node, kEmbedLayerNormWordEmbeddingIndex, *table_arg);
+      if (scale_arg != nullptr) {
+        // skip the missing optional inputs before the scale
+        for (int i = static_cast<int>(node.InputDefs().size()); i < kEmbedLayerNormWordEmbeddingScaleIndex; ++i) {
+          graph_utils::AddNodeInput(node, i, graph.GetOrCreateNodeArg("", nullptr));
+        }
+
+        graph_utils::AddNodeInput(node, kEmbedLayerNormWordEmbeddingScaleIndex, *scale_arg);
+        graph_utils::AddNodeInput(node, kEmbedLayerNormWordEmbeddingZeroPointIndex, *zero_point_arg);
+      }
+    }
+  }
+
+  graph.RemoveInitializedTensor(name);
+}
+
+Status EmbeddingTableCompression::ApplyImpl(Graph& graph, bool& modified, int graph_level,
+                                            const logging::Logger& logger) const {
+  GraphViewer graph_viewer(graph);
+  for (auto node_index : graph_viewer.GetNodesInTopologicalOrder()) {
+    auto* node = graph.GetNode(node_index);
+    if (node != nullptr) {
+      ORT_RETURN_IF_ERROR(Recurse(*node, modified, graph_level, logger));
+    }
+  }
+
+  // collect the tables first, as compressing them modifies the initializers
+  std::vector<std::string> table_names;
+  for (const auto& entry : graph.GetAllInitializedTensors()) {
+    if (IsCompressible(graph, *entry.second)) {
+      table_names.push_back(entry.first);
+    }
+  }
+
+  for (const auto& name : table_names) {
+    Compress(graph, name);
+    LOGS(logger, INFO) << "Compressed embedding table " << name;
+    modified = true;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class EmbeddingTableCompression
+
+Lossy transformer that stores the float embedding tables of Gather and EmbedLayerNormalization nodes as float16,
+bfloat16 or per row quantized int8, which the kernels dequantize as they look up the rows.
+
+A table is compressed when it's a 2D float constant initializer that's only used as the data of Gather nodes
+on axis 0, which are replaced by DequantizeGather, and as the word_embedding of EmbedLayerNormalization nodes.
+Enabled with the kOrtSessionOptionsConfigEmbeddingTableFormat session option.
+*/
+class EmbeddingTableCompression : public GraphTransformer {
+ public:
+  enum class Format {
+    Float16,
+    BFloat16,
+    Int8,
+  };
+
+  EmbeddingTableCompression(Format format,
+                            const std::unordered_set<std::string>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("EmbeddingTableCompression", compatible_execution_providers), format_(format) {}
+
+  // Parses the value of kOrtSessionOptionsConfigEmbeddingTableFormat: "float16", "bfloat16" or "int8".
+  static Status ParseFormat(const std::string& value, Format& format);
+
+ private:
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+
+  bool IsCompressible(const Graph& graph, const ONNX_NAMESPACE::TensorProto& table) const;
+
+  void Compress(Graph& graph, const std::string& name) const;
+
+  const Format format_;
+};
+
+}  // namespace onnxruntime
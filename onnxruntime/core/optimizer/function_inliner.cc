@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/function_inliner.h"
+
+#include "core/common/logging/logging.h"
+#include "core/graph/function.h"
+
+namespace onnxruntime {
+
+bool FunctionInliner::HasKernel(const Node& node) const {
+  for (const auto& provider_type : provider_types_) {
+    if (KernelRegistryManager::HasImplementationOf(registry_manager_.get(), node, provider_type)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+Status FunctionInliner::ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const {
+  for (auto& node : graph.Nodes()) {
+    ORT_RETURN_IF_ERROR(Recurse(node, modified, graph_level, logger));
+  }
+
+  // the body of a function may use other function ops, so repeat until none of the nodes can be inlined
+  std::vector<Node*> nodes_to_inline;
+  do {
+    nodes_to_inline.clear();
+    for (auto& node : graph.Nodes()) {
+      // nodes already assigned to a provider are handled by it
+      if (node.GetExecutionProviderType().empty() && !HasKernel(node) && nullptr != node.GetFunctionBody()) {
+        nodes_to_inline.push_back(&node);
+      }
+    }
+
+    for (auto* node : nodes_to_inline) {
+      LOGS(logger, VERBOSE) << "Inlining the body of " << node->OpType() << " node " << node->Name();
+      ORT_RETURN_IF_ERROR(graph.InlineFunction(*node));
+      modified = true;
+    }
+  } while (!nodes_to_inline.empty());
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
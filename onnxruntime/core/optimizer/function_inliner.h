@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <functional>
+
+#include "core/common/common.h"
+#include "core/framework/kernel_registry_manager.h"
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class FunctionInliner
+
+Transformer that replaces the nodes of function ops none of the execution providers has a kernel for with the nodes
+of the function body. It runs before the level 1 transformers, so fusions such as Gelu and LayerNormalization match
+across the function boundary. Nodes of function ops with a kernel are left as they are.
+*/
+class FunctionInliner : public GraphTransformer {
+ public:
+  FunctionInliner(const std::vector<std::string>& provider_types, const KernelRegistryManager& registry_manager)
+      : GraphTransformer("FunctionInliner"), provider_types_(provider_types), registry_manager_(std::cref(registry_manager)) {}
+
+ private:
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+
+  bool HasKernel(const Node& node) const;
+
+  const std::vector<std::string> provider_types_;
+  std::reference_wrapper<const KernelRegistryManager> registry_manager_;
+};
+
+}  // namespace onnxruntime
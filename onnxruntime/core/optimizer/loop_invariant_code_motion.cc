@@ -0,0 +1,278 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/loop_invariant_code_motion.h"
+
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/graph_utils.h"
+#include "core/optimizer/utils.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+
+namespace onnxruntime {
+
+namespace {
+
+// Returns true if the name of the value is free to be used for a value of the graph containing the loop.
+// Hoisted values keep their names so the body can still refer to them.
+bool IsNameAvailable(Graph& graph, const std::string& name) {
+  return graph.GetNodeArgIncludingParentGraphs(name) == nullptr;
+}
+
+// Returns true if the value is a constant scalar initializer of the given type, and sets value to it.
+template <typename T>
+bool GetConstantScalar(const Graph& graph, const NodeArg& node_arg, ONNX_NAMESPACE::TensorProto_DataType data_type,
+                       T& value) {
+  const auto* tensor_proto = graph_utils::GetConstantInitializer(graph, node_arg.Name());
+  if (tensor_proto == nullptr || tensor_proto->data_type() != data_type) {
+    return false;
+  }
+  int64_t size = 1;
+  for (auto dim : tensor_proto->dims()) {
+    size *= dim;
+  }
+  return size == 1 && utils::UnpackTensor(*tensor_proto, &value, 1).IsOK();
+}
+
+// Returns true if the body of the Loop or Scan node is known to run at least once. Hoisting a node out of a body
+// that doesn't run would compute it when it otherwise wouldn't be, which is only safe for nodes that can't fail.
+bool RunsAtLeastOnce(const Graph& graph, const Node& node) {
+  const auto& inputs = node.InputDefs();
+  if (node.OpType() == "Loop") {
+    // the body runs once if the trip count is absent or positive, and the initial condition is absent or true.
+    int64_t trip_count = 0;
+    if (!inputs.empty() && inputs[0]->Exists() &&
+        !(GetConstantScalar(graph, *inputs[0], TensorProto_DataType_INT64, trip_count) && trip_count > 0)) {
+      return false;
+    }
+    bool cond = false;
+    if (inputs.size() > 1 && inputs[1]->Exists() &&
+        !(GetConstantScalar(graph, *inputs[1], TensorProto_DataType_BOOL, cond) && cond)) {
+      return false;
+    }
+    return true;
+  }
+
+  // Scan runs its body once per element of the scan axis of its scan inputs, which all have the same length.
+  // Scan 8 has a leading batch axis and optional per batch sequence lengths that may be 0.
+  const bool has_batch_axis = node.SinceVersion() == 8;
+  if (has_batch_axis && !inputs.empty() && inputs[0]->Exists()) {
+    return false;
+  }
+  const auto& attributes = node.GetAttributes();
+  auto num_scan_inputs_attr = attributes.find("num_scan_inputs");
+  if (num_scan_inputs_attr == attributes.end() || num_scan_inputs_attr->second.i() < 1 ||
+      static_cast<size_t>(num_scan_inputs_attr->second.i()) > inputs.size()) {
+    return false;
+  }
+  const NodeArg& scan_input = *inputs[inputs.size() - static_cast<size_t>(num_scan_inputs_attr->second.i())];
+  const auto* shape = scan_input.Shape();
+  if (shape == nullptr) {
+    return false;
+  }
+
+  int64_t axis = has_batch_axis ? 1 : 0;
+  auto axes_attr = attributes.find("scan_input_axes");
+  if (!has_batch_axis && axes_attr != attributes.end() && axes_attr->second.ints_size() > 0) {
+    axis = axes_attr->second.ints(0);
+  }
+  if (axis < 0) {
+    axis += shape->dim_size();
+  }
+  if (axis < 0 || axis >= shape->dim_size()) {
+    return false;
+  }
+  auto has_positive_dim = [shape](int64_t i) {
+    return shape->dim(static_cast<int>(i)).has_dim_value() && shape->dim(static_cast<int>(i)).dim_value() > 0;
+  };
+  return has_positive_dim(axis) && (!has_batch_axis || has_positive_dim(0));
+}
+
+// Returns true if the node can't fail on inputs of a valid type and has no side effects, so it can be hoisted out of
+// a loop that may not run. The only cost of doing so is computing a value that may not be used.
+bool IsSafeToSpeculate(const Node& node) {
+  static const std::unordered_set<std::string> safe_ops = {
+      "Abs", "Ceil", "Exp", "Floor", "Identity", "Log", "Neg", "Not", "Reciprocal",
+      "Relu", "Shape", "Sigmoid", "Sign", "Size", "Sqrt", "Tanh"};
+  return node.Domain() == kOnnxDomain && safe_ops.count(node.OpType()) > 0;
+}
+
+// Find the nodes of body that only depend on outer scope values, constant initializers of body, and the outputs
+// of other such nodes. If the body may not run, only nodes that are safe to speculate are hoisted.
+// The nodes are returned in an order in which they can be added to the graph.
+std::vector<Node*> FindInvariantNodes(Graph& graph, Graph& body, bool runs_at_least_once,
+                                      std::unordered_set<std::string>& initializers) {
+  std::unordered_set<std::string> body_outputs;
+  for (const auto* output : body.GetOutputs()) {
+    body_outputs.insert(output->Name());
+  }
+
+  std::unordered_set<std::string> invariant_values;
+  std::unordered_set<const Node*> hoisted;
+  std::vector<Node*> invariant_nodes;
+
+  auto is_invariant_input = [&](const NodeArg& input) {
+    const auto& name = input.Name();
+    if (invariant_values.count(name) > 0 || body.IsOuterScopeValue(name)) {
+      return true;
+    }
+    if (graph_utils::IsConstantInitializer(body, name, false) && IsNameAvailable(graph, name)) {
+      initializers.insert(name);
+      return true;
+    }
+    return false;
+  };
+
+  // hoisting a node makes its outputs invariant, which may allow hoisting its consumers. as the body may
+  // contain nodes added since it was last resolved, repeat until nothing changes instead of relying on the
+  // topological order.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto& node : body.Nodes()) {
+      if (hoisted.count(&node) > 0 || node.InputDefs().empty() || node.ContainsSubgraph() ||
+          !optimizer_utils::IsOperationDeterministic(node.Domain(), node.OpType()) ||
+          (!runs_at_least_once && !IsSafeToSpeculate(node))) {
+        continue;
+      }
+
+      bool is_invariant = std::all_of(node.InputDefs().cbegin(), node.InputDefs().cend(),
+                                      [&](const NodeArg* input) {
+                                        return !input->Exists() || is_invariant_input(*input);
+                                      });
+
+      // outputs of the body are fetched from the body's own values, so nodes producing them stay.
+      is_invariant = is_invariant &&
+                     std::all_of(node.OutputDefs().cbegin(), node.OutputDefs().cend(), [&](const NodeArg* output) {
+                       return !output->Exists() ||
+                              (body_outputs.count(output->Name()) == 0 && IsNameAvailable(graph, output->Name()));
+                     });
+
+      if (is_invariant) {
+        for (const auto* output : node.OutputDefs()) {
+          invariant_values.insert(output->Name());
+        }
+        hoisted.insert(&node);
+        invariant_nodes.push_back(&node);
+        changed = true;
+      }
+    }
+  }
+
+  // only copy initializers used by the nodes being hoisted.
+  std::unordered_set<std::string> used_initializers;
+  for (const auto* node : invariant_nodes) {
+    for (const auto* input : node->InputDefs()) {
+      if (initializers.count(input->Name()) > 0) {
+        used_initializers.insert(input->Name());
+      }
+    }
+  }
+  initializers.swap(used_initializers);
+
+  return invariant_nodes;
+}
+
+Status HoistInvariantNodes(Graph& graph, Graph& body, bool runs_at_least_once, bool& modified,
+                           const logging::Logger& logger) {
+  std::unordered_set<std::string> initializers;
+  std::vector<Node*> invariant_nodes = FindInvariantNodes(graph, body, runs_at_least_once, initializers);
+  if (invariant_nodes.empty()) {
+    return Status::OK();
+  }
+
+  // the initializers may still be used by nodes remaining in the body, so copy them rather than move them.
+  for (const auto& name : initializers) {
+    const TensorProto* initializer = nullptr;
+    body.GetInitializedTensor(name, initializer);
+    graph.AddInitializedTensor(*initializer);
+  }
+
+  auto get_or_create_node_arg = [&graph](const NodeArg* node_arg) -> NodeArg* {
+    if (!node_arg->Exists()) {
+      return &graph.GetOrCreateNodeArg("", nullptr);
+    }
+    return &graph.GetOrCreateNodeArg(node_arg->Name(), node_arg->TypeAsProto());
+  };
+
+  for (auto* node : invariant_nodes) {
+    std::vector<NodeArg*> inputs;
+    std::vector<NodeArg*> outputs;
+    for (const auto* input : node->InputDefs()) {
+      inputs.push_back(get_or_create_node_arg(input));
+    }
+    for (const auto* output : node->OutputDefs()) {
+      outputs.push_back(get_or_create_node_arg(output));
+    }
+
+    Node& hoisted_node = graph.AddNode(graph.GenerateNodeName(node->Name()), node->OpType(), node->Description(),
+                                       inputs, outputs, &node->GetAttributes(), node->Domain());
+    hoisted_node.SetExecutionProviderType(node->GetExecutionProviderType());
+
+    LOGS(logger, VERBOSE) << "Hoisted loop invariant " << node->OpType() << " node '" << node->Name()
+                          << "' out of a subgraph of " << body.ParentNode()->OpType() << " node '"
+                          << body.ParentNode()->Name() << "'";
+  }
+
+  // the body refers to the hoisted values as outer scope values by the same names.
+  for (auto it = invariant_nodes.rbegin(), end = invariant_nodes.rend(); it != end; ++it) {
+    graph_utils::RemoveNodeOutputEdges(body, **it);
+    body.RemoveNode((*it)->Index());
+  }
+
+  // the consumer lookup of the body is not updated by removing nodes, so check the remaining nodes directly.
+  std::unordered_set<std::string> used_names;
+  for (const auto& node : body.Nodes()) {
+    for (const auto* input : node.InputDefs()) {
+      used_names.insert(input->Name());
+    }
+    for (const auto* input : node.ImplicitInputDefs()) {
+      used_names.insert(input->Name());
+    }
+  }
+  for (const auto* output : body.GetOutputs()) {
+    used_names.insert(output->Name());
+  }
+  for (const auto& name : initializers) {
+    if (used_names.count(name) == 0) {
+      body.RemoveInitializedTensor(name);
+    }
+  }
+
+  modified = true;
+  return Status::OK();
+}
+
+}  // namespace
+
+Status LoopInvariantCodeMotion::ApplyImpl(Graph& graph, bool& modified, int graph_level,
+                                          const logging::Logger& logger) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  for (NodeIndex i : order) {
+    auto* node = graph.GetNode(i);
+    if (!node) {
+      continue;
+    }
+
+    // process nested loops first so their invariant nodes can be hoisted further by this loop.
+    ORT_RETURN_IF_ERROR(Recurse(*node, modified, graph_level, logger));
+
+    if (!graph_utils::IsSupportedProvider(*node, GetCompatibleExecutionProviders()) ||
+        !(graph_utils::IsSupportedOptypeVersionAndDomain(*node, "Loop", {1, 11}) ||
+          graph_utils::IsSupportedOptypeVersionAndDomain(*node, "Scan", {8, 9, 11}))) {
+      continue;
+    }
+
+    Graph* body = node->GetMutableGraphAttribute("body");
+    if (body != nullptr) {
+      ORT_RETURN_IF_ERROR(HoistInvariantNodes(graph, *body, RunsAtLeastOnce(graph, *node), modified, logger));
+    }
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
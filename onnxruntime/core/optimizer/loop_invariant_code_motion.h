@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class LoopInvariantCodeMotion
+
+Moves nodes in the body of a Loop or Scan that only depend on outer scope values and initializers out of the
+body, so they are computed once instead of in every iteration. The hoisted values are consumed by the body
+as implicit inputs of the Loop or Scan node.
+
+Nodes are only hoisted out of a body that is known to run at least once: a Loop with a constant positive trip count
+(or none) and a constant true condition (or none), or a Scan with a known non-empty scan axis. Otherwise hoisting
+could run a node that fails, e.g. on shapes that only match inside the loop, so only nodes that can't fail and have
+no side effects are hoisted.
+
+Nested loops are processed innermost first, so a value that is invariant in several enclosing loops moves to the
+outermost graph it can be computed in.
+*/
+class LoopInvariantCodeMotion : public GraphTransformer {
+ public:
+  LoopInvariantCodeMotion(const std::unordered_set<std::string>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("LoopInvariantCodeMotion", compatible_execution_providers) {
+  }
+
+ private:
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+};
+
+}  // namespace onnxruntime
@@ -68,6 +68,15 @@ struct ThreadOptions {
 
   // Set or unset denormal as zero.
   bool set_denormal_as_zero = false;
+
+  // If true, and the thread pool is allowed to spin, idle threads spin for a duration derived from
+  // the observed interval between arrivals of work rather than for a fixed number of iterations.
+  bool adaptive_spinning = false;
+
+  // If true, the thread pool's threads record how long they spend spinning and running work,
+  // reported through ThreadPool::GetSpinStats.  Off by default, as this reads the clock around
+  // every work item.
+  bool collect_stats = false;
 };
 /// \brief An interface used by the onnxruntime implementation to
 /// access operating system functionality like the filesystem etc.
@@ -188,6 +197,13 @@ class Env {
   // Mainly for use with protobuf library
   virtual common::Status FileClose(int fd) const = 0;
 
+  // Renames a file, replacing the destination if it exists. The replacement is atomic if both are on the same volume.
+  virtual common::Status RenameFile(const PathString& from, const PathString& to) const = 0;
+  // Deletes a file.
+  virtual common::Status RemoveFile(const PathString& path) const = 0;
+  // Gets the time of the last modification of a file, in seconds since the Unix epoch.
+  virtual common::Status GetFileModificationTime(const PathString& path, int64_t& seconds) const = 0;
+
   /** Gets the canonical form of a file path (symlinks resolved). */
   virtual common::Status GetCanonicalPath(
       const PathString& path,
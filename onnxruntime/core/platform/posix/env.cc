@@ -412,6 +412,29 @@ class PosixEnv : public Env {
     return Status::OK();
   }
 
+  common::Status RenameFile(const PathString& from, const PathString& to) const override {
+    if (rename(from.c_str(), to.c_str()) != 0) {
+      return ReportSystemError("rename", from);
+    }
+    return Status::OK();
+  }
+
+  common::Status RemoveFile(const PathString& path) const override {
+    if (unlink(path.c_str()) != 0) {
+      return ReportSystemError("unlink", path);
+    }
+    return Status::OK();
+  }
+
+  common::Status GetFileModificationTime(const PathString& path, int64_t& seconds) const override {
+    struct stat buf;
+    if (stat(path.c_str(), &buf) != 0) {
+      return ReportSystemError("stat", path);
+    }
+    seconds = static_cast<int64_t>(buf.st_mtime);
+    return Status::OK();
+  }
+
   common::Status GetCanonicalPath(
       const PathString& path,
       PathString& canonical_path) const override {
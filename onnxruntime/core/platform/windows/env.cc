@@ -374,6 +374,41 @@ class WindowsEnv : public Env {
     return final_status;
   }
 
+  common::Status RenameFile(const PathString& from, const PathString& to) const override {
+    if (!MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+      const auto err = GetLastError();
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "MoveFileEx() failed - path: ", ToMBString(from),
+                             ", error code: ", err);
+    }
+    return Status::OK();
+  }
+
+  common::Status RemoveFile(const PathString& path) const override {
+    if (!DeleteFileW(path.c_str())) {
+      const auto err = GetLastError();
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "DeleteFile() failed - path: ", ToMBString(path),
+                             ", error code: ", err);
+    }
+    return Status::OK();
+  }
+
+  common::Status GetFileModificationTime(const PathString& path, int64_t& seconds) const override {
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attributes)) {
+      const auto err = GetLastError();
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "GetFileAttributesEx() failed - path: ", ToMBString(path),
+                             ", error code: ", err);
+    }
+
+    // FILETIME is in 100ns intervals since 1601-01-01
+    ULARGE_INTEGER time;
+    time.LowPart = attributes.ftLastWriteTime.dwLowDateTime;
+    time.HighPart = attributes.ftLastWriteTime.dwHighDateTime;
+    constexpr ULONGLONG kUnixEpochOffset = 116444736000000000ULL;
+    seconds = static_cast<int64_t>((time.QuadPart - kUnixEpochOffset) / 10000000ULL);
+    return Status::OK();
+  }
+
   common::Status FileOpenRd(const std::wstring& path, /*out*/ int& fd) const override {
     _wsopen_s(&fd, path.c_str(), _O_RDONLY | _O_SEQUENTIAL | _O_BINARY, _SH_DENYWR, _S_IREAD | _S_IWRITE);
     if (0 > fd) {
@@ -16,10 +16,12 @@
 #include "core/framework/framework_common.h"
 #include "core/framework/op_kernel_context_internal.h"
 #include "core/framework/session_state.h"
+#include "core/framework/subgraph_execution_context.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/providers/cpu/tensor/utils.h"
 #include "core/framework/session_options.h"
+#include "core/platform/threadpool.h"
 
 #include "gsl/gsl"
 
@@ -164,6 +166,11 @@ class LoopImpl {
   void CreateInitialFeeds(std::vector<OrtValue>& feeds);
   void SaveOutputsAndUpdateFeeds(const std::vector<OrtValue>& last_outputs, std::vector<OrtValue>& next_inputs);
 
+  // custom allocator for the output of loop carried var 'index' that reuses the buffer of the value of the
+  // variable consumed by the previous iteration
+  Status ReuseLoopCarriedVarBuffer(int index, const OrtValue& current_value, const TensorShape& shape,
+                                   const OrtMemoryInfo& location, OrtValue& ort_value, bool& allocated);
+
   // create the single Loop output from a collection of per-iteration outputs
   Status ConcatenateLoopOutput(std::vector<OrtValue>& per_iteration_output, int output_index);
 
@@ -183,6 +190,11 @@ class LoopImpl {
   // the order from the subgraph matches the order from the loop output
   std::vector<std::vector<OrtValue>> loop_output_tensors_;
 
+  // value of each loop carried var consumed by the previous iteration. as loop carried vars have the same type and
+  // usually the same shape in every iteration, their buffers are alternated between iterations instead of
+  // allocating a new buffer for every output.
+  std::vector<OrtValue> spare_loop_carried_vars_;
+
   const Loop::ConcatOutput& concat_output_func_;
 };
 
@@ -377,6 +389,7 @@ Status LoopImpl::Initialize() {
   condition_mlvalue_ = MakeScalarMLValue<bool>(cpu_allocator, condition_, condition_rank);
 
   loop_output_tensors_.resize(info_.num_outputs - info_.num_loop_carried_vars);
+  spare_loop_carried_vars_.resize(info_.num_loop_carried_vars);
 
   return status;
 }
@@ -406,6 +419,10 @@ void LoopImpl::SaveOutputsAndUpdateFeeds(const std::vector<OrtValue>& last_outpu
 
   // simple copy for cond and loop carried vars. start at 1 to skip iter_num in input
   for (int i = 1; i < info_.num_subgraph_inputs; ++i) {
+    if (i > 1) {
+      spare_loop_carried_vars_[i - 2] = next_inputs[i];
+    }
+
     next_inputs[i] = last_outputs[i - 1];
   }
 
@@ -434,6 +451,27 @@ Status LoopImpl::ConcatenateLoopOutput(std::vector<OrtValue>& per_iteration_outp
   return Status::OK();
 }
 
+Status LoopImpl::ReuseLoopCarriedVarBuffer(int index, const OrtValue& current_value, const TensorShape& shape,
+                                           const OrtMemoryInfo& location, OrtValue& ort_value, bool& allocated) {
+  OrtValue& spare = spare_loop_carried_vars_[index];
+
+  // the spare value may still be referenced if it was also a loop output, the subgraph passed it through to
+  // another output, or it was the initial value of the variable from outside the Loop.
+  if (!spare.IsTensor() || !spare.IsUniquelyOwned() || !current_value.IsTensor()) {
+    return Status::OK();
+  }
+
+  const auto& tensor = spare.Get<Tensor>();
+  if (tensor.OwnsBuffer() && tensor.Shape() == shape && tensor.Location().device == location.device &&
+      tensor.DataType() == current_value.Get<Tensor>().DataType()) {
+    ort_value = spare;
+    spare = OrtValue();
+    allocated = true;
+  }
+
+  return Status::OK();
+}
+
 Status LoopImpl::Execute(const FeedsFetchesManager& ffm) {
   auto status = Status::OK();
 
@@ -442,16 +480,33 @@ Status LoopImpl::Execute(const FeedsFetchesManager& ffm) {
 
   CreateInitialFeeds(feeds);
 
+  // the outputs for the loop carried vars follow 'cond' in the subgraph outputs, and the inputs follow iter_num and
+  // 'cond' in the subgraph inputs.
+  std::unordered_map<size_t, IExecutor::CustomAllocator> fetch_allocators;
+  for (int i = 0; i < info_.num_loop_carried_vars; ++i) {
+    fetch_allocators[i + 1] = [this, i, &feeds](const TensorShape& shape, const OrtMemoryInfo& location,
+                                                OrtValue& ort_value, bool& allocated) {
+      return ReuseLoopCarriedVarBuffer(i, feeds[i + 2], shape, location, ort_value, allocated);
+    };
+  }
+
+  // the frame used to execute the subgraph is kept across iterations
+  SubgraphExecutionContext subgraph_context(session_state_, ffm, context_.GetTerminateFlag(), context_.Logger());
+
   auto& iter_num_value = *iter_num_mlvalue_.GetMutable<Tensor>()->MutableData<int64_t>();
 
   while (iter_num_value < max_trip_count_ && *condition_mlvalue_.GetMutable<Tensor>()->MutableData<bool>()) {
+    if (concurrency::SchedulingHint::Current().DeadlineExpired()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Loop exiting after ", iter_num_value,
+                             " iterations due to the run deadline being exceeded.");
+    }
+
     if (iter_num_value != 0) {
       SaveOutputsAndUpdateFeeds(fetches, feeds);
       fetches.clear();
     }
 
-    status = utils::ExecuteSubgraph(session_state_, ffm, feeds, fetches, {},
-                                    ExecutionMode::ORT_SEQUENTIAL, context_.GetTerminateFlag(), context_.Logger());
+    status = subgraph_context.Execute(feeds, fetches, fetch_allocators);
 
     ORT_RETURN_IF_ERROR(status);
 
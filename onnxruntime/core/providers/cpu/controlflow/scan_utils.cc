@@ -16,10 +16,12 @@
 #include "core/framework/mldata_type_utils.h"
 #include "core/framework/op_kernel_context_internal.h"
 #include "core/framework/sequential_executor.h"
+#include "core/framework/subgraph_execution_context.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/providers/cpu/controlflow/utils.h"
 #include "core/framework/session_options.h"
+#include "core/platform/threadpool.h"
 
 #ifdef _MSC_VER
 #pragma warning(pop)
@@ -198,6 +200,8 @@ Status IterateSequence(OpKernelContextInternal& context, const SessionState& ses
   std::vector<OrtValue> fetches;
   std::unordered_map<size_t, IExecutor::CustomAllocator> fetch_allocators;
 
+  SubgraphExecutionContext subgraph_context(session_state, ffm, context.GetTerminateFlag(), context.Logger());
+
   feeds.resize(num_inputs);
   fetches.resize(num_variadic_outputs);
 
@@ -209,6 +213,11 @@ Status IterateSequence(OpKernelContextInternal& context, const SessionState& ses
 
   int64_t seq_no = 0;
   for (; seq_no < seq_length; ++seq_no) {
+    if (concurrency::SchedulingHint::Current().DeadlineExpired()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Scan exiting after ", seq_no,
+                             " iterations due to the run deadline being exceeded.");
+    }
+
     for (int input = 0; input < num_variadic_inputs; ++input) {
       if (input < num_loop_state_variables) {
         // add loop state variable input
@@ -268,9 +277,8 @@ Status IterateSequence(OpKernelContextInternal& context, const SessionState& ses
       }
     }
 
-    // Create Executor and run graph.
-    status = utils::ExecuteSubgraph(session_state, ffm, feeds, fetches, fetch_allocators,
-                                    ExecutionMode::ORT_SEQUENTIAL, context.GetTerminateFlag(), context.Logger());
+    // run the graph, reusing the execution frame from the previous iteration where possible
+    status = subgraph_context.Execute(feeds, fetches, fetch_allocators);
 
     ORT_RETURN_IF_ERROR(status);
 
@@ -22,10 +22,9 @@ limitations under the License.
 #endif
 
 #include <algorithm>
-#include <chrono>
-#include <random>
 
 #include "core/common/safeint.h"
+#include "core/framework/philox_random.h"
 #include "core/util/math_cpuonly.h"
 #include "core/common/eigen_common_wrapper.h"
 #include "gsl/gsl"
@@ -69,19 +68,25 @@ ONNX_CPU_OPERATOR_KERNEL(
     Multinomial);
 
 template <typename T, typename TDistribution>
-void GenerateData(std::default_random_engine& generator, TDistribution distribution, Tensor& tensor);
+void GenerateData(PhiloxGenerator& generator, const TDistribution& distribution, Tensor& tensor,
+                  concurrency::ThreadPool* thread_pool);
 
-static Status RandomNormalCompute(float mean, float scale, std::default_random_engine& generator, TensorProto::DataType dtype, Tensor& Y);
-static Status RandomUniformCompute(float high, float low, std::default_random_engine& generator, TensorProto::DataType dtype, Tensor& Y);
+static Status RandomNormalCompute(float mean, float scale, PhiloxGenerator& generator, TensorProto::DataType dtype, Tensor& Y,
+                                  concurrency::ThreadPool* thread_pool);
+static Status RandomUniformCompute(float high, float low, PhiloxGenerator& generator, TensorProto::DataType dtype, Tensor& Y,
+                                   concurrency::ThreadPool* thread_pool);
 
 static Status CreateOutputTensorFromTensorShape(OpKernelContext* ctx, const Tensor& X, Tensor** Y);
 static TensorProto::DataType InferDataType(const Tensor& tensor);
 
+static PhiloxGenerator& GetGenerator(const std::unique_ptr<PhiloxGenerator>& generator) {
+  return generator != nullptr ? *generator : PhiloxGenerator::Default();
+}
+
 Status RandomNormal::Compute(OpKernelContext* ctx) const {
   Tensor& Y = *ctx->Output(0, shape_);
 
-  std::lock_guard<onnxruntime::OrtMutex> l(generator_mutex_);
-  auto status = RandomNormalCompute(mean_, scale_, generator_, dtype_, Y);
+  auto status = RandomNormalCompute(mean_, scale_, GetGenerator(generator_), dtype_, Y, ctx->GetOperatorThreadPool());
 
   return status;
 }
@@ -89,8 +94,7 @@ Status RandomNormal::Compute(OpKernelContext* ctx) const {
 Status RandomUniform::Compute(OpKernelContext* ctx) const {
   Tensor& Y = *ctx->Output(0, shape_);
 
-  std::lock_guard<onnxruntime::OrtMutex> l(generator_mutex_);
-  auto status = RandomUniformCompute(low_, high_, generator_, dtype_, Y);
+  auto status = RandomUniformCompute(low_, high_, GetGenerator(generator_), dtype_, Y, ctx->GetOperatorThreadPool());
 
   return status;
 }
@@ -111,8 +115,7 @@ Status RandomNormalLike::Compute(OpKernelContext* ctx) const {
                            "Could not infer data type from input tensor with data type ",
                            X.DataType());
 
-  std::lock_guard<onnxruntime::OrtMutex> l(generator_mutex_);
-  status = RandomNormalCompute(mean_, scale_, generator_, dtype, *Y);
+  status = RandomNormalCompute(mean_, scale_, GetGenerator(generator_), dtype, *Y, ctx->GetOperatorThreadPool());
 
   return status;
 }
@@ -132,8 +135,7 @@ Status RandomUniformLike::Compute(OpKernelContext* ctx) const {
     return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL,
                            "Could not infer data type from input tensor with data type ",
                            X.DataType());
-  std::lock_guard<onnxruntime::OrtMutex> l(generator_mutex_);
-  status = RandomUniformCompute(low_, high_, generator_, dtype, *Y);
+  status = RandomUniformCompute(low_, high_, GetGenerator(generator_), dtype, *Y, ctx->GetOperatorThreadPool());
 
   return status;
 }
@@ -154,57 +156,75 @@ static Status MultinomialCompute(OpKernelContext* ctx,
                                  const int64_t batch_size,
                                  const int64_t num_classes,
                                  const int64_t num_samples,
-                                 std::default_random_engine& generator,
+                                 PhiloxGenerator& generator,
                                  Tensor& Y) {
-  // implementation copied from Tensorflow with some changes such as using the std::uniform_real_distribution
-  // instead of the Philox RNG.
+  // implementation copied from Tensorflow with some changes such as using a uniform distribution of doubles
+  // and splitting the batches over the thread pool.
   Eigen::array<int64_t, 2> X_dims = {{batch_size, num_classes}};
   ConstMatrix<float> logits = ConstMatrix<float>(X.template Data<float>(), X_dims);
 
   Eigen::array<int64_t, 2> Y_dims = {{batch_size, num_samples}};
   Matrix<OutputType> output = Matrix<OutputType>(Y.template MutableData<OutputType>(), Y_dims);
 
-  // BEGIN create temporary tensor
   AllocatorPtr alloc;
   ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&alloc));
-  auto cdf_data = static_cast<double*>(alloc->Alloc(SafeInt<size_t>(sizeof(double)) * num_classes));
-  BufferUniquePtr cdf_buffer(cdf_data, BufferDeleter(alloc));
-  Eigen::array<int64_t, 1> cdf_dims = {{num_classes}};
-  auto cdf = EigenVector<double>(cdf_data, cdf_dims);
-  // END create temporary tensor
-
-  std::uniform_real_distribution<double> dist(0.0, 1.0);  // TODO: should this be initialized per batch?
-
-  for (int64_t b = 0; b < batch_size; ++b) {
-    const float* logits_row = &(logits(b, 0));
-    // Takes an along-class maximum (for numerical stability).
-    float maxx = std::numeric_limits<float>::lowest();
-    for (int64_t j = 0; j < num_classes; ++j) {
-      if (Eigen::numext::isfinite(logits_row[j])) {
-        maxx = std::max(maxx, logits_row[j]);
-      }
-    }
-    const auto max_logit = static_cast<double>(maxx);
-
-    // Precompute cumulative probability distribution across classes.
-    // Note: This isn't normalized.
-    cdf = (logits.chip<0>(b).cast<double>() - max_logit).exp();
-    double running_total = 0;
-    for (int64_t j = 0; j < num_classes; ++j) {
-      if (Eigen::numext::isfinite(logits_row[j])) {
-        running_total += cdf(j);
-      }
-      cdf(j) = running_total;
-    }
-    // Generate each sample.
-    const double* cdf_begin = cdf.data();
-    const double* cdf_end = cdf.data() + num_classes;
-    for (int64_t j = 0; j < num_samples; ++j) {
-      const double to_find = dist(generator) * running_total;
-      auto found_iter = std::upper_bound(cdf_begin, cdf_end, to_find);
-      output(b, j) = static_cast<OutputType>(std::distance(cdf_begin, found_iter));
-    }
-  }
+
+  // every batch draws its samples from its own blocks of the stream, so they don't depend on the number of threads
+  using Distribution = PhiloxUniformDistribution<double>;
+  const Distribution dist(0.0, 1.0);
+  const uint64_t blocks_per_batch = PhiloxBlockCount<Distribution>(num_samples);
+  const auto seeds = generator.NextPhiloxSeeds(blocks_per_batch * static_cast<uint64_t>(batch_size));
+
+  const TensorOpCost cost{static_cast<double>(num_classes * sizeof(float)),
+                          static_cast<double>(num_samples * sizeof(OutputType)),
+                          static_cast<double>(num_classes * 10 + num_samples * 20)};
+  concurrency::ThreadPool::TryParallelFor(
+      ctx->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(batch_size), cost,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        // BEGIN create temporary tensor
+        auto cdf_data = static_cast<double*>(alloc->Alloc(SafeInt<size_t>(sizeof(double)) * num_classes));
+        BufferUniquePtr cdf_buffer(cdf_data, BufferDeleter(alloc));
+        Eigen::array<int64_t, 1> cdf_dims = {{num_classes}};
+        auto cdf = EigenVector<double>(cdf_data, cdf_dims);
+        // END create temporary tensor
+
+        for (std::ptrdiff_t b = first; b < last; ++b) {
+          const float* logits_row = &(logits(b, 0));
+          // Takes an along-class maximum (for numerical stability).
+          float maxx = std::numeric_limits<float>::lowest();
+          for (int64_t j = 0; j < num_classes; ++j) {
+            if (Eigen::numext::isfinite(logits_row[j])) {
+              maxx = std::max(maxx, logits_row[j]);
+            }
+          }
+          const auto max_logit = static_cast<double>(maxx);
+
+          // Precompute cumulative probability distribution across classes.
+          // Note: This isn't normalized.
+          cdf = (logits.chip<0>(b).cast<double>() - max_logit).exp();
+          double running_total = 0;
+          for (int64_t j = 0; j < num_classes; ++j) {
+            if (Eigen::numext::isfinite(logits_row[j])) {
+              running_total += cdf(j);
+            }
+            cdf(j) = running_total;
+          }
+          // Generate each sample.
+          const double* cdf_begin = cdf.data();
+          const double* cdf_end = cdf.data() + num_classes;
+          PhiloxRandom engine(seeds.first, seeds.second + blocks_per_batch * static_cast<uint64_t>(b));
+          double uniforms[Distribution::kResultElementCount];
+          for (int64_t j = 0; j < num_samples; ++j) {
+            const int64_t index_in_block = j % Distribution::kResultElementCount;
+            if (index_in_block == 0) {
+              dist(engine, uniforms);
+            }
+            const double to_find = uniforms[index_in_block] * running_total;
+            auto found_iter = std::upper_bound(cdf_begin, cdf_end, to_find);
+            output(b, j) = static_cast<OutputType>(std::distance(cdf_begin, found_iter));
+          }
+        }
+      });
 
   return Status::OK();
 }
@@ -236,14 +256,14 @@ Status Multinomial::Compute(OpKernelContext* ctx) const {
   Tensor* Y = ctx->Output(0, {batch_size, num_samples_});
 
   Status status = Status::OK();
-  std::lock_guard<onnxruntime::OrtMutex> l(generator_mutex_);
+  PhiloxGenerator& generator = GetGenerator(generator_);
   switch (output_dtype_) {
     case TensorProto::INT32: {
-      status = MultinomialCompute<int32_t>(ctx, X, batch_size, num_classes, num_samples_, generator_, *Y);
+      status = MultinomialCompute<int32_t>(ctx, X, batch_size, num_classes, num_samples_, generator, *Y);
       break;
     }
     case TensorProto::INT64: {
-      status = MultinomialCompute<int64_t>(ctx, X, batch_size, num_classes, num_samples_, generator_, *Y);
+      status = MultinomialCompute<int64_t>(ctx, X, batch_size, num_classes, num_samples_, generator, *Y);
       break;
     }
     default:
@@ -273,20 +293,19 @@ static TensorProto::DataType InferDataType(const Tensor& tensor) {
 }
 
 static Status RandomNormalCompute(float mean, float scale,
-                                  std::default_random_engine& generator,
-                                  TensorProto::DataType dtype, Tensor& Y) {
+                                  PhiloxGenerator& generator,
+                                  TensorProto::DataType dtype, Tensor& Y,
+                                  concurrency::ThreadPool* thread_pool) {
   switch (dtype) {
     case TensorProto::FLOAT: {
-      GenerateData<float, std::normal_distribution<float>>(
-          generator, std::normal_distribution<float>{mean, scale}, Y);
+      GenerateData<float>(generator, PhiloxNormalDistribution<float>{mean, scale}, Y, thread_pool);
       break;
     }
     case TensorProto::FLOAT16: {
       ORT_NOT_IMPLEMENTED("FLOAT16 is not supported");
     }
     case TensorProto::DOUBLE: {
-      GenerateData<double, std::normal_distribution<double>>(
-          generator, std::normal_distribution<double>{mean, scale}, Y);
+      GenerateData<double>(generator, PhiloxNormalDistribution<double>{mean, scale}, Y, thread_pool);
       break;
     }
     default:
@@ -297,21 +316,20 @@ static Status RandomNormalCompute(float mean, float scale,
 }
 
 static Status RandomUniformCompute(float low, float high,
-                                   std::default_random_engine& generator,
+                                   PhiloxGenerator& generator,
                                    TensorProto::DataType dtype,
-                                   Tensor& Y) {
+                                   Tensor& Y,
+                                   concurrency::ThreadPool* thread_pool) {
   switch (dtype) {
     case TensorProto::FLOAT: {
-      GenerateData<float, std::uniform_real_distribution<float>>(
-          generator, std::uniform_real_distribution<float>{low, high}, Y);
+      GenerateData<float>(generator, PhiloxUniformDistribution<float>{low, high}, Y, thread_pool);
       break;
     }
     case TensorProto::FLOAT16: {
       ORT_NOT_IMPLEMENTED("FLOAT16 is not supported");
     }
     case TensorProto::DOUBLE: {
-      GenerateData<double, std::uniform_real_distribution<double>>(
-          generator, std::uniform_real_distribution<double>{low, high}, Y);
+      GenerateData<double>(generator, PhiloxUniformDistribution<double>{low, high}, Y, thread_pool);
       break;
     }
     default:
@@ -322,12 +340,9 @@ static Status RandomUniformCompute(float low, float high,
 }
 
 template <typename T, typename TDistribution>
-void GenerateData(std::default_random_engine& generator, TDistribution distribution, Tensor& tensor) {
-  T* out = tensor.MutableData<T>();
-  for (int64_t i = 0, end = tensor.Shape().Size(); i < end; ++i) {
-    *out = distribution(generator);
-    ++out;
-  }
+void GenerateData(PhiloxGenerator& generator, const TDistribution& distribution, Tensor& tensor,
+                  concurrency::ThreadPool* thread_pool) {
+  FillPhiloxRandom(generator, distribution, tensor.MutableData<T>(), tensor.Shape().Size(), thread_pool);
 }
 
 }  // namespace onnxruntime
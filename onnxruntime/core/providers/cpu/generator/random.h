@@ -3,12 +3,11 @@
 
 #pragma once
 
-#include <random>
 #include "gsl/gsl"
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
-#include "core/platform/ort_mutex.h"
+#include "core/framework/random_generator.h"
 
 namespace onnxruntime {
 
@@ -18,15 +17,10 @@ class RandomNormal final : public OpKernel {
     ORT_ENFORCE(info.GetAttr<float>("mean", &mean_).IsOK());
     ORT_ENFORCE(info.GetAttr<float>("scale", &scale_).IsOK());
 
-    // read optional seed attribute and generate if not provided
+    // read optional seed attribute. PhiloxGenerator::Default() is used if not provided
     float seed = 0.f;
     if (info.GetAttr<float>("seed", &seed).IsOK()) {
-      generator_ = std::default_random_engine{gsl::narrow_cast<uint32_t>(seed)};
-    }
-    else {
-      generator_ = std::default_random_engine{
-        gsl::narrow_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count())
-      };
+      generator_ = onnxruntime::make_unique<PhiloxGenerator>(gsl::narrow_cast<uint32_t>(seed));
     }
 
     int64_t dtype;
@@ -45,12 +39,10 @@ class RandomNormal final : public OpKernel {
  private:
   float mean_;
   float scale_;
-  
-  // generator_ is updated with every call to Compute(). 
-  // use generator_mutex_ to ensure Compute() can be called concurrently.
-  // this is to ensure that a model with random generators is deterministic and still can be executed in parallel.
-  mutable std::default_random_engine generator_;
-  mutable onnxruntime::OrtMutex generator_mutex_;
+
+  // every call to Compute() reserves the part of the stream of generator_ it uses, so Compute() can be called
+  // concurrently while a model with random generators is still deterministic.
+  mutable std::unique_ptr<PhiloxGenerator> generator_;
   ONNX_NAMESPACE::TensorProto::DataType dtype_;
   TensorShape shape_;
 };
@@ -61,15 +53,10 @@ class RandomNormalLike final : public OpKernel {
     ORT_ENFORCE(info.GetAttr<float>("mean", &mean_).IsOK());
     ORT_ENFORCE(info.GetAttr<float>("scale", &scale_).IsOK());
 
-    // read optional seed attribute and generate if not provided
+    // read optional seed attribute. PhiloxGenerator::Default() is used if not provided
     float seed = 0.f;
     if (info.GetAttr<float>("seed", &seed).IsOK()) {
-      generator_ = std::default_random_engine{gsl::narrow_cast<uint32_t>(seed)};
-    }
-    else {
-      generator_ = std::default_random_engine{
-        gsl::narrow_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count())
-      };
+      generator_ = onnxruntime::make_unique<PhiloxGenerator>(gsl::narrow_cast<uint32_t>(seed));
     }
 
     int64_t dtype;
@@ -85,10 +72,9 @@ class RandomNormalLike final : public OpKernel {
  private:
   float mean_;
   float scale_;
-  
-  // see comments for generator_ and generator_mutex_ in RandomNormal class.
-  mutable std::default_random_engine generator_;
-  mutable onnxruntime::OrtMutex generator_mutex_;
+
+  // see comments for generator_ in RandomNormal class.
+  mutable std::unique_ptr<PhiloxGenerator> generator_;
   ONNX_NAMESPACE::TensorProto::DataType dtype_ = ONNX_NAMESPACE::TensorProto::DataType::TensorProto_DataType_UNDEFINED;  //optional and may be inferred
 };
 
@@ -98,15 +84,10 @@ class RandomUniform final : public OpKernel {
     ORT_ENFORCE(info.GetAttr<float>("high", &high_).IsOK());
     ORT_ENFORCE(info.GetAttr<float>("low", &low_).IsOK());
 
-    // read optional seed attribute and generate if not provided
+    // read optional seed attribute. PhiloxGenerator::Default() is used if not provided
     float seed = 0.f;
     if (info.GetAttr<float>("seed", &seed).IsOK()) {
-      generator_ = std::default_random_engine{gsl::narrow_cast<uint32_t>(seed)};
-    }
-    else {
-      generator_ = std::default_random_engine{
-        gsl::narrow_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count())
-      };
+      generator_ = onnxruntime::make_unique<PhiloxGenerator>(gsl::narrow_cast<uint32_t>(seed));
     }
 
     int64_t dtype;
@@ -126,9 +107,8 @@ class RandomUniform final : public OpKernel {
   float high_;
   float low_;
 
-  // see comments for generator_ and generator_mutex_ in RandomNormal class.
-  mutable std::default_random_engine generator_;
-  mutable onnxruntime::OrtMutex generator_mutex_;
+  // see comments for generator_ in RandomNormal class.
+  mutable std::unique_ptr<PhiloxGenerator> generator_;
   ONNX_NAMESPACE::TensorProto::DataType dtype_;
   TensorShape shape_;
 };
@@ -138,15 +118,10 @@ class RandomUniformLike final : public OpKernel {
   RandomUniformLike(const OpKernelInfo& info) : OpKernel(info) {
     ORT_ENFORCE(info.GetAttr<float>("high", &high_).IsOK());
     ORT_ENFORCE(info.GetAttr<float>("low", &low_).IsOK());
-    // read optional seed attribute and generate if not provided
+    // read optional seed attribute. PhiloxGenerator::Default() is used if not provided
     float seed = 0.f;
     if (info.GetAttr<float>("seed", &seed).IsOK()) {
-      generator_ = std::default_random_engine{gsl::narrow_cast<uint32_t>(seed)};
-    }
-    else {
-      generator_ = std::default_random_engine{
-        gsl::narrow_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count())
-      };
+      generator_ = onnxruntime::make_unique<PhiloxGenerator>(gsl::narrow_cast<uint32_t>(seed));
     }
 
     int64_t dtype;
@@ -162,10 +137,9 @@ class RandomUniformLike final : public OpKernel {
  private:
   float high_;
   float low_;
-  
-  // see comments for generator_ and generator_mutex_ in RandomNormal class.
-  mutable std::default_random_engine generator_;
-  mutable onnxruntime::OrtMutex generator_mutex_;
+
+  // see comments for generator_ in RandomNormal class.
+  mutable std::unique_ptr<PhiloxGenerator> generator_;
   ONNX_NAMESPACE::TensorProto::DataType dtype_ = ONNX_NAMESPACE::TensorProto::DataType::TensorProto_DataType_UNDEFINED;  //optional and may be inferred
 };
 
@@ -174,14 +148,10 @@ class Multinomial final : public OpKernel {
   Multinomial(const OpKernelInfo& info) : OpKernel(info) {
     ORT_ENFORCE(info.GetAttr<int64_t>("sample_size", &num_samples_).IsOK());
 
+    // read optional seed attribute. PhiloxGenerator::Default() is used if not provided
     float seed = 0.f;
     if (info.GetAttr<float>("seed", &seed).IsOK()) {
-      generator_ = std::default_random_engine{gsl::narrow_cast<uint32_t>(seed)};
-    }
-    else {
-      generator_ = std::default_random_engine{
-        gsl::narrow_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count())
-      };
+      generator_ = onnxruntime::make_unique<PhiloxGenerator>(gsl::narrow_cast<uint32_t>(seed));
     }
 
     int64_t output_dtype_tmp;
@@ -199,9 +169,8 @@ class Multinomial final : public OpKernel {
  private:
   int64_t num_samples_;
 
-  // see comments for generator_ and generator_mutex_ in RandomNormal class.
-  mutable std::default_random_engine generator_;
-  mutable onnxruntime::OrtMutex generator_mutex_;
+  // see comments for generator_ in RandomNormal class.
+  mutable std::unique_ptr<PhiloxGenerator> generator_;
   ONNX_NAMESPACE::TensorProto::DataType output_dtype_;
 };
 }  // namespace onnxruntime
@@ -66,6 +66,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<float>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<float>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
+    einsum_compute_processor.SetContractionOrderCache(&contraction_order_cache_);
     return einsum_compute_processor.Run();
   } else if (inputs[0]->IsDataType<int32_t>()) {
     auto einsum_compute_processor = EinsumTypedComputeProcessor<int32_t>(context,
@@ -79,6 +80,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<int32_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<int32_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
+    einsum_compute_processor.SetContractionOrderCache(&contraction_order_cache_);
 
     return einsum_compute_processor.Run();
   } else if (inputs[0]->IsDataType<double>()) {
@@ -93,6 +95,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<double>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<double>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
+    einsum_compute_processor.SetContractionOrderCache(&contraction_order_cache_);
     return einsum_compute_processor.Run();
   } else if (inputs[0]->IsDataType<int64_t>()) {
     auto einsum_compute_processor = EinsumTypedComputeProcessor<int64_t>(context,
@@ -105,6 +108,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<int64_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<int64_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
+    einsum_compute_processor.SetContractionOrderCache(&contraction_order_cache_);
 
     return einsum_compute_processor.Run();
   }
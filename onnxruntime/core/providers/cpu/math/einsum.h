@@ -27,6 +27,9 @@ class Einsum : public OpKernel {
 
   std::string equation_;
   std::unique_ptr<EinsumEquationPreprocessor> einsum_equation_preprocessor_;
+
+  // The contraction order chosen for the input shapes seen by this kernel
+  mutable EinsumOp::ContractionOrderCache contraction_order_cache_;
 };
 
 }  // namespace onnxruntime
@@ -58,95 +58,74 @@ Tensor ReduceSum(const Tensor& input, const std::vector<int64_t>& reduce_axes,
                                          input_shape_override);
 }
 // CPU specific Diagonal helper(s)
-static inline bool IsTransposeRequiredForDiagonal(int64_t dim_1, int64_t dim_2, int64_t rank) {
-  // If the input is 2D, we don't need a transpose
-  if (rank == 2)
-    return false;
-
-  // If the two dims are the innermost dims, no transpose is required
-  if ((dim_1 == rank - 1 && dim_2 == rank - 2) ||
-      (dim_1 == rank - 2 && dim_2 == rank - 1))
-    return false;
-
-  // Transpose is required
-  return true;
-}
-
 template <typename T>
-static void DiagonalDataAssignment(const T* input_data, T* output_data, int64_t batch_size,
-                                   int64_t base_stride, int64_t inner_stride) {
-  int64_t output_iter = 0;
-  // TODO: Parallelize this operation
-  for (int64_t i = 0; i < batch_size; ++i) {
-    auto base_offset = i * base_stride;
-    for (int64_t j = 0; j < inner_stride; ++j) {
-      output_data[output_iter] = input_data[base_offset + j * inner_stride + j];
-      output_iter++;
+static void DiagonalDataAssignment(const T* input_data, T* output_data,
+                                   int64_t outer_size, int64_t diagonal_size, int64_t middle_size, int64_t inner_size) {
+  // the input is viewed as [outer_size, diagonal_size, middle_size, diagonal_size, inner_size] and the output as
+  // [outer_size, diagonal_size, middle_size, inner_size]. moving along the diagonal moves along both diagonal dims.
+  const int64_t input_middle_stride = diagonal_size * inner_size;
+  const int64_t input_diagonal_stride = middle_size * input_middle_stride + inner_size;
+  const int64_t input_outer_stride = diagonal_size * middle_size * input_middle_stride;
+
+  T* output = output_data;
+  for (int64_t o = 0; o < outer_size; ++o) {
+    for (int64_t d = 0; d < diagonal_size; ++d) {
+      const T* input = input_data + o * input_outer_stride + d * input_diagonal_stride;
+      for (int64_t m = 0; m < middle_size; ++m) {
+        const T* input_inner = input + m * input_middle_stride;
+        for (int64_t i = 0; i < inner_size; ++i) {
+          *output++ = input_inner[i];
+        }
+      }
     }
   }
 }
 
-// Parse diagonal elements along the 2 innermost dimensions
-// E.g.: input_shape = [1, 2, 3, 3]
-
-// This implementation provides flexibility as to which of the 2 innermost dim values is preserved
-// via the `preserve_innermost_dim_val` parameter
-
-// preserve_innermost_dim_val == true,
-//       output_shape = [1, 2, 1, 3] => the diagonal contains 3 elements and the dim value of the innermost dim is preserved
-
-// preserve_innermost_dim_val == false,
-//       output_shape = [1, 2, 3, 1] => the diagonal contains 3 elements and the dim value of the non-innermost dim is preserved
-
-static std::unique_ptr<Tensor> DiagonalInnermostDims(const Tensor& input,
-                                                     bool preserve_innermost_dim_val, AllocatorPtr allocator) {
-  const auto& input_dims = input.Shape().GetDims();
-  auto rank = input_dims.size();
-  const size_t element_size_in_bytes = input.DataType()->Size();
+// Parse the diagonal elements along 2 dims of any rank by reading the input with strides.
+// This avoids transposing the 2 dims to the innermost dims and back.
+// E.g.: input_shape = [2, 3, 5, 3], dim_1 = 1, dim_2 = 3 => output_shape = [2, 3, 5]
+std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim_2, AllocatorPtr allocator) {
+  const auto& input_shape = input.Shape();
+  const auto& input_dims = input_shape.GetDims();
+  auto rank = static_cast<int64_t>(input_dims.size());
 
-  // This is an internal method and we already have finished all validations in the calling method.
-  // We proceed without duplicating all validations again here.
+  ORT_ENFORCE(rank >= 2 && dim_1 != dim_2 && input_dims[dim_1] == input_dims[dim_2],
+              "Cannot parse the diagonal elements along dims ", dim_1, " and ", dim_2, " for input shape ", input_shape);
 
-  // We have a minimalistic check here to make sure the innermost dims have the same dim value
-  // as the calling method may have done a transpose before calling this method
-  ORT_ENFORCE(input_dims[rank - 2] == input_dims[rank - 1],
-              "The innermost dims should have the same dim value to parse the diagonal elements");
+  // the first dim holds the diagonal in the output and the second dim is squeezed
+  const int64_t first_dim = std::min(dim_1, dim_2);
+  const int64_t second_dim = std::max(dim_1, dim_2);
 
   std::vector<int64_t> output_dims;
-  output_dims.reserve(rank);
-
-  int64_t batch_size = 1;  // Flatten the outermost dims - this will be the number of iterations
-  for (size_t i = 0; i < rank - 2; ++i) {
-    auto input_dim_value = input_dims[i];
-    batch_size *= input_dim_value;
-    output_dims.push_back(input_dim_value);
+  output_dims.reserve(rank - 1);
+  for (int64_t i = 0; i < rank; ++i) {
+    if (i != second_dim) {
+      output_dims.push_back(input_dims[i]);
+    }
   }
 
-  if (preserve_innermost_dim_val) {
-    output_dims.push_back(1);
-    output_dims.push_back(input_dims[rank - 1]);
-  } else {
-    output_dims.push_back(input_dims[rank - 1]);
-    output_dims.push_back(1);
+  const int64_t outer_size = input_shape.SizeToDimension(static_cast<size_t>(first_dim));
+  const int64_t diagonal_size = input_dims[first_dim];
+  int64_t middle_size = 1;
+  for (int64_t i = first_dim + 1; i < second_dim; ++i) {
+    middle_size *= input_dims[i];
   }
-
-  int64_t inner_stride = input_dims[rank - 1];        // offset to move over the innermost dim
-  int64_t base_stride = inner_stride * inner_stride;  // offset to move over all the axes except the 2 innermost dims
+  const int64_t inner_size = input_shape.SizeFromDimension(static_cast<size_t>(second_dim) + 1);
 
   // Pass in allocator as that will be used as an allocator deleter by the framework
   // and it will de-allocate the memory for this intermediate tensor when it goes out of scope
   std::unique_ptr<Tensor> output = onnxruntime::make_unique<Tensor>(input.DataType(), output_dims, allocator);
 
-  switch (element_size_in_bytes) {
+  switch (input.DataType()->Size()) {
     case 4:
       DiagonalDataAssignment<float>(reinterpret_cast<const float*>(input.DataRaw()),
                                     reinterpret_cast<float*>(output->MutableDataRaw()),
-                                    batch_size, base_stride, inner_stride);
+                                    outer_size, diagonal_size, middle_size, inner_size);
       break;
     case 8:
       DiagonalDataAssignment<double>(reinterpret_cast<const double*>(input.DataRaw()),
                                      reinterpret_cast<double*>(output->MutableDataRaw()),
-                                     batch_size, base_stride, inner_stride);
+                                     outer_size, diagonal_size, middle_size, inner_size);
       break;
 
     default:
@@ -156,97 +135,6 @@ static std::unique_ptr<Tensor> DiagonalInnermostDims(const Tensor& input,
   return output;
 }
 
-std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim_2, AllocatorPtr allocator) {
-  const auto& input_shape = input.Shape();
-  const auto& input_dims = input_shape.GetDims();
-  auto rank = static_cast<int64_t>(input_dims.size());
-
-  ORT_ENFORCE(rank >= 2 && dim_1 != dim_2 && input_dims[dim_1] == input_dims[dim_2],
-              "Cannot parse the diagonal elements along dims ", dim_1, " and ", dim_2, " for input shape ", input_shape);
-
-  int64_t first_dim = -1;   // first_dim holds the lesser of dim_1 and dim_2
-  int64_t second_dim = -1;  // second_dim holds the greater of dim_1 and dim_2
-  if (dim_1 < dim_2) {
-    first_dim = dim_1;
-    second_dim = dim_2;
-  } else {
-    first_dim = dim_2;
-    second_dim = dim_1;
-  }
-
-  std::unique_ptr<Tensor> output;
-  bool preserve_innermost_dim_val = false;
-
-  bool is_transpose_required = IsTransposeRequiredForDiagonal(dim_1, dim_2, rank);
-  if (is_transpose_required) {
-    std::vector<size_t> permutation(rank, 0);
-    int64_t first_dim_axis = -1;  // This is the axis eventually occupied by the first_dim
-
-    // If one of the diagonal dimensions is one of the 2 innermost dims, then leave it as such
-    // so as to avoid transpose overhead
-    if (first_dim == rank - 2) {  // If rank - 2 is occupied by first_dim, keep it there
-      permutation[rank - 2] = first_dim;
-      first_dim_axis = rank - 2;
-    } else {
-      if (second_dim != rank - 2) {  // If rank - 2 is not occupied by second_dim, then put first_dim there
-        permutation[rank - 2] = first_dim;
-        first_dim_axis = rank - 2;
-      } else {  // If rank - 2 is occupied by second_dim, then put first_dim in rank - 1
-        permutation[rank - 1] = first_dim;
-        first_dim_axis = rank - 1;
-        preserve_innermost_dim_val = true;  // We always want to preserve the dim value of the first_dim
-      }
-    }
-
-    // Put the second_dim in the dim not occupied by the first_dim
-    if (first_dim_axis != rank - 1) {
-      permutation[rank - 1] = second_dim;
-    } else {
-      permutation[rank - 2] = second_dim;
-    }
-
-    int64_t iter = 0;
-    for (int64_t i = 0; i < rank; ++i) {
-      if (i != first_dim && i != second_dim) {
-        permutation[iter++] = i;
-      }
-    }
-
-    // Permutate the input so that the dims from which we need the diagonal forms the innermost dims
-    // (Pass in CPU Transpose function here as this Diagonal method will only be used for CPU based diagonal parsing)
-    auto transposed = EinsumOp::Transpose(input, input_dims, permutation, allocator, nullptr, Transpose);
-
-    // Parse the diagonal from the innermost dims
-    output = DiagonalInnermostDims(*transposed, preserve_innermost_dim_val, allocator);
-
-    // Swap back the dimensions to the original axes ordering using a "reverse permutation"
-
-    // Find the "reverse" permutation
-    iter = 0;
-    std::vector<size_t> reverse_permutation(rank, 0);
-    for (const auto& perm : permutation) {
-      reverse_permutation[perm] = iter++;
-    }
-
-    // Permutate using the reverse permutation to get back the original axes ordering
-    // (Pass in CPU Transpose function here as this Diagonal method will only be used for CPU based diagonal parsing)
-    output = EinsumOp::Transpose(*output, output->Shape().GetDims(), reverse_permutation, allocator, nullptr, Transpose);
-  } else {
-    // No transposing required
-    output = DiagonalInnermostDims(input, preserve_innermost_dim_val, allocator);
-  }
-
-  // Make copy of the output dims
-  auto output_dims = output->Shape().GetDims();
-
-  // Unsqueeze the reduced dim
-  auto iter = output_dims.begin() + second_dim;
-  output_dims.erase(iter);
-
-  output->Reshape(output_dims);
-  return output;
-}
-
 }  // namespace CpuDeviceHelpers
 
 }  // namespace DeviceHelpers
@@ -272,6 +160,29 @@ bool IsTransposeRequired(size_t input_rank, const std::vector<size_t>& permutati
   return transpose_required;
 }
 
+bool IsTransposeRequired(const std::vector<int64_t>& input_dims, const std::vector<size_t>& permutation) {
+  ORT_ENFORCE(input_dims.size() == permutation.size(), "The rank of the input must match permutation size for Transpose");
+
+  // Dims with value 1 can be moved anywhere without changing the memory layout,
+  // so the transpose is a no-op unless it changes the order of the other dims
+  size_t last_moved_dim = 0;
+  bool first = true;
+  for (const auto dim : permutation) {
+    if (input_dims[dim] == 1) {
+      continue;
+    }
+
+    if (!first && dim < last_moved_dim) {
+      return true;
+    }
+
+    last_moved_dim = dim;
+    first = false;
+  }
+
+  return false;
+}
+
 // The following are thin wrappers over device specific helpers
 std::unique_ptr<Tensor> Transpose(const Tensor& input, const std::vector<int64_t>& input_shape_override,
                                   const std::vector<size_t>& permutation, AllocatorPtr allocator,
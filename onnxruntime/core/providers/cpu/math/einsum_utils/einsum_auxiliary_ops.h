@@ -85,6 +85,10 @@ std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim
 // This helps decide if we need to apply (and pay the cost) of a Transpose
 bool IsTransposeRequired(size_t input_rank, const std::vector<size_t>& permutation);
 
+// Also identifies transposes that only move dims with value 1, which don't change the memory layout of the input.
+// When this returns false, the input can be reshaped to the permuted dims instead of being transposed.
+bool IsTransposeRequired(const std::vector<int64_t>& input_dims, const std::vector<size_t>& permutation);
+
 // Thin wrapper over the Transpose op to be called from Einsum that does some checks and invokes the device specific helper
 std::unique_ptr<Tensor> Transpose(const Tensor& input, const std::vector<int64_t>& input_shape_override,
                                   const std::vector<size_t>& permutation, AllocatorPtr allocator, void* einsum_cuda_assets,
@@ -453,8 +453,9 @@ Status EinsumComputePreprocessor::PreprocessInputs() {
       }
     }
 
-    // (Identify no-op transpose and prevent triggering the transpose)
-    if (EinsumOp::IsTransposeRequired(preprocessed ? preprocessed->Shape().GetDims().size() : inputs_[input_iter]->Shape().GetDims().size(),
+    // (Identify no-op transpose, including one only moving dims of value 1, and prevent triggering the transpose.
+    // The operand is reshaped to homogenized_input_dims either way)
+    if (EinsumOp::IsTransposeRequired(preprocessed ? preprocessed->Shape().GetDims() : inputs_[input_iter]->Shape().GetDims(),
                                       permutation)) {
       preprocessed = EinsumOp::Transpose(preprocessed ? *preprocessed : *inputs_[input_iter],
                                          preprocessed ? preprocessed->Shape().GetDims() : inputs_[input_iter]->Shape().GetDims(),
@@ -0,0 +1,352 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "einsum_contraction_order.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+
+namespace EinsumOp {
+
+namespace {
+
+using Dims = std::vector<int64_t>;
+
+// A label has to be kept in the result of contracting the operands at `left` and `right`
+// if it is in the output or in any of the other remaining operands
+bool IsLabelKept(const std::vector<Dims>& operands, size_t left, size_t right,
+                 const std::vector<int64_t>& subscript_indices_to_output_indices, size_t label) {
+  if (subscript_indices_to_output_indices[label] != -1) {
+    return true;
+  }
+
+  for (size_t i = 0, end = operands.size(); i < end; ++i) {
+    if (i != left && i != right && operands[i][label] > 1) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Contract the operands at `left` and `right` and return the dims of the result.
+// `cost` is set to the number of multiply-adds of the contraction.
+Dims ContractDims(const std::vector<Dims>& operands, size_t left, size_t right,
+                  const std::vector<int64_t>& subscript_indices_to_output_indices, double& cost) {
+  const size_t num_labels = subscript_indices_to_output_indices.size();
+  Dims result(num_labels, 1);
+  cost = 1.0;
+
+  for (size_t label = 0; label < num_labels; ++label) {
+    const int64_t dim = std::max(operands[left][label], operands[right][label]);
+    cost *= static_cast<double>(dim);
+    if (dim > 1 && IsLabelKept(operands, left, right, subscript_indices_to_output_indices, label)) {
+      result[label] = dim;
+    }
+  }
+
+  return result;
+}
+
+// Apply a step to the list of remaining operands
+void ApplyStep(std::vector<Dims>& operands, const ContractionStep& step, Dims result) {
+  operands.erase(operands.begin() + std::max(step.left, step.right));
+  operands.erase(operands.begin() + std::min(step.left, step.right));
+  operands.push_back(std::move(result));
+}
+
+double Size(const Dims& dims) {
+  double size = 1.0;
+  for (const auto dim : dims) {
+    size *= static_cast<double>(dim);
+  }
+
+  return size;
+}
+
+// Contract the operands left to right, which is the order the operands were contracted in before
+// the order was chosen by cost
+std::vector<ContractionStep> LeftToRightOrder(size_t num_operands) {
+  std::vector<ContractionStep> order;
+  order.reserve(num_operands - 1);
+  order.push_back({0, 1});
+
+  // the result of the previous step is at the end of the list and the next input at the start of it
+  for (size_t remaining = num_operands - 1; remaining > 1; --remaining) {
+    order.push_back({remaining - 1, 0});
+  }
+
+  return order;
+}
+
+void SearchOptimalOrder(const std::vector<Dims>& operands, const std::vector<int64_t>& subscript_indices_to_output_indices,
+                        std::vector<ContractionStep>& current, double current_cost,
+                        std::vector<ContractionStep>& best, double& best_cost) {
+  if (operands.size() == 1) {
+    if (current_cost < best_cost) {
+      best = current;
+      best_cost = current_cost;
+    }
+
+    return;
+  }
+
+  // no order starting with the current steps can be strictly cheaper than the best one found so far
+  if (current_cost >= best_cost) {
+    return;
+  }
+
+  for (size_t left = 0, end = operands.size(); left < end; ++left) {
+    for (size_t right = left + 1; right < end; ++right) {
+      double step_cost;
+      Dims result = ContractDims(operands, left, right, subscript_indices_to_output_indices, step_cost);
+
+      std::vector<Dims> remaining = operands;
+      ApplyStep(remaining, {left, right}, std::move(result));
+
+      current.push_back({left, right});
+      SearchOptimalOrder(remaining, subscript_indices_to_output_indices, current, current_cost + step_cost,
+                         best, best_cost);
+      current.pop_back();
+    }
+  }
+}
+
+// Repeatedly contract the pair that costs the least, preferring pairs with smaller results on ties
+std::vector<ContractionStep> GreedyOrder(std::vector<Dims> operands,
+                                         const std::vector<int64_t>& subscript_indices_to_output_indices) {
+  std::vector<ContractionStep> order;
+  order.reserve(operands.size() - 1);
+
+  while (operands.size() > 1) {
+    ContractionStep best_step{0, 1};
+    Dims best_result;
+    double best_cost = std::numeric_limits<double>::max();
+    double best_size = std::numeric_limits<double>::max();
+
+    for (size_t left = 0, end = operands.size(); left < end; ++left) {
+      for (size_t right = left + 1; right < end; ++right) {
+        double cost;
+        Dims result = ContractDims(operands, left, right, subscript_indices_to_output_indices, cost);
+        const double size = Size(result);
+        if (cost < best_cost || (cost == best_cost && size < best_size)) {
+          best_step = {left, right};
+          best_result = std::move(result);
+          best_cost = cost;
+          best_size = size;
+        }
+      }
+    }
+
+    order.push_back(best_step);
+    ApplyStep(operands, best_step, std::move(best_result));
+  }
+
+  return order;
+}
+
+// Groups of the dims of the operands and the result of the batched MatMul of a pair-wise contraction.
+// See EinsumTypedComputeProcessor::PairwiseOperandProcess, which arranges the left operand as
+// [lro, lo, reduced, ro], the right operand as [lro, reduced, ro, lo] and produces [lro, lo, reduced, ro].
+enum class DimGroup {
+  kLeftRightOutput,  // lro
+  kLeftOutput,       // lo
+  kReduced,
+  kRightOutput,  // ro
+  kTrivial,      // dim value 1 - doesn't affect the memory layout
+};
+
+// Returns true if the groups, listed in the order of the dims in memory, are not in the given order of groups,
+// in which case the dims have to be transposed to bring them into that order.
+bool AreGroupsOutOfOrder(const std::vector<DimGroup>& groups, const std::vector<DimGroup>& group_order) {
+  size_t previous = 0;
+  for (const auto group : groups) {
+    if (group == DimGroup::kTrivial) {
+      continue;
+    }
+
+    const size_t position = static_cast<size_t>(
+        std::find(group_order.begin(), group_order.end(), group) - group_order.begin());
+    if (position < previous) {
+      return true;
+    }
+
+    previous = position;
+  }
+
+  return false;
+}
+
+// The number of elements transposed to contract the operands with the given dims in the given orientation
+double TransposeCost(const Dims& left, const Dims& right, const std::vector<bool>& is_reduced,
+                     bool is_final_pair, const std::vector<int64_t>& subscript_indices_to_output_indices) {
+  const size_t num_labels = left.size();
+  std::vector<DimGroup> left_groups(num_labels, DimGroup::kTrivial);
+  std::vector<DimGroup> right_groups(num_labels, DimGroup::kTrivial);
+  std::vector<DimGroup> output_groups(num_labels, DimGroup::kTrivial);
+  Dims output(num_labels, 1);
+
+  for (size_t label = 0; label < num_labels; ++label) {
+    const bool has_left_dim = left[label] > 1;
+    const bool has_right_dim = right[label] > 1;
+    if (is_reduced[label]) {
+      // a dim only one of the operands has is reduced in that operand before the MatMul
+      if (has_left_dim && has_right_dim) {
+        left_groups[label] = DimGroup::kReduced;
+        right_groups[label] = DimGroup::kReduced;
+      }
+    } else if (has_left_dim && has_right_dim) {
+      left_groups[label] = DimGroup::kLeftRightOutput;
+      right_groups[label] = DimGroup::kLeftRightOutput;
+      output_groups[label] = DimGroup::kLeftRightOutput;
+      output[label] = left[label];
+    } else if (has_left_dim) {
+      left_groups[label] = DimGroup::kLeftOutput;
+      output_groups[label] = DimGroup::kLeftOutput;
+      output[label] = left[label];
+    } else if (has_right_dim) {
+      right_groups[label] = DimGroup::kRightOutput;
+      output_groups[label] = DimGroup::kRightOutput;
+      output[label] = right[label];
+    }
+  }
+
+  double cost = 0.0;
+  if (AreGroupsOutOfOrder(left_groups, {DimGroup::kLeftRightOutput, DimGroup::kLeftOutput, DimGroup::kReduced})) {
+    cost += Size(left);
+  }
+
+  if (AreGroupsOutOfOrder(right_groups, {DimGroup::kLeftRightOutput, DimGroup::kReduced, DimGroup::kRightOutput})) {
+    cost += Size(right);
+  }
+
+  // the result is transposed to the order of the labels, or to the order of the op's output after the final pair.
+  // the result of the MatMul has its dims in group order, so a transpose is needed if the target order isn't.
+  std::vector<DimGroup> output_groups_in_target_order;
+  if (is_final_pair) {
+    std::vector<std::pair<int64_t, size_t>> output_index_and_label;
+    for (size_t label = 0; label < num_labels; ++label) {
+      if (subscript_indices_to_output_indices[label] != -1) {
+        output_index_and_label.emplace_back(subscript_indices_to_output_indices[label], label);
+      }
+    }
+    std::sort(output_index_and_label.begin(), output_index_and_label.end());
+    for (const auto& entry : output_index_and_label) {
+      output_groups_in_target_order.push_back(output_groups[entry.second]);
+    }
+  } else {
+    output_groups_in_target_order = output_groups;
+  }
+
+  if (AreGroupsOutOfOrder(output_groups_in_target_order,
+                          {DimGroup::kLeftRightOutput, DimGroup::kLeftOutput, DimGroup::kRightOutput})) {
+    cost += Size(output);
+  }
+
+  return cost;
+}
+
+// Swap the operands of each step if that avoids transposing more elements
+void ChooseOperandOrder(std::vector<Dims> operands, const std::vector<int64_t>& subscript_indices_to_output_indices,
+                        std::vector<ContractionStep>& order) {
+  const size_t num_labels = subscript_indices_to_output_indices.size();
+  for (size_t i = 0, end = order.size(); i < end; ++i) {
+    auto& step = order[i];
+    const bool is_final_pair = i == end - 1;
+
+    std::vector<bool> is_reduced(num_labels);
+    for (size_t label = 0; label < num_labels; ++label) {
+      is_reduced[label] = !IsLabelKept(operands, step.left, step.right, subscript_indices_to_output_indices, label);
+    }
+
+    const Dims& left = operands[step.left];
+    const Dims& right = operands[step.right];
+    if (TransposeCost(right, left, is_reduced, is_final_pair, subscript_indices_to_output_indices) <
+        TransposeCost(left, right, is_reduced, is_final_pair, subscript_indices_to_output_indices)) {
+      std::swap(step.left, step.right);
+    }
+
+    double cost;
+    Dims result = ContractDims(operands, step.left, step.right, subscript_indices_to_output_indices, cost);
+    ApplyStep(operands, step, std::move(result));
+  }
+}
+
+}  // namespace
+
+double ContractionOrderCost(const std::vector<std::vector<int64_t>>& operand_dims,
+                            const std::vector<int64_t>& subscript_indices_to_output_indices,
+                            const std::vector<ContractionStep>& order) {
+  std::vector<Dims> operands = operand_dims;
+  double total_cost = 0.0;
+  for (const auto& step : order) {
+    double cost;
+    Dims result = ContractDims(operands, step.left, step.right, subscript_indices_to_output_indices, cost);
+    ApplyStep(operands, step, std::move(result));
+    total_cost += cost;
+  }
+
+  return total_cost;
+}
+
+std::vector<ContractionStep> FindContractionOrder(const std::vector<std::vector<int64_t>>& operand_dims,
+                                                  const std::vector<int64_t>& subscript_indices_to_output_indices) {
+  const size_t num_operands = operand_dims.size();
+  ORT_ENFORCE(num_operands >= 2, "Einsum op: A contraction order requires at least 2 operands");
+
+  std::vector<ContractionStep> best = LeftToRightOrder(num_operands);
+  double best_cost = ContractionOrderCost(operand_dims, subscript_indices_to_output_indices, best);
+
+  if (num_operands > 2) {
+    if (num_operands <= kMaxOperandsForOptimalContractionOrder) {
+      std::vector<ContractionStep> current;
+      current.reserve(num_operands - 1);
+      SearchOptimalOrder(operand_dims, subscript_indices_to_output_indices, current, 0.0, best, best_cost);
+    } else {
+      auto greedy = GreedyOrder(operand_dims, subscript_indices_to_output_indices);
+      if (ContractionOrderCost(operand_dims, subscript_indices_to_output_indices, greedy) < best_cost) {
+        best = std::move(greedy);
+      }
+    }
+  }
+
+  ChooseOperandOrder(operand_dims, subscript_indices_to_output_indices, best);
+
+  return best;
+}
+
+std::vector<ContractionStep> ContractionOrderCache::GetOrFind(
+    const std::vector<std::vector<int64_t>>& operand_dims,
+    const std::vector<int64_t>& subscript_indices_to_output_indices) {
+  // all operands have a dim for every label, so concatenating them is unambiguous
+  std::vector<int64_t> key(subscript_indices_to_output_indices);
+  for (const auto& dims : operand_dims) {
+    key.insert(key.end(), dims.begin(), dims.end());
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    auto entry = orders_.find(key);
+    if (entry != orders_.end()) {
+      return entry->second;
+    }
+  }
+
+  auto order = FindContractionOrder(operand_dims, subscript_indices_to_output_indices);
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  if (orders_.size() >= kMaxEntries) {
+    orders_.clear();
+  }
+  orders_.emplace(std::move(key), order);
+
+  return order;
+}
+
+}  // namespace EinsumOp
+
+}  // namespace onnxruntime
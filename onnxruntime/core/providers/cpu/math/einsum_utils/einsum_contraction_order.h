@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This module hosts the logic to choose the order in which the operands of Einsum are contracted pair-wise.
+// It only deals with the "homogenized" dims of the operands (see EinsumComputePreprocessor), where every operand has
+// a dim for every subscript label in the same order, and a dim value of 1 for the labels that it does not have.
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+namespace EinsumOp {
+
+// A pair-wise contraction of 2 of the remaining operands.
+// The operands at positions `left` and `right` in the list of remaining operands are removed from it, and the result
+// of contracting them is appended to the end of the list (the same convention as numpy.einsum_path).
+// `left` is the operand that is passed as the left operand of the batched MatMul.
+struct ContractionStep {
+  size_t left;
+  size_t right;
+};
+
+// The order is found by an exhaustive search up to this number of operands, and greedily above it
+constexpr size_t kMaxOperandsForOptimalContractionOrder = 5;
+
+// Find the order of pair-wise contractions that minimizes the number of multiply-adds, given the homogenized dims
+// of the operands and the index of each subscript label in the output (-1 if the label is not in the output).
+// Labels are reduced as soon as no remaining operand or the output has them, so a good order keeps the intermediate
+// results small. Left to right contraction is kept unless another order is strictly cheaper.
+// The operands of each step are ordered to avoid transposes before and after the batched MatMul where possible.
+std::vector<ContractionStep> FindContractionOrder(const std::vector<std::vector<int64_t>>& operand_dims,
+                                                  const std::vector<int64_t>& subscript_indices_to_output_indices);
+
+// The number of multiply-adds needed to contract the operands in the given order
+double ContractionOrderCost(const std::vector<std::vector<int64_t>>& operand_dims,
+                            const std::vector<int64_t>& subscript_indices_to_output_indices,
+                            const std::vector<ContractionStep>& order);
+
+// Caches the contraction order for each set of operand dims seen by an Einsum kernel,
+// so the search is not repeated for every run when the input shapes don't change
+class ContractionOrderCache {
+ public:
+  std::vector<ContractionStep> GetOrFind(const std::vector<std::vector<int64_t>>& operand_dims,
+                                         const std::vector<int64_t>& subscript_indices_to_output_indices);
+
+ private:
+  // The cache is cleared when it reaches this size, to bound its memory with inputs of many different shapes
+  static constexpr size_t kMaxEntries = 64;
+
+  OrtMutex mutex_;
+  std::map<std::vector<int64_t>, std::vector<ContractionStep>> orders_;
+};
+
+}  // namespace EinsumOp
+
+}  // namespace onnxruntime
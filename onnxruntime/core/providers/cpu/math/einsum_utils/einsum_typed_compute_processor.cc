@@ -3,6 +3,8 @@
 
 #include "einsum_typed_compute_processor.h"
 
+#include <algorithm>
+
 namespace onnxruntime {
 
 template <typename T>
@@ -48,8 +50,8 @@ void EinsumTypedComputeProcessor<T>::FinalizeOutput(const Tensor& candidate_outp
   }
 
   // Transpose to the required final output order
-  // (Identify no-op transposes and prevent triggering the transpose)
-  if (EinsumOp::IsTransposeRequired(candidate_output_shape_without_reduced_dims.size(), output_permutation)) {
+  // (Identify no-op transposes, including those only moving dims of value 1, and prevent triggering the transpose)
+  if (EinsumOp::IsTransposeRequired(candidate_output_shape_without_reduced_dims, output_permutation)) {
     auto candidate_output_transposed = EinsumOp::Transpose(candidate_output, candidate_output_shape_without_reduced_dims,
                                                            output_permutation,
                                                            allocator_, einsum_ep_assets_, device_transpose_func_);
@@ -137,11 +139,14 @@ std::unique_ptr<Tensor> EinsumTypedComputeProcessor<T>::PairwiseOperandProcess(c
                     "Einsum op: Input dimensions must be equal along an axis to be reduced across all inputs");
         reduced_size *= left_dim;
       } else if (has_left_dim) {  // if it is only in one of left and right, we can reduce right away
+        // (reduce what was already reduced in the operand if there are several such dims)
         current_left = EinsumOp::ReduceSum<T>(
-            left, left_dims, {i}, allocator_, tp_, einsum_ep_assets_, device_reduce_sum_func_);
+            current_left ? *current_left : left, current_left ? current_left->Shape().GetDims() : left_dims, {i},
+            allocator_, tp_, einsum_ep_assets_, device_reduce_sum_func_);
       } else if (has_right_dim) {
         current_right = EinsumOp::ReduceSum<T>(
-            right, right_dims, {i}, allocator_, tp_, einsum_ep_assets_, device_reduce_sum_func_);
+            current_right ? *current_right : right, current_right ? current_right->Shape().GetDims() : right_dims, {i},
+            allocator_, tp_, einsum_ep_assets_, device_reduce_sum_func_);
       }
     } else {  // This dimension is not reduced (i.e.) it appears in the output after processing these 2 operands
       // Both the left and right operands have non-trivial dimension value along this axis
@@ -171,7 +176,8 @@ std::unique_ptr<Tensor> EinsumTypedComputeProcessor<T>::PairwiseOperandProcess(c
   left_permutation.insert(left_permutation.end(), lo.begin(), lo.end());
   left_permutation.insert(left_permutation.end(), reduce_dims.begin(), reduce_dims.end());
   left_permutation.insert(left_permutation.end(), ro.begin(), ro.end());
-  if (EinsumOp::IsTransposeRequired(current_left ? current_left->Shape().GetDims().size() : left_dims.size(),
+  // (the MatMul reads the operand as [lro, lo, reduce_dims] so a transpose only moving dims of value 1 is not needed)
+  if (EinsumOp::IsTransposeRequired(current_left ? current_left->Shape().GetDims() : left_dims,
                                     left_permutation)) {
     current_left = EinsumOp::Transpose(current_left ? *current_left : left,
                                        current_left ? current_left->Shape().GetDims() : left_dims,
@@ -186,7 +192,7 @@ std::unique_ptr<Tensor> EinsumTypedComputeProcessor<T>::PairwiseOperandProcess(c
   right_permutation.insert(right_permutation.end(), reduce_dims.begin(), reduce_dims.end());
   right_permutation.insert(right_permutation.end(), ro.begin(), ro.end());
   right_permutation.insert(right_permutation.end(), lo.begin(), lo.end());
-  if (EinsumOp::IsTransposeRequired(current_right ? current_right->Shape().GetDims().size() : right_dims.size(),
+  if (EinsumOp::IsTransposeRequired(current_right ? current_right->Shape().GetDims() : right_dims,
                                     right_permutation)) {
     current_right = EinsumOp::Transpose(current_right ? *current_right : right,
                                         current_right ? current_right->Shape().GetDims() : right_dims,
@@ -257,9 +263,17 @@ std::unique_ptr<Tensor> EinsumTypedComputeProcessor<T>::PairwiseOperandProcess(c
   output->Reshape(output_dims);
 
   if (!is_final_pair) {  // This is not the final pair - so bring the axes order to what the inputs conformed to
-    if (EinsumOp::IsTransposeRequired(output_dims.size(), output_permutation)) {
+    if (EinsumOp::IsTransposeRequired(output_dims, output_permutation)) {
       output = EinsumOp::Transpose(*output, output_dims, output_permutation, allocator_,
                                    einsum_ep_assets_, device_transpose_func_);
+    } else if (EinsumOp::IsTransposeRequired(output_dims.size(), output_permutation)) {
+      // Only dims of value 1 move, so the memory layout is already in the required order
+      std::vector<int64_t> permuted_output_dims;
+      permuted_output_dims.reserve(output_dims.size());
+      for (const auto dim : output_permutation) {
+        permuted_output_dims.push_back(output_dims[dim]);
+      }
+      output->Reshape(permuted_output_dims);
     }
   } else {  // This is the final pair - Transpose directly to the output ordering required and copy the contents to the op's output
     FinalizeOutput(*output, current_subscript_order);
@@ -293,13 +307,11 @@ Status EinsumTypedComputeProcessor<T>::Run() {
 
   auto num_inputs = context_->InputCount();
 
-  // Pre-process the first input so as to reduce any dims that only it has
-  std::unique_ptr<const Tensor> result;
-
-  {
+  // Finalize the output right away if there is a single input
+  if (num_inputs == 1) {
+    std::unique_ptr<const Tensor> result;
     std::vector<int64_t> reduced_dims;
     std::vector<int64_t> preserved_dims;           // dims which were not reduced
-    std::vector<int64_t> preserved_shape;          // shape pertaining to only the dims that were preserved (not reduced)
     reduced_dims.reserve(num_subscript_labels);    // num_subscript_labels is the upper bound. No harm in over-reserving.
     preserved_dims.reserve(num_subscript_labels);  // num_subscript_labels is the upper bound. No harm in over-reserving.
 
@@ -324,39 +336,98 @@ Status EinsumTypedComputeProcessor<T>::Run() {
       }
     }
 
-    // Finalize the output at this stage if num_inputs == 1
-    if (num_inputs == 1) {
-      // Finalize the output by applying any transpose required to get
-      // it to the required output ordering and move it to the op's output
-      FinalizeOutput(result ? *result : *raw_inputs[0], preserved_dims);
+    // Finalize the output by applying any transpose required to get
+    // it to the required output ordering and move it to the op's output
+    FinalizeOutput(result ? *result : *raw_inputs[0], preserved_dims);
+
+    return Status::OK();
+  }
+
+  const auto& subscript_indices_to_output_indices = einsum_compute_preprocessor_.GetMappedSubscriptIndicesToOutputindices();
+
+  // The operands that remain to be contracted, with their homogenized dims
+  std::vector<std::unique_ptr<Tensor>> owned_operands;
+  std::vector<const Tensor*> operands;
+  std::vector<std::vector<int64_t>> operand_dims;
+  owned_operands.reserve(num_inputs);
+  operands.reserve(num_inputs);
+  operand_dims.reserve(num_inputs);
 
-      return Status::OK();
+  // Pre-process the inputs so as to reduce any dims that only one of them has
+  // (and are not in the output), so that the contraction order is chosen on the reduced sizes
+  for (int input = 0; input < num_inputs; ++input) {
+    const auto& dims = homogenized_input_dims[input].GetDims();
+
+    std::vector<int64_t> reduced_dims;
+    for (int64_t dim = 0; dim < num_subscript_labels; ++dim) {
+      if (dims[static_cast<size_t>(dim)] <= 1 || subscript_indices_to_output_indices[dim] != -1) {
+        continue;
+      }
+
+      bool only_in_this_input = true;
+      for (int other = 0; other < num_inputs && only_in_this_input; ++other) {
+        only_in_this_input = other == input || homogenized_input_dims[other][static_cast<size_t>(dim)] <= 1;
+      }
+
+      if (only_in_this_input) {
+        reduced_dims.push_back(dim);
+      }
     }
+
+    // Use either the preprocessed inputs (if it is available) or the corresponding raw inputs
+    std::unique_ptr<Tensor> operand = std::move(preprocessed_inputs[input]);
+    if (!reduced_dims.empty()) {
+      operand = EinsumOp::ReduceSum<T>(operand ? *operand : *raw_inputs[input], dims, reduced_dims,
+                                       allocator_, tp_, einsum_ep_assets_, device_reduce_sum_func_);
+    }
+
+    operands.push_back(operand ? operand.get() : raw_inputs[input]);
+    operand_dims.push_back(operand ? operand->Shape().GetDims() : dims);
+    owned_operands.push_back(std::move(operand));
   }
 
-  // Process the operands in a pair-wise fashion
-  {
-    bool is_final_pair = false;
-    // Keep processing each input pair-wise
-    for (int input = 1; input < num_inputs; ++input) {
-      std::vector<int64_t> reduced_dims;
-      reduced_dims.reserve(num_subscript_labels);  // num_subscript_labels is the upper bound. No harm in over-reserving by a small margin.
-      for (int64_t dim = 0; dim < num_subscript_labels; ++dim) {
-        if (mapped_indices_to_last_input_index[dim] == input) {
-          // This is the last input we are seeing this dimension (and it doesn't occur in the output), so reduce along the dimension
-          reduced_dims.push_back(dim);
-        }
+  const auto contraction_order =
+      contraction_order_cache_
+          ? contraction_order_cache_->GetOrFind(operand_dims, subscript_indices_to_output_indices)
+          : EinsumOp::FindContractionOrder(operand_dims, subscript_indices_to_output_indices);
+
+  // Process the operands in a pair-wise fashion in the chosen order
+  for (size_t step_index = 0, num_steps = contraction_order.size(); step_index < num_steps; ++step_index) {
+    const auto& step = contraction_order[step_index];
+    const bool is_final_pair = step_index == num_steps - 1;
+
+    // Reduce the dims that neither the output nor any of the other remaining operands have
+    std::vector<int64_t> reduced_dims;
+    reduced_dims.reserve(num_subscript_labels);  // num_subscript_labels is the upper bound. No harm in over-reserving by a small margin.
+    for (int64_t dim = 0; dim < num_subscript_labels; ++dim) {
+      if (subscript_indices_to_output_indices[dim] != -1) {
+        continue;
       }
-      if (input == num_inputs - 1) {
-        is_final_pair = true;
+
+      bool in_other_operand = false;
+      for (size_t other = 0, end = operands.size(); other < end && !in_other_operand; ++other) {
+        in_other_operand = other != step.left && other != step.right && operand_dims[other][static_cast<size_t>(dim)] > 1;
       }
-      // Use either the preprocessed inputs (if it is available) or the corresponding raw inputs
-      result = PairwiseOperandProcess(result ? *result : *raw_inputs[0],
-                                      result ? result->Shape() : homogenized_input_dims[0],
-                                      preprocessed_inputs[input] ? *preprocessed_inputs[input] : *raw_inputs[input],
-                                      homogenized_input_dims[input],
-                                      reduced_dims, is_final_pair);
+
+      if (!in_other_operand) {
+        reduced_dims.push_back(dim);
+      }
+    }
+
+    auto result = PairwiseOperandProcess(*operands[step.left], operand_dims[step.left],
+                                         *operands[step.right], operand_dims[step.right],
+                                         reduced_dims, is_final_pair);
+
+    // Remove the contracted operands and append the result
+    for (size_t position : {std::max(step.left, step.right), std::min(step.left, step.right)}) {
+      owned_operands.erase(owned_operands.begin() + position);
+      operands.erase(operands.begin() + position);
+      operand_dims.erase(operand_dims.begin() + position);
     }
+
+    operands.push_back(result.get());
+    operand_dims.push_back(result->Shape().GetDims());
+    owned_operands.push_back(std::move(result));
   }
 
   return Status::OK();
@@ -9,6 +9,7 @@
 
 #include "einsum_auxiliary_ops.h"
 #include "einsum_compute_preprocessor.h"
+#include "einsum_contraction_order.h"
 
 namespace onnxruntime {
 
@@ -33,6 +34,12 @@ class EinsumTypedComputeProcessor {
                         const EinsumOp::DeviceHelpers::ReduceSum<T>& device_reduce_sum_func,
                         const EinsumOp::DeviceHelpers::DataCopy& device_data_copy_func);
 
+  // Optional cache of the contraction order, owned by the kernel so that it persists across runs.
+  // If not set, the contraction order is found in every run.
+  void SetContractionOrderCache(EinsumOp::ContractionOrderCache* contraction_order_cache) {
+    contraction_order_cache_ = contraction_order_cache;
+  }
+
   Status Run();
 
  private:
@@ -67,6 +74,8 @@ class EinsumTypedComputeProcessor {
 
   // Holds EP-specific assets required for (auxiliary) ops that need to be executed on non-CPU EPs
   void* einsum_ep_assets_;
+
+  EinsumOp::ContractionOrderCache* contraction_order_cache_ = nullptr;
 };
 
 }  // namespace onnxruntime
@@ -3,6 +3,8 @@
 
 #include "core/providers/cpu/ml/array_feature_extractor.h"
 
+#include "core/platform/threadpool.h"
+
 /**
 https://github.com/onnx/onnx/blob/master/onnx/defs/traditionalml/defs.cc
 ONNX_OPERATOR_SCHEMA(ArrayFeatureExtractor)
@@ -93,12 +95,19 @@ common::Status ArrayFeatureExtractorOp<T>::Compute(OpKernelContext* context) con
   T* z_data = Z->template MutableData<T>();
 
   const int64_t x_size_until_last_dim = x_shape.SizeToDimension(x_num_dims - 1);
-  for (int64_t i = 0; i < x_size_until_last_dim; ++i) {
-    for (int64_t j = 0; j < num_indices; ++j) {
-      *z_data++ = x_data[y_data[j]];
-    }
-    x_data += stride;
-  }
+  concurrency::ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), x_size_until_last_dim,
+      TensorOpCost{static_cast<double>(sizeof(T) * num_indices), static_cast<double>(sizeof(T) * num_indices),
+                   static_cast<double>(num_indices)},
+      [x_data, y_data, z_data, stride, num_indices](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          const T* x_row = x_data + i * stride;
+          T* z_row = z_data + i * num_indices;
+          for (int64_t j = 0; j < num_indices; ++j) {
+            z_row[j] = x_row[y_data[j]];
+          }
+        }
+      });
 
   return Status::OK();
 }
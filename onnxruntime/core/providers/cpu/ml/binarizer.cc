@@ -2,7 +2,9 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/ml/binarizer.h"
+#include <atomic>
 #include <cmath>
+#include "core/platform/threadpool.h"
 /**
 https://github.com/onnx/onnx/blob/master/onnx/defs/traditionalml/defs.cc
 
@@ -43,20 +45,36 @@ common::Status BinarizerOp<T>::Compute(OpKernelContext* context) const {
   Tensor* Y = context->Output(0, x_shape);
   const T* x_data = X.template Data<T>();
   T* y_data = Y->template MutableData<T>();
-  size_t x_size = x_shape.Size();
-
-  common::Status status = common::Status::OK();
-  for (size_t i = 0; i < x_size; ++i) {
-    T x_val = x_data[i];
-    T& y_val = y_data[i];
-
-    auto tmp = static_cast<float>(x_val);  // this cast is necessary because isnan doesn't work otherwise.
-    if (std::isnan(tmp)) {
-      return common::Status(common::ONNXRUNTIME, common::FAIL, "Input data with index: " + std::to_string(i) + " is NaN");
-    }
-    y_val = x_val > threshold_ ? static_cast<T>(1) : static_cast<T>(0);
+  const int64_t x_size = x_shape.Size();
+  const float threshold = threshold_;
+
+  // the index of the first NaN in the input, or x_size if there is none
+  std::atomic<int64_t> first_nan{x_size};
+
+  concurrency::ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), x_size,
+      TensorOpCost{static_cast<double>(sizeof(T)), static_cast<double>(sizeof(T)), 2.0},
+      [x_data, y_data, threshold, &first_nan](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          const T x_val = x_data[i];
+          if (std::isnan(static_cast<float>(x_val))) {  // this cast is necessary because isnan doesn't work otherwise.
+            int64_t current = first_nan.load();
+            while (i < current && !first_nan.compare_exchange_weak(current, i)) {
+            }
+            return;
+          }
+
+          y_data[i] = x_val > threshold ? static_cast<T>(1) : static_cast<T>(0);
+        }
+      });
+
+  const int64_t nan_index = first_nan.load();
+  if (nan_index < x_size) {
+    return common::Status(common::ONNXRUNTIME, common::FAIL,
+                          "Input data with index: " + std::to_string(nan_index) + " is NaN");
   }
-  return status;
+
+  return common::Status::OK();
 }
 }  // namespace ml
 }  // namespace onnxruntime
@@ -3,8 +3,12 @@
 
 #include "core/providers/cpu/ml/feature_vectorizer.h"
 
+#include <algorithm>
+
 #include <gsl/gsl>
 
+#include "core/platform/threadpool.h"
+
 namespace onnxruntime {
 namespace ml {
 
@@ -20,12 +24,7 @@ ONNX_CPU_OPERATOR_ML_KERNEL(
 
 template <typename T>
 static void VectorizeTensor(const Tensor& input_tensor, int64_t feature_size, int64_t sum_input_dimensions,
-                            typename gsl::span<float>::iterator out_iter);
-
-template <typename T>
-static void CopyWithCast(typename gsl::span<const T>::const_iterator begin,
-                         typename gsl::span<const T>::const_iterator end,
-                         gsl::span<float>::iterator out_iter);
+                            float* out, int64_t num_rows, concurrency::ThreadPool* tp);
 
 Status FeatureVectorizer::Compute(OpKernelContext* context) const {
   int input_count = context->NumVariadicInputs(0);
@@ -40,14 +39,11 @@ Status FeatureVectorizer::Compute(OpKernelContext* context) const {
   // assumes all inputs have the same batch size
   int64_t N = X.Shape().NumDimensions() == 1 ? 1 : x_dims[0];
 
-  // initialize all the output to 0.f
+  // every column of the output is written by one of the inputs, including any padding
   Tensor* Y = context->Output(0, {N, total_dimensions_});
   auto Y_data = Y->template MutableData<float>();
 
-  auto out = gsl::make_span(Y_data, Y->Shape().Size());
-
-  // init all to 0.f so we don't need to do that each loop if we have to add padding
-  std::fill_n(out.data(), out.size(), 0.f);
+  auto* tp = context->GetOperatorThreadPool();
 
   int64_t feature_offset = 0;
 
@@ -59,17 +55,17 @@ Status FeatureVectorizer::Compute(OpKernelContext* context) const {
 
     auto feature_size = input_dimensions_[index];
 
-    auto cur_out = out.begin() + feature_offset;
+    auto* cur_out = Y_data + feature_offset;
 
     if (input_tensor.IsDataType<float>()) {
       // straight copy for float to float
-      VectorizeTensor<float>(input_tensor, feature_size, total_dimensions_, cur_out);
+      VectorizeTensor<float>(input_tensor, feature_size, total_dimensions_, cur_out, N, tp);
     } else if (input_tensor.IsDataType<int32_t>()) {
-      VectorizeTensor<int32_t>(input_tensor, feature_size, total_dimensions_, cur_out);
+      VectorizeTensor<int32_t>(input_tensor, feature_size, total_dimensions_, cur_out, N, tp);
     } else if (input_tensor.IsDataType<int64_t>()) {
-      VectorizeTensor<int64_t>(input_tensor, feature_size, total_dimensions_, cur_out);
+      VectorizeTensor<int64_t>(input_tensor, feature_size, total_dimensions_, cur_out, N, tp);
     } else if (input_tensor.IsDataType<double>()) {
-      VectorizeTensor<double>(input_tensor, feature_size, total_dimensions_, cur_out);
+      VectorizeTensor<double>(input_tensor, feature_size, total_dimensions_, cur_out, N, tp);
     } else {
       // should never happen. graph validation should have failed
       ORT_THROW("Invalid input type:", input_tensor.DataType());
@@ -82,9 +78,11 @@ Status FeatureVectorizer::Compute(OpKernelContext* context) const {
   return Status::OK();
 }  // namespace ml
 
+// Write the input to the columns [0, feature_size) of each of the num_rows rows of out.
+// Columns the input has no data for are set to 0.
 template <typename T>
 static void VectorizeTensor(const Tensor& input_tensor, int64_t feature_size, int64_t sum_input_dimensions,
-                            typename gsl::span<float>::iterator out_iter) {
+                            float* out, int64_t num_rows, concurrency::ThreadPool* tp) {
   auto& shape = input_tensor.Shape();
   auto& input_dims = shape.GetDims();
 
@@ -97,32 +95,27 @@ static void VectorizeTensor(const Tensor& input_tensor, int64_t feature_size, in
     stride = feature_size;
   }
 
-  auto data = input_tensor.template Data<T>();
-  auto input = gsl::make_span(data, shape.Size());
-  auto input_iter = input.cbegin();
-
-  for (int i = 0; i < N;) {
-    // copy each row to the output. iters are passed by value
-    CopyWithCast<T>(input_iter, input_iter + stride, out_iter);
-
-    // skip to start of next input row, and start of next output
-    // if we have more input. otherwise we go past then end of the input and the bounds checking errors out
-    if (++i < N) {
-      input_iter += input_size;
-      out_iter += sum_input_dimensions;
-    }
-  }
-}
-
-template <typename T>
-static void CopyWithCast(typename gsl::span<const T>::const_iterator begin,
-                         typename gsl::span<const T>::const_iterator end,
-                         gsl::span<float>::iterator out_iter) {
-  std::for_each(begin, end,
-                [&out_iter](const typename gsl::span<T>::const_reference value) {
-                  *out_iter = static_cast<float>(value);
-                  ++out_iter;
-                });
+  const T* data = input_tensor.template Data<T>();
+
+  concurrency::ThreadPool::TryParallelFor(
+      tp, num_rows,
+      TensorOpCost{static_cast<double>(sizeof(T) * stride), static_cast<double>(sizeof(float) * feature_size),
+                   static_cast<double>(feature_size)},
+      [data, out, input_size, N, stride, feature_size, sum_input_dimensions](std::ptrdiff_t first,
+                                                                            std::ptrdiff_t last) {
+        for (std::ptrdiff_t row = first; row < last; ++row) {
+          float* out_row = out + row * sum_input_dimensions;
+          int64_t copied = 0;
+          if (row < N) {
+            const T* in_row = data + row * input_size;
+            for (; copied < stride; ++copied) {
+              out_row[copied] = static_cast<float>(in_row[copied]);
+            }
+          }
+
+          std::fill(out_row + copied, out_row + feature_size, 0.f);
+        }
+      });
 }
 
 }  // namespace ml
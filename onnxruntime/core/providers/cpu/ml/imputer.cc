@@ -3,6 +3,7 @@
 
 #include "core/providers/cpu/ml/imputer.h"
 #include <cmath>
+#include "core/platform/threadpool.h"
 /**
 https://github.com/onnx/onnx/blob/master/onnx/defs/traditionalml/defs.cc
 ONNX_OPERATOR_SCHEMA(Imputer)
@@ -87,28 +88,31 @@ common::Status ComputeByType(OpKernelContext* context,
 
   Tensor* Y = context->Output(0, x_shape);
   T* y_data = Y->template MutableData<T>();
-  if (imputed_values.size() == static_cast<size_t>(stride)) {
-    for (size_t i = 0; i < x_size; i++) {
-      if (std::isnan(static_cast<float>(x_data[i])) && std::isnan(static_cast<float>(replaced_value))) {
-        y_data[i] = imputed_values[i % stride];
-      } else if (x_data[i] == replaced_value) {
-        y_data[i] = imputed_values[i % stride];
-      } else {
-        y_data[i] = x_data[i];
-      }
-    }
-  } else {
-    for (size_t i = 0; i < x_size; i++) {
-      if (std::isnan(static_cast<float>(x_data[i])) && std::isnan(static_cast<float>(replaced_value))) {
-        y_data[i] = imputed_values[0];
-      } else if (x_data[i] == replaced_value) {
-        y_data[i] = imputed_values[0];
-      } else {
-        y_data[i] = x_data[i];
-      }
-    }
+  if (x_size == 0) {
+    return Status::OK();
   }
 
+  // impute whole rows in parallel. if there isn't an imputed value per feature the first one is used for all.
+  const bool per_feature = imputed_values.size() == static_cast<size_t>(stride);
+  const bool replace_nan = std::isnan(static_cast<float>(replaced_value));
+  const int64_t num_rows = static_cast<int64_t>(x_size) / stride;
+  const T* imputed = imputed_values.data();
+  const TensorOpCost cost{static_cast<double>(sizeof(T) * stride), static_cast<double>(sizeof(T) * stride),
+                          static_cast<double>(2 * stride)};
+
+  concurrency::ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), num_rows, cost,
+      [=](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t row = first; row < last; ++row) {
+          const T* x = x_data + row * stride;
+          T* y = y_data + row * stride;
+          for (int64_t i = 0; i < stride; ++i) {
+            const bool replace = replace_nan ? std::isnan(static_cast<float>(x[i])) : x[i] == replaced_value;
+            y[i] = replace ? imputed[per_feature ? i : 0] : x[i];
+          }
+        }
+      });
+
   return Status::OK();
 }
 
@@ -6,6 +6,8 @@
 #include <algorithm>
 #include "gsl/gsl"
 
+#include "core/platform/threadpool.h"
+
 /*
 ONNX_OPERATOR_SCHEMA(Normalizer)
     .SetDomain("ai.onnx.ml")
@@ -42,82 +44,94 @@ ONNX_CPU_OPERATOR_ML_KERNEL(
                                                      DataTypeImpl::GetTensorType<int64_t>()}),
     Normalizer);
 
+// Each function normalizes a single row of batch_size values
+
 template <typename T>
-void NormalizeMax(const T* in, float* out, int64_t num_batches, int64_t batch_size) {
-  for (int b = 0; b < num_batches; ++b) {
-    float max = std::numeric_limits<float>::lowest();
+static void NormalizeMax(const T* in, float* out, int64_t batch_size) {
+  float max = std::numeric_limits<float>::lowest();
+  for (int64_t i = 0; i < batch_size; ++i) {
+    max = std::max(max, static_cast<float>(in[i]));
+  }
 
-    for (int i = 0; i < batch_size; ++i) {
-      max = std::max(max, static_cast<float>(*in++));
+  if (max != 0.f) {
+    for (int64_t i = 0; i < batch_size; ++i) {
+      out[i] = static_cast<float>(in[i]) / max;
     }
-
-    in -= batch_size;
-
-    if (max != 0.f) {
-      for (int i = 0; i < batch_size; ++i) {
-        *out++ = static_cast<float>(*in++) / max;
-      }
-    } else {
-      for (int i = 0; i < batch_size; ++i) {
-        *out++ = static_cast<float>(*in++);
-      }
+  } else {
+    for (int64_t i = 0; i < batch_size; ++i) {
+      out[i] = static_cast<float>(in[i]);
     }
   }
 }
 
 template <typename T>
-static void NormalizeL1(const T* in, float* out, int64_t num_batches, int64_t batch_size) {
-  for (int b = 0; b < num_batches; ++b) {
-    float sum = 0.f;
+static void NormalizeL1(const T* in, float* out, int64_t batch_size) {
+  float sum = 0.f;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    sum += static_cast<float>(std::abs(in[i]));
+  }
 
-    for (int i = 0; i < batch_size; ++i) {
-      sum += static_cast<float>(std::abs(*in++));
+  if (sum != 0.f) {
+    for (int64_t i = 0; i < batch_size; ++i) {
+      out[i] = static_cast<float>(in[i]) / sum;
     }
-
-    in -= batch_size;
-
-    if (sum != 0.f) {
-      for (int i = 0; i < batch_size; ++i) {
-        *out++ = static_cast<float>(*in++) / sum;
-      }
-    } else {
-      for (int i = 0; i < batch_size; ++i) {
-        *out++ = static_cast<float>(*in++);
-      }
+  } else {
+    for (int64_t i = 0; i < batch_size; ++i) {
+      out[i] = static_cast<float>(in[i]);
     }
   }
 }
 
 template <typename T>
-void NormalizeL2(const T* in, float* out, int64_t num_batches, int64_t batch_size) {
-  for (int b = 0; b < num_batches; ++b) {
-    float sum = 0.f;
-
-    for (int i = 0; i < batch_size; ++i) {
-      auto x = *in++;
-      auto x_sq = static_cast<float>(x * x);
-      *out++ = x_sq;
-      sum += x_sq;
-    }
-
-    in -= batch_size;
-    out -= batch_size;
-
-    if (sum != 0.f) {
-      for (int i = 0; i < batch_size; ++i) {
-        auto x = *in++;
-        auto x_sq = *out;
+static void NormalizeL2(const T* in, float* out, int64_t batch_size) {
+  // the input may be the same buffer as the output, so the squares can't be stored in the output
+  // before the sum is known
+  float sum = 0.f;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    sum += static_cast<float>(in[i] * in[i]);
+  }
 
-        *out++ = (x < 0) ? std::sqrt(x_sq / sum) * -1 : std::sqrt(x_sq / sum);
-      }
-    } else {
-      for (int i = 0; i < batch_size; ++i) {
-        *out++ = static_cast<float>(*in++);
-      }
+  if (sum != 0.f) {
+    for (int64_t i = 0; i < batch_size; ++i) {
+      const auto x = in[i];
+      const auto x_sq = static_cast<float>(x * x);
+      out[i] = (x < 0) ? std::sqrt(x_sq / sum) * -1 : std::sqrt(x_sq / sum);
+    }
+  } else {
+    for (int64_t i = 0; i < batch_size; ++i) {
+      out[i] = static_cast<float>(in[i]);
     }
   }
 }
 
+template <typename T>
+static void NormalizeRows(NORMALIZE normalization, const T* input, float* output, int64_t num_batches,
+                          int64_t batch_size, concurrency::ThreadPool* tp) {
+  // each row is loaded twice
+  const TensorOpCost cost{static_cast<double>(2 * sizeof(T) * batch_size),
+                          static_cast<double>(sizeof(float) * batch_size),
+                          static_cast<double>(4 * batch_size)};
+
+  concurrency::ThreadPool::TryParallelFor(
+      tp, num_batches, cost, [normalization, input, output, batch_size](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t b = first; b < last; ++b) {
+          const T* in = input + b * batch_size;
+          float* out = output + b * batch_size;
+          switch (normalization) {
+            case NORMALIZE::NMAX:
+              NormalizeMax(in, out, batch_size);
+              break;
+            case NORMALIZE::L1:
+              NormalizeL1(in, out, batch_size);
+              break;
+            case NORMALIZE::L2:
+              NormalizeL2(in, out, batch_size);
+              break;
+          }
+        }
+      });
+}
+
 template <typename T>
 Status Normalizer::Normalize(OpKernelContext* context) const {
   const Tensor& X = *context->Input<Tensor>(0);
@@ -138,16 +152,10 @@ Status Normalizer::Normalize(OpKernelContext* context) const {
   float* output = Y->MutableData<float>();
 
   switch (normalization_) {
-    case NORMALIZE::NMAX: {
-      NormalizeMax(input, output, num_batches, batch_size);
-      break;
-    }
-    case NORMALIZE::L1: {
-      NormalizeL1(input, output, num_batches, batch_size);
-      break;
-    }
+    case NORMALIZE::NMAX:
+    case NORMALIZE::L1:
     case NORMALIZE::L2: {
-      NormalizeL2(input, output, num_batches, batch_size);
+      NormalizeRows(normalization_, input, output, num_batches, batch_size, context->GetOperatorThreadPool());
       break;
     }
     default: {
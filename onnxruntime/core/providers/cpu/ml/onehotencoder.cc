@@ -2,6 +2,11 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/ml/onehotencoder.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "core/platform/threadpool.h"
 /**
 https://github.com/onnx/onnx/blob/master/onnx/defs/traditionalml/defs.cc
 ONNX_OPERATOR_SCHEMA(OneHotEncoder)
@@ -78,18 +83,27 @@ common::Status OneHotEncoderOp<T>::Compute(OpKernelContext* context) const {
 
   Tensor* Y = context->Output(0, TensorShape(output_shape));
   auto* y_data = Y->template MutableData<float>();
-  std::fill_n(y_data, Y->Shape().Size(), 0.0f);
 
   const auto* x_data = X->template Data<T>();
   const auto x_size = input_shape.Size();
-  std::unordered_map<int64_t, size_t>::const_iterator idx;
-  for (int64_t i = 0; i < x_size; ++i) {
-    auto int_idx = cats_int64s_.find(static_cast<int64_t>(x_data[i]));
-    if (int_idx != cats_int64s_.cend())
-      y_data[i * num_categories_ + int_idx->second] = 1.0f;
-    else if (!zeros_)
-      return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
-  }
+  std::atomic<bool> unknown_category{false};
+  concurrency::ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), x_size,
+      TensorOpCost{static_cast<double>(sizeof(T)), static_cast<double>(sizeof(float) * num_categories_), 20.0},
+      [this, x_data, y_data, &unknown_category](std::ptrdiff_t first, std::ptrdiff_t last) {
+        // each input value owns a row of num_categories_ outputs, so rows are zeroed in the same pass
+        std::fill(y_data + first * num_categories_, y_data + last * num_categories_, 0.0f);
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          auto int_idx = cats_int64s_.find(static_cast<int64_t>(x_data[i]));
+          if (int_idx != cats_int64s_.cend())
+            y_data[i * num_categories_ + int_idx->second] = 1.0f;
+          else if (!zeros_)
+            unknown_category = true;
+        }
+      });
+
+  if (unknown_category)
+    return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
   return Status::OK();
 }
 
@@ -103,17 +117,27 @@ common::Status OneHotEncoderOp<std::string>::Compute(OpKernelContext* context) c
 
   Tensor* Y = context->Output(0, TensorShape(output_shape));
   auto* y_data = Y->template MutableData<float>();
-  std::fill_n(y_data, Y->Shape().Size(), 0.0f);
 
   const auto* x_data = X->template Data<std::string>();
   const auto x_size = input_shape.Size();
-  for (int64_t i = 0; i < x_size; ++i) {
-    auto str_idx = cats_strings_.find(x_data[i]);
-    if (str_idx != cats_strings_.cend())
-      y_data[i * num_categories_ + str_idx->second] = 1.0f;
-    else if (!zeros_)
-      return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
-  }
+  std::atomic<bool> unknown_category{false};
+  concurrency::ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), x_size,
+      TensorOpCost{static_cast<double>(sizeof(std::string)), static_cast<double>(sizeof(float) * num_categories_), 100.0},
+      [this, x_data, y_data, &unknown_category](std::ptrdiff_t first, std::ptrdiff_t last) {
+        // each input value owns a row of num_categories_ outputs, so rows are zeroed in the same pass
+        std::fill(y_data + first * num_categories_, y_data + last * num_categories_, 0.0f);
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          auto str_idx = cats_strings_.find(x_data[i]);
+          if (str_idx != cats_strings_.cend())
+            y_data[i * num_categories_ + str_idx->second] = 1.0f;
+          else if (!zeros_)
+            unknown_category = true;
+        }
+      });
+
+  if (unknown_category)
+    return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
   return Status::OK();
 }
 
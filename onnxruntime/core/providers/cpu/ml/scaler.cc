@@ -3,6 +3,8 @@
 
 #include "core/providers/cpu/ml/scaler.h"
 
+#include "core/platform/threadpool.h"
+
 /**
 https://github.com/onnx/onnx/blob/master/onnx/defs/traditionalml/defs.cc
 ONNX_OPERATOR_SCHEMA(Scaler)
@@ -60,8 +62,6 @@ ONNX_CPU_OPERATOR_TYPED_ML_KERNEL(
     KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<int32_t>()).MayInplace(0, 0),
     ScalerOp<int32_t>);
 
-static constexpr int kParallelizationThreshold = 10 * 1000;
-
 template <typename T>
 ScalerOp<T>::ScalerOp(const OpKernelInfo& info) : OpKernel(info),
                                                   scale_(info.GetAttrsOrDefault<float>("scale")),
@@ -83,35 +83,48 @@ common::Status ScalerOp<T>::Compute(OpKernelContext* context) const {
     return Status(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid argument: input has empty dimensions.");
   }
 
-  size_t x_size = x_shape.Size();
-  int64_t stride = x_dims.size() == 1 ? x_dims[0] : x_dims[1];
-  auto* ttp = context->GetOperatorThreadPool();
-  auto conditional_batch_call = [ttp, x_size](std::function<void(ptrdiff_t)> f) {
-    if (x_size < kParallelizationThreshold) {  // TODO: tune this, arbitrary threshold
-      for (size_t i = 0; i < x_size; ++i) {
-        f(i);
-      }
-    } else {
-      concurrency::ThreadPool::TryBatchParallelFor(ttp, x_size, f, 0);
-    }
-  };
+  const int64_t x_size = x_shape.Size();
+  const int64_t stride = x_dims.size() == 1 ? x_dims[0] : x_dims[1];
 
-  if (static_cast<int64_t>(offset_.size()) == stride &&
-      static_cast<int64_t>(scale_.size()) == stride) {
-    auto fn = [this, y_data, x_data, stride](ptrdiff_t i) {
-      y_data[i] = static_cast<float>((x_data[i] - offset_[i % stride]) * scale_[i % stride]);
-    };
-    conditional_batch_call(fn);
-  } else if (offset_.size() == 1 && scale_.size() == 1) {
-    auto fn = [this, y_data, x_data](ptrdiff_t i) {
-      y_data[i] = static_cast<float>((x_data[i] - offset_[0]) * scale_[0]);
-    };
-    conditional_batch_call(fn);
-  } else {
+  const bool per_feature = static_cast<int64_t>(offset_.size()) == stride &&
+                           static_cast<int64_t>(scale_.size()) == stride;
+  if (!per_feature && !(offset_.size() == 1 && scale_.size() == 1)) {
     std::ostringstream err_msg;
     err_msg << "Either both scale and offset can be of feature size (" << stride << ") or 1";
     return Status(ONNXRUNTIME, INVALID_ARGUMENT, err_msg.str());
   }
+
+  if (x_size == 0) {
+    return Status::OK();
+  }
+
+  // process whole rows so the inner loops are over contiguous features and can be vectorized
+  const int64_t num_rows = x_size / stride;
+  const float* offset = offset_.data();
+  const float* scale = scale_.data();
+  const TensorOpCost cost{static_cast<double>(sizeof(T) * stride), static_cast<double>(sizeof(float) * stride),
+                          static_cast<double>(2 * stride)};
+
+  concurrency::ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), num_rows, cost,
+      [x_data, y_data, stride, offset, scale, per_feature](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t row = first; row < last; ++row) {
+          const T* x = x_data + row * stride;
+          float* y = y_data + row * stride;
+          if (per_feature) {
+            for (int64_t i = 0; i < stride; ++i) {
+              y[i] = static_cast<float>((x[i] - offset[i]) * scale[i]);
+            }
+          } else {
+            const float row_offset = offset[0];
+            const float row_scale = scale[0];
+            for (int64_t i = 0; i < stride; ++i) {
+              y[i] = static_cast<float>((x[i] - row_offset) * row_scale);
+            }
+          }
+        }
+      });
+
   return Status::OK();
 }
 }  // namespace ml
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/ml/zipmap.h"
+#include "core/platform/threadpool.h"
 #include "core/util/math_cpuonly.h"
 /**
 https://github.com/onnx/onnx/blob/master/onnx/defs/traditionalml/defs.cc
@@ -35,6 +36,46 @@ ONNX_CPU_OPERATOR_ML_KERNEL(
                                             DataTypeImpl::GetType<std::vector<std::map<std::int64_t, float>>>()}),
     ZipMapOp);
 
+template <typename TKey>
+static void BuildMapTemplate(const std::vector<TKey>& labels, std::map<TKey, float>& map_template,
+                             std::vector<size_t>& value_indices) {
+  // with duplicate labels the value of the last one is kept, as if the map was built by inserting in label order
+  std::map<TKey, size_t> last_index;
+  for (size_t j = 0, end = labels.size(); j < end; ++j) {
+    last_index[labels[j]] = j;
+  }
+
+  value_indices.reserve(last_index.size());
+  for (const auto& entry : last_index) {
+    map_template.emplace_hint(map_template.end(), entry.first, 0.f);
+    value_indices.push_back(entry.second);
+  }
+}
+
+// Copy the template for each row and assign the values in key order, which avoids looking up every key
+template <typename TKey>
+static void FillMaps(const std::map<TKey, float>& map_template, const std::vector<size_t>& value_indices,
+                     const float* x_data, int64_t batch_size, int64_t features_per_batch,
+                     std::vector<std::map<TKey, float>>& maps, concurrency::ThreadPool* tp) {
+  maps.resize(batch_size);
+  concurrency::ThreadPool::TryParallelFor(
+      tp, batch_size,
+      TensorOpCost{static_cast<double>(sizeof(float) * features_per_batch),
+                   static_cast<double>(sizeof(typename std::map<TKey, float>::value_type) * features_per_batch),
+                   static_cast<double>(50 * features_per_batch)},
+      [&map_template, &value_indices, &maps, x_data, features_per_batch](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t n = first; n < last; ++n) {
+          const float* row = x_data + n * features_per_batch;
+          auto& map = maps[n];
+          map = map_template;
+          auto value_index = value_indices.cbegin();
+          for (auto& entry : map) {
+            entry.second = row[*value_index++];
+          }
+        }
+      });
+}
+
 ZipMapOp::ZipMapOp(const OpKernelInfo& info)
     : OpKernel(info),
       classlabels_int64s_(info.GetAttrsOrDefault<int64_t>("classlabels_int64s")),
@@ -42,6 +83,12 @@ ZipMapOp::ZipMapOp(const OpKernelInfo& info)
   ORT_ENFORCE(classlabels_strings_.empty() ^ classlabels_int64s_.empty(),
               "Must provide classlabels_strings or classlabels_int64s but not both.");
   using_strings_ = !classlabels_strings_.empty();
+
+  if (using_strings_) {
+    BuildMapTemplate(classlabels_strings_, string_map_template_, value_indices_);
+  } else {
+    BuildMapTemplate(classlabels_int64s_, int64_map_template_, value_indices_);
+  }
 }
 
 common::Status ZipMapOp::Compute(OpKernelContext* context) const {
@@ -77,17 +124,8 @@ common::Status ZipMapOp::Compute(OpKernelContext* context) const {
     auto* y_data = context->Output<std::vector<std::map<std::string, float>>>(0);
     if (y_data == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
 
-    //auto* y_data = Y->template MutableData<std::vector<std::map<std::string, float>>>();
-    y_data->resize(batch_size);
-    int64_t current_weight_0 = 0;
-    for (int64_t n = 0; n < batch_size; n++) {
-      std::map<std::string, float> map1;
-      for (int64_t j = 0; j < features_per_batch; j++) {
-        map1[classlabels_strings_[j]] = x_data[current_weight_0 + j];
-      }
-      current_weight_0 += features_per_batch;
-      (*y_data)[n] = std::move(map1);
-    }
+    FillMaps(string_map_template_, value_indices_, x_data, batch_size, features_per_batch, *y_data,
+             context->GetOperatorThreadPool());
   } else {
     if (features_per_batch != static_cast<int64_t>(classlabels_int64s_.size())) {
       return Status(ONNXRUNTIME,
@@ -97,17 +135,8 @@ common::Status ZipMapOp::Compute(OpKernelContext* context) const {
     }
     auto* y_data = context->Output<std::vector<std::map<std::int64_t, float>>>(0);
     if (y_data == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
-    //auto* y_data = Y->template MutableData<std::vector<std::map<int64_t, float>>>();
-    y_data->resize(batch_size);
-    int64_t current_weight_0 = 0;
-    for (int n = 0; n < batch_size; n++) {
-      std::map<int64_t, float> map2;
-      for (int j = 0; j < features_per_batch; j++) {
-        map2[classlabels_int64s_[j]] = x_data[current_weight_0 + j];
-      }
-      current_weight_0 += features_per_batch;
-      (*y_data)[n] = std::move(map2);
-    }
+    FillMaps(int64_map_template_, value_indices_, x_data, batch_size, features_per_batch, *y_data,
+             context->GetOperatorThreadPool());
   }
   return common::Status::OK();
 }
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <map>
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
 namespace onnxruntime {
@@ -16,6 +17,12 @@ class ZipMapOp final : public OpKernel {
   bool using_strings_;
   std::vector<int64_t> classlabels_int64s_;
   std::vector<std::string> classlabels_strings_;
+
+  // the map produced for every row has the same keys, so it is built once and copied for each row.
+  // value_indices_[i] is the index of the input feature whose value the i-th entry of the map (in key order) holds.
+  std::map<std::string, float> string_map_template_;
+  std::map<int64_t, float> int64_map_template_;
+  std::vector<size_t> value_indices_;
 };
 
 }  // namespace ml
@@ -4,9 +4,8 @@
 #pragma once
 
 #include "core/framework/op_kernel.h"
+#include "core/framework/philox_random.h"
 #include "core/framework/random_generator.h"
-#include <chrono>
-#include <random>
 #include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
@@ -17,14 +16,14 @@ class Dropout final: public OpKernel {
   Dropout(const OpKernelInfo& info) : OpKernel{info} {
     int64_t seed = 0;
     if (info.GetAttr<int64_t>("seed", &seed).IsOK()) {
-      generator_ = onnxruntime::make_unique<RandomGenerator>(seed);
+      generator_ = onnxruntime::make_unique<PhiloxGenerator>(static_cast<uint64_t>(seed));
     }
   }
 
   Status Compute(OpKernelContext* context) const override;
 
  private:
-  mutable std::unique_ptr<RandomGenerator> generator_;
+  mutable std::unique_ptr<PhiloxGenerator> generator_;
 };
 
 namespace {
@@ -84,12 +83,9 @@ Status Dropout<T1, T2, trainable_dropout>::Compute(OpKernelContext* context) con
 
     // generate mask
     {
-      RandomGenerator& generator = generator_ != nullptr ? *generator_.get() : RandomGenerator::Default();
-      std::default_random_engine rng(generator.NextSeed());
-      std::uniform_real_distribution<float> dist{0.0f, 1.0f};
-      mask_arr = Eigen::ArrayX<bool>::NullaryExpr(
-          mask_arr.size(),
-          [ratio_value, &dist, &rng]() { return dist(rng) >= ratio_value; });
+      PhiloxGenerator& generator = generator_ != nullptr ? *generator_.get() : PhiloxGenerator::Default();
+      FillPhiloxRandom(generator, PhiloxBernoulliDistribution{1.0f - ratio_value}, mask_span.data(),
+                       static_cast<int64_t>(mask_span.size()), context->GetOperatorThreadPool());
     }
 
     Y_arr = mask_arr.cast<T1>() * X_arr / (1.0f - ratio_value);
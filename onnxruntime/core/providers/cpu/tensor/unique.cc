@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/tensor/unique.h"
+#include "core/providers/cpu/tensor/unique_values.h"
 
 #include <map>
 #include "gsl/gsl"
@@ -131,11 +132,10 @@ class Subtensor {
 
 template <typename T>
 static void CreateFlattenedOutput(OpKernelContext& context,
-                                  const std::map<const T, int64_t>& offsets,         // map sorted key to unsorted idx
-                                  const std::vector<std::vector<int64_t>>& indices,  // unsorted
-                                  const std::vector<int64_t>& inverse_index,         // unsorted
+                                  const UniqueValues<T>& unique_values,  // in the order of first occurrence
+                                  const std::vector<int64_t>& inverse_index,
                                   bool sorted) {
-  int64_t num_unique = static_cast<int64_t>(indices.size());
+  int64_t num_unique = static_cast<int64_t>(unique_values.Size());
   Tensor& Y = *context.Output(0, {num_unique});
   Tensor* indices_out = context.Output(1, {num_unique});
   Tensor* inverse_indices = context.Output(2, {static_cast<int64_t>(inverse_index.size())});
@@ -149,21 +149,23 @@ static void CreateFlattenedOutput(OpKernelContext& context,
   gsl::span<int64_t> counts_data = counts != nullptr ? counts->MutableDataAsSpan<int64_t>()
                                                      : gsl::span<int64_t>();
 
-  // iterate using 'offsets' which is sorted, but contains the offset of the unsorted entry
-  auto offsets_iter = offsets.begin();
-  for (int64_t i = 0, end = num_unique; i < end; ++i, ++offsets_iter) {
-    // write sequentially if we want sorted output, use the unsorted_idx if not
-    auto unsorted_idx = offsets_iter->second;
-    auto output_idx = sorted ? i : unsorted_idx;
+  // output i is the unique value order[i]
+  std::vector<int64_t> order;
+  if (sorted) {
+    order = SortUniqueValues(unique_values);
+  }
 
-    Y_data[output_idx] = offsets_iter->first;
+  for (int64_t i = 0; i < num_unique; ++i) {
+    auto unsorted_idx = sorted ? order[i] : i;
+
+    Y_data[i] = *unique_values.values[unsorted_idx];
 
     if (indices_out) {
-      indices_data[output_idx] = indices[unsorted_idx].front();
+      indices_data[i] = unique_values.first_indices[unsorted_idx];
     }
 
     if (counts) {
-      counts_data[output_idx] = indices[unsorted_idx].size();
+      counts_data[i] = unique_values.counts[unsorted_idx];
     }
   }
 
@@ -172,18 +174,15 @@ static void CreateFlattenedOutput(OpKernelContext& context,
       // need to convert unsorted entries in the inverse index to their sorted values
       std::vector<int64_t> unsorted_to_sorted;
       unsorted_to_sorted.resize(num_unique);
-      int64_t sorted_idx = 0;
-      for (const auto& offset : offsets) {
-        unsorted_to_sorted[offset.second] = sorted_idx++;
+      for (int64_t sorted_idx = 0; sorted_idx < num_unique; ++sorted_idx) {
+        unsorted_to_sorted[order[sorted_idx]] = sorted_idx;
       }
 
       for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
         inverse_indices_data[i] = unsorted_to_sorted[inverse_index[i]];
       }
     } else {
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[i] = inverse_index[i];
-      }
+      std::copy(inverse_index.cbegin(), inverse_index.cend(), inverse_indices_data.begin());
     }
   }
 }
@@ -289,30 +288,12 @@ Status Unique::ComputeImpl(OpKernelContext& context) const {
   auto data = input.DataAsSpan<T>();
 
   if (flatten_) {
-    std::map<const T, int64_t> offsets;  // offset of entry in indices. provides map between sorted and unsorted values
-    std::vector<std::vector<int64_t>> indices;
-    std::vector<int64_t> inverse_index;
-
-    indices.reserve(data.size() / 2);  // arbitrary value. at worst 1 realloc but could be too large
-    inverse_index.reserve(data.size());
-
-    int64_t num_unique = 0;
-
-    for (int64_t i = 0, end = input.Shape().Size(); i < end; ++i) {
-      auto entry = offsets.find(data[i]);
-      if (entry == offsets.end()) {
-        offsets[data[i]] = num_unique;
-        inverse_index.push_back({num_unique});
-        indices.push_back({i});
-        ++num_unique;
-      } else {
-        size_t indices_idx = entry->second;
-        indices[indices_idx].push_back(i);
-        inverse_index.push_back(indices_idx);
-      }
-    }
+    // hash based, as the values are only ordered when sorting the unique ones
+    UniqueValues<T> unique_values;
+    std::vector<int64_t> inverse_index(data.size());
+    FindUniqueValues(data, inverse_index.data(), unique_values, context.GetOperatorThreadPool());
 
-    CreateFlattenedOutput(context, offsets, indices, inverse_index, sort_);
+    CreateFlattenedOutput(context, unique_values, inverse_index, sort_);
   } else {
     const auto& input_shape = input.Shape();
     const int64_t input_dims = static_cast<int64_t>(input_shape.NumDimensions());
@@ -0,0 +1,322 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "gsl/gsl"
+#include "core/common/common.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+
+namespace unique_values_internal {
+
+// splitmix64 finalizer, so the low bits of the hash, which select the slot, depend on all the bits of the value
+inline uint64_t MixBits(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// Hash, equality and radix sort key of the values. -0.0 is equal to 0.0 and all the NaNs are equal to each other,
+// so each of them is a single unique value. NaNs sort last.
+template <typename T, typename Enable = void>
+struct ValueTraits;
+
+template <typename T>
+struct ValueTraits<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+  static constexpr bool kRadixSortable = true;
+
+  static uint64_t Hash(T value) { return MixBits(static_cast<uint64_t>(value)); }
+
+  static bool Equal(T a, T b) { return a == b; }
+
+  // flipping the sign bit orders the signed values as unsigned ones
+  static uint64_t SortKey(T value) {
+    using Unsigned = typename std::make_unsigned<T>::type;
+    const Unsigned bits = static_cast<Unsigned>(value);
+    return std::is_signed<T>::value ? bits ^ (Unsigned{1} << (sizeof(T) * 8 - 1)) : bits;
+  }
+};
+
+template <>
+struct ValueTraits<float> {
+  static constexpr bool kRadixSortable = true;
+
+  static uint32_t CanonicalBits(float value) {
+    if (value == 0.0f) {
+      value = 0.0f;
+    } else if (std::isnan(value)) {
+      value = std::numeric_limits<float>::quiet_NaN();
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  static uint64_t Hash(float value) { return MixBits(CanonicalBits(value)); }
+
+  static bool Equal(float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); }
+
+  // the bits of the positive values are flipped to above the negative ones, whose order is reversed
+  static uint64_t SortKey(float value) {
+    const uint32_t bits = CanonicalBits(value);
+    return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+  }
+};
+
+template <>
+struct ValueTraits<std::string> {
+  static constexpr bool kRadixSortable = false;
+
+  static uint64_t Hash(const std::string& value) { return MixBits(std::hash<std::string>{}(value)); }
+
+  static bool Equal(const std::string& a, const std::string& b) { return a == b; }
+};
+
+/**
+ * Open addressing hash table, with linear probing, of the distinct values of a sequence along with the index of
+ * their first occurrence and their count. The values are referred to, not copied, so they must outlive the table.
+ * Each value gets an id, the number of distinct values inserted before it.
+ */
+template <typename T>
+class UniqueValueTable {
+ public:
+  using Traits = ValueTraits<T>;
+
+  explicit UniqueValueTable(size_t expected_count = 0) {
+    size_t capacity = 16;
+    while (capacity < expected_count * 2) {
+      capacity *= 2;
+    }
+
+    slots_.assign(capacity, -1);
+  }
+
+  // Adds count occurrences of value, first occurring at index, and returns its id.
+  int64_t Insert(const T* value, uint64_t hash, int64_t index, int64_t count) {
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask) {
+      const int64_t id = slots_[slot];
+      if (id < 0) {
+        const int64_t new_id = static_cast<int64_t>(values_.size());
+        slots_[slot] = new_id;
+        values_.push_back(value);
+        hashes_.push_back(hash);
+        first_indices_.push_back(index);
+        counts_.push_back(count);
+
+        // the load factor is kept at or below 1/2, so the probe sequences stay short
+        if (values_.size() * 2 > slots_.size()) {
+          Grow();
+        }
+
+        return new_id;
+      }
+
+      if (hashes_[id] == hash && Traits::Equal(*values_[id], *value)) {
+        counts_[id] += count;
+        return id;
+      }
+    }
+  }
+
+  size_t Size() const { return values_.size(); }
+
+  const std::vector<const T*>& Values() const { return values_; }
+  const std::vector<uint64_t>& Hashes() const { return hashes_; }
+  const std::vector<int64_t>& FirstIndices() const { return first_indices_; }
+  const std::vector<int64_t>& Counts() const { return counts_; }
+
+  std::vector<const T*>& MutableValues() { return values_; }
+  std::vector<int64_t>& MutableFirstIndices() { return first_indices_; }
+  std::vector<int64_t>& MutableCounts() { return counts_; }
+
+ private:
+  void Grow() {
+    std::vector<int64_t> slots(slots_.size() * 2, -1);
+    const size_t mask = slots.size() - 1;
+    for (size_t id = 0; id < values_.size(); ++id) {
+      size_t slot = static_cast<size_t>(hashes_[id]) & mask;
+      while (slots[slot] >= 0) {
+        slot = (slot + 1) & mask;
+      }
+
+      slots[slot] = static_cast<int64_t>(id);
+    }
+
+    slots_ = std::move(slots);
+  }
+
+  std::vector<int64_t> slots_;  // id of the value in each slot, -1 if empty
+  std::vector<const T*> values_;
+  std::vector<uint64_t> hashes_;
+  std::vector<int64_t> first_indices_;
+  std::vector<int64_t> counts_;
+};
+
+// LSD radix sort of the ids by key, 8 bits at a time. The passes on digits that are the same for all keys are skipped.
+inline void RadixSortIds(std::vector<uint64_t>& keys, std::vector<int64_t>& ids, size_t key_bytes) {
+  const size_t count = keys.size();
+  std::vector<uint64_t> sorted_keys(count);
+  std::vector<int64_t> sorted_ids(count);
+  for (size_t byte = 0; byte < key_bytes; ++byte) {
+    const int shift = static_cast<int>(byte * 8);
+    size_t offsets[256] = {};
+    for (const uint64_t key : keys) {
+      ++offsets[(key >> shift) & 0xff];
+    }
+
+    if (offsets[(keys[0] >> shift) & 0xff] == count) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (auto& bucket : offsets) {
+      const size_t bucket_count = bucket;
+      bucket = offset;
+      offset += bucket_count;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      const size_t position = offsets[(keys[i] >> shift) & 0xff]++;
+      sorted_keys[position] = keys[i];
+      sorted_ids[position] = ids[i];
+    }
+
+    keys.swap(sorted_keys);
+    ids.swap(sorted_ids);
+  }
+}
+
+template <typename T>
+void SortIds(const std::vector<const T*>& values, std::vector<int64_t>& ids, std::true_type /*radix_sortable*/) {
+  // below this the passes over the 256 buckets cost more than a comparison sort
+  constexpr size_t kMinRadixSortCount = 256;
+  if (ids.size() < kMinRadixSortCount) {
+    std::sort(ids.begin(), ids.end(), [&values](int64_t a, int64_t b) {
+      return ValueTraits<T>::SortKey(*values[a]) < ValueTraits<T>::SortKey(*values[b]);
+    });
+    return;
+  }
+
+  std::vector<uint64_t> keys(ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    keys[i] = ValueTraits<T>::SortKey(*values[ids[i]]);
+  }
+
+  RadixSortIds(keys, ids, sizeof(T));
+}
+
+template <typename T>
+void SortIds(const std::vector<const T*>& values, std::vector<int64_t>& ids, std::false_type /*radix_sortable*/) {
+  std::sort(ids.begin(), ids.end(), [&values](int64_t a, int64_t b) { return *values[a] < *values[b]; });
+}
+
+}  // namespace unique_values_internal
+
+/**
+ * The distinct values of a sequence in the order of their first occurrence, along with the index of their first
+ * occurrence and their count. The values refer to the elements of the sequence.
+ */
+template <typename T>
+struct UniqueValues {
+  std::vector<const T*> values;
+  std::vector<int64_t> first_indices;
+  std::vector<int64_t> counts;
+
+  size_t Size() const { return values.size(); }
+};
+
+/**
+ * Finds the distinct values of data, and writes the position of the value of each element in unique_values
+ * to inverse_indices, which has the size of data.
+ *
+ * Large inputs are split in contiguous chunks that are deduplicated in parallel, each in a hash table of its own.
+ * The tables are then merged in the order of the chunks, which keeps the values in the order of their first
+ * occurrence, and the inverse indices are mapped from the chunk tables to the merged one in parallel.
+ */
+template <typename T>
+void FindUniqueValues(gsl::span<const T> data, int64_t* inverse_indices, UniqueValues<T>& unique_values,
+                      concurrency::ThreadPool* thread_pool) {
+  using namespace unique_values_internal;
+  using Traits = ValueTraits<T>;
+
+  // each chunk must be large enough for its share of the merge to pay off
+  constexpr std::ptrdiff_t kMinChunkSize = 16384;
+  const std::ptrdiff_t count = static_cast<std::ptrdiff_t>(data.size());
+  const std::ptrdiff_t num_chunks = std::max<std::ptrdiff_t>(
+      1, std::min<std::ptrdiff_t>(concurrency::ThreadPool::DegreeOfParallelism(thread_pool), count / kMinChunkSize));
+
+  std::vector<UniqueValueTable<T>> tables(static_cast<size_t>(num_chunks));
+  concurrency::ThreadPool::TrySimpleParallelFor(thread_pool, num_chunks, [&](std::ptrdiff_t chunk) {
+    const auto work = concurrency::ThreadPool::PartitionWork(chunk, num_chunks, count);
+    auto& table = tables[chunk];
+    for (std::ptrdiff_t i = work.start; i < work.end; ++i) {
+      inverse_indices[i] = table.Insert(&data[i], Traits::Hash(data[i]), i, 1);
+    }
+  });
+
+  if (num_chunks == 1) {
+    unique_values.values = std::move(tables[0].MutableValues());
+    unique_values.first_indices = std::move(tables[0].MutableFirstIndices());
+    unique_values.counts = std::move(tables[0].MutableCounts());
+    return;
+  }
+
+  UniqueValueTable<T> merged(tables[0].Size());
+  std::vector<std::vector<int64_t>> chunk_to_merged_ids(static_cast<size_t>(num_chunks));
+  for (std::ptrdiff_t chunk = 0; chunk < num_chunks; ++chunk) {
+    const auto& table = tables[chunk];
+    auto& merged_ids = chunk_to_merged_ids[chunk];
+    merged_ids.resize(table.Size());
+    for (size_t id = 0; id < table.Size(); ++id) {
+      merged_ids[id] = merged.Insert(table.Values()[id], table.Hashes()[id], table.FirstIndices()[id],
+                                     table.Counts()[id]);
+    }
+  }
+
+  concurrency::ThreadPool::TrySimpleParallelFor(thread_pool, num_chunks, [&](std::ptrdiff_t chunk) {
+    const auto work = concurrency::ThreadPool::PartitionWork(chunk, num_chunks, count);
+    const auto& merged_ids = chunk_to_merged_ids[chunk];
+    for (std::ptrdiff_t i = work.start; i < work.end; ++i) {
+      inverse_indices[i] = merged_ids[inverse_indices[i]];
+    }
+  });
+
+  unique_values.values = std::move(merged.MutableValues());
+  unique_values.first_indices = std::move(merged.MutableFirstIndices());
+  unique_values.counts = std::move(merged.MutableCounts());
+}
+
+/**
+ * Returns the positions in unique_values of the values in ascending order.
+ * Integers and floats are radix sorted, strings are sorted with std::sort.
+ */
+template <typename T>
+std::vector<int64_t> SortUniqueValues(const UniqueValues<T>& unique_values) {
+  using namespace unique_values_internal;
+  std::vector<int64_t> ids(unique_values.Size());
+  std::iota(ids.begin(), ids.end(), int64_t{0});
+  if (!ids.empty()) {
+    SortIds(unique_values.values, ids, std::integral_constant<bool, ValueTraits<T>::kRadixSortable>());
+  }
+
+  return ids;
+}
+
+}  // namespace onnxruntime
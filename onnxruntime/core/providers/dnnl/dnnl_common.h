@@ -5,8 +5,7 @@
 #include "core/providers/shared_library/provider_api.h"
 #include "gsl/gsl-lite.hpp"
 #include "dnnl.hpp"
-#include <unordered_map>
-#include <list>
+#include "core/providers/dnnl/dnnl_primitive_cache.h"
 
 namespace onnxruntime {
 namespace ort_dnnl {
@@ -34,43 +33,5 @@ static void AddDimsToKey(std::string& key, const dnnl::memory::dims& dims) {
   key.append(1, '#');
 }
 
-class PrimitiveBase {
- public:
-  virtual ~PrimitiveBase() = default;
-};
-
-template <typename T>
-class PrimitivePool {
- public:
-  PrimitivePool() = default;
-  ~PrimitivePool() = default;
-
-  void SetPrimitive(const std::string& key, std::unique_ptr<PrimitiveBase> primitive) {
-    auto& map = PrimitivePool<T>::GetMap();
-    auto iter = map.find(key);
-    // We should not find a primitive already using this key.
-    ORT_ENFORCE(iter == map.end(), "duplicate key: " + key);
-    map.insert(std::make_pair(key, std::move(primitive)));
-  }
-
-  PrimitiveBase* GetPrimitive(const std::string& key) {
-    const auto& map = PrimitivePool<T>::GetMap();
-    auto iter = map.find(key);
-    if (iter != map.end()) {
-      return iter->second.get();
-    } else {
-      return nullptr;
-    }
-  }
-
- private:
-  // For thread safety, the map needs to be kept in thread local storage.
-  static inline std::unordered_map<std::string, std::unique_ptr<PrimitiveBase>>& GetMap() {
-    using MapType = std::unordered_map<std::string, std::unique_ptr<PrimitiveBase>>;
-    static thread_local DeleteOnUnloadPtr<MapType> map(new MapType());
-    return *map;
-  }
-};
-
 }  // namespace ort_dnnl
 }  // namespace onnxruntime
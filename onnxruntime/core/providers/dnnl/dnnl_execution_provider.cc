@@ -6,9 +6,11 @@
 #endif
 
 #include "core/providers/shared_library/provider_api.h"
+#include <limits>
 #include <unordered_set>
 #include "subgraph/dnnl_func_kernel.h"
 #include "dnnl_execution_provider.h"
+#include "dnnl_primitive_cache.h"
 #include "dnnl_fwd.h"
 
 namespace onnxruntime {
@@ -16,6 +18,27 @@ namespace onnxruntime {
 constexpr const char* DNNL = "Dnnl";
 constexpr const char* DNNL_CPU = "DnnlCpu";
 
+// Parses a non-negative decimal number of primitives. Unlike std::stoull this doesn't throw, and it rejects
+// signs, whitespace, trailing characters and values that don't fit in size_t.
+static bool ParseCacheCapacity(const std::string& value, size_t& capacity) {
+  if (value.empty()) {
+    return false;
+  }
+  size_t result = 0;
+  for (char c : value) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    const size_t digit = static_cast<size_t>(c - '0');
+    if (result > (std::numeric_limits<size_t>::max() - digit) / 10) {
+      return false;
+    }
+    result = result * 10 + digit;
+  }
+  capacity = result;
+  return true;
+}
+
 DNNLExecutionProvider::DNNLExecutionProvider(const DNNLExecutionProviderInfo& info)
     : Provider_IExecutionProvider{onnxruntime::kDnnlExecutionProvider} {
   AllocatorCreationInfo default_memory_info(
@@ -33,9 +56,25 @@ DNNLExecutionProvider::DNNLExecutionProvider(const DNNLExecutionProviderInfo& in
 
   Provider_InsertAllocator(CreateAllocator(default_memory_info));
   Provider_InsertAllocator(CreateAllocator(cpu_memory_info));
+
+  // the cache is shared by all the DNNL execution providers in the process, so the last one created sets its capacity
+  const std::string cache_capacity_env = onnxruntime::GetEnvironmentVar(dnnl_env_vars::kPrimitiveCacheCapacity);
+  if (!cache_capacity_env.empty()) {
+    size_t capacity = 0;
+    if (!ParseCacheCapacity(cache_capacity_env, capacity)) {
+      LOGS_DEFAULT(WARNING) << "Ignoring invalid value '" << cache_capacity_env << "' of "
+                            << dnnl_env_vars::kPrimitiveCacheCapacity << ". Using the default DNNL primitive cache "
+                            << "capacity of " << ort_dnnl::PrimitiveCache::kDefaultCapacity << ".";
+      capacity = ort_dnnl::PrimitiveCache::kDefaultCapacity;
+    }
+    ort_dnnl::PrimitiveCache::GetInstance().SetCapacity(capacity);
+  }
 }  // namespace onnxruntime
 
 DNNLExecutionProvider::~DNNLExecutionProvider() {
+  const auto stats = ort_dnnl::PrimitiveCache::GetInstance().GetStats();
+  LOGS_DEFAULT(VERBOSE) << "DNNL primitive cache hits: " << stats.hits << ", misses: " << stats.misses
+                        << ", evictions: " << stats.evictions << ", cached primitives: " << stats.size;
 }
 
 namespace ort_dnnl {
@@ -117,6 +156,64 @@ bool DNNLExecutionProvider::UseSubgraph(const onnxruntime::Provider_GraphViewer&
   return use_subgraph;
 }
 
+bool DNNLExecutionProvider::IsMatMulSupported(const onnxruntime::Provider_GraphViewer& graph_viewer,
+                                              const Provider_Node* node) const {
+  if (node->OpType() != "MatMul" && node->OpType() != "Gemm") {
+    return true;
+  }
+
+  const auto& initializers = graph_viewer.GetAllInitializedTensors();
+  auto node_inputs = node->InputDefs();
+  for (size_t i = 0; i < node_inputs.size(); i++) {
+    if (node_inputs[i]->Type() == nullptr || *node_inputs[i]->Type() != "tensor(float)") {
+      return false;
+    }
+  }
+
+  const auto* b = node_inputs[1];
+  if (initializers.count(b->Name()) == 0 || b->Shape() == nullptr || b->Shape()->dim_size() != 2) {
+    return false;
+  }
+
+  if (node->OpType() == "Gemm") {
+    const auto& attributes = node->GetAttributes();
+    auto attr = attributes.find("transA");
+    if (attr != attributes.end() && attr->second().i() != 0) {
+      return false;
+    }
+    attr = attributes.find("alpha");
+    if (attr != attributes.end() && attr->second().f() != 1.0f) {
+      return false;
+    }
+
+    if (node_inputs.size() > 2 && node_inputs[2]->Exists()) {
+      attr = attributes.find("beta");
+      if (attr != attributes.end() && attr->second().f() != 1.0f) {
+        return false;
+      }
+
+      // the bias is added to every row, so it must hold exactly N values
+      const auto* c = node_inputs[2];
+      if (initializers.count(c->Name()) == 0 || c->Shape() == nullptr || c->Shape()->dim_size() != 1) {
+        return false;
+      }
+
+      std::vector<int64_t> b_dims;
+      for (const auto& dim : b->Shape()->dim()) {
+        b_dims.push_back(dim.has_dim_value() ? dim.dim_value() : -1);
+      }
+      attr = attributes.find("transB");
+      const int64_t n = (attr != attributes.end() && attr->second().i() != 0) ? b_dims[0] : b_dims[1];
+      const auto& c_dim = *c->Shape()->dim().begin();
+      if (n < 0 || !c_dim.has_dim_value() || c_dim.dim_value() != n) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 void DNNLExecutionProvider::CreateOrUpdateDnnlNode(const Provider_Node* node,
                                                    std::shared_ptr<ort_dnnl::Subgraph>& subgraph_ptr,
                                                    ort_dnnl::Subgraph::SubgraphVariables& sub_var,
@@ -219,7 +316,7 @@ std::vector<std::unique_ptr<Provider_ComputeCapability>> DNNLExecutionProvider::
       continue;
     }
 
-    if (IsDimensionSupported(node) == false) {
+    if (IsDimensionSupported(node) == false || IsMatMulSupported(graph_viewer, node) == false) {
       node_index++;
       if (subgraph_ptr->dnnl_nodes.size() > 0) {
         CreateMetaDef(graph_viewer, *subgraph_attributes, subgraph_ptr, sub_var, result);
@@ -243,7 +340,8 @@ std::vector<std::unique_ptr<Provider_ComputeCapability>> DNNLExecutionProvider::
         }
       }
       if (sub_var.subgraph_node_indexes.size() > 1 && node->OpType() == "Relu") {
-        if (subgraph_ptr->dnnl_nodes.back().name == "Conv-BatchNormalization" || subgraph_ptr->dnnl_nodes.back().name == "BatchNormalization" || subgraph_ptr->dnnl_nodes.back().name == "Conv") {
+        if (subgraph_ptr->dnnl_nodes.back().name == "Conv-BatchNormalization" || subgraph_ptr->dnnl_nodes.back().name == "BatchNormalization" || subgraph_ptr->dnnl_nodes.back().name == "Conv" ||
+            subgraph_ptr->dnnl_nodes.back().name == "MatMul" || subgraph_ptr->dnnl_nodes.back().name == "Gemm") {
           subgraph_ptr->dnnl_nodes.back().name += "-Relu";
           fused = true;
         }
@@ -7,6 +7,7 @@
 #include <map>
 #include <list>
 #include <memory.h>
+#include <string>
 
 #include "core/platform/ort_mutex.h"
 #include "core/providers/dnnl/subgraph/subgraph.h"
@@ -18,6 +19,11 @@ struct memory;
 
 namespace onnxruntime {
 
+namespace dnnl_env_vars {
+// Maximum number of idle subgraph primitives kept in the process wide primitive cache. 0 disables the cache.
+static const std::string kPrimitiveCacheCapacity = "ORT_DNNL_PRIMITIVE_CACHE_CAPACITY";
+}  // namespace dnnl_env_vars
+
 // Information needed to construct DNNL execution providers.
 struct DNNLExecutionProviderInfo {
   bool create_arena{true};
@@ -141,9 +147,21 @@ class DNNLExecutionProvider : public Provider_IExecutionProvider {
       if (node->OutputDefs().size() > 1)
         supported = false;
     }
+    if (node->OpType() == "MatMul" || node->OpType() == "Softmax") {
+      // the output of the kernels is described with the ONNX Runtime format for its rank, see GetSourceFormat
+      auto node_inputs = node->InputDefs();
+      if (node_inputs[0]->Shape() == nullptr || node_inputs[0]->Shape()->dim_size() > 5 ||
+          node_inputs[0]->Shape()->dim_size() < (node->OpType() == "MatMul" ? 2 : 1)) {
+        supported = false;
+      }
+    }
     return supported;
   }
 
+  // MatMul and Gemm run on DNNL only if B, and C for Gemm, are float initializers, as the key of the subgraph
+  // primitives only has the shapes of the subgraph inputs. Gemm must be a MatMul with an optional bias.
+  bool IsMatMulSupported(const onnxruntime::Provider_GraphViewer& graph_viewer, const Provider_Node* node) const;
+
   void CreateOrUpdateDnnlNode(const Provider_Node* node,
                               std::shared_ptr<ort_dnnl::Subgraph>& subgraph_ptr,
                               ort_dnnl::Subgraph::SubgraphVariables& sub_var,
@@ -169,7 +187,8 @@ class DNNLExecutionProvider : public Provider_IExecutionProvider {
 
   // supported Dnnl Operators
   std::set<std::string> dnnl_ops_ = {"Conv", "BatchNormalization", "Relu", "Sum",
-                                     "AveragePool", "GlobalMaxPool", "GlobalAveragePool", "MaxPool", "LRN"};
+                                     "AveragePool", "GlobalMaxPool", "GlobalAveragePool", "MaxPool", "LRN",
+                                     "MatMul", "Gemm", "Softmax"};
 
   mutable std::unordered_map<std::string, std::shared_ptr<ort_dnnl::Subgraph>> mkl_subgraphs_;
 };
@@ -0,0 +1,17 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/shared_library/provider_api.h"
+#include "core/providers/dnnl/dnnl_primitive_cache.h"
+
+namespace onnxruntime {
+namespace ort_dnnl {
+
+PrimitiveCache& PrimitiveCache::GetInstance() {
+  // the primitives must be destroyed before the DNNL library is unloaded
+  static DeleteOnUnloadPtr<PrimitiveCache> cache(new PrimitiveCache());
+  return *cache;
+}
+
+}  // namespace ort_dnnl
+}  // namespace onnxruntime
@@ -0,0 +1,122 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+namespace ort_dnnl {
+
+class PrimitiveBase {
+ public:
+  virtual ~PrimitiveBase() = default;
+};
+
+struct PrimitiveCacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+  // number of primitives in the cache. primitives that are in use are not counted.
+  size_t size = 0;
+};
+
+// Process wide LRU cache of the primitives created for the DNNL subgraphs, shared by all threads and sessions.
+//
+// A primitive binds the inputs and outputs of the run it's used for, so it can't be used by 2 threads at once.
+// Take removes a primitive from the cache for the duration of a run and Return puts it back for any thread to use.
+// There can be several primitives with the same key when the same subgraph and shapes are run concurrently.
+// Once the cache holds more than its capacity the least recently returned primitives are destroyed.
+// The cache is implemented in this header so that it can be tested without loading the provider library.
+class PrimitiveCache {
+ public:
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  static PrimitiveCache& GetInstance();
+
+  // Use GetInstance outside of tests.
+  PrimitiveCache() = default;
+
+  // Returns nullptr if there is no idle primitive for the key.
+  std::unique_ptr<PrimitiveBase> Take(const std::string& key) {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    auto entry = index_.find(key);
+    if (entry == index_.end()) {
+      ++stats_.misses;
+      return nullptr;
+    }
+
+    auto primitive = std::move(entry->second->second);
+    entries_.erase(entry->second);
+    index_.erase(entry);
+    ++stats_.hits;
+    return primitive;
+  }
+
+  void Return(const std::string& key, std::unique_ptr<PrimitiveBase> primitive) {
+    std::vector<std::unique_ptr<PrimitiveBase>> evicted;
+    {
+      std::lock_guard<OrtMutex> lock(mutex_);
+      entries_.emplace_front(key, std::move(primitive));
+      index_.emplace(key, entries_.begin());
+      EvictToCapacity(evicted);
+    }
+  }
+
+  // A capacity of 0 disables the caching, so a primitive is created for every run.
+  void SetCapacity(size_t capacity) {
+    std::vector<std::unique_ptr<PrimitiveBase>> evicted;
+    {
+      std::lock_guard<OrtMutex> lock(mutex_);
+      capacity_ = capacity;
+      EvictToCapacity(evicted);
+    }
+  }
+
+  PrimitiveCacheStats GetStats() const {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    PrimitiveCacheStats stats = stats_;
+    stats.size = entries_.size();
+    return stats;
+  }
+
+ private:
+  using Entry = std::pair<std::string, std::unique_ptr<PrimitiveBase>>;
+
+  // Moves the least recently returned primitives out of the cache until it's within capacity.
+  // mutex_ must be held. The primitives are destroyed by the caller after releasing it.
+  void EvictToCapacity(std::vector<std::unique_ptr<PrimitiveBase>>& evicted) {
+    while (entries_.size() > capacity_) {
+      auto last = std::prev(entries_.end());
+      auto range = index_.equal_range(last->first);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == last) {
+          index_.erase(it);
+          break;
+        }
+      }
+
+      evicted.push_back(std::move(last->second));
+      entries_.erase(last);
+      ++stats_.evictions;
+    }
+  }
+
+  mutable OrtMutex mutex_;
+  size_t capacity_ = kDefaultCapacity;
+  // most recently returned first
+  std::list<Entry> entries_;
+  std::unordered_multimap<std::string, std::list<Entry>::iterator> index_;
+  PrimitiveCacheStats stats_;
+};
+
+}  // namespace ort_dnnl
+}  // namespace onnxruntime
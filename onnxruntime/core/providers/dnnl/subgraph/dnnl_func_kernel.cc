@@ -15,6 +15,8 @@
 #include "core/providers/dnnl/subgraph/dnnl_pool.h"
 #include "core/providers/dnnl/subgraph/dnnl_sum.h"
 #include "core/providers/dnnl/subgraph/dnnl_lrn.h"
+#include "core/providers/dnnl/subgraph/dnnl_matmul.h"
+#include "core/providers/dnnl/subgraph/dnnl_softmax.h"
 
 namespace onnxruntime {
 namespace ort_dnnl {
@@ -170,6 +172,34 @@ class SubgraphPrimitive : public PrimitiveBase {
           kernel->parents_.push_back(context_.kernels[index]);
         }
         context_.kernels.push_back(kernel);
+      } else if (dnnl_node.name == "MatMul" || dnnl_node.name == "Gemm") {
+        std::ostringstream os;
+        os << dnnl_node.name << "-" << dnnl_node.node_index << "-";
+        std::shared_ptr<DnnlMatMul<T>> kernel;
+        kernel = std::make_shared<DnnlMatMul<T>>(dnnl_node, params.provider, *params.attributes, os.str());
+        for (auto index : dnnl_node.parent_nodes) {
+          kernel->parents_.push_back(context_.kernels[index]);
+        }
+        context_.kernels.push_back(kernel);
+      } else if (dnnl_node.name == "MatMul-Relu" || dnnl_node.name == "Gemm-Relu") {
+        std::ostringstream os;
+        os << dnnl_node.name.substr(0, dnnl_node.name.find('-')) << "-" << dnnl_node.node_index << "-";
+        std::shared_ptr<DnnlMatMul<T>> kernel;
+        kernel = std::make_shared<DnnlMatMul<T>>(dnnl_node, params.provider, *params.attributes, os.str());
+        kernel->fuse_relu_ = true;
+        for (auto index : dnnl_node.parent_nodes) {
+          kernel->parents_.push_back(context_.kernels[index]);
+        }
+        context_.kernels.push_back(kernel);
+      } else if (dnnl_node.name == "Softmax") {
+        std::ostringstream os;
+        os << "Softmax-" << dnnl_node.node_index << "-";
+        std::shared_ptr<DnnlSoftmax<T>> kernel;
+        kernel = std::make_shared<DnnlSoftmax<T>>(dnnl_node, params.provider, *params.attributes, os.str());
+        for (auto index : dnnl_node.parent_nodes) {
+          kernel->parents_.push_back(context_.kernels[index]);
+        }
+        context_.kernels.push_back(kernel);
       } else if (dnnl_node.name == "Sum") {
         std::ostringstream os;
         os << "Sum-" << dnnl_node.node_index << "-";
@@ -207,16 +237,19 @@ class SubgraphPrimitive : public PrimitiveBase {
   dnnl::engine& cpu_engine_;
 };
 
-// Pool which allows for reuse of DNNL Conv primitives which are expensive to instantiate.
-// To address thread safety, the primitives are stored in a map on thread local storage.
+// Gets the primitives of the subgraphs from the process wide PrimitiveCache, creating them on a miss.
+// A primitive is used exclusively by the caller of Get until it's returned to the cache with Release.
 template <typename T>
-class SubgraphPrimitivePool : public PrimitivePool<T> {
+class SubgraphPrimitivePool {
  public:
-  static SubgraphPrimitive<T>* Get(const OrtCustomOpApi* api,
-                                   OrtKernelContext* context,
-                                   const SubgraphParams& params) {
+  // The key of the primitive for the subgraph and the shapes of its current inputs
+  static std::string GetKey(const OrtCustomOpApi* api,
+                            OrtKernelContext* context,
+                            const SubgraphParams& params) {
     Ort::CustomOpApi ort{*api};
-    std::string dims_str;
+    std::string key = params.subgraph_key;
+    key.append(1, '-');
+    key.append(std::to_string(static_cast<int>(DnnnType<T>())));
     for (auto i = 0; i < params.subgraph->dnnl_nodes[0].num_inputs; i++) {
       const OrtValue* input_tensor = ort.KernelContext_GetInput(context, i);
       auto tensor_info = ort.GetTensorTypeAndShape(input_tensor);
@@ -224,27 +257,27 @@ class SubgraphPrimitivePool : public PrimitivePool<T> {
       ort.ReleaseTensorTypeAndShapeInfo(tensor_info);
 
       dnnl::memory::dims src_dims(tensor_shape);
-      AddDimsToKey(dims_str, src_dims);
+      AddDimsToKey(key, src_dims);
     }
+    return key;
+  }
 
-    SubgraphPrimitive<T>* primitive = dynamic_cast<SubgraphPrimitive<T>*>(
-        SubgraphPrimitivePool<T>::GetInstance().GetPrimitive(params.subgraph_key + dims_str));
-
-    if (primitive == nullptr) {
-      auto subgraph_primitive = onnxruntime::make_unique<SubgraphPrimitive<T>>(api, context, params);
-      primitive = subgraph_primitive.get();
-      SubgraphPrimitivePool<T>::GetInstance().SetPrimitive(params.subgraph_key + dims_str, std::move(subgraph_primitive));
+  static std::unique_ptr<SubgraphPrimitive<T>> Get(const OrtCustomOpApi* api,
+                                                   OrtKernelContext* context,
+                                                   const SubgraphParams& params,
+                                                   const std::string& key) {
+    std::unique_ptr<PrimitiveBase> cached = PrimitiveCache::GetInstance().Take(key);
+    auto* primitive = dynamic_cast<SubgraphPrimitive<T>*>(cached.get());
+    if (primitive != nullptr) {
+      cached.release();
+      return std::unique_ptr<SubgraphPrimitive<T>>(primitive);
     }
-    return primitive;
-  }
 
- private:
-  SubgraphPrimitivePool() = default;
-  ~SubgraphPrimitivePool() = default;
+    return onnxruntime::make_unique<SubgraphPrimitive<T>>(api, context, params);
+  }
 
-  static SubgraphPrimitivePool& GetInstance() {
-    static SubgraphPrimitivePool pool;
-    return pool;
+  static void Release(const std::string& key, std::unique_ptr<SubgraphPrimitive<T>> primitive) {
+    PrimitiveCache::GetInstance().Return(key, std::move(primitive));
   }
 };
 }  // namespace
@@ -253,9 +286,14 @@ template <typename T>
 Status DnnlFuncKernel<T>::Compute(const OrtCustomOpApi* api, OrtKernelContext* context) const {
   Status status;
   try {
-    SubgraphPrimitive<T>* primitive = SubgraphPrimitivePool<T>::Get(api, context, params_);
+    const std::string key = SubgraphPrimitivePool<T>::GetKey(api, context, params_);
+    std::unique_ptr<SubgraphPrimitive<T>> primitive = SubgraphPrimitivePool<T>::Get(api, context, params_, key);
     primitive->UpdateProvider(params_);
     status = primitive->Compute(api, context);
+    // a primitive that failed is dropped, as its state may be inconsistent
+    if (status.IsOK()) {
+      SubgraphPrimitivePool<T>::Release(key, std::move(primitive));
+    }
   } catch (const dnnl::error& e) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Status: ", e.status, ", message: ", e.what());
   }
@@ -58,5 +58,32 @@ dnnl::memory::format_tag DnnlKernel::GetSourceFormat(int dim_size) {
   return source_format;
 }
 
+void DnnlKernel::InitPlainSrcMemory(const dnnl::memory::desc& plain_src_md,
+                                    dnnl::engine& cpu_engine,
+                                    std::vector<dnnl::primitive>& net,
+                                    std::vector<std::unordered_map<int, dnnl::memory>>& net_args) {
+  const auto& parent = parents_[0];
+  dnnl::memory::dims parent_dims(
+      parent->primitive_dst_shape_.GetDims().begin(), parent->primitive_dst_shape_.GetDims().end());
+  dnnl::memory::desc parent_ort_desc(parent_dims,
+                                     static_cast<dnnl::memory::data_type>(parent->primitive_dst_desc_.data.data_type),
+                                     parent->ort_source_format_);
+
+  parent_reorder_dst_mem_.reset();
+  if (parent->primitive_dst_desc_ != parent_ort_desc) {
+    parent_reorder_dst_mem_ = std::make_shared<dnnl::memory>(dnnl::memory(parent_ort_desc, cpu_engine));
+    net.push_back(dnnl::reorder(*parent->primitive_dst_mem_, *parent_reorder_dst_mem_));
+    net_args.push_back({{DNNL_ARG_FROM, *parent->primitive_dst_mem_},
+                        {DNNL_ARG_TO, *parent_reorder_dst_mem_}});
+  }
+
+  plain_src_mem_ = std::make_shared<dnnl::memory>(dnnl::memory(plain_src_md, cpu_engine, nullptr));
+}
+
+void DnnlKernel::BindPlainSrcMemory() {
+  const auto& src_mem = parent_reorder_dst_mem_ != nullptr ? *parent_reorder_dst_mem_ : *parents_[0]->primitive_dst_mem_;
+  plain_src_mem_->set_data_handle(src_mem.get_data_handle());
+}
+
 }  // namespace ort_dnnl
 }  // namespace onnxruntime
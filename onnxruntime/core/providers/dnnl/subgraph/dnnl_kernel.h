@@ -84,6 +84,18 @@ class DnnlKernel {
 
   dnnl::memory::format_tag GetSourceFormat(int dim_size);
 
+  // Creates plain_src_mem_, which views the output of the parent node with plain_src_md.
+  // plain_src_md must describe the output of the parent in the ONNX Runtime layout, e.g. with some dims collapsed.
+  // The output of the parent is reordered only if it's in a blocked format, so consecutive nodes that can use
+  // blocked formats keep them. BindPlainSrcMemory must be called from Bind.
+  void InitPlainSrcMemory(const dnnl::memory::desc& plain_src_md,
+                          dnnl::engine& cpu_engine,
+                          std::vector<dnnl::primitive>& net,
+                          std::vector<std::unordered_map<int, dnnl::memory>>& net_args);
+
+  // The output buffer of the parent can be an output of the subgraph, which changes with every run
+  void BindPlainSrcMemory();
+
  public:
   std::string name_;
   std::vector<std::shared_ptr<DnnlKernel>> parents_;
@@ -111,6 +123,10 @@ class DnnlKernel {
 
   // memory used for reorders
   std::unique_ptr<dnnl::memory> reorder_dst_mem_to_;
+
+  // see InitPlainSrcMemory
+  std::shared_ptr<dnnl::memory> plain_src_mem_;
+  std::shared_ptr<dnnl::memory> parent_reorder_dst_mem_;
   AllocatorPtr alloc_;
   DNNLExecutionProvider* provider_;
 };
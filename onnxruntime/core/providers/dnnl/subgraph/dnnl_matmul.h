@@ -0,0 +1,252 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#include "core/providers/dnnl/dnnl_fwd.h"
+#include "core/providers/dnnl/dnnl_execution_provider.h"
+#include "core/providers/dnnl/subgraph/dnnl_kernel.h"
+
+namespace onnxruntime {
+namespace ort_dnnl {
+
+// MatMul, and Gemm with transA = 0, alpha = 1 and beta = 1, using the DNNL matmul primitive.
+// The leading dims of A are collapsed so A is a 2D matrix. B must be a 2D initializer, and the bias C of Gemm
+// must have N elements. Relu is fused as a post-op.
+template <typename T>
+class DnnlMatMul : public DnnlKernel {
+ public:
+  DnnlMatMul(const DnnlNode& node,
+             DNNLExecutionProvider* provider,
+             const Provider_NodeAttributes& attributes,
+             const std::string attributes_prefix = "") : DnnlKernel(node, provider) {
+    is_gemm_ = node.name.compare(0, 4, "Gemm") == 0;
+    has_bias_ = is_gemm_ && node.num_inputs > 2;
+    ReadAttributes(attributes, attributes_prefix);
+  }
+
+  void CreatePrimitives(const OrtCustomOpApi* api,
+                        OrtKernelContext* context,
+                        dnnl::engine& cpu_engine,
+                        std::vector<dnnl::primitive>& net,
+                        std::vector<std::unordered_map<int, dnnl::memory>>& net_args) override {
+    Ort::CustomOpApi ort{*api};
+    int input_index = mklnode_ptr_->input_start_index < 0 ? 0 : mklnode_ptr_->input_start_index;
+
+    TensorShape a_shape;
+    if (mklnode_ptr_->parent_nodes.empty()) {
+      const OrtValue* input_tensor = ort.KernelContext_GetInput(context, input_index);
+      auto tensor_info = ort.GetTensorTypeAndShape(input_tensor);
+      auto tensor_shape = ort.GetTensorShape(tensor_info);
+      ort.ReleaseTensorTypeAndShapeInfo(tensor_info);
+      a_shape = TensorShape(tensor_shape);
+
+      dnnl::memory::dims src_dims(a_shape.GetDims().begin(), a_shape.GetDims().end());
+      source_desc_ = dnnl::memory::desc({src_dims}, DnnnType<T>(), GetSourceFormat(static_cast<int>(src_dims.size())));
+    } else {
+      a_shape = parents_[0].get()->primitive_dst_shape_;
+      source_desc_ = parents_[0].get()->primitive_dst_desc_;
+    }
+
+    const OrtValue* b_tensor = ort.KernelContext_GetInput(context, input_index + 1);
+    auto b_tensor_info = ort.GetTensorTypeAndShape(b_tensor);
+    auto b_tensor_shape = ort.GetTensorShape(b_tensor_info);
+    ort.ReleaseTensorTypeAndShapeInfo(b_tensor_info);
+    TensorShape b_shape(b_tensor_shape);
+
+    if (a_shape.NumDimensions() < 2 || a_shape[a_shape.NumDimensions() - 1] <= 0 || b_shape.NumDimensions() != 2) {
+      primitive_created_status_ = ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Unsupported shapes for ",
+                                                  mklnode_ptr_->name, ". A: ", a_shape.ToString(),
+                                                  " B: ", b_shape.ToString());
+      return;
+    }
+
+    // A is viewed as a [M, K] matrix, and B as [K, N]
+    const int64_t k = a_shape[a_shape.NumDimensions() - 1];
+    const int64_t m = a_shape.Size() / k;
+    const int64_t n = trans_b_ ? b_shape[0] : b_shape[1];
+    if ((trans_b_ ? b_shape[1] : b_shape[0]) != k) {
+      primitive_created_status_ = ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Incompatible dimensions for ",
+                                                  mklnode_ptr_->name, ". A: ", a_shape.ToString(),
+                                                  " B: ", b_shape.ToString());
+      return;
+    }
+
+    if (has_bias_) {
+      const OrtValue* c_tensor = ort.KernelContext_GetInput(context, input_index + 2);
+      auto c_tensor_info = ort.GetTensorTypeAndShape(c_tensor);
+      auto c_tensor_shape = ort.GetTensorShape(c_tensor_info);
+      ort.ReleaseTensorTypeAndShapeInfo(c_tensor_info);
+      TensorShape c_shape(c_tensor_shape);
+      if (c_shape.Size() != n) {
+        primitive_created_status_ = ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Unsupported shape for the bias of ",
+                                                    mklnode_ptr_->name, ". C: ", c_shape.ToString(), " N: ", n);
+        return;
+      }
+    }
+
+    std::vector<int64_t> y_dims(a_shape.GetDims().begin(), a_shape.GetDims().end() - 1);
+    y_dims.push_back(n);
+    primitive_dst_shape_ = TensorShape(y_dims);
+
+    dnnl::memory::desc src_md({m, k}, DnnnType<T>(), dnnl::memory::format_tag::ab);
+    if (mklnode_ptr_->parent_nodes.empty()) {
+      plain_src_mem_ = std::make_shared<dnnl::memory>(dnnl::memory(src_md, cpu_engine, nullptr));
+    } else {
+      InitPlainSrcMemory(src_md, cpu_engine, net, net_args);
+    }
+
+    // B is stored as [N, K] if it's transposed
+    dnnl::memory::desc weights_md({k, n}, DnnnType<T>(),
+                                  trans_b_ ? dnnl::memory::format_tag::ba : dnnl::memory::format_tag::ab);
+    weights_mem_ = onnxruntime::make_unique<dnnl::memory>(dnnl::memory(weights_md, cpu_engine, nullptr));
+
+    dnnl::memory::desc dst_md({m, n}, DnnnType<T>(), dnnl::memory::format_tag::ab);
+
+    std::unique_ptr<dnnl::matmul::desc> fwd_desc;
+    if (has_bias_) {
+      dnnl::memory::desc bias_md({1, n}, DnnnType<T>(), dnnl::memory::format_tag::ab);
+      bias_mem_ = onnxruntime::make_unique<dnnl::memory>(dnnl::memory(bias_md, cpu_engine, nullptr));
+      fwd_desc = onnxruntime::make_unique<dnnl::matmul::desc>(
+          dnnl::matmul::desc(src_md, weights_md, bias_md, dst_md));
+    } else {
+      fwd_desc = onnxruntime::make_unique<dnnl::matmul::desc>(
+          dnnl::matmul::desc(src_md, weights_md, dst_md));
+    }
+
+    if (fuse_relu_) {
+      dnnl::primitive_attr attr;
+      // Execute RELU as Fuse PostOps
+      const float ops_scale = 1.f;
+      const float ops_alpha = 0.f;  // relu negative slope
+      const float ops_beta = 0.f;
+      dnnl::post_ops ops;
+      ops.append_eltwise(ops_scale, dnnl::algorithm::eltwise_relu, ops_alpha, ops_beta);
+      attr.set_post_ops(ops);
+
+      matmul_pd_ = onnxruntime::make_unique<dnnl::matmul::primitive_desc>(
+          dnnl::matmul::primitive_desc(*fwd_desc, attr, cpu_engine));
+    } else {
+      matmul_pd_ = onnxruntime::make_unique<dnnl::matmul::primitive_desc>(
+          dnnl::matmul::primitive_desc(*fwd_desc, cpu_engine));
+    }
+
+    // The output is plain, so the next nodes and the output tensor view it with the dims of Y.
+    // No reorder is needed at the end of the subgraph.
+    dnnl::memory::dims dst_dims_mkl(y_dims.begin(), y_dims.end());
+    ort_source_format_ = GetSourceFormat(static_cast<int>(dst_dims_mkl.size()));
+    ort_source_desc_ = dnnl::memory::desc({dst_dims_mkl}, DnnnType<T>(), ort_source_format_);
+    primitive_src_desc_ = src_md;
+    primitive_dst_desc_ = ort_source_desc_;
+
+    if (mklnode_ptr_->output_index >= 0) {
+      // last node of sub-graph. the output tensor is set in Bind
+      matmul_dst_mem_ = onnxruntime::make_unique<dnnl::memory>(dnnl::memory(dst_md, cpu_engine, nullptr));
+      primitive_dst_mem_ = std::make_shared<dnnl::memory>(dnnl::memory(primitive_dst_desc_, cpu_engine, nullptr));
+    } else {
+      // Intermediate node. Use Dnnl kernel internal memory for output and
+      // use this as input to next node.
+      matmul_dst_mem_ = onnxruntime::make_unique<dnnl::memory>(dnnl::memory(dst_md, cpu_engine));
+      primitive_dst_mem_ = std::make_shared<dnnl::memory>(
+          dnnl::memory(primitive_dst_desc_, cpu_engine, matmul_dst_mem_->get_data_handle()));
+    }
+
+    matmul_fwd_ = onnxruntime::make_unique<dnnl::matmul>(dnnl::matmul(*matmul_pd_));
+    net.push_back(*matmul_fwd_);
+    if (has_bias_) {
+      net_args.push_back({{DNNL_ARG_SRC, *plain_src_mem_},
+                          {DNNL_ARG_WEIGHTS, *weights_mem_},
+                          {DNNL_ARG_BIAS, *bias_mem_},
+                          {DNNL_ARG_DST, *matmul_dst_mem_}});
+    } else {
+      net_args.push_back({{DNNL_ARG_SRC, *plain_src_mem_},
+                          {DNNL_ARG_WEIGHTS, *weights_mem_},
+                          {DNNL_ARG_DST, *matmul_dst_mem_}});
+    }
+  }
+
+  Status Bind(const OrtCustomOpApi* api, OrtKernelContext* context) override {
+    Ort::CustomOpApi ort{*api};
+
+    ORT_RETURN_IF_ERROR(primitive_created_status_);
+
+    int input_index = mklnode_ptr_->input_start_index < 0 ? 0 : mklnode_ptr_->input_start_index;
+
+    if (mklnode_ptr_->parent_nodes.empty()) {
+      // Sub-graph's first node. Read input from input buffer
+      const OrtValue* input_tensor = ort.KernelContext_GetInput(context, input_index);
+      const T* src_data = ort.GetTensorData<T>(input_tensor);
+      plain_src_mem_->set_data_handle(static_cast<void*>(const_cast<T*>(src_data)));
+    } else {
+      BindPlainSrcMemory();
+    }
+
+    const OrtValue* b_tensor = ort.KernelContext_GetInput(context, input_index + 1);
+    const T* b_data = ort.GetTensorData<T>(b_tensor);
+    weights_mem_->set_data_handle(static_cast<void*>(const_cast<T*>(b_data)));
+
+    if (has_bias_) {
+      const OrtValue* c_tensor = ort.KernelContext_GetInput(context, input_index + 2);
+      const T* c_data = ort.GetTensorData<T>(c_tensor);
+      bias_mem_->set_data_handle(static_cast<void*>(const_cast<T*>(c_data)));
+    }
+
+    if (mklnode_ptr_->output_index >= 0) {
+      auto& y_dims = primitive_dst_shape_.GetDims();
+      // Allocate memory for output bufffer
+      OrtValue* output = ort.KernelContext_GetOutput(context, mklnode_ptr_->output_index, &y_dims[0], static_cast<int>(primitive_dst_shape_.GetDims().size()));
+      T* dst_data = ort.GetTensorMutableData<T>(output);
+      matmul_dst_mem_->set_data_handle(dst_data);
+      primitive_dst_mem_->set_data_handle(dst_data);
+    }
+
+    return Status::OK();
+  }
+
+ private:
+  void ReadAttributes(const Provider_NodeAttributes& attributes,
+                      const std::string attributes_prefix = "") override {
+    if (!is_gemm_) {
+      return;
+    }
+
+    int64_t trans_a = 0;
+    auto attr = attributes.find(attributes_prefix + "transA");
+    if (attr != attributes.end()) {
+      ORT_ENFORCE(GetIntAttr(attr->second(), trans_a).IsOK());
+    }
+    attr = attributes.find(attributes_prefix + "transB");
+    if (attr != attributes.end()) {
+      int64_t trans_b = 0;
+      ORT_ENFORCE(GetIntAttr(attr->second(), trans_b).IsOK());
+      trans_b_ = trans_b != 0;
+    }
+
+    float alpha = 1.f;
+    float beta = 1.f;
+    attr = attributes.find(attributes_prefix + "alpha");
+    if (attr != attributes.end()) {
+      ORT_ENFORCE(GetFloatAttr(attr->second(), alpha).IsOK());
+    }
+    attr = attributes.find(attributes_prefix + "beta");
+    if (attr != attributes.end()) {
+      ORT_ENFORCE(GetFloatAttr(attr->second(), beta).IsOK());
+    }
+
+    // DNNLExecutionProvider only assigns Gemm nodes that are a MatMul with an optional bias
+    ORT_ENFORCE(trans_a == 0 && alpha == 1.f && beta == 1.f, "Unsupported Gemm attributes");
+  }
+
+ private:
+  bool is_gemm_ = false;
+  bool has_bias_ = false;
+  bool trans_b_ = false;
+
+  std::unique_ptr<dnnl::memory> weights_mem_;
+  std::unique_ptr<dnnl::memory> bias_mem_;
+  std::unique_ptr<dnnl::memory> matmul_dst_mem_;
+
+  std::unique_ptr<dnnl::matmul::primitive_desc> matmul_pd_;
+  std::unique_ptr<dnnl::primitive> matmul_fwd_;
+};
+}  // namespace ort_dnnl
+}  // namespace onnxruntime
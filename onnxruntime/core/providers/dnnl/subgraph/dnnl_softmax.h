@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#include "core/providers/dnnl/dnnl_fwd.h"
+#include "core/providers/dnnl/dnnl_execution_provider.h"
+#include "core/providers/dnnl/subgraph/dnnl_kernel.h"
+
+namespace onnxruntime {
+namespace ort_dnnl {
+
+// The input is coerced to a 2D [outer, inner] matrix at axis as defined by ONNX Softmax,
+// so the DNNL softmax primitive runs on the second dim.
+template <typename T>
+class DnnlSoftmax : public DnnlKernel {
+ public:
+  DnnlSoftmax(const DnnlNode& node,
+              DNNLExecutionProvider* provider,
+              const Provider_NodeAttributes& attributes,
+              const std::string attributes_prefix = "") : DnnlKernel(node, provider) {
+    ReadAttributes(attributes, attributes_prefix);
+  }
+
+  void CreatePrimitives(const OrtCustomOpApi* api,
+                        OrtKernelContext* context,
+                        dnnl::engine& cpu_engine,
+                        std::vector<dnnl::primitive>& net,
+                        std::vector<std::unordered_map<int, dnnl::memory>>& net_args) override {
+    Ort::CustomOpApi ort{*api};
+    int input_index = mklnode_ptr_->input_start_index < 0 ? 0 : mklnode_ptr_->input_start_index;
+
+    TensorShape x_shape;
+    if (mklnode_ptr_->parent_nodes.empty()) {
+      const OrtValue* input_tensor = ort.KernelContext_GetInput(context, input_index);
+      auto tensor_info = ort.GetTensorTypeAndShape(input_tensor);
+      auto tensor_shape = ort.GetTensorShape(tensor_info);
+      ort.ReleaseTensorTypeAndShapeInfo(tensor_info);
+      x_shape = TensorShape(tensor_shape);
+    } else {
+      x_shape = parents_[0].get()->primitive_dst_shape_;
+      source_desc_ = parents_[0].get()->primitive_dst_desc_;
+    }
+
+    const int64_t rank = static_cast<int64_t>(x_shape.NumDimensions());
+    const int64_t axis = axis_ < 0 ? axis_ + rank : axis_;
+    if (rank == 0 || axis < 0 || axis >= rank || x_shape.Size() == 0) {
+      primitive_created_status_ = ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Unsupported input shape for Softmax ",
+                                                  x_shape.ToString(), " with axis ", axis_);
+      return;
+    }
+
+    primitive_dst_shape_ = TensorShape(x_shape);
+    dnnl::memory::dims dims_mkl(x_shape.GetDims().begin(), x_shape.GetDims().end());
+    ort_source_format_ = GetSourceFormat(static_cast<int>(dims_mkl.size()));
+    ort_source_desc_ = dnnl::memory::desc({dims_mkl}, DnnnType<T>(), ort_source_format_);
+    if (mklnode_ptr_->parent_nodes.empty()) {
+      source_desc_ = ort_source_desc_;
+    }
+
+    const int64_t outer = x_shape.Slice(0, static_cast<size_t>(axis)).Size();
+    const int64_t inner = x_shape.Slice(static_cast<size_t>(axis)).Size();
+    dnnl::memory::desc md({outer, inner}, DnnnType<T>(), dnnl::memory::format_tag::ab);
+    if (mklnode_ptr_->parent_nodes.empty()) {
+      plain_src_mem_ = std::make_shared<dnnl::memory>(dnnl::memory(md, cpu_engine, nullptr));
+    } else {
+      InitPlainSrcMemory(md, cpu_engine, net, net_args);
+    }
+
+    fwd_desc_ = onnxruntime::make_unique<dnnl::softmax_forward::desc>(
+        dnnl::softmax_forward::desc(dnnl::prop_kind::forward_inference, md, 1));
+    softmax_fwd_pd_ = onnxruntime::make_unique<dnnl::softmax_forward::primitive_desc>(
+        dnnl::softmax_forward::primitive_desc(*fwd_desc_, cpu_engine));
+
+    // The output is plain like the output of MatMul, see DnnlMatMul
+    primitive_src_desc_ = md;
+    primitive_dst_desc_ = ort_source_desc_;
+
+    if (mklnode_ptr_->output_index >= 0) {
+      // last node of sub-graph. the output tensor is set in Bind
+      softmax_dst_mem_ = onnxruntime::make_unique<dnnl::memory>(dnnl::memory(md, cpu_engine, nullptr));
+      primitive_dst_mem_ = std::make_shared<dnnl::memory>(dnnl::memory(primitive_dst_desc_, cpu_engine, nullptr));
+    } else {
+      // Intermediate node. Use Dnnl kernel internal memory for output and
+      // use this as input to next node.
+      softmax_dst_mem_ = onnxruntime::make_unique<dnnl::memory>(dnnl::memory(md, cpu_engine));
+      primitive_dst_mem_ = std::make_shared<dnnl::memory>(
+          dnnl::memory(primitive_dst_desc_, cpu_engine, softmax_dst_mem_->get_data_handle()));
+    }
+
+    softmax_fwd_ = onnxruntime::make_unique<dnnl::softmax_forward>(
+        dnnl::softmax_forward(*softmax_fwd_pd_));
+    net.push_back(*softmax_fwd_);
+    net_args.push_back({{DNNL_ARG_SRC, *plain_src_mem_},
+                        {DNNL_ARG_DST, *softmax_dst_mem_}});
+  }
+
+  Status Bind(const OrtCustomOpApi* api, OrtKernelContext* context) override {
+    Ort::CustomOpApi ort{*api};
+
+    ORT_RETURN_IF_ERROR(primitive_created_status_);
+
+    int input_index = mklnode_ptr_->input_start_index < 0 ? 0 : mklnode_ptr_->input_start_index;
+
+    if (mklnode_ptr_->parent_nodes.empty()) {
+      // Sub-graph's first node. Read input from input buffer
+      const OrtValue* input_tensor = ort.KernelContext_GetInput(context, input_index);
+      const T* src_data = ort.GetTensorData<T>(input_tensor);
+      plain_src_mem_->set_data_handle(static_cast<void*>(const_cast<T*>(src_data)));
+    } else {
+      BindPlainSrcMemory();
+    }
+
+    if (mklnode_ptr_->output_index >= 0) {
+      auto& y_dims = primitive_dst_shape_.GetDims();
+      // Allocate memory for output bufffer
+      OrtValue* output = ort.KernelContext_GetOutput(context, mklnode_ptr_->output_index, &y_dims[0], static_cast<int>(primitive_dst_shape_.GetDims().size()));
+      T* dst_data = ort.GetTensorMutableData<T>(output);
+      softmax_dst_mem_->set_data_handle(dst_data);
+      primitive_dst_mem_->set_data_handle(dst_data);
+    }
+
+    return Status::OK();
+  }
+
+ private:
+  void ReadAttributes(const Provider_NodeAttributes& attributes,
+                      const std::string attributes_prefix = "") override {
+    auto attr = attributes.find(attributes_prefix + "axis");
+    if (attr != attributes.end()) {
+      ORT_ENFORCE(GetIntAttr(attr->second(), axis_).IsOK());
+    }
+  }
+
+ private:
+  int64_t axis_ = 1;
+
+  std::unique_ptr<dnnl::memory> softmax_dst_mem_;
+
+  std::unique_ptr<dnnl::softmax_forward::desc> fwd_desc_;
+  std::unique_ptr<dnnl::softmax_forward::primitive_desc> softmax_fwd_pd_;
+  std::unique_ptr<dnnl::primitive> softmax_fwd_;
+};
+}  // namespace ort_dnnl
+}  // namespace onnxruntime
@@ -292,6 +292,8 @@ struct ProviderHost {
 
   // Provider_TensorShapeProto_Dimension
   virtual const std::string& Provider_TensorShapeProto_Dimension__dim_param(const Provider_TensorShapeProto_Dimension* p) = 0;
+  virtual bool Provider_TensorShapeProto_Dimension__has_dim_value(const Provider_TensorShapeProto_Dimension* p) = 0;
+  virtual int64_t Provider_TensorShapeProto_Dimension__dim_value(const Provider_TensorShapeProto_Dimension* p) = 0;
 
   // Provider_TensorShapeProto_Dimensions
   virtual std::unique_ptr<Provider_TensorShapeProto_Dimension_Iterator> Provider_TensorShapeProto_Dimensions__begin(const Provider_TensorShapeProto_Dimensions* p) = 0;
@@ -609,6 +611,8 @@ struct Provider_TensorProtos {
 
 struct Provider_TensorShapeProto_Dimension {
   const std::string& dim_param() const { return g_host->Provider_TensorShapeProto_Dimension__dim_param(this); }
+  bool has_dim_value() const { return g_host->Provider_TensorShapeProto_Dimension__has_dim_value(this); }
+  int64_t dim_value() const { return g_host->Provider_TensorShapeProto_Dimension__dim_value(this); }
 
   PROVIDER_DISALLOW_ALL(Provider_TensorShapeProto_Dimension)
 };
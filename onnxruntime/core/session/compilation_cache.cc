@@ -0,0 +1,334 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#if !defined(ORT_MINIMAL_BUILD)
+
+#include "core/session/compilation_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <tuple>
+
+#include "core/common/logging/logging.h"
+#include "core/platform/env.h"
+#include "core/platform/path_lib.h"
+
+namespace onnxruntime {
+
+constexpr size_t CompilationCache::kDefaultMaxBytes;
+
+static const ORTCHAR_T* const kEntryExtension = ORT_TSTR(".ort");
+
+// an entry is the ORT format model, the key, the size of the key as a uint64_t and then kEntryMagic.
+static const char kEntryMagic[8] = {'O', 'R', 'T', 'C', 'A', 'C', 'H', 'E'};
+constexpr size_t kEntryFooterSize = sizeof(uint64_t) + sizeof(kEntryMagic);
+
+static bool IsEntryFileName(const PathString& name) {
+  const PathString extension{kEntryExtension};
+  return name.size() > extension.size() &&
+         name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+CompilationCache::CompilationCache(const PathString& dir, size_t max_bytes) : dir_(dir), max_bytes_(max_bytes) {
+}
+
+namespace {
+
+// SHA-256 as specified in FIPS 180-4.
+class Sha256 {
+ public:
+  void Update(const unsigned char* data, size_t size) {
+    total_bytes_ += size;
+    while (size > 0) {
+      const size_t num_copied = std::min(size, block_.size() - block_size_);
+      memcpy(block_.data() + block_size_, data, num_copied);
+      block_size_ += num_copied;
+      data += num_copied;
+      size -= num_copied;
+      if (block_size_ == block_.size()) {
+        Compress();
+        block_size_ = 0;
+      }
+    }
+  }
+
+  std::array<unsigned char, 32> Finish() {
+    const uint64_t total_bits = total_bytes_ * 8;
+    const unsigned char padding_start = 0x80;
+    Update(&padding_start, 1);
+    const unsigned char zero = 0;
+    while (block_size_ != 56) {
+      Update(&zero, 1);
+    }
+
+    for (int i = 7; i >= 0; --i) {
+      const auto length_byte = static_cast<unsigned char>(total_bits >> (i * 8));
+      Update(&length_byte, 1);
+    }
+
+    std::array<unsigned char, 32> digest;
+    for (size_t i = 0; i < 8; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        digest[i * 4 + j] = static_cast<unsigned char>(state_[i] >> (24 - j * 8));
+      }
+    }
+
+    return digest;
+  }
+
+ private:
+  static uint32_t RotateRight(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+  void Compress() {
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = (uint32_t{block_[i * 4]} << 24) | (uint32_t{block_[i * 4 + 1]} << 16) |
+             (uint32_t{block_[i * 4 + 2]} << 8) | uint32_t{block_[i * 4 + 3]};
+    }
+
+    for (int i = 16; i < 64; ++i) {
+      const uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      const uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+    for (int i = 0; i < 64; ++i) {
+      const uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+      const uint32_t ch = (e & f) ^ (~e & g);
+      const uint32_t t1 = h + s1 + ch + k[i] + w[i];
+      const uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+      const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      const uint32_t t2 = s0 + maj;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+  }
+
+  uint32_t state_[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  std::array<unsigned char, 64> block_;
+  size_t block_size_ = 0;
+  uint64_t total_bytes_ = 0;
+};
+
+}  // namespace
+
+std::string CompilationCache::Digest(const std::string& data) {
+  Sha256 sha256;
+  sha256.Update(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+
+  static const char hex_digits[] = "0123456789abcdef";
+  std::string digest;
+  for (const unsigned char byte : sha256.Finish()) {
+    digest += hex_digits[byte >> 4];
+    digest += hex_digits[byte & 0xf];
+  }
+
+  return digest;
+}
+
+std::string CompilationCache::MakeKey(const std::vector<std::string>& key_parts) {
+  // each part is prefixed with its size so moving bytes between parts changes the key
+  std::string key;
+  for (const auto& part : key_parts) {
+    key += std::to_string(part.size());
+    key += ':';
+    key += part;
+  }
+
+  return key;
+}
+
+std::string CompilationCache::MakeEntryName(const std::string& key) {
+  // 64-bit FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (const char c : key) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+
+  char name[17];
+  snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+  return name;
+}
+
+PathString CompilationCache::GetEntryPath(const std::string& entry_name) const {
+  return ConcatPathComponent<PathChar>(dir_, ToPathString(entry_name) + kEntryExtension);
+}
+
+Status CompilationCache::Read(const std::string& entry_name, const std::string& key, std::vector<uint8_t>& bytes,
+                              bool& found) const {
+  found = false;
+  const PathString entry_path = GetEntryPath(entry_name);
+  size_t num_bytes = 0;
+  if (!Env::Default().GetFileLength(entry_path.c_str(), num_bytes).IsOK()) {
+    return Status::OK();
+  }
+
+  bytes.resize(num_bytes);
+  std::ifstream entry_stream(entry_path, std::ifstream::in | std::ifstream::binary);
+  entry_stream.read(reinterpret_cast<char*>(bytes.data()), num_bytes);
+  if (!entry_stream) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to read ", ToMBString(entry_path), ". Only ",
+                           entry_stream.gcount(), "/", num_bytes, " bytes were able to be read.");
+  }
+
+  uint64_t key_size = 0;
+  if (num_bytes < kEntryFooterSize ||
+      memcmp(bytes.data() + num_bytes - sizeof(kEntryMagic), kEntryMagic, sizeof(kEntryMagic)) != 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, ToMBString(entry_path), " isn't a complete compilation cache entry.");
+  }
+
+  memcpy(&key_size, bytes.data() + num_bytes - kEntryFooterSize, sizeof(key_size));
+  if (key_size > num_bytes - kEntryFooterSize) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, ToMBString(entry_path), " isn't a complete compilation cache entry.");
+  }
+
+  const size_t model_size = num_bytes - kEntryFooterSize - static_cast<size_t>(key_size);
+  if (key_size != key.size() || memcmp(bytes.data() + model_size, key.data(), key.size()) != 0) {
+    std::vector<uint8_t>().swap(bytes);
+    return Status::OK();
+  }
+
+  bytes.resize(model_size);
+  found = true;
+  return Status::OK();
+}
+
+Status CompilationCache::BeginWrite(const std::string& entry_name, PathString& temporary_path) const {
+  // the sessions of a process may compile the same model concurrently, so the pid alone isn't unique
+  static std::atomic<uint64_t> write_count{0};
+
+  ORT_RETURN_IF_ERROR(Env::Default().CreateFolder(dir_));
+
+  const std::string name = entry_name + ".tmp." + std::to_string(Env::Default().GetSelfPid()) + "." +
+                           std::to_string(write_count++);
+  temporary_path = ConcatPathComponent<PathChar>(dir_, ToPathString(name));
+  return Status::OK();
+}
+
+Status CompilationCache::CommitWrite(const std::string& entry_name, const std::string& key,
+                                     const PathString& temporary_path, const logging::Logger& logger) const {
+  Status status;
+  {
+    const uint64_t key_size = key.size();
+    std::ofstream entry_stream(temporary_path, std::ofstream::out | std::ofstream::binary | std::ofstream::app);
+    entry_stream.write(key.data(), key.size());
+    entry_stream.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+    entry_stream.write(kEntryMagic, sizeof(kEntryMagic));
+    entry_stream.close();
+    if (!entry_stream) {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to write the key to ", ToMBString(temporary_path));
+    }
+  }
+
+  const PathString entry_path = GetEntryPath(entry_name);
+  if (status.IsOK()) {
+    status = Env::Default().RenameFile(temporary_path, entry_path);
+  }
+
+  if (!status.IsOK()) {
+    ORT_IGNORE_RETURN_VALUE(Env::Default().RemoveFile(temporary_path));
+    return status;
+  }
+
+  Evict(entry_path, logger);
+  return Status::OK();
+}
+
+void CompilationCache::Evict(const PathString& entry_path, const logging::Logger& logger) const {
+  struct Entry {
+    int64_t modification_time;
+    PathString path;
+    size_t size;
+  };
+
+  std::vector<Entry> entries;
+  size_t total_bytes = 0;
+
+  ORT_TRY {
+    LoopDir(dir_, [&](const PathChar* filename, OrtFileType file_type) {
+      const PathString name{filename};
+      if ((file_type != OrtFileType::TYPE_REG && file_type != OrtFileType::TYPE_UNKNOWN) ||
+          !IsEntryFileName(name)) {
+        return true;
+      }
+
+      // another process may evict an entry while we're looking at it, so skip the entries we can't stat.
+      Entry entry{0, ConcatPathComponent<PathChar>(dir_, name), 0};
+      if (Env::Default().GetFileLength(entry.path.c_str(), entry.size).IsOK() &&
+          Env::Default().GetFileModificationTime(entry.path, entry.modification_time).IsOK()) {
+        total_bytes += entry.size;
+        entries.push_back(std::move(entry));
+      }
+
+      return true;
+    });
+  }
+  ORT_CATCH(const std::exception& ex) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      LOGS(logger, WARNING) << "Failed to list the compilation cache for eviction: " << ex.what();
+    });
+    return;
+  }
+
+  if (total_bytes <= max_bytes_) {
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return std::tie(a.modification_time, a.path) < std::tie(b.modification_time, b.path);
+  });
+
+  for (const auto& entry : entries) {
+    if (total_bytes <= max_bytes_) {
+      break;
+    }
+
+    if (entry.path == entry_path) {
+      continue;
+    }
+
+    auto status = Env::Default().RemoveFile(entry.path);
+    if (status.IsOK()) {
+      LOGS(logger, VERBOSE) << "Evicted " << ToMBString(entry.path) << " from the compilation cache.";
+    }
+
+    // if the removal failed the entry is most likely gone already, so it's counted as evicted either way
+    total_bytes -= entry.size;
+  }
+}
+
+}  // namespace onnxruntime
+
+#endif  // !defined(ORT_MINIMAL_BUILD)
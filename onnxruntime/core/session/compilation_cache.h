@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#if !defined(ORT_MINIMAL_BUILD)
+
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/path_string.h"
+#include "core/common/status.h"
+
+namespace onnxruntime {
+
+namespace logging {
+class Logger;
+}
+
+/**
+On disk cache of the sessions compiled by InferenceSession::Initialize, see
+kOrtSessionOptionsConfigCompilationCacheDir.
+
+An entry is an ORT format model holding the optimized and partitioned graph along with the session state, in a file
+named after the hash of the key, which is everything the compilation depends on with the model as its SHA-256
+digest. The key itself follows the model in the file, so an entry is only used for the key it was written for, even if
+the hashes of two keys collide. An entry is written to a temporary file that is
+renamed into place once complete, so a process never reads a partially written entry, even when several processes
+share the directory. Once the entries exceed the byte budget, the oldest ones are deleted.
+*/
+class CompilationCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = size_t{1} << 30;
+
+  CompilationCache(const PathString& dir, size_t max_bytes);
+
+  // SHA-256 of data in hex. The large parts of a key, such as the model, are added as their digest so the key stays
+  // small.
+  static std::string Digest(const std::string& data);
+
+  // Joins the parts of a key.
+  static std::string MakeKey(const std::vector<std::string>& key_parts);
+
+  // Hashes a key into the name of its entry.
+  static std::string MakeEntryName(const std::string& key);
+
+  // Path of the file of an entry. The file doesn't exist if the entry isn't cached.
+  PathString GetEntryPath(const std::string& entry_name) const;
+
+  // Reads the ORT format model of the entry into bytes. found is false if the entry isn't cached, or if it was
+  // written for another key with the same hash. Fails if the file isn't a complete entry.
+  common::Status Read(const std::string& entry_name, const std::string& key, std::vector<uint8_t>& bytes,
+                      bool& found) const;
+
+  // Creates the cache directory if needed and returns a path, unique to the caller, to write the ORT format model
+  // of the entry to.
+  common::Status BeginWrite(const std::string& entry_name, PathString& temporary_path) const;
+
+  // Appends the key to the file written to temporary_path and moves it into the cache as the entry, then evicts the
+  // oldest entries while the cache is over its byte budget. The new entry is never evicted.
+  common::Status CommitWrite(const std::string& entry_name, const std::string& key, const PathString& temporary_path,
+                             const logging::Logger& logger) const;
+
+ private:
+  void Evict(const PathString& entry_path, const logging::Logger& logger) const;
+
+  const PathString dir_;
+  const size_t max_bytes_;
+};
+
+}  // namespace onnxruntime
+
+#endif  // !defined(ORT_MINIMAL_BUILD)
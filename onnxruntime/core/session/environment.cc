@@ -22,6 +22,7 @@
 #include "core/graph/dml_ops/dml_defs.h"
 #endif
 
+#include "core/common/threadpool_governor.h"
 #include "core/platform/env.h"
 #include "core/util/thread_utils.h"
 #include "core/session/allocator_impl.h"
@@ -44,6 +45,13 @@ using namespace ONNX_NAMESPACE;
 
 std::once_flag schemaRegistrationOnceFlag;
 
+// How often the thread pool governor redistributes the core budget.
+static constexpr std::chrono::milliseconds kThreadPoolGovernorInterval{10};
+
+Environment::Environment() = default;
+
+Environment::~Environment() = default;
+
 Status Environment::Create(std::unique_ptr<logging::LoggingManager> logging_manager,
                            std::unique_ptr<Environment>& environment,
                            const OrtThreadingOptions* tp_options,
@@ -76,6 +84,9 @@ Status Environment::Initialize(std::unique_ptr<logging::LoggingManager> logging_
   // create thread pools
   if (create_global_thread_pools) {
     create_global_thread_pools_ = true;
+    if (tp_options->max_spinning_threads >= 0) {
+      concurrency::SpinLimiter::SetMaxSpinningThreads(tp_options->max_spinning_threads);
+    }
     OrtThreadPoolParams to = tp_options->intra_op_thread_pool_params;
     if (to.name == nullptr) {
       to.name = ORT_TSTR("intra-op");
@@ -86,6 +97,11 @@ Status Environment::Initialize(std::unique_ptr<logging::LoggingManager> logging_
       to.name = ORT_TSTR("inter-op");
     }
     inter_op_thread_pool_ = concurrency::CreateThreadPool(&Env::Default(), to, concurrency::ThreadPoolType::INTER_OP);
+    if (tp_options->core_budget > 0) {
+      thread_pool_governor_ = onnxruntime::make_unique<concurrency::ThreadPoolGovernor>(tp_options->core_budget,
+                                                                                       kThreadPoolGovernorInterval);
+      thread_pool_governor_->Register(intra_op_thread_pool_.get());
+    }
   }
 
   ORT_TRY {
@@ -4,15 +4,20 @@
 #include "core/graph/onnx_protobuf.h"
 #include "core/session/inference_session.h"
 
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <limits>
 #include <sstream>
 #include <unordered_set>
 #include <list>
 #include <string>
 #include <thread>
 
+#include "core/common/cpuid_info.h"
 #include "core/common/denormal.h"
 #include "core/common/logging/logging.h"
+#include "core/common/threadpool_governor.h"
 #include "core/framework/allocatormgr.h"
 #include "core/framework/error_code_helper.h"
 #include "core/framework/execution_frame.h"
@@ -29,6 +34,8 @@
 #include "core/framework/utils.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
+#include "core/optimizer/embedding_table_compression.h"
+#include "core/optimizer/function_inliner.h"
 #include "core/optimizer/transformer_memcpy.h"
 #include "core/optimizer/graph_transformer.h"
 #include "core/optimizer/insert_cast_transformer.h"
@@ -93,6 +100,17 @@ inline std::basic_string<T> GetCurrentTimeString() {
   return std::basic_string<T>(time_str);
 }
 
+// Returns true if all the execution providers run nodes with the kernels registered for their op types. The other
+// ones may compile a function node as a whole, which they can only claim in GetCapability if it isn't inlined yet.
+bool HasOnlyStaticKernelProviders(const ExecutionProviders& providers) {
+  static const std::unordered_set<std::string> static_kernel_providers{
+      kCpuExecutionProvider, kCudaExecutionProvider, kRocmExecutionProvider, kAclExecutionProvider,
+      kArmNNExecutionProvider};
+  const auto& ids = providers.GetIds();
+  return std::all_of(ids.cbegin(), ids.cend(),
+                     [](const std::string& id) { return static_kernel_providers.count(id) != 0; });
+}
+
 }  // namespace
 
 std::atomic<uint32_t> InferenceSession::global_session_id_{1};
@@ -223,6 +241,8 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
     });
   }
 
+  bool adaptive_spinning = session_options_.GetConfigOrDefault(kOrtSessionOptionsConfigAdaptiveSpinning, "0") == "1";
+
   use_per_session_threads_ = session_options.use_per_session_threads;
 
   if (use_per_session_threads_) {
@@ -233,6 +253,7 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
         to.name = ORT_TSTR("intra-op");
       }
       to.set_denormal_as_zero = set_denormal_as_zero;
+      to.adaptive_spinning = to.adaptive_spinning || adaptive_spinning;
       // If the thread pool can use all the processors, then
       // we set affinity of each thread to each processor.
       to.auto_set_affinity = to.thread_pool_size == 0 &&
@@ -240,6 +261,17 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
                              to.affinity_vec_len == 0;
       thread_pool_ =
           concurrency::CreateThreadPool(&Env::Default(), to, concurrency::ThreadPoolType::INTRA_OP);
+
+      if (thread_pool_ &&
+          session_options_.GetConfigOrDefault(kOrtSessionOptionsConfigUseEnvCoreBudget, "0") == "1") {
+        thread_pool_governor_ = session_env.GetThreadPoolGovernor();
+        if (thread_pool_governor_) {
+          thread_pool_governor_->Register(thread_pool_.get());
+        } else {
+          LOGS(*session_logger_, WARNING) << "Session requested to share the env's core budget but the env was "
+                                             "not created with one. The intra-op thread pool size is fixed.";
+        }
+      }
     }
     if (session_options_.execution_mode == ExecutionMode::ORT_PARALLEL) {
       OrtThreadPoolParams to = session_options_.inter_op_param;
@@ -250,6 +282,7 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
       if (to.name == nullptr)
         to.name = ORT_TSTR("intra-op");
       to.set_denormal_as_zero = set_denormal_as_zero;
+      to.adaptive_spinning = to.adaptive_spinning || adaptive_spinning;
       inter_op_thread_pool_ =
           concurrency::CreateThreadPool(&Env::Default(), to, concurrency::ThreadPoolType::INTER_OP);
       if (inter_op_thread_pool_ == nullptr) {
@@ -351,6 +384,10 @@ InferenceSession::InferenceSession(const SessionOptions& session_options, const
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
 InferenceSession::~InferenceSession() {
+  if (thread_pool_governor_) {
+    thread_pool_governor_->Unregister(thread_pool_.get());
+  }
+
   if (session_options_.enable_profiling) {
     ORT_TRY {
       EndProfiling();
@@ -454,7 +491,9 @@ common::Status InferenceSession::RegisterGraphTransformer(
                           "Graph transformers must be registered before the session is initialized.");
   }
 
-  return graph_transformation_mgr_.Register(std::move(p_graph_transformer), level);
+  ORT_RETURN_IF_ERROR(graph_transformation_mgr_.Register(std::move(p_graph_transformer), level));
+  has_custom_graph_transformers_ = true;
+  return Status::OK();
 }
 
 common::Status InferenceSession::AddCustomTransformerList(const std::vector<std::string>& transformers_to_enable) {
@@ -519,6 +558,7 @@ common::Status InferenceSession::SaveToOrtFormat(const std::basic_string<ORTCHAR
     int size = builder.GetSize();
     file.write(reinterpret_cast<const char*>(buf), size);
     file.close();
+    ORT_RETURN_IF_NOT(file, "Failed to write the ORT format model to ", ToMBString(filepath));
   }
 
   return Status::OK();
@@ -787,6 +827,14 @@ common::Status InferenceSession::Load() {
   return Load(loader, "model_loading_from_saved_proto");
 }
 
+common::Status InferenceSession::LoadComposite(const std::vector<CompositeModelStage>& stages) {
+  auto model_proto = onnxruntime::make_unique<ModelProto>();
+  ORT_RETURN_IF_ERROR_SESSIONID_(inference_session_utils::ComposeModels(stages, *model_proto));
+  LOGS(*session_logger_, INFO) << "Composed " << stages.size() << " models into " << model_proto->graph().name();
+
+  return Load(std::move(model_proto));
+}
+
 common::Status InferenceSession::TransformGraph(onnxruntime::Graph& graph,
                                                 const onnxruntime::GraphTransformerManager& graph_transformer_mgr,
                                                 const ExecutionProviders& providers,
@@ -794,12 +842,23 @@ common::Status InferenceSession::TransformGraph(onnxruntime::Graph& graph,
                                                 const InsertCastTransformer& insert_cast_transformer,
                                                 SessionState& session_state) {
   // The transformer order:
+  // 0. inline function ops without a kernel, if optimizing for static kernel execution providers only
   // 1. built-in graph rewriter
   // 2. each execution provider's transformer
   // 3. do node placement according to kernel definition
   // 4. insert copy nodes
   // 5. insert cast nodes.
 
+  // inline the function ops without a kernel first, so the level 1 fusions also match across the function bodies.
+  // this is skipped when there are no fusions to match, or when an execution provider might compile the function
+  // nodes. the partitioner inlines the ones that are left afterwards.
+  if (session_options_.graph_optimization_level > TransformerLevel::Default &&
+      HasOnlyStaticKernelProviders(providers)) {
+    FunctionInliner function_inliner(providers.GetIds(), kernel_registry_manager);
+    bool inlined = false;
+    ORT_RETURN_IF_ERROR_SESSIONID_(function_inliner.Apply(graph, inlined, *session_logger_));
+  }
+
   // first apply global(execution provider independent),  level 1(default/system/basic) graph to graph optimizations
   ORT_RETURN_IF_ERROR_SESSIONID_(
       graph_transformer_mgr.ApplyTransformers(graph, TransformerLevel::Level1, *session_logger_));
@@ -822,9 +881,29 @@ common::Status InferenceSession::TransformGraph(onnxruntime::Graph& graph,
 #endif
 
   // Do partitioning based on execution providers' capability.
-  GraphPartitioner partitioner(kernel_registry_manager, providers);
-  ORT_RETURN_IF_ERROR_SESSIONID_(partitioner.Partition(graph, session_state.ExportDll(),
-                                                       session_state.GetMutableFuncMgr()));
+  if (session_options_.GetConfigOrDefault(kOrtSessionOptionsConfigCostBasedPartitioning, "0") == "1") {
+    PartitioningCostModel cost_model;
+    std::string profile_file;
+    if (session_options_.TryGetConfigEntry(kOrtSessionOptionsConfigPartitioningProfileFile, profile_file)) {
+      ORT_RETURN_IF_ERROR_SESSIONID_(
+          inference_session_utils::LoadPartitioningProfile(profile_file, cost_model, *session_logger_));
+    }
+
+    std::vector<PartitioningDecision> report;
+    GraphPartitioner partitioner(kernel_registry_manager, providers, &cost_model);
+    ORT_RETURN_IF_ERROR_SESSIONID_(partitioner.Partition(graph, session_state.ExportDll(),
+                                                         session_state.GetMutableFuncMgr(), &report));
+
+    LOGS(*session_logger_, INFO) << "Cost based partitioning of " << report.size() << " node(s)";
+    for (const auto& decision : report) {
+      LOGS(*session_logger_, INFO) << " " << decision.op_type << " (" << decision.node_name << ") -> ["
+                                   << decision.provider << "]: " << decision.reason;
+    }
+  } else {
+    GraphPartitioner partitioner(kernel_registry_manager, providers);
+    ORT_RETURN_IF_ERROR_SESSIONID_(partitioner.Partition(graph, session_state.ExportDll(),
+                                                         session_state.GetMutableFuncMgr()));
+  }
 
   // apply transformers except default transformers
   // Default transformers are required for correctness and they are owned and run by inference session
@@ -962,7 +1041,14 @@ Status InferenceSession::LoadOrtModel(std::function<Status()> load_ort_format_mo
   }
 
   ORT_RETURN_IF_ERROR(load_ort_format_model_bytes());
+  ORT_RETURN_IF_ERROR(LoadOrtModelFromBytes());
 
+  is_model_loaded_ = true;
+
+  return Status::OK();
+}
+
+Status InferenceSession::LoadOrtModelFromBytes() {
   // Verify the ort_format_model_bytes_ is a valid InferenceSessionBuffer before we access the data
   flatbuffers::Verifier verifier(ort_format_model_bytes_.data(), ort_format_model_bytes_.size());
   ORT_RETURN_IF_NOT(fbs::VerifyInferenceSessionBuffer(verifier));
@@ -980,21 +1066,158 @@ Status InferenceSession::LoadOrtModel(std::function<Status()> load_ort_format_mo
   const auto* fbs_model = fbs_session->model();
   ORT_RETURN_IF(nullptr == fbs_model, "Missing Model. Invalid ORT format model.");
 
+  const auto* fbs_sess_state = fbs_session->session_state();
+  ORT_RETURN_IF(nullptr == fbs_sess_state, "SessionState is null. Invalid ORT format model.");
+
   // need to go from unique_ptr to shared_ptr when moving into model_
   std::unique_ptr<Model> tmp_model;
   ORT_RETURN_IF_ERROR(Model::LoadFromOrtFormat(*fbs_model, *session_logger_, tmp_model));
   ORT_RETURN_IF_ERROR(SaveModelMetadata(*tmp_model));
   model_ = std::move(tmp_model);
 
-  // Initialize takes the session_mutex_ as well so we need to have released it prior to calling this
-  const auto* fbs_sess_state = fbs_session->session_state();
-  ORT_RETURN_IF(nullptr == fbs_sess_state, "SessionState is null. Invalid ORT format model.");
+  return Status::OK();
+}
+#endif  // defined(ENABLE_ORT_FORMAT_LOAD)
 
-  is_model_loaded_ = true;
+#if !defined(ORT_MINIMAL_BUILD) && defined(ENABLE_ORT_FORMAT_LOAD)
+Status InferenceSession::LoadFromCompilationCache(bool& loaded) {
+  loaded = false;
+
+  std::string cache_dir;
+  if (!session_options_.TryGetConfigEntry(kOrtSessionOptionsConfigCompilationCacheDir, cache_dir) ||
+      cache_dir.empty()) {
+    return Status::OK();
+  }
+
+  size_t max_bytes = CompilationCache::kDefaultMaxBytes;
+  std::string max_bytes_config;
+  if (session_options_.TryGetConfigEntry(kOrtSessionOptionsConfigCompilationCacheMaxBytes, max_bytes_config)) {
+    std::istringstream max_bytes_stream(max_bytes_config);
+    if (!(max_bytes_stream >> max_bytes) || !max_bytes_stream.eof()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid value for ",
+                             kOrtSessionOptionsConfigCompilationCacheMaxBytes, ": ", max_bytes_config);
+    }
+  }
+
+  // the ORT format only holds the kernels of the CPU execution provider, and the key below only covers the
+  // contents of the model and the session options.
+  const auto& provider_ids = execution_providers_.GetIds();
+  const auto& initializers = model_->MainGraph().GetAllInitializedTensors();
+  const char* not_cached_reason = nullptr;
+  if (!ort_format_model_bytes_.empty()) {
+    not_cached_reason = "the model is already an ORT format model";
+  } else if (provider_ids.size() != 1 || provider_ids[0] != kCpuExecutionProvider) {
+    not_cached_reason = "it uses execution providers other than the CPU execution provider";
+  } else if (HasLocalSchema()) {
+    not_cached_reason = "it uses custom ops";
+  } else if (has_custom_graph_transformers_) {
+    not_cached_reason = "it uses custom graph transformers";
+  } else if (!session_options_.initializers_to_share_map.empty()) {
+    not_cached_reason = "it uses shared initializers";
+  } else if (std::any_of(initializers.cbegin(), initializers.cend(), [](const InitializedTensorSet::value_type& entry) {
+               return entry.second->data_location() == ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL;
+             })) {
+    not_cached_reason = "it has initializers in external files";
+  }
+
+  if (not_cached_reason != nullptr) {
+    LOGS(*session_logger_, WARNING) << "The session isn't compiled with the compilation cache as "
+                                    << not_cached_reason << ".";
+    return Status::OK();
+  }
+
+  std::vector<std::string> key_parts;
+  key_parts.push_back(MakeString(ORT_VERSION, " ", kOrtModelVersion, " ", sizeof(void*)));
+  key_parts.push_back(CompilationCache::Digest(model_->ToProto().SerializeAsString()));
 
+  const auto& cpuid_info = CPUIDInfo::GetCPUIDInfo();
+  key_parts.push_back(MakeString(cpuid_info.HasSSE3(), cpuid_info.HasF16C(), cpuid_info.HasAVX(), cpuid_info.HasAVX2(),
+                                 cpuid_info.HasAVX512f(), cpuid_info.HasAVX512Skylake()));
+
+  key_parts.insert(key_parts.end(), provider_ids.cbegin(), provider_ids.cend());
+  key_parts.push_back(MakeString(static_cast<int>(session_options_.graph_optimization_level), " ",
+                                 static_cast<int>(session_options_.execution_mode), " ",
+                                 session_options_.enable_mem_pattern, " ",
+                                 session_options_.enable_cpu_mem_arena, " ",
+                                 session_options_.use_deterministic_compute));
+
+  for (const auto& dim_override : session_options_.free_dimension_overrides) {
+    key_parts.push_back(MakeString(dim_override.dim_identifier, " ",
+                                   static_cast<int>(dim_override.dim_identifer_type), " ", dim_override.dim_value));
+  }
+
+  // sorted so the key doesn't depend on the order the configurations were added in
+  const std::map<std::string, std::string> configurations(session_options_.session_configurations.cbegin(),
+                                                          session_options_.session_configurations.cend());
+  for (const auto& configuration : configurations) {
+    if (configuration.first != kOrtSessionOptionsConfigCompilationCacheDir &&
+        configuration.first != kOrtSessionOptionsConfigCompilationCacheMaxBytes) {
+      key_parts.push_back(configuration.first + "=" + configuration.second);
+    }
+  }
+
+  key_parts.insert(key_parts.end(), transformers_to_enable_.cbegin(), transformers_to_enable_.cend());
+
+  compilation_cache_ = onnxruntime::make_unique<CompilationCache>(ToPathString(cache_dir), max_bytes);
+  compilation_cache_key_ = CompilationCache::MakeKey(key_parts);
+  compilation_cache_entry_ = CompilationCache::MakeEntryName(compilation_cache_key_);
+
+  bool found = false;
+  auto status = compilation_cache_->Read(compilation_cache_entry_, compilation_cache_key_, ort_format_model_bytes_,
+                                         found);
+  if (status.IsOK() && !found) {
+    LOGS(*session_logger_, INFO) << "Compilation cache miss for entry " << compilation_cache_entry_;
+    return Status::OK();
+  }
+
+  // the entry is an ORT format model so it's loaded like one, but model_location_ stays the original model.
+  if (status.IsOK()) {
+    status = LoadOrtModelFromBytes();
+  }
+
+  if (!status.IsOK()) {
+    LOGS(*session_logger_, WARNING) << "Failed to load entry " << compilation_cache_entry_
+                                    << " of the compilation cache, compiling the model instead. "
+                                    << status.ErrorMessage();
+    std::vector<uint8_t>().swap(ort_format_model_bytes_);
+    return Status::OK();
+  }
+
+  LOGS(*session_logger_, INFO) << "Compilation cache hit for entry " << compilation_cache_entry_;
+  loaded = true;
   return Status::OK();
 }
-#endif  // defined(ENABLE_ORT_FORMAT_LOAD)
+
+void InferenceSession::AddToCompilationCache() {
+  PathString temporary_path;
+  Status status;
+  ORT_TRY {
+    status = compilation_cache_->BeginWrite(compilation_cache_entry_, temporary_path);
+    if (status.IsOK()) {
+      status = SaveToOrtFormat(temporary_path);
+      if (status.IsOK()) {
+        status = compilation_cache_->CommitWrite(compilation_cache_entry_, compilation_cache_key_, temporary_path,
+                                                 *session_logger_);
+      } else {
+        ORT_IGNORE_RETURN_VALUE(Env::Default().RemoveFile(temporary_path));
+      }
+    }
+  }
+  ORT_CATCH(const std::exception& ex) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+    });
+  }
+
+  if (!status.IsOK()) {
+    LOGS(*session_logger_, WARNING) << "Failed to add entry " << compilation_cache_entry_
+                                    << " to the compilation cache. " << status.ErrorMessage();
+    return;
+  }
+
+  LOGS(*session_logger_, INFO) << "Added entry " << compilation_cache_entry_ << " to the compilation cache.";
+}
+#endif  // !defined(ORT_MINIMAL_BUILD) && defined(ENABLE_ORT_FORMAT_LOAD)
 
 bool InferenceSession::IsInitialized() const {
   std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
@@ -1106,6 +1329,14 @@ common::Status InferenceSession::Initialize() {
     session_activity_started_ = true;
 #endif
 
+#if !defined(ORT_MINIMAL_BUILD)
+    // a hit replaces model_ with the compiled model, so this must happen before the session state is created
+    bool loaded_from_compilation_cache = false;
+#if defined(ENABLE_ORT_FORMAT_LOAD)
+    ORT_RETURN_IF_ERROR_SESSIONID_(LoadFromCompilationCache(loaded_from_compilation_cache));
+#endif
+#endif  // !defined(ORT_MINIMAL_BUILD)
+
     // now that we have all the execution providers, create the session state
     session_state_ = onnxruntime::make_unique<SessionState>(
         model_->MainGraph(),
@@ -1131,25 +1362,50 @@ common::Status InferenceSession::Initialize() {
     ORT_RETURN_IF_ERROR_SESSIONID_(kernel_registry_manager_.RegisterKernels(execution_providers_));
 
 #if !defined(ORT_MINIMAL_BUILD)
-    // add predefined transformers
-    AddPredefinedTransformers(graph_transformation_mgr_, session_options_.graph_optimization_level,
-                              transformers_to_enable_);
+    // the graph from the compilation cache is already optimized and partitioned
+    if (!loaded_from_compilation_cache) {
+      // add predefined transformers
+      AddPredefinedTransformers(graph_transformation_mgr_, session_options_.graph_optimization_level,
+                                transformers_to_enable_);
+
+      // the lossy compression of the embedding tables runs after the level 2 fusions, which create the
+      // EmbedLayerNormalization nodes
+      std::string embedding_table_format;
+      if (session_options_.TryGetConfigEntry(kOrtSessionOptionsConfigEmbeddingTableFormat, embedding_table_format)) {
+#ifndef DISABLE_CONTRIB_OPS
+        EmbeddingTableCompression::Format format;
+        ORT_RETURN_IF_ERROR_SESSIONID_(EmbeddingTableCompression::ParseFormat(embedding_table_format, format));
+        ORT_RETURN_IF_ERROR_SESSIONID_(graph_transformation_mgr_.Register(
+            onnxruntime::make_unique<EmbeddingTableCompression>(
+                format, std::unordered_set<std::string>{onnxruntime::kCpuExecutionProvider}),
+            TransformerLevel::Level2));
+#else
+        ORT_RETURN_IF_ERROR_SESSIONID_(ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                                                       "Embedding table compression requires the contrib ops."));
+#endif
+      }
 
-    // apply any transformations to the main graph and any subgraphs
-    ORT_RETURN_IF_ERROR_SESSIONID_(TransformGraph(graph, graph_transformation_mgr_,
-                                                  execution_providers_, kernel_registry_manager_,
-                                                  insert_cast_transformer_,
-                                                  *session_state_));
+      // apply any transformations to the main graph and any subgraphs
+      ORT_RETURN_IF_ERROR_SESSIONID_(TransformGraph(graph, graph_transformation_mgr_,
+                                                    execution_providers_, kernel_registry_manager_,
+                                                    insert_cast_transformer_,
+                                                    *session_state_));
 
-    // now that all the transforms are done, call Resolve on the main graph. this will recurse into the subgraphs.
-    ORT_RETURN_IF_ERROR_SESSIONID_(graph.Resolve());
+      // now that all the transforms are done, call Resolve on the main graph. this will recurse into the subgraphs.
+      ORT_RETURN_IF_ERROR_SESSIONID_(graph.Resolve());
+
+      // Update temporary copies of metadata, input- and output definitions to the same state as the resolved graph
+      ORT_RETURN_IF_ERROR_SESSIONID_(SaveModelMetadata(*model_));
+    }
 
-    // Update temporary copies of metadata, input- and output definitions to the same state as the resolved graph
-    ORT_RETURN_IF_ERROR_SESSIONID_(SaveModelMetadata(*model_));
+    const bool add_to_compilation_cache = compilation_cache_ != nullptr && !loaded_from_compilation_cache;
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
     // need to keep the initializers if we're going to save the optimized model
     bool keep_initializers = !session_options_.optimized_model_filepath.empty();
+#if !defined(ORT_MINIMAL_BUILD)
+    keep_initializers = keep_initializers || add_to_compilation_cache;
+#endif
 
     auto* serialized_session_state = !ort_format_model_bytes_.empty()
                                          ? fbs::GetInferenceSession(ort_format_model_bytes_.data())->session_state()
@@ -1180,9 +1436,21 @@ common::Status InferenceSession::Initialize() {
         ORT_RETURN_IF_ERROR_SESSIONID_(Model::Save(*model_, session_options_.optimized_model_filepath));
       }
     }
+
+#if defined(ENABLE_ORT_FORMAT_LOAD)
+    if (add_to_compilation_cache) {
+      AddToCompilationCache();
+
+      // the initializers were only kept for the cache
+      if (session_options_.optimized_model_filepath.empty()) {
+        session_state_->CleanInitializedTensorsFromGraph();
+      }
+    }
+#endif
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
     session_state_->ResolveMemoryPatternFlag();
+    ORT_RETURN_IF_ERROR_SESSIONID_(CreateNodeResultCache());
     is_inited_ = true;
 
     // we don't directly use the ORT format bytes currently, so free those now
@@ -1412,6 +1680,22 @@ Status InferenceSession::Run(const RunOptions& run_options,
     tp = session_profiler_.StartTime();
   }
 
+  // Tag all thread pool work submitted by this call with its priority and deadline.
+  concurrency::SchedulingHint scheduling_hint;
+  scheduling_hint.priority = static_cast<concurrency::WorkPriority>(run_options.run_priority);
+  if (run_options.run_deadline_ms > 0) {
+    // Saturate rather than overflow for deadlines too far away to matter.
+    const int64_t now_ns = concurrency::SchedulingHint::NowNs();
+    const int64_t max_deadline_ms = (std::numeric_limits<int64_t>::max() - now_ns) / 1000000;
+    scheduling_hint.deadline_ns = now_ns + std::min(run_options.run_deadline_ms, max_deadline_ms) * 1000000;
+  }
+  concurrency::ScopedSchedulingHint scoped_scheduling_hint(scheduling_hint);
+  concurrency::QueueingDelayStats queueing_stats_at_start;
+  if (session_profiler_.IsEnabled()) {
+    queueing_stats_at_start = concurrency::ThreadPool::GetQueueingDelayStats(GetIntraOpThreadPoolToUse(),
+                                                                             scheduling_hint.priority);
+  }
+
 #ifdef ONNXRUNTIME_ENABLE_INSTRUMENT
   TraceLoggingActivity<telemetry_provider_handle> ortrun_activity;
   ortrun_activity.SetRelatedActivity(session_activity);
@@ -1435,6 +1719,16 @@ Status InferenceSession::Run(const RunOptions& run_options,
     ORT_RETURN_IF_ERROR_SESSIONID_(ValidateInputs(feed_names, feeds));
     ORT_RETURN_IF_ERROR_SESSIONID_(ValidateOutputs(output_names, p_fetches));
 
+    // graph inputs are not produced by any node, so observe them here.
+    auto* statistics_collector = session_state_->GetTensorStatisticsCollector();
+    if (statistics_collector != nullptr) {
+      for (size_t i = 0, end = feed_names.size(); i < end; ++i) {
+        if (feeds[i].IsTensor() && statistics_collector->IsObserved(feed_names[i])) {
+          statistics_collector->Observe(feed_names[i], feeds[i].Get<Tensor>(), GetIntraOpThreadPoolToUse());
+        }
+      }
+    }
+
     FeedsFetchesInfo info(feed_names, output_names, session_state_->GetOrtValueNameIdxMap());
     FeedsFetchesManager feeds_fetches_manager{std::move(info)};
 
@@ -1524,7 +1818,18 @@ Status InferenceSession::Run(const RunOptions& run_options,
 
   // send out profiling events (optional)
   if (session_profiler_.IsEnabled()) {
-    session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp);
+    // Report the queueing delay seen by intra-op work of this run's priority class while it ran.
+    // The pool may be shared, so this includes work from concurrent runs of the same class.
+    auto queueing_stats = concurrency::ThreadPool::GetQueueingDelayStats(GetIntraOpThreadPoolToUse(),
+                                                                         scheduling_hint.priority);
+    uint64_t queued_tasks = queueing_stats.num_tasks - queueing_stats_at_start.num_tasks;
+    uint64_t queued_ns = queueing_stats.total_delay_ns - queueing_stats_at_start.total_delay_ns;
+    session_profiler_.EndTimeAndRecordEvent(
+        profiling::SESSION_EVENT, "model_run", tp,
+        {{"run_priority", std::to_string(static_cast<int>(run_options.run_priority))},
+         {"intra_op_queued_tasks", std::to_string(queued_tasks)},
+         {"intra_op_mean_queueing_delay_us",
+          std::to_string(queued_tasks == 0 ? 0 : queued_ns / queued_tasks / 1000)}});
   }
 #ifdef ONNXRUNTIME_ENABLE_INSTRUMENT
   TraceLoggingWriteStop(ortrun_activity, "OrtRun");
@@ -1532,6 +1837,71 @@ Status InferenceSession::Run(const RunOptions& run_options,
   return retval;
 }
 
+Status InferenceSession::RunIncremental(const RunOptions& run_options, const std::vector<std::string>& feed_names,
+                                        const std::vector<OrtValue>& feeds,
+                                        const std::vector<std::string>& changed_feed_names,
+                                        const std::vector<std::string>& output_names,
+                                        std::vector<OrtValue>* p_fetches) {
+  if (!is_inited_) {
+    LOGS(*session_logger_, ERROR) << "Session was not initialized";
+    return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+  }
+
+  if (session_options_.execution_mode != ExecutionMode::ORT_SEQUENTIAL) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED, "Incremental runs require the sequential execution mode.");
+  }
+
+  ORT_RETURN_IF_ERROR_SESSIONID_(ValidateInputs(feed_names, feeds));
+  ORT_RETURN_IF_ERROR_SESSIONID_(ValidateOutputs(output_names, p_fetches));
+
+  std::lock_guard<onnxruntime::OrtMutex> lock(incremental_execution_mutex_);
+
+  if (!incremental_execution_context_ || !incremental_execution_context_->Matches(feed_names, output_names)) {
+    // release the values of the previous incremental runs before the new ones are produced
+    incremental_execution_context_.reset();
+    ORT_RETURN_IF_ERROR_SESSIONID_(IncrementalExecutionContext::Create(*session_state_, feed_names, output_names,
+                                                                       incremental_execution_context_));
+  }
+
+  Status retval = Status::OK();
+  std::vector<IExecutionProvider*> exec_providers_to_stop;
+  exec_providers_to_stop.reserve(execution_providers_.NumProviders());
+
+  ++current_num_runs_;
+
+  ORT_TRY {
+    std::unique_ptr<logging::Logger> owned_run_logger;
+    auto& run_logger = CreateLoggerForRun(run_options, owned_run_logger);
+
+    for (auto& xp : execution_providers_) {
+      auto status = xp->OnRunStart();
+      ORT_CHECK_AND_SET_RETVAL(status);
+      if (status.IsOK()) {
+        exec_providers_to_stop.push_back(xp.get());
+      }
+    }
+
+    ORT_CHECK_AND_SET_RETVAL(incremental_execution_context_->Execute(feeds, changed_feed_names, *p_fetches,
+                                                                     run_options.terminate, run_logger));
+  }
+  ORT_CATCH(const std::exception& e) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
+      // the kept values may be incomplete
+      incremental_execution_context_.reset();
+    });
+  }
+
+  for (auto* xp : exec_providers_to_stop) {
+    auto status = xp->OnRunEnd();
+    ORT_CHECK_AND_SET_RETVAL(status);
+  }
+
+  --current_num_runs_;
+
+  return retval;
+}
+
 common::Status InferenceSession::Run(const NameMLValMap& feeds, const std::vector<std::string>& output_names,
                                      std::vector<OrtValue>* p_fetches) {
   return Run(RunOptions(), feeds, output_names, p_fetches);
@@ -1664,6 +2034,94 @@ std::string InferenceSession::EndProfiling() {
   return std::string();
 }
 
+Status InferenceSession::SetIntraOpNumThreads(int intra_op_num_threads) {
+  if (intra_op_num_threads < 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "intra_op_num_threads must be at least 1");
+  }
+  if (!session_options_.use_per_session_threads) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Session uses the env's global thread pools. Resize them through the env instead.");
+  }
+  if (thread_pool_) {
+    thread_pool_->SetDegreeOfParallelism(intra_op_num_threads);
+  }
+  return Status::OK();
+}
+
+Status InferenceSession::CreateNodeResultCache() {
+  std::string stable_inputs_config;
+  if (!session_options_.TryGetConfigEntry(kOrtSessionOptionsConfigMemoizationStableInputs, stable_inputs_config) ||
+      stable_inputs_config.empty()) {
+    return Status::OK();
+  }
+
+  if (session_options_.execution_mode != ExecutionMode::ORT_SEQUENTIAL) {
+    LOGS(*session_logger_, WARNING) << "Memoization of the nodes depending on stable inputs is only supported with "
+                                    << "the sequential execution mode. The nodes will run every time.";
+    return Status::OK();
+  }
+
+  std::vector<std::string> stable_inputs;
+  std::istringstream stream(stable_inputs_config);
+  for (std::string name; std::getline(stream, name, ',');) {
+    if (!name.empty()) {
+      stable_inputs.push_back(name);
+    }
+  }
+
+  size_t byte_budget = NodeResultCache::kDefaultByteBudget;
+  std::string byte_budget_config;
+  if (session_options_.TryGetConfigEntry(kOrtSessionOptionsConfigMemoizationByteBudget, byte_budget_config)) {
+    std::istringstream byte_budget_stream(byte_budget_config);
+    if (!(byte_budget_stream >> byte_budget) || !byte_budget_stream.eof()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid value for ",
+                             kOrtSessionOptionsConfigMemoizationByteBudget, ": ", byte_budget_config);
+    }
+  }
+
+  ORT_RETURN_IF_ERROR(NodeResultCache::Create(session_state_->GetGraphViewer(), session_state_->GetOrtValueNameIdxMap(),
+                                              stable_inputs, byte_budget, session_state_->GetAllocator(OrtDevice()),
+                                              node_result_cache_));
+  if (node_result_cache_ == nullptr) {
+    LOGS(*session_logger_, WARNING) << "No node only depends on the stable inputs " << stable_inputs_config
+                                    << " and initializers, so nothing is memoized.";
+    return Status::OK();
+  }
+
+  LOGS(*session_logger_, INFO) << "Memoizing " << node_result_cache_->NumMemoizedNodes()
+                               << " node(s) depending on the stable inputs " << stable_inputs_config;
+  session_state_->SetNodeResultCache(node_result_cache_.get());
+  return Status::OK();
+}
+
+Status InferenceSession::StartCalibration(const std::unordered_set<std::string>& tensor_names, size_t num_bins) {
+  if (!is_inited_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Session not initialized.");
+  }
+  if (tensor_statistics_collector_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Calibration has already been started.");
+  }
+  if (num_bins == 0 || num_bins % 4 != 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Number of histogram bins must be a multiple of 4. Got ",
+                           num_bins);
+  }
+
+  tensor_statistics_collector_ = onnxruntime::make_unique<TensorStatisticsCollector>(tensor_names, num_bins);
+  session_state_->SetTensorStatisticsCollector(tensor_statistics_collector_.get());
+  return Status::OK();
+}
+
+Status InferenceSession::EndCalibration(std::unordered_map<std::string, TensorStatistics>& statistics) {
+  if (!tensor_statistics_collector_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Calibration has not been started.");
+  }
+
+  session_state_->SetTensorStatisticsCollector(nullptr);
+  statistics = tensor_statistics_collector_->GetStatistics();
+  tensor_statistics_collector_.reset();
+  return Status::OK();
+}
+
 const profiling::Profiler& InferenceSession::GetProfiling() const {
   return session_profiler_;
 }
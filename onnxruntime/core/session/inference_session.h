@@ -13,13 +13,17 @@
 #include "core/framework/execution_providers.h"
 #include "core/framework/framework_common.h"
 #include "core/framework/iexecutor.h"
+#include "core/framework/incremental_execution_context.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/framework/session_state.h"
+#include "core/framework/node_result_cache.h"
+#include "core/framework/tensor_statistics_collector.h"
 #include "core/graph/basic_types.h"
 #include "core/optimizer/graph_transformer_level.h"
 #include "core/optimizer/graph_transformer_mgr.h"
 #include "core/optimizer/insert_cast_transformer.h"
 #include "core/framework/session_options.h"
+#include "core/session/compilation_cache.h"
 #ifdef ENABLE_LANGUAGE_INTEROP_OPS
 #include "core/language_interop_ops/language_interop_ops.h"
 #endif
@@ -52,6 +56,10 @@ namespace logging {
 class LoggingManager;
 }
 
+namespace concurrency {
+class ThreadPoolGovernor;
+}
+
 /**
   * Pre-defined and custom metadata about the model.
   */
@@ -71,6 +79,19 @@ struct ModelMetadata {
   std::unordered_map<std::string, std::string> custom_metadata_map;
 };
 
+/**
+  * A model that is loaded as a stage of a composite model, see InferenceSession::LoadComposite.
+  */
+struct CompositeModelStage {
+  // Unique name of the stage. The names of the values and nodes of the model are prefixed with "<name>/" in the
+  // composite model, e.g. the output "logits" of the stage "classifier" is "classifier/logits".
+  std::string name;
+  std::basic_string<ORTCHAR_T> model_uri;
+  // Inputs of the model that consume an output of an earlier stage.
+  // The key is the name of the input in the model and the value is the prefixed name of the output.
+  std::unordered_map<std::string, std::string> input_links;
+};
+
 /**
  * @brief This is the main class used to Run a model.
  * Sample simple usage:
@@ -247,6 +268,21 @@ class InferenceSession {
     * @return OK if success.
     */
   common::Status Load() ORT_MUST_USE_RESULT;
+
+  /**
+    * Load several ONNX models as the stages of a single composite model, e.g. a tokenizer, an encoder and a
+    * classifier. The outputs of a stage are consumed by the stages linked to them inside the session, so they're not
+    * copied out and fed back through the API, and all the stages share one allocation plan, arena and thread pool.
+    * The stages may run concurrently for concurrent requests, and in parallel execution mode independent stages
+    * may run in parallel for a single request.
+    * The inputs of the composite model are the inputs of the stages that are not linked, and its outputs are the
+    * outputs of the stages that are not consumed by a link, all prefixed with the stage name.
+    * The stages must import the same opset versions for the domains they share.
+    * The composite model has no path, so external data files of the stages are looked up in the current directory.
+    * @param stages the models in the order they are executed. a stage may only link to the outputs of earlier stages.
+    * @return OK if success.
+    */
+  common::Status LoadComposite(const std::vector<CompositeModelStage>& stages) ORT_MUST_USE_RESULT;
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
   /**
@@ -285,6 +321,23 @@ class InferenceSession {
                      const std::vector<std::string>& output_names,
                      std::vector<OrtValue>* p_fetches) ORT_MUST_USE_RESULT;
 
+  /**
+    * Run the model again with feeds that partially changed since the previous incremental run.
+    * The values produced by the previous incremental run with the same feed and output names are kept, and only the
+    * nodes that depend on the feeds in changed_feed_names are run. The first incremental run runs all the nodes.
+    * Requires the sequential execution mode. Incremental runs are serialized, but can run concurrently with Run.
+    * See IncrementalExecutionContext for details.
+    * @param changed_feed_names names of the feeds whose contents changed since the previous incremental run.
+    *        feeds with a different type or shape are treated as changed as well.
+    * @param p_fetches output values in the order specified by output_names. Must be empty as the values are
+    *        produced by the run.
+    * @return OK if success.
+    */
+  common::Status RunIncremental(const RunOptions& run_options, const std::vector<std::string>& feed_names,
+                                const std::vector<OrtValue>& feeds, const std::vector<std::string>& changed_feed_names,
+                                const std::vector<std::string>& output_names,
+                                std::vector<OrtValue>* p_fetches) ORT_MUST_USE_RESULT;
+
   /**
   * Creates a new binding object for binding inputs and outputs.
   * @param provider_type specifies the location where the inputs need to be potentially copied.
@@ -378,6 +431,30 @@ class InferenceSession {
     */
   const profiling::Profiler& GetProfiling() const;
 
+  /**
+    * Change the degree of parallelism of the session's intra-op thread pool.
+    * The session must use per session thread pools. The pool cannot grow beyond the number of threads it was
+    * created with. If the pool shares the env's core budget the governor may later override the value.
+    * @param intra_op_num_threads the new degree of parallelism, including the thread calling Run.
+    */
+  common::Status SetIntraOpNumThreads(int intra_op_num_threads);
+
+  /**
+    * Start collecting min/max and histograms of float tensors in the main graph for calibration.
+    * Subsequent calls to Run update the statistics until EndCalibration is called.
+    * Must not be called concurrently with Run.
+    * @param tensor_names names of the graph inputs and node outputs to observe. All float tensors if empty.
+    * @param num_bins number of histogram bins. Must be a multiple of 4.
+    */
+  common::Status StartCalibration(const std::unordered_set<std::string>& tensor_names,
+                                  size_t num_bins = TensorStatisticsCollector::kDefaultNumBins);
+
+  /**
+    * Stop collecting tensor statistics and return those collected since StartCalibration.
+    * Must not be called concurrently with Run.
+    */
+  common::Status EndCalibration(std::unordered_map<std::string, TensorStatistics>& statistics);
+
   /**
     * Search registered execution providers for an allocator that has characteristics
     * specified within mem_info
@@ -493,8 +570,20 @@ class InferenceSession {
 
   common::Status LoadOrtModel(std::function<Status()> load_ort_format_model_bytes) ORT_MUST_USE_RESULT;
 
+  // Parses ort_format_model_bytes_ and replaces model_ with the model in them.
+  common::Status LoadOrtModelFromBytes() ORT_MUST_USE_RESULT;
+
 #endif  // defined(ENABLE_ORT_FORMAT_LOAD)
 
+#if !defined(ORT_MINIMAL_BUILD) && defined(ENABLE_ORT_FORMAT_LOAD)
+  // Sets up compilation_cache_ if the session options name a cache directory and the session can be cached,
+  // then replaces model_ with the compiled model from the cache if it's there. loaded is true on a hit.
+  common::Status LoadFromCompilationCache(bool& loaded) ORT_MUST_USE_RESULT;
+
+  // Adds the initialized session to compilation_cache_.
+  void AddToCompilationCache();
+#endif
+
   // Create a Logger for a single execution if possible. Otherwise use the default logger.
   // If a new logger is created, it will also be stored in new_run_logger,
   // which must remain valid for the duration of the execution.
@@ -522,6 +611,9 @@ class InferenceSession {
   // Updates all providers with the allocators from the env based on OrtMemoryInfo
   void UpdateProvidersWithSharedAllocators();
 
+  // Creates node_result_cache_ if the session options name stable inputs.
+  common::Status CreateNodeResultCache() ORT_MUST_USE_RESULT;
+
 #if !defined(ORT_MINIMAL_BUILD)
   virtual void AddPredefinedTransformers(GraphTransformerManager& transformer_manager,
                                          TransformerLevel graph_optimization_level,
@@ -568,6 +660,19 @@ class InferenceSession {
   onnxruntime::concurrency::ThreadPool* intra_op_thread_pool_from_env_{};
   onnxruntime::concurrency::ThreadPool* inter_op_thread_pool_from_env_{};
 
+  // Governor of the env that thread_pool_ is registered with, if the session shares the env's core budget.
+  onnxruntime::concurrency::ThreadPoolGovernor* thread_pool_governor_{};
+
+  // Collector of tensor statistics between StartCalibration and EndCalibration.
+  std::unique_ptr<TensorStatisticsCollector> tensor_statistics_collector_;
+
+  // Cache of the outputs of the nodes depending on stable inputs, see kOrtSessionOptionsConfigMemoizationStableInputs.
+  std::unique_ptr<NodeResultCache> node_result_cache_;
+
+  // Values kept between incremental runs, see RunIncremental.
+  std::unique_ptr<IncrementalExecutionContext> incremental_execution_context_;
+  onnxruntime::OrtMutex incremental_execution_mutex_;
+
   // initialized from session options
   // Determines which threadpools will be intialized and used for the duration of this session.
   // If true, use the per session ones, or else the global threadpools.
@@ -581,6 +686,13 @@ class InferenceSession {
   //CustomRegistry objects own the corresponding KernelRegistry and OnnxRuntimeOpSchemaRegistry objects.
   //So its lifetime should be same as its constituents. This vector is to extend the lifetime of the owner.
   std::vector<std::shared_ptr<CustomRegistry>> custom_registries_;
+
+  // On disk cache of the compiled session, see kOrtSessionOptionsConfigCompilationCacheDir. null if not used.
+  std::unique_ptr<CompilationCache> compilation_cache_;
+  // the graph transformers registered with RegisterGraphTransformer aren't part of the key of the cache
+  bool has_custom_graph_transformers_ = false;
+  std::string compilation_cache_key_;
+  std::string compilation_cache_entry_;
 #endif
 
   ModelMetadata model_metadata_;
@@ -5,6 +5,16 @@
 
 #include "core/session/inference_session_utils.h"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <unordered_set>
+
+#include "core/graph/constants.h"
+#include "core/graph/model.h"
+
 namespace onnxruntime {
 
 //---------------------
@@ -107,6 +117,57 @@ static Status SetEnableProfiling(SessionOptions& session_options,
 //--- end of session options related helpers ---
 //---------------------------------------------------
 
+//--------------------------------------------
+//--- model composition related helpers ---
+//--------------------------------------------
+
+// Renames the values and nodes of the graph and of its subgraphs.
+static void RenameGraph(ONNX_NAMESPACE::GraphProto& graph,
+                        const std::function<std::string(const std::string&)>& rename) {
+  auto rename_value = [&rename](std::string* name) {
+    if (!name->empty()) {
+      *name = rename(*name);
+    }
+  };
+
+  for (auto& value_info : *graph.mutable_input()) rename_value(value_info.mutable_name());
+  for (auto& value_info : *graph.mutable_output()) rename_value(value_info.mutable_name());
+  for (auto& value_info : *graph.mutable_value_info()) rename_value(value_info.mutable_name());
+  for (auto& initializer : *graph.mutable_initializer()) rename_value(initializer.mutable_name());
+  for (auto& sparse_initializer : *graph.mutable_sparse_initializer()) {
+    rename_value(sparse_initializer.mutable_values()->mutable_name());
+  }
+
+  for (auto& node : *graph.mutable_node()) {
+    rename_value(node.mutable_name());
+    for (auto& input : *node.mutable_input()) rename_value(&input);
+    for (auto& output : *node.mutable_output()) rename_value(&output);
+
+    // subgraphs may consume the values of the graph, so their names are renamed the same way
+    for (auto& attr : *node.mutable_attribute()) {
+      if (attr.has_g()) {
+        RenameGraph(*attr.mutable_g(), rename);
+      }
+
+      for (auto& subgraph : *attr.mutable_graphs()) {
+        RenameGraph(subgraph, rename);
+      }
+    }
+  }
+}
+
+static bool HaveSameElementType(const ONNX_NAMESPACE::TypeProto& a, const ONNX_NAMESPACE::TypeProto& b) {
+  if (!a.has_tensor_type() || !b.has_tensor_type()) {
+    return a.value_case() == b.value_case();
+  }
+
+  return a.tensor_type().elem_type() == b.tensor_type().elem_type();
+}
+
+//--------------------------------------------
+//--- end of model composition related helpers ---
+//--------------------------------------------
+
 //---------------------
 //--- end of local helpers ---
 //---------------------
@@ -227,6 +288,179 @@ Status JsonConfigParser::ParseRunOptionsFromModelProto(RunOptions& /*run_options
                          "Parsing RunOptions from ModelProto is not supported yet");
 }
 
+Status LoadPartitioningProfile(const std::string& profile_file, PartitioningCostModel& cost_model,
+                               const logging::Logger& logger) {
+  std::ifstream stream(profile_file);
+  if (!stream.good()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Failed to open the partitioning profile ", profile_file);
+  }
+
+  // the events of every run are in the profile, so the cost of a node is its average
+  static constexpr const char* kKernelTimeSuffix = "_kernel_time";
+  const size_t suffix_length = strlen(kKernelTimeSuffix);
+  std::map<std::pair<std::string, std::string>, std::pair<double, int>> durations;
+
+  auto status = Status::OK();
+  ORT_TRY {
+    const json events = json::parse(stream);
+    if (!events.is_array()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "The partitioning profile ", profile_file,
+                             " is not a list of profiler events.");
+    }
+
+    for (const auto& event : events) {
+      if (!event.is_object() || event.value("cat", "") != "Node" || !event.contains("dur") ||
+          !event.contains("args") || !event["args"].contains("provider")) {
+        continue;
+      }
+
+      const std::string name = event.value("name", "");
+      if (name.size() <= suffix_length ||
+          name.compare(name.size() - suffix_length, suffix_length, kKernelTimeSuffix) != 0) {
+        continue;
+      }
+
+      auto& duration = durations[{event["args"]["provider"].get<std::string>(),
+                                  name.substr(0, name.size() - suffix_length)}];
+      duration.first += event["dur"].get<double>();
+      ++duration.second;
+    }
+  }
+  ORT_CATCH(const std::exception& e) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "The partitioning profile ", profile_file,
+                               " cannot be parsed. Error message: ", e.what());
+    });
+  }
+  ORT_RETURN_IF_ERROR(status);
+
+  for (const auto& duration : durations) {
+    cost_model.AddProfiledCost(duration.first.first, duration.first.second,
+                               duration.second.first / duration.second.second);
+  }
+
+  LOGS(logger, INFO) << "Loaded the cost of " << durations.size() << " kernel(s) from the partitioning profile "
+                     << profile_file;
+  return Status::OK();
+}
+
+Status ComposeModels(const std::vector<CompositeModelStage>& stages, ONNX_NAMESPACE::ModelProto& composed) {
+  if (stages.empty()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "A composite model needs at least one stage.");
+  }
+
+  composed.Clear();
+  auto& composed_graph = *composed.mutable_graph();
+  std::map<std::string, int64_t> opset_versions;
+  std::unordered_set<std::string> stage_names;
+
+  // prefixed name of the outputs of the earlier stages -> their value info, in the order of the stages
+  std::vector<ONNX_NAMESPACE::ValueInfoProto> stage_outputs;
+  std::unordered_set<std::string> linked_outputs;
+
+  for (const auto& stage : stages) {
+    if (stage.name.empty() || !stage_names.insert(stage.name).second) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "The stages of a composite model need unique names. '",
+                             stage.name, "' is empty or used more than once.");
+    }
+
+    ONNX_NAMESPACE::ModelProto model;
+    ORT_RETURN_IF_ERROR(Model::Load(stage.model_uri, model));
+
+    for (const auto& opset_import : model.opset_import()) {
+      const auto& domain = opset_import.domain() == kOnnxDomainAlias ? kOnnxDomain : opset_import.domain();
+      auto entry = opset_versions.emplace(domain, opset_import.version());
+      if (entry.first->second != opset_import.version()) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Stage '", stage.name, "' imports version ",
+                               opset_import.version(), " of the opset of domain '", domain,
+                               "' but an earlier stage imports version ", entry.first->second);
+      }
+    }
+
+    composed.set_ir_version(std::max(composed.ir_version(), model.ir_version()));
+
+    auto& graph = *model.mutable_graph();
+    std::unordered_set<std::string> initializer_names;
+    for (const auto& initializer : graph.initializer()) {
+      initializer_names.insert(initializer.name());
+    }
+
+    for (const auto& link : stage.input_links) {
+      const auto input = std::find_if(graph.input().cbegin(), graph.input().cend(),
+                                      [&link](const ONNX_NAMESPACE::ValueInfoProto& value_info) {
+                                        return value_info.name() == link.first;
+                                      });
+      if (input == graph.input().cend() || initializer_names.count(link.first) != 0) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "'", link.first, "' linked to '", link.second,
+                               "' is not an input of stage '", stage.name, "'");
+      }
+
+      const auto output = std::find_if(stage_outputs.cbegin(), stage_outputs.cend(),
+                                       [&link](const ONNX_NAMESPACE::ValueInfoProto& value_info) {
+                                         return value_info.name() == link.second;
+                                       });
+      if (output == stage_outputs.cend()) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "'", link.second, "' linked to input '", link.first,
+                               "' of stage '", stage.name, "' is not an output of an earlier stage");
+      }
+
+      if (!HaveSameElementType(input->type(), output->type())) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "The type of '", link.second,
+                               "' doesn't match the type of input '", link.first, "' of stage '", stage.name, "'");
+      }
+
+      linked_outputs.insert(link.second);
+    }
+
+    // the linked inputs are replaced by the outputs they consume, so they are not inputs of the composite model
+    const std::string prefix = stage.name + "/";
+    RenameGraph(graph, [&stage, &prefix](const std::string& name) {
+      auto link = stage.input_links.find(name);
+      return link != stage.input_links.cend() ? link->second : prefix + name;
+    });
+
+    for (const auto& input : graph.input()) {
+      if (std::none_of(stage.input_links.cbegin(), stage.input_links.cend(),
+                       [&input](const std::pair<const std::string, std::string>& link) {
+                         return link.second == input.name();
+                       })) {
+        *composed_graph.add_input() = input;
+      }
+    }
+
+    for (auto& node : *graph.mutable_node()) *composed_graph.add_node() = std::move(node);
+    for (auto& initializer : *graph.mutable_initializer()) *composed_graph.add_initializer() = std::move(initializer);
+    for (auto& sparse_initializer : *graph.mutable_sparse_initializer()) {
+      *composed_graph.add_sparse_initializer() = std::move(sparse_initializer);
+    }
+    for (auto& value_info : *graph.mutable_value_info()) *composed_graph.add_value_info() = std::move(value_info);
+    for (const auto& output : graph.output()) stage_outputs.push_back(output);
+
+    if (!composed_graph.name().empty()) {
+      composed_graph.mutable_name()->append("+");
+    }
+    composed_graph.mutable_name()->append(graph.name().empty() ? stage.name : graph.name());
+  }
+
+  for (auto& output : stage_outputs) {
+    if (linked_outputs.count(output.name()) != 0) {
+      // keep the type and shape of the internal value
+      *composed_graph.add_value_info() = std::move(output);
+    } else {
+      *composed_graph.add_output() = std::move(output);
+    }
+  }
+
+  for (const auto& opset_version : opset_versions) {
+    auto& opset_import = *composed.add_opset_import();
+    opset_import.set_domain(opset_version.first);
+    opset_import.set_version(opset_version.second);
+  }
+
+  composed.set_producer_name("onnxruntime");
+  return Status::OK();
+}
+
 }  // namespace inference_session_utils
 }  // namespace onnxruntime
 
@@ -12,6 +12,7 @@
 #include "core/graph/onnx_protobuf.h"
 #include "core/session/inference_session.h"
 #include "core/framework/session_options.h"
+#include "core/framework/graph_partitioner.h"
 #include "core/common/common.h"
 
 #ifdef _WIN32
@@ -65,6 +66,14 @@ class JsonConfigParser {
   bool is_ort_config_json_available_ = false;
 };
 
+// Adds the average duration of the kernels in a profile written by the ORT profiler to the cost model,
+// see kOrtSessionOptionsConfigPartitioningProfileFile.
+Status LoadPartitioningProfile(const std::string& profile_file, PartitioningCostModel& cost_model,
+                               const logging::Logger& logger);
+
+// Composes the models of the stages into a single model, see InferenceSession::LoadComposite.
+Status ComposeModels(const std::vector<CompositeModelStage>& stages, ONNX_NAMESPACE::ModelProto& composed);
+
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
 }  // namespace inference_session_utils
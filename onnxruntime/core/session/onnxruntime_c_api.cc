@@ -1804,6 +1804,30 @@ ORT_API_STATUS_IMPL(OrtApis::SessionGetProfilingStartTimeNs, _In_ const OrtSessi
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtApis::SessionSetIntraOpNumThreads, _Inout_ OrtSession* sess, int intra_op_num_threads) {
+  API_IMPL_BEGIN
+  auto* session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  return ToOrtStatus(session->SetIntraOpNumThreads(intra_op_num_threads));
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtApis::EnvSetGlobalIntraOpNumThreads, _Inout_ OrtEnv* env, int intra_op_num_threads) {
+  API_IMPL_BEGIN
+  if (intra_op_num_threads < 1) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "intra_op_num_threads must be at least 1");
+  }
+  const auto& environment = env->GetEnvironment();
+  if (!environment.EnvCreatedWithGlobalThreadPools()) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "The env was not created with global thread pools");
+  }
+  auto* tp = environment.GetIntraOpThreadPool();
+  if (tp != nullptr) {
+    tp->SetDegreeOfParallelism(intra_op_num_threads);
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
 // End support for non-tensor types
 
 #ifndef USE_CUDA
@@ -2043,6 +2067,15 @@ static constexpr OrtApi ort_api_1_to_6 = {
     &OrtApis::CreateEnvWithCustomLoggerAndGlobalThreadPools,
     &OrtApis::OrtSessionOptionsAppendExecutionProvider_CUDA,
     &OrtApis::SetGlobalDenormalAsZero,
+    &OrtApis::RunOptionsSetRunPriority,
+    &OrtApis::RunOptionsGetRunPriority,
+    &OrtApis::RunOptionsSetRunDeadline,
+    &OrtApis::RunOptionsGetRunDeadline,
+    &OrtApis::SetGlobalAdaptiveSpinning,
+    &OrtApis::SetGlobalMaxSpinningThreads,
+    &OrtApis::SetGlobalCoreBudget,
+    &OrtApis::SessionSetIntraOpNumThreads,
+    &OrtApis::EnvSetGlobalIntraOpNumThreads,
 };
 
 // Assert to do a limited check to ensure Version 1 of OrtApi never changes (will detect an addition or deletion but not if they cancel out each other)
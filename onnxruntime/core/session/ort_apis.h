@@ -247,4 +247,14 @@ ORT_API_STATUS_IMPL(AddInitializer, _Inout_ OrtSessionOptions* options, _In_ con
 ORT_API_STATUS_IMPL(OrtSessionOptionsAppendExecutionProvider_CUDA,
                     _In_ OrtSessionOptions* options, _In_ OrtCUDAProviderOptions* cuda_options);
 ORT_API_STATUS_IMPL(SetGlobalDenormalAsZero, _Inout_ OrtThreadingOptions* options);
+
+ORT_API_STATUS_IMPL(RunOptionsSetRunPriority, _Inout_ OrtRunOptions* options, OrtRunPriority priority);
+ORT_API_STATUS_IMPL(RunOptionsGetRunPriority, _In_ const OrtRunOptions* options, _Out_ OrtRunPriority* out);
+ORT_API_STATUS_IMPL(RunOptionsSetRunDeadline, _Inout_ OrtRunOptions* options, int64_t deadline_ms);
+ORT_API_STATUS_IMPL(RunOptionsGetRunDeadline, _In_ const OrtRunOptions* options, _Out_ int64_t* out);
+ORT_API_STATUS_IMPL(SetGlobalAdaptiveSpinning, _Inout_ OrtThreadingOptions* tp_options, int adaptive_spinning);
+ORT_API_STATUS_IMPL(SetGlobalMaxSpinningThreads, _Inout_ OrtThreadingOptions* tp_options, int max_spinning_threads);
+ORT_API_STATUS_IMPL(SetGlobalCoreBudget, _Inout_ OrtThreadingOptions* tp_options, int core_budget);
+ORT_API_STATUS_IMPL(SessionSetIntraOpNumThreads, _Inout_ OrtSession* sess, int intra_op_num_threads);
+ORT_API_STATUS_IMPL(EnvSetGlobalIntraOpNumThreads, _Inout_ OrtEnv* env, int intra_op_num_threads);
 }  // namespace OrtApis
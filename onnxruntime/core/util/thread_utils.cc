@@ -28,6 +28,8 @@ CreateThreadPoolHelper(Env* env, OrtThreadPoolParams options) {
       to.affinity = cpu_list;
   }
   to.set_denormal_as_zero = options.set_denormal_as_zero;
+  to.adaptive_spinning = options.adaptive_spinning;
+  to.collect_stats = options.collect_stats;
 
   return onnxruntime::make_unique<ThreadPool>(env, to, options.name, options.thread_pool_size,
                                               options.allow_spinning);
@@ -100,4 +102,38 @@ ORT_API_STATUS_IMPL(SetGlobalDenormalAsZero, _Inout_ OrtThreadingOptions* tp_opt
   return nullptr;
 }
 
+ORT_API_STATUS_IMPL(SetGlobalAdaptiveSpinning, _Inout_ OrtThreadingOptions* tp_options, int adaptive_spinning) {
+  if (!tp_options) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Received null OrtThreadingOptions");
+  }
+  if (!(adaptive_spinning == 1 || adaptive_spinning == 0)) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Received invalid value for adaptive_spinning. Valid values are 0 or 1");
+  }
+  tp_options->intra_op_thread_pool_params.adaptive_spinning = adaptive_spinning;
+  tp_options->inter_op_thread_pool_params.adaptive_spinning = adaptive_spinning;
+  return nullptr;
+}
+
+ORT_API_STATUS_IMPL(SetGlobalMaxSpinningThreads, _Inout_ OrtThreadingOptions* tp_options, int max_spinning_threads) {
+  if (!tp_options) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Received null OrtThreadingOptions");
+  }
+  if (max_spinning_threads < 0) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Received negative value for max_spinning_threads");
+  }
+  tp_options->max_spinning_threads = max_spinning_threads;
+  return nullptr;
+}
+
+ORT_API_STATUS_IMPL(SetGlobalCoreBudget, _Inout_ OrtThreadingOptions* tp_options, int core_budget) {
+  if (!tp_options) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Received null OrtThreadingOptions");
+  }
+  if (core_budget < 0) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Received negative value for core_budget");
+  }
+  tp_options->core_budget = core_budget;
+  return nullptr;
+}
+
 }  // namespace OrtApis
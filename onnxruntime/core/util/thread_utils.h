@@ -18,6 +18,10 @@ struct OrtThreadPoolParams {
   bool auto_set_affinity = false;
   //If it is true, the thread pool will spin a while after the queue became empty.
   bool allow_spinning = true;
+  //If it is true and allow_spinning is true, the spin duration adapts to how frequently work arrives.
+  bool adaptive_spinning = false;
+  //If it is true, the thread pool records spin and busy time statistics.
+  bool collect_stats = false;
 
   unsigned int stack_size = 0;
   //Index is thread id, value is processor ID
@@ -36,6 +40,14 @@ struct OrtThreadingOptions {
 
   // Params for creating the threads that parallelizes execution across ops
   OrtThreadPoolParams inter_op_thread_pool_params;
+
+  // Process-wide limit on the number of concurrently spinning threads, applied when the env is created.
+  // -1: leave the current limit unchanged. 0: no limit.
+  int max_spinning_threads = -1;
+
+  // If greater than 0, the number of cores shared between the global intra-op thread pool and any per session
+  // intra-op thread pools that opt in, divided according to their queue depth. 0: no sharing.
+  int core_budget = 0;
 };
 
 namespace onnxruntime {
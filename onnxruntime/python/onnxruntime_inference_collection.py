@@ -142,6 +142,24 @@ class Session:
         """
         return self._sess.end_profiling()
 
+    def start_calibration(self, tensor_names=None, num_bins=2048):
+        """
+        Start collecting min, max and a histogram of float tensors in subsequent calls to :meth:`run`,
+        without the tensors having to be outputs of the model.
+
+        :param tensor_names: names of the inputs and intermediate tensors to observe, all float tensors if empty
+        :param num_bins: number of histogram bins, must be a multiple of 4
+        """
+        self._sess.start_calibration(tensor_names or [], num_bins)
+
+    def end_calibration(self):
+        """
+        Stop collecting tensor statistics and return them as a dictionary
+        ``{ tensor_name: { 'min', 'max', 'num_values', 'histogram_range', 'histogram' } }``.
+        The histogram has equally sized bins covering ``[-histogram_range, histogram_range]``.
+        """
+        return self._sess.end_calibration()
+
     def get_profiling_start_time_ns(self):
         """
         Return the nanoseconds of profiling's start time
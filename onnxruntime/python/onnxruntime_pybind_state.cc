@@ -1728,6 +1728,33 @@ including arg name, arg type (contains both type and shape).)pbdoc")
       .def("end_profiling", [](PyInferenceSession* sess) -> std::string {
         return sess->GetSessionHandle()->EndProfiling();
       })
+      .def(
+          "start_calibration",
+          [](PyInferenceSession* sess, const std::vector<std::string>& tensor_names, size_t num_bins) {
+            OrtPybindThrowIfError(sess->GetSessionHandle()->StartCalibration(
+                std::unordered_set<std::string>(tensor_names.begin(), tensor_names.end()), num_bins));
+          },
+          py::arg("tensor_names"), py::arg("num_bins") = TensorStatisticsCollector::kDefaultNumBins,
+          R"pbdoc(Start collecting statistics of float tensors in subsequent runs. Observes all float tensors if tensor_names is empty.)pbdoc")
+      .def(
+          "end_calibration",
+          [](PyInferenceSession* sess) -> py::dict {
+            std::unordered_map<std::string, TensorStatistics> statistics;
+            OrtPybindThrowIfError(sess->GetSessionHandle()->EndCalibration(statistics));
+            py::dict result;
+            for (const auto& entry : statistics) {
+              py::dict tensor_statistics;
+              tensor_statistics["min"] = entry.second.min;
+              tensor_statistics["max"] = entry.second.max;
+              tensor_statistics["num_values"] = entry.second.num_values;
+              tensor_statistics["histogram_range"] = entry.second.histogram_range;
+              tensor_statistics["histogram"] = entry.second.histogram;
+              result[py::str(entry.first)] = tensor_statistics;
+            }
+            return result;
+          },
+          R"pbdoc(Stop collecting tensor statistics and return a dict of min, max, num_values, histogram_range and histogram per tensor name.
+The histogram has equally sized bins covering [-histogram_range, histogram_range].)pbdoc")
       .def_property_readonly("get_profiling_start_time_ns", [](const PyInferenceSession* sess) -> uint64_t{
         return sess->GetSessionHandle()->GetProfiling().GetStartTimeNs();
       })
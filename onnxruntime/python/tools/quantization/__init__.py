@@ -1,5 +1,5 @@
-from .quantize import quantize, quantize_static, quantize_dynamic, quantize_qat
+from .quantize import quantize, quantize_static, quantize_dynamic, quantize_qat, compress_embedding_tables
 from .quantize import QuantizationMode
 from .calibrate import CalibrationDataReader
 from .calibrate import calibrate
-from .quant_utils import QuantType
+from .quant_utils import QuantType, EmbeddingTableFormat
@@ -57,18 +57,7 @@ class ONNXCalibrater:
 
         added_nodes = []
         added_outputs = []
-        tensors_to_calibrate = set()
-
-        for node in model.graph.node:
-            should_be_calibrate = ((node.op_type in self.calibrate_op_types) and
-                                   (node.name not in self.black_nodes)) or (node.name in self.white_nodes)
-            if should_be_calibrate:
-                tensors_to_calibrate.update(node.input)
-                tensors_to_calibrate.update(node.output)
-
-            for tensor in tensors_to_calibrate:
-                if tensor in model.graph.initializer:
-                    tensors_to_calibrate.remove(tensor)
+        tensors_to_calibrate = self.select_tensors_to_calibrate(model)
 
         for tensor in tensors_to_calibrate:
             # Adding ReduceMin nodes
@@ -94,6 +83,84 @@ class ONNXCalibrater:
 
         return model
 
+    def select_tensors_to_calibrate(self, model):
+        '''
+        Select the inputs and outputs of the nodes to be quantized, excluding initializers
+        :return: set of tensor names
+        '''
+        tensors_to_calibrate = set()
+        for node in model.graph.node:
+            should_be_calibrate = ((node.op_type in self.calibrate_op_types) and
+                                   (node.name not in self.black_nodes)) or (node.name in self.white_nodes)
+            if should_be_calibrate:
+                tensors_to_calibrate.update(node.input)
+                tensors_to_calibrate.update(node.output)
+
+        initializers = set(initializer.name for initializer in model.graph.initializer)
+        tensors_to_calibrate.difference_update(initializers)
+        tensors_to_calibrate.discard('')
+        return tensors_to_calibrate
+
+    def get_tensor_ranges(self, calib_mode='naive', percentile=99.999):
+        '''
+            Gather the ranges of the tensors to calibrate in a single pass over the calibration data set,
+            using statistics collected natively by the inference session instead of running an augmented model.
+            parameter calib_mode: type 'naive' gives the minimum and maximum of all values of each tensor;
+                                type 'percentile' gives the values at percentile and 100 - percentile of the
+                                histogram of each tensor, which ignores outliers
+            parameter percentile: percentage of values within the range in 'percentile' mode
+            :return: dictionary mapping: {tensor names: (min, max) pairs }
+        '''
+        if calib_mode not in ('naive', 'percentile'):
+            raise ValueError('Unknown value for calib_mode. Currently naive and percentile modes are supported.')
+
+        model = onnx.load(self.model_path)
+        tensors_to_calibrate = self.select_tensors_to_calibrate(model)
+
+        # the graph must not be optimized, or tensors to calibrate could be fused away and get no statistics
+        sess_options = onnxruntime.SessionOptions()
+        sess_options.graph_optimization_level = onnxruntime.GraphOptimizationLevel.ORT_DISABLE_ALL
+        session = onnxruntime.InferenceSession(self.model_path, sess_options)
+        session.start_calibration(list(tensors_to_calibrate))
+        while True:
+            inputs = self.data_reader.get_next()
+            if not inputs:
+                break
+            session.run(None, inputs)
+        statistics = session.end_calibration()
+
+        missing_tensors = sorted(set(tensors_to_calibrate) - set(statistics.keys()))
+        if missing_tensors:
+            raise ValueError('No statistics were collected for tensors: {}. Check that the calibration data set '
+                             'is not empty and that these tensors are computed by the model.'.format(missing_tensors))
+
+        ranges = {}
+        for tensor_name, tensor_statistics in statistics.items():
+            if calib_mode == 'naive':
+                ranges[tensor_name] = (float(tensor_statistics['min']), float(tensor_statistics['max']))
+            else:
+                ranges[tensor_name] = self._get_percentile_range(tensor_statistics, percentile)
+
+        return ranges
+
+    @staticmethod
+    def _get_percentile_range(tensor_statistics, percentile):
+        '''
+            Helper function to get the range holding percentile percent of the values of a tensor
+            from its histogram, which has equally sized bins covering [-histogram_range, histogram_range]
+        '''
+        histogram = np.asarray(tensor_statistics['histogram'], dtype=np.float64)
+        histogram_range = tensor_statistics['histogram_range']
+        edges = np.linspace(-histogram_range, histogram_range, len(histogram) + 1)
+        cdf = np.cumsum(histogram) / tensor_statistics['num_values']
+
+        tail = (100.0 - percentile) / 200.0
+        rmin = edges[np.searchsorted(cdf, tail, side='left')]
+        rmax = edges[min(np.searchsorted(cdf, 1.0 - tail, side='left') + 1, len(histogram))]
+        rmin = max(float(rmin), float(tensor_statistics['min']))
+        rmax = min(float(rmax), float(tensor_statistics['max']))
+        return (rmin, rmax)
+
     #Using augmented outputs to generate inputs for quantization
     def get_intermediate_outputs(self, calib_mode='naive'):
         ''' 
@@ -238,7 +305,9 @@ def calibrate(model_path,
               op_types=['Conv', 'MatMul'],
               black_nodes=[],
               white_nodes=[],
-              augmented_model_path='augmented_model.onnx'):
+              augmented_model_path='augmented_model.onnx',
+              use_native_statistics=False,
+              calib_mode='naive'):
     '''
         Given an onnx model, augment and run the augmented model on calibration data set, aggregate and calculate the quantization parameters.
 
@@ -248,14 +317,25 @@ def calibrate(model_path,
     :param black_nodes: operator names that should not be quantized, default = ''
     :param white_nodes: operator names that force to be quantized, default = ''
     :param augmented_model_path: save augmented_model to this path
+    :param use_native_statistics: opt in to collecting tensor ranges in a single pass over the original model in the
+                                  inference session, instead of running an augmented model, default = False
+    :param calib_mode: 'naive' for the min and max of the values, or 'percentile' to ignore outliers.
+                       'percentile' requires use_native_statistics.
     '''
+    if calib_mode != 'naive' and not use_native_statistics:
+        raise ValueError("calib_mode '{}' requires use_native_statistics=True.".format(calib_mode))
+
     #1. initialize a calibrater
     calibrater = ONNXCalibrater(model_path, data_reader, op_types, black_nodes, white_nodes, augmented_model_path)
-    #2. augment
-    augmented_model = calibrater.augment_graph()
-    onnx.save(augmented_model, augmented_model_path)
-    #3. generate quantization thresholds
-    dict_for_quantization = calibrater.get_intermediate_outputs()
+    if use_native_statistics:
+        #2. generate quantization thresholds in a single pass over the original model
+        dict_for_quantization = calibrater.get_tensor_ranges(calib_mode)
+    else:
+        #2. augment
+        augmented_model = calibrater.augment_graph()
+        onnx.save(augmented_model, augmented_model_path)
+        #3. generate quantization thresholds
+        dict_for_quantization = calibrater.get_intermediate_outputs(calib_mode)
     #4. generate quantization parameters dict
     quantization_params_dict = calibrater.calculate_quantization_params(dict_for_quantization)
 
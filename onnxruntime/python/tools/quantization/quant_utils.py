@@ -53,6 +53,12 @@ class QuantType(Enum):
     QUInt8 = 2
 
 
+class EmbeddingTableFormat(Enum):
+    Float16 = 1
+    BFloat16 = 2
+    Int8 = 3
+
+
 class QuantizedInitializer:
     '''
         Represents a linearly quantized weight input from ONNX operators
@@ -16,7 +16,7 @@ from onnxruntime import SessionOptions, InferenceSession, GraphOptimizationLevel
 
 from .quant_utils import QuantizationMode, QuantizedValueType, QuantizedInitializer, QuantizedValue, quantization_modes
 from .quant_utils import find_by_name, get_elem_index, get_mul_node, generate_identified_filename, attribute_to_kwarg
-from .quant_utils import QuantType
+from .quant_utils import QuantType, EmbeddingTableFormat, ms_domain
 
 from .registry import CreateOpQuantizer, CreateDefaultOpQuantizer, QLinearOpsRegistry, IntegerOpsRegistry
 
@@ -301,4 +301,103 @@ def quantize_qat(model_input: Path,
         op_types_to_quantize)
 
     quantizer.quantize_model()
-    quantizer.model.save_model_to_file(model_output, use_external_data_format)
\ No newline at end of file
+    quantizer.model.save_model_to_file(model_output, use_external_data_format)
+
+
+def _compress_embedding_table(data, table_format):
+    '''
+        Returns the compressed table and, for Int8, the per row scale and zero point.
+        Each row is quantized with the range of its values, extended to include 0.
+    '''
+    if table_format == EmbeddingTableFormat.Float16:
+        return data.astype(np.float16), None, None
+
+    if table_format == EmbeddingTableFormat.BFloat16:
+        # bfloat16 is the upper half of float32, truncated like the conversion of onnxruntime
+        bits = np.ascontiguousarray(data, dtype=np.float32).view(np.uint32)
+        return (bits >> 16).astype(np.uint16), None, None
+
+    row_min = np.minimum(data.min(axis=1), 0)
+    row_max = np.maximum(data.max(axis=1), 0)
+    scale = ((row_max - row_min) / 255).astype(np.float32)
+    scale[scale == 0] = 1
+    zero_point = np.clip(np.round(-128 - row_min / scale), -128, 127)
+    quantized = np.clip(np.round(data / scale[:, None]) + zero_point[:, None], -128, 127)
+    return quantized.astype(np.int8), scale, zero_point.astype(np.int8)
+
+
+def compress_embedding_tables(model_input: Path,
+                              model_output: Path,
+                              table_format=EmbeddingTableFormat.Int8,
+                              use_external_data_format=False):
+    '''
+        Given an onnx model, store its float embedding tables as float16, bfloat16 or int8 quantized per row,
+        and save the model into a file. It is the offline version of the session.embedding_table_format session
+        option. A table is compressed when it is a 2D float initializer only used as the data of Gather nodes
+        on axis 0, which are replaced by com.microsoft DequantizeGather nodes, or as the word embedding
+        (input 2) of EmbedLayerNormalization nodes. The rows are converted back to float as they are looked up.
+        The resulting model runs on the CPU execution provider.
+    :param model_input: file path of model to compress
+    :param model_output: file path of compressed model
+    :param table_format: EmbeddingTableFormat of the compressed tables
+    :parma use_external_data_format: option used for large size (>2GB) model. Set to False by default.
+    '''
+    model = ONNXModel(onnx.load(model_input))
+    input_name_to_nodes = model.input_name_to_nodes()
+    graph_outputs = set(output.name for output in model.graph().output)
+
+    def table_input_index(node):
+        if node.op_type == "Gather" and node.domain in ("", "ai.onnx"):
+            axis = [attr.i for attr in node.attribute if attr.name == "axis"]
+            return 0 if not axis or axis[0] in (0, -2) else -1
+        if node.op_type == "EmbedLayerNormalization" and node.domain == ms_domain and len(node.input) <= 8:
+            return 2
+        return -1
+
+    compressed = False
+    for initializer in list(model.initializer()):
+        if initializer.data_type != onnx_proto.TensorProto.FLOAT or len(initializer.dims) != 2 \
+                or initializer.name in graph_outputs:
+            continue
+
+        consumers = input_name_to_nodes.get(initializer.name, [])
+        if not consumers or any(
+                table_input_index(node) < 0 or
+                [i for i, name in enumerate(node.input) if name == initializer.name] != [table_input_index(node)]
+                for node in consumers):
+            continue
+
+        table, scale, zero_point = _compress_embedding_table(onnx.numpy_helper.to_array(initializer), table_format)
+        table_name = initializer.name + "_" + table_format.name.lower()
+        if table_format == EmbeddingTableFormat.BFloat16:
+            table_tensor = onnx.helper.make_tensor(table_name, onnx_proto.TensorProto.BFLOAT16, table.shape,
+                                                   table.tobytes(), raw=True)
+        else:
+            table_tensor = onnx.numpy_helper.from_array(table, table_name)
+        model.add_initializer(table_tensor)
+        extra_inputs = []
+        if scale is not None:
+            extra_inputs = [initializer.name + "_scale", initializer.name + "_zero_point"]
+            model.add_initializer(onnx.numpy_helper.from_array(scale, extra_inputs[0]))
+            model.add_initializer(onnx.numpy_helper.from_array(zero_point, extra_inputs[1]))
+
+        for node in consumers:
+            if node.op_type == "Gather":
+                # DequantizeGather has the inputs of Gather followed by the scale and zero point, and no axis
+                node.op_type = "DequantizeGather"
+                node.domain = ms_domain
+                del node.attribute[:]
+                node.input[0] = table_name
+                node.input.extend(extra_inputs)
+            else:
+                node.input[2] = table_name
+                if extra_inputs:
+                    node.input.extend([""] * (8 - len(node.input)) + extra_inputs)
+
+        model.remove_initializer(initializer)
+        compressed = True
+
+    if compressed and not any(opset.domain == ms_domain for opset in model.opset_import()):
+        model.opset_import().extend([onnx.helper.make_opsetid(ms_domain, 1)])
+
+    model.save_model_to_file(model_output, use_external_data_format)
@@ -0,0 +1,216 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <cmath>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "core/graph/model.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/framework/test_utils.h"
+
+using namespace ONNX_NAMESPACE;
+
+namespace onnxruntime {
+namespace test {
+
+static constexpr int32_t kVocabSize = 4;
+static constexpr int32_t kEosTokenId = 3;
+static constexpr int32_t kPadTokenId = 0;
+
+// Creates a single layer decoder with 1 head of size 1, whose next token probabilities only depend on the
+// current token (a bigram model). The present state is the past state with the token ids appended, so that the
+// shape of the state is checked by the Concat nodes at every step.
+static GraphProto CreateBigramDecoder(const std::vector<std::vector<float>>& probabilities) {
+  Model model("decoder", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{"", 12}},
+              {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  TypeProto int32_2d;
+  int32_2d.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT32);
+  int32_2d.mutable_tensor_type()->mutable_shape()->add_dim();
+  int32_2d.mutable_tensor_type()->mutable_shape()->add_dim();
+
+  TypeProto float_past;
+  float_past.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  auto* past_shape = float_past.mutable_tensor_type()->mutable_shape();
+  past_shape->add_dim()->set_dim_value(2);
+  past_shape->add_dim();
+  past_shape->add_dim()->set_dim_value(1);
+  past_shape->add_dim();
+  past_shape->add_dim()->set_dim_value(1);
+
+  auto& input_ids = graph.GetOrCreateNodeArg("input_ids", &int32_2d);
+  auto& position_ids = graph.GetOrCreateNodeArg("position_ids", &int32_2d);
+  auto& attention_mask = graph.GetOrCreateNodeArg("attention_mask", &int32_2d);
+  auto& past_0 = graph.GetOrCreateNodeArg("past_0", &float_past);
+
+  auto& weights = graph.GetOrCreateNodeArg("weights", nullptr);
+  auto& logits = graph.GetOrCreateNodeArg("logits", nullptr);
+  auto& ids_float = graph.GetOrCreateNodeArg("ids_float", nullptr);
+  auto& kv = graph.GetOrCreateNodeArg("kv", nullptr);
+  auto& new_kv = graph.GetOrCreateNodeArg("new_kv", nullptr);
+  auto& present_0 = graph.GetOrCreateNodeArg("present_0", nullptr);
+
+  // the logits are log probabilities, so the log softmax of beam search recovers them.
+  TensorProto weights_tensor;
+  weights_tensor.set_name("weights");
+  weights_tensor.set_data_type(TensorProto_DataType_FLOAT);
+  weights_tensor.add_dims(kVocabSize);
+  weights_tensor.add_dims(kVocabSize);
+  for (const auto& row : probabilities) {
+    for (float p : row) {
+      weights_tensor.add_float_data(std::log(p));
+    }
+  }
+  graph.AddInitializedTensor(weights_tensor);
+
+  graph.AddNode("gather", "Gather", "Bigram logits", {&weights, &input_ids}, {&logits});
+  graph.AddNode("cast", "Cast", "Token ids as state", {&input_ids}, {&ids_float})
+      .AddAttribute("to", int64_t(TensorProto_DataType_FLOAT));
+  graph.AddNode("unsqueeze", "Unsqueeze", "(1, N, 1, S, 1)", {&ids_float}, {&kv})
+      .AddAttribute("axes", std::vector<int64_t>{0, 2, 4});
+  graph.AddNode("concat_kv", "Concat", "Keys and values", {&kv, &kv}, {&new_kv})
+      .AddAttribute("axis", int64_t(0));
+  graph.AddNode("concat_past", "Concat", "Append to past state", {&past_0, &new_kv}, {&present_0})
+      .AddAttribute("axis", int64_t(3));
+
+  graph.SetInputs({&input_ids, &position_ids, &attention_mask, &past_0});
+  graph.SetOutputs({&logits, &present_0});
+
+  auto status = graph.Resolve();
+  EXPECT_EQ(status, Status::OK());
+
+  return graph.ToGraphProto();
+}
+
+// From token 0 the most likely continuation is 1 then end-of-sequence, but 2 then end-of-sequence is more
+// likely overall, which beam search finds and greedy search does not.
+static const std::vector<std::vector<float>> kBigramProbabilities = {
+    {0.001f, 0.5f, 0.4f, 0.1f},
+    {0.001f, 0.3f, 0.3f, 0.4f},
+    {0.001f, 0.001f, 0.001f, 0.997f},
+    {0.25f, 0.25f, 0.25f, 0.25f}};
+
+TEST(BeamSearchTest, FindsMostLikelySequences) {
+  OpTester test("BeamSearch", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("decoder", CreateBigramDecoder(kBigramProbabilities));
+  test.AddAttribute<int64_t>("eos_token_id", kEosTokenId);
+  test.AddAttribute<int64_t>("pad_token_id", kPadTokenId);
+
+  test.AddInput<int32_t>("input_ids", {1, 1}, {0});
+  test.AddInput<int32_t>("max_length", {1}, {4});
+  test.AddInput<int32_t>("min_length", {1}, {1});
+  test.AddInput<int32_t>("num_beams", {1}, {2});
+  test.AddInput<int32_t>("num_return_sequences", {1}, {2});
+  test.AddInput<float>("length_penalty", {1}, {1.0f});
+  test.AddInput<float>("repetition_penalty", {1}, {1.0f});
+
+  // scores are the sums of the log probabilities divided by the length without the end-of-sequence token.
+  test.AddOutput<int32_t>("sequences", {1, 2, 4}, {0, 2, 3, kPadTokenId,
+                                                   0, 1, 2, 3});
+  test.AddOutput<float>("sequences_scores", {1, 2}, {-0.460147f, -0.634041f});
+  test.Run();
+}
+
+TEST(BeamSearchTest, MinLengthSuppressesEos) {
+  OpTester test("BeamSearch", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("decoder", CreateBigramDecoder(kBigramProbabilities));
+  test.AddAttribute<int64_t>("eos_token_id", kEosTokenId);
+  test.AddAttribute<int64_t>("pad_token_id", kPadTokenId);
+
+  test.AddInput<int32_t>("input_ids", {1, 1}, {2});
+  test.AddInput<int32_t>("max_length", {1}, {3});
+  test.AddInput<int32_t>("min_length", {1}, {3});
+  test.AddInput<int32_t>("num_beams", {1}, {1});
+  test.AddInput<int32_t>("num_return_sequences", {1}, {1});
+
+  // without the minimum length, 2 is followed by end-of-sequence. ties are resolved by the smaller token id.
+  test.AddOutput<int32_t>("sequences", {1, 1, 3}, {2, 0, 1});
+  test.Run();
+}
+
+TEST(GreedySearchTest, PadsFinishedSequences) {
+  OpTester test("GreedySearch", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("decoder", CreateBigramDecoder(kBigramProbabilities));
+  test.AddAttribute<int64_t>("eos_token_id", kEosTokenId);
+  test.AddAttribute<int64_t>("pad_token_id", kPadTokenId);
+
+  test.AddInput<int32_t>("input_ids", {2, 1}, {0, 2});
+  test.AddInput<int32_t>("max_length", {1}, {4});
+
+  test.AddOutput<int32_t>("sequences", {2, 4}, {0, 1, 3, kPadTokenId,
+                                                2, 3, kPadTokenId, kPadTokenId});
+  test.Run();
+}
+
+TEST(GreedySearchTest, RepetitionPenalty) {
+  OpTester test("GreedySearch", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("decoder", CreateBigramDecoder(kBigramProbabilities));
+  test.AddAttribute<int64_t>("eos_token_id", kEosTokenId);
+  test.AddAttribute<int64_t>("pad_token_id", kPadTokenId);
+
+  // after 1, end-of-sequence is the most likely token unless penalized for appearing in the prompt.
+  test.AddInput<int32_t>("input_ids", {1, 2}, {3, 1});
+  test.AddInput<int32_t>("max_length", {1}, {3});
+  test.AddMissingOptionalInput<int32_t>();
+  test.AddInput<float>("repetition_penalty", {1}, {2.0f});
+
+  // 1 is penalized too, leaving 2 as the most likely token.
+  test.AddOutput<int32_t>("sequences", {1, 3}, {3, 1, 2});
+  test.Run();
+}
+
+TEST(GreedySearchTest, SampleTopKOneIsGreedy) {
+  OpTester test("GreedySearch", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("decoder", CreateBigramDecoder(kBigramProbabilities));
+  test.AddAttribute<int64_t>("eos_token_id", kEosTokenId);
+  test.AddAttribute<int64_t>("pad_token_id", kPadTokenId);
+  test.AddAttribute<int64_t>("do_sample", 1);
+  test.AddAttribute<int64_t>("top_k", 1);
+  test.AddAttribute<int64_t>("seed", 1);
+
+  test.AddInput<int32_t>("input_ids", {2, 1}, {0, 2});
+  test.AddInput<int32_t>("max_length", {1}, {4});
+
+  // only the most likely token can be drawn, so the output is the one of PadsFinishedSequences.
+  test.AddOutput<int32_t>("sequences", {2, 4}, {0, 1, 3, kPadTokenId,
+                                                2, 3, kPadTokenId, kPadTokenId});
+  test.Run();
+}
+
+TEST(GreedySearchTest, SampleSmallTopPKeepsMostLikelyToken) {
+  OpTester test("GreedySearch", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("decoder", CreateBigramDecoder(kBigramProbabilities));
+  test.AddAttribute<int64_t>("eos_token_id", kEosTokenId);
+  test.AddAttribute<int64_t>("pad_token_id", kPadTokenId);
+  test.AddAttribute<int64_t>("do_sample", 1);
+  test.AddAttribute<float>("top_p", 0.01f);
+  test.AddAttribute<int64_t>("seed", 1);
+
+  test.AddInput<int32_t>("input_ids", {2, 1}, {0, 2});
+  test.AddInput<int32_t>("max_length", {1}, {4});
+
+  // the most likely token alone exceeds top_p, so it is the only candidate.
+  test.AddOutput<int32_t>("sequences", {2, 4}, {0, 1, 3, kPadTokenId,
+                                                2, 3, kPadTokenId, kPadTokenId});
+  test.Run();
+}
+
+TEST(GreedySearchTest, InvalidTopP) {
+  OpTester test("GreedySearch", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("decoder", CreateBigramDecoder(kBigramProbabilities));
+  test.AddAttribute<int64_t>("eos_token_id", kEosTokenId);
+  test.AddAttribute<int64_t>("pad_token_id", kPadTokenId);
+  test.AddAttribute<int64_t>("do_sample", 1);
+  test.AddAttribute<float>("top_p", 1.5f);
+
+  test.AddInput<int32_t>("input_ids", {1, 1}, {0});
+  test.AddInput<int32_t>("max_length", {1}, {3});
+
+  test.AddOutput<int32_t>("sequences", {1, 3}, {0, 1, 3});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "top_p must be in the range (0, 1]");
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -1,6 +1,11 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -69,5 +74,246 @@ TEST(CDistOpTest, DoubleEuclidean) {
   test.Run();
 }
 
+TEST(CDistOpTest, Cosine) {
+  OpTester test("CDist", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("metric", "cosine");
+
+  test.AddInput<float>("A", {4, 2},
+                       {-1.0856307f, 0.99734545f,
+                        0.2829785f, -1.5062947f,
+                        -0.5786002f, 1.6514366f,
+                        -2.4266791f, -0.42891264f});
+  test.AddInput<float>("B", {3, 2},
+                       {1.2659363f, -0.8667404f,
+                        -0.6788862f, -0.09470897f,
+                        1.4913896f, -0.638902f});
+
+  test.AddOutput<float>("y", {4, 3},
+                        {1.989838f, 0.3641223f, 1.943321f,
+                         0.2924266f, 1.04707f, 0.4432724f,
+                         1.805996f, 0.8029135f, 1.675571f,
+                         1.714211f, 0.0006598694f, 1.836636f});
+  test.Run();
+}
+
+TEST(CDistOpTest, InnerProduct) {
+  OpTester test("CDist", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("metric", "inner_product");
+
+  test.AddInput<float>("A", {4, 2},
+                       {-1.0856307f, 0.99734545f,
+                        0.2829785f, -1.5062947f,
+                        -0.5786002f, 1.6514366f,
+                        -2.4266791f, -0.42891264f});
+  test.AddInput<float>("B", {3, 2},
+                       {1.2659363f, -0.8667404f,
+                        -0.6788862f, -0.09470897f,
+                        1.4913896f, -0.638902f});
+
+  test.AddOutput<float>("y", {4, 3},
+                        {-2.238779f, 0.6425621f, -2.256304f,
+                         1.663799f, -0.04945058f, 1.384406f,
+                         -2.163838f, 0.2363978f, -1.918024f,
+                         -2.700265f, 1.688061f, -3.345091f});
+  test.Run();
+}
+
+TEST(CDistOpTest, EuclideanTopK) {
+  OpTester test("CDist", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("metric", "euclidean");
+  test.AddAttribute("k", static_cast<int64_t>(2));
+
+  test.AddInput<float>("A", {4, 2},
+                       {-1.0856307f, 0.99734545f,
+                        0.2829785f, -1.5062947f,
+                        -0.5786002f, 1.6514366f,
+                        -2.4266791f, -0.42891264f});
+  test.AddInput<float>("B", {3, 2},
+                       {1.2659363f, -0.8667404f,
+                        -0.6788862f, -0.09470897f,
+                        1.4913896f, -0.638902f});
+
+  test.AddOutput<float>("y", {4, 2},
+                        {1.1653428f, 3.0007803f,
+                         1.1727045f, 1.4874904f,
+                         1.749023f, 3.0871522f,
+                         1.7794584f, 3.718481f});
+  test.AddOutput<int64_t>("indices", {4, 2},
+                          {1, 0,
+                           0, 2,
+                           1, 2,
+                           1, 0});
+  test.Run();
+}
+
+// the nearest rows are those with the largest inner product
+TEST(CDistOpTest, InnerProductTopK) {
+  OpTester test("CDist", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("metric", "inner_product");
+  test.AddAttribute("k", static_cast<int64_t>(2));
+
+  test.AddInput<float>("A", {4, 2},
+                       {-1.0856307f, 0.99734545f,
+                        0.2829785f, -1.5062947f,
+                        -0.5786002f, 1.6514366f,
+                        -2.4266791f, -0.42891264f});
+  test.AddInput<float>("B", {3, 2},
+                       {1.2659363f, -0.8667404f,
+                        -0.6788862f, -0.09470897f,
+                        1.4913896f, -0.638902f});
+
+  test.AddOutput<float>("y", {4, 2},
+                        {0.6425621f, -2.238779f,
+                         1.663799f, 1.384406f,
+                         0.2363978f, -1.918024f,
+                         1.688061f, -2.700265f});
+  test.Run();
+}
+
+TEST(CDistOpTest, TopKTiesByIndex) {
+  OpTester test("CDist", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("metric", "sqeuclidean");
+  test.AddAttribute("k", static_cast<int64_t>(3));
+
+  test.AddInput<float>("A", {1, 2}, {0.0f, 0.0f});
+  test.AddInput<float>("B", {4, 2},
+                       {2.0f, 0.0f,
+                        0.0f, 1.0f,
+                        0.0f, -2.0f,
+                        1.0f, 0.0f});
+
+  test.AddOutput<float>("y", {1, 3}, {1.0f, 1.0f, 4.0f});
+  test.AddOutput<int64_t>("indices", {1, 3}, {1, 3, 0});
+  test.Run();
+}
+
+TEST(CDistOpTest, TopKLargerThanB) {
+  OpTester test("CDist", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("metric", "euclidean");
+  test.AddAttribute("k", static_cast<int64_t>(4));
+
+  test.AddInput<float>("A", {4, 2},
+                       {-1.0856307f, 0.99734545f,
+                        0.2829785f, -1.5062947f,
+                        -0.5786002f, 1.6514366f,
+                        -2.4266791f, -0.42891264f});
+  test.AddInput<float>("B", {3, 2},
+                       {1.2659363f, -0.8667404f,
+                        -0.6788862f, -0.09470897f,
+                        1.4913896f, -0.638902f});
+
+  test.AddOutput<float>("y", {4, 4}, std::vector<float>(16, 0.0f));
+  test.Run(OpTester::ExpectResult::kExpectFailure, "k (4) is larger than the number of rows of B (3)");
+}
+
+// Small integers keep the products exact, so the GEMM based kernel and the naive reference agree bit for bit
+// and the ties, which are plentiful, have to be broken by index.
+static std::vector<float> RandomIntegralMatrix(int64_t rows, int64_t cols, unsigned seed) {
+  std::default_random_engine generator(seed);
+  std::uniform_int_distribution<int> distribution(-4, 4);
+  std::vector<float> values(static_cast<size_t>(rows * cols));
+  for (auto& value : values) {
+    value = static_cast<float>(distribution(generator));
+  }
+  return values;
+}
+
+static std::vector<float> NaiveSqeuclidean(const std::vector<float>& a, const std::vector<float>& b,
+                                           int64_t m, int64_t n, int64_t k) {
+  std::vector<float> distances(static_cast<size_t>(m * n));
+  for (int64_t i = 0; i < m; ++i) {
+    for (int64_t j = 0; j < n; ++j) {
+      double sum = 0;
+      for (int64_t l = 0; l < k; ++l) {
+        const double diff = static_cast<double>(a[i * k + l]) - b[j * k + l];
+        sum += diff * diff;
+      }
+      distances[i * n + j] = static_cast<float>(sum);
+    }
+  }
+  return distances;
+}
+
+// m and n span several tiles of rows and columns, and the pool splits the tiles between threads.
+static SessionOptions MultiThreadedSessionOptions() {
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 4;
+  return so;
+}
+
+TEST(CDistOpTest, SqeuclideanManyTiles) {
+  constexpr int64_t m = 130, n = 2100, k = 8;
+  const auto a = RandomIntegralMatrix(m, k, 1);
+  const auto b = RandomIntegralMatrix(n, k, 2);
+
+  OpTester test("CDist", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("metric", "sqeuclidean");
+  test.AddInput<float>("A", {m, k}, a);
+  test.AddInput<float>("B", {n, k}, b);
+  test.AddOutput<float>("y", {m, n}, NaiveSqeuclidean(a, b, m, n, k));
+  test.Run(MultiThreadedSessionOptions());
+}
+
+TEST(CDistOpTest, SqeuclideanTopKManyTiles) {
+  constexpr int64_t m = 130, n = 2100, k = 8, top_k = 5;
+  const auto a = RandomIntegralMatrix(m, k, 3);
+  const auto b = RandomIntegralMatrix(n, k, 4);
+  const auto distances = NaiveSqeuclidean(a, b, m, n, k);
+
+  std::vector<float> expected_values;
+  std::vector<int64_t> expected_indices;
+  std::vector<int64_t> order(static_cast<size_t>(n));
+  for (int64_t i = 0; i < m; ++i) {
+    const float* row = distances.data() + i * n;
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [row](int64_t x, int64_t y) { return row[x] < row[y]; });
+    for (int64_t j = 0; j < top_k; ++j) {
+      expected_values.push_back(row[order[j]]);
+      expected_indices.push_back(order[j]);
+    }
+  }
+
+  OpTester test("CDist", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("metric", "sqeuclidean");
+  test.AddAttribute("k", top_k);
+  test.AddInput<float>("A", {m, k}, a);
+  test.AddInput<float>("B", {n, k}, b);
+  test.AddOutput<float>("y", {m, top_k}, expected_values);
+  test.AddOutput<int64_t>("indices", {m, top_k}, expected_indices);
+  test.Run(MultiThreadedSessionOptions());
+}
+
+// A zero row has no direction, so its cosine distances are NaN, and NaN is the farthest.
+TEST(CDistOpTest, CosineZeroRow) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const std::vector<float> a{0.0f, 0.0f,
+                             2.0f, 0.0f};
+  const std::vector<float> b{0.0f, 0.0f,
+                             0.0f, 3.0f,
+                             1.0f, 0.0f};
+
+  OpTester full("CDist", 1, onnxruntime::kMSDomain);
+  full.AddAttribute("metric", "cosine");
+  full.AddInput<float>("A", {2, 2}, a);
+  full.AddInput<float>("B", {3, 2}, b);
+  full.AddOutput<float>("y", {2, 3},
+                        {nan, nan, nan,
+                         nan, 1.0f, 0.0f});
+  full.Run();
+
+  OpTester top_k("CDist", 1, onnxruntime::kMSDomain);
+  top_k.AddAttribute("metric", "cosine");
+  top_k.AddAttribute("k", static_cast<int64_t>(2));
+  top_k.AddInput<float>("A", {2, 2}, a);
+  top_k.AddInput<float>("B", {3, 2}, b);
+  top_k.AddOutput<float>("y", {2, 2},
+                         {nan, nan,
+                          0.0f, 1.0f});
+  top_k.AddOutput<int64_t>("indices", {2, 2},
+                           {0, 1,
+                            2, 1});
+  top_k.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
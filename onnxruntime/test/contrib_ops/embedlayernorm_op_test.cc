@@ -514,5 +514,37 @@ TEST(EmbedLayerNormTest, EmbedLayerNormBatch_Distill) {
           true,
           false);
 }
+
+// the word embedding of EmbedLayerNormBatch1 quantized to int8 with a scale of 0.1 and a zero point per row
+TEST(EmbedLayerNormTest, EmbedLayerNormBatch1_QuantizedWordEmbedding) {
+  OpTester tester("EmbedLayerNormalization", 1, onnxruntime::kMSDomain);
+  tester.AddInput<int32_t>("input_ids", {1, 2}, {1, 3});
+  tester.AddInput<int32_t>("segment_ids", {1, 2}, {0, 1});
+  tester.AddInput<int8_t>("word_embedding", {6, 4},
+                          {2, 1, 4, -6,
+                           -2, -3, 0, 1,
+                           9, 10, 3, 2,
+                           18, 16, 19, 22,
+                           0, 2, 4, 8,
+                           17, -13, 18, 15});
+  tester.AddInput<float>("position_embedding", {3, 4},
+                         {0.1f, 0.1f, 0.4f, 0.6f,
+                          0.6f, 0.0f, 0.8f, 0.6f,
+                          0.3f, 0.9f, -2.0f, 0.8f});
+  tester.AddInput<float>("segment_embedding", {2, 4},
+                         {0.3f, 0.4f, 0.9f, 0.1f,
+                          0.7f, 0.3f, 0.5f, 0.2f});
+  tester.AddInput<float>("gamma", {4}, {0.25f, 0.15f, 0.45f, -0.66f});
+  tester.AddInput<float>("beta", {4}, {0.6f, 0.2f, 0.5f, -0.6f});
+  tester.AddInput<int32_t>("mask", {1, 2}, {1, 1});
+  tester.AddInput<float>("word_embedding_scale", {6}, {0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f});
+  tester.AddInput<int8_t>("word_embedding_zero_point", {6}, {0, -5, 3, 10, -1, 7});
+  tester.AddAttribute("epsilon", epsilon_);
+  tester.AddOutput<float>("output", {1, 2, 4},
+                          {0.36917170882225037f, 0.061503000557422638f, 1.1598974466323853f, -0.85092413425445557f,
+                           0.74301940202713013f, -0.057434864342212677f, 0.84324657917022705f, -0.85171419382095337f});
+  tester.AddOutput<int32_t>("mask_index", {1}, {2});
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {kCudaExecutionProvider});
+}
 }  // namespace test
 }  // namespace onnxruntime
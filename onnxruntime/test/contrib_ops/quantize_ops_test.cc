@@ -331,5 +331,71 @@ TEST(QuantizeLinearContribOpTest, QuantizeLinear_per_channel_negative_axis) {
                            0, 0, 1, 250});
   test.Run();
 }
+
+// int8 table with a scale and zero point per row
+TEST(DequantizeGatherOpTest, DequantizeGather_int8) {
+  OpTester test("DequantizeGather", 1, onnxruntime::kMSDomain);
+  test.AddInput<int8_t>("data", {3, 2},
+                        {-128, 127,
+                         0, 10,
+                         -3, 5});
+  test.AddInput<int64_t>("indices", {2, 2}, {2, 0, -2, 2});
+  test.AddInput<float>("scale", {3}, {1.0f, 0.5f, 2.0f});
+  test.AddInput<int8_t>("zero_point", {3}, {-128, 0, 1});
+  test.AddOutput<float>("output", {2, 2, 2},
+                        {-8.0f, 8.0f,
+                         0.0f, 255.0f,
+                         0.0f, 5.0f,
+                         -8.0f, 8.0f});
+  test.Run();
+}
+
+// uint8 table without zero point
+TEST(DequantizeGatherOpTest, DequantizeGather_uint8_no_zero_point) {
+  OpTester test("DequantizeGather", 1, onnxruntime::kMSDomain);
+  test.AddInput<uint8_t>("data", {2, 3}, {0, 1, 255, 4, 8, 12});
+  test.AddInput<int32_t>("indices", {3}, {1, 0, 1});
+  test.AddInput<float>("scale", {2}, {0.5f, 0.25f});
+  test.AddOutput<float>("output", {3, 3},
+                        {1.0f, 2.0f, 3.0f,
+                         0.0f, 0.5f, 127.5f,
+                         1.0f, 2.0f, 3.0f});
+  test.Run();
+}
+
+TEST(DequantizeGatherOpTest, DequantizeGather_float16) {
+  OpTester test("DequantizeGather", 1, onnxruntime::kMSDomain);
+  test.AddInput<MLFloat16>("data", {3, 2}, ToFloat16({0.5f, -1.0f, 2.25f, 3.0f, -0.125f, 100.0f}));
+  test.AddInput<int64_t>("indices", {2}, {2, 1});
+  test.AddOutput<float>("output", {2, 2}, {-0.125f, 100.0f, 2.25f, 3.0f});
+  test.Run();
+}
+
+TEST(DequantizeGatherOpTest, DequantizeGather_bfloat16) {
+  OpTester test("DequantizeGather", 1, onnxruntime::kMSDomain);
+  test.AddInput<BFloat16>("data", {2, 2}, {BFloat16(0.5f), BFloat16(-1.0f), BFloat16(2.25f), BFloat16(3.0f)});
+  test.AddInput<int64_t>("indices", {3}, {1, 1, 0});
+  test.AddOutput<float>("output", {3, 2}, {2.25f, 3.0f, 2.25f, 3.0f, 0.5f, -1.0f});
+  test.Run();
+}
+
+TEST(DequantizeGatherOpTest, DequantizeGather_invalid_index) {
+  OpTester test("DequantizeGather", 1, onnxruntime::kMSDomain);
+  test.AddInput<int8_t>("data", {2, 2}, {1, 2, 3, 4});
+  test.AddInput<int64_t>("indices", {1}, {2});
+  test.AddInput<float>("scale", {2}, {1.0f, 1.0f});
+  test.AddOutput<float>("output", {1, 2}, {0.0f, 0.0f});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "indices element out of data bounds");
+}
+
+// an 8-bit table needs a scale per row
+TEST(DequantizeGatherOpTest, DequantizeGather_invalid_scale) {
+  OpTester test("DequantizeGather", 1, onnxruntime::kMSDomain);
+  test.AddInput<int8_t>("data", {2, 2}, {1, 2, 3, 4});
+  test.AddInput<int64_t>("indices", {1}, {0});
+  test.AddInput<float>("scale", {1}, {1.0f});
+  test.AddOutput<float>("output", {1, 2}, {1.0f, 2.0f});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "scale of embedding table is expected to have shape");
+}
 }  // namespace test
 }  // namespace onnxruntime
\ No newline at end of file
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <unordered_map>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -43,5 +45,54 @@ TEST(UniqueOpTest, Unique_AllUniqueElements) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
 }
 
+TEST(UniqueOpTest, Unique_Int64) {
+  OpTester test("Unique", 1, onnxruntime::kMSDomain);
+  test.AddInput<int64_t>("x", {7}, {1000000007, -3, 5, -3, 1000000007, 0, 5});
+  test.AddOutput<int64_t>("uniques", {4}, {1000000007, -3, 5, 0});
+  test.AddOutput<int64_t>("idx", {7}, {0, 1, 2, 1, 0, 3, 2});
+  test.AddOutput<int64_t>("counts", {4}, {2, 2, 2, 1});
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+}
+
+TEST(UniqueOpTest, Unique_String) {
+  OpTester test("Unique", 1, onnxruntime::kMSDomain);
+  test.AddInput<std::string>("x", {5}, {"b", "a", "b", "", "a"});
+  test.AddOutput<std::string>("uniques", {3}, {"b", "a", ""});
+  test.AddOutput<int64_t>("idx", {5}, {0, 1, 0, 2, 1});
+  test.AddOutput<int64_t>("counts", {3}, {2, 2, 1});
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+}
+
+// large enough to be split between threads, which must not change the order of first occurrence
+TEST(UniqueOpTest, Unique_LargeInput) {
+  const int64_t num_elements = 200000;
+  std::vector<int64_t> x(num_elements);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    x[i] = (i * 7919) % 30011 - 15000;
+  }
+
+  std::vector<int64_t> uniques;
+  std::vector<int64_t> idx(num_elements);
+  std::vector<int64_t> counts;
+  std::unordered_map<int64_t, int64_t> ids;
+  for (int64_t i = 0; i < num_elements; ++i) {
+    auto entry = ids.emplace(x[i], static_cast<int64_t>(uniques.size()));
+    if (entry.second) {
+      uniques.push_back(x[i]);
+      counts.push_back(0);
+    }
+
+    idx[i] = entry.first->second;
+    ++counts[idx[i]];
+  }
+
+  OpTester test("Unique", 1, onnxruntime::kMSDomain);
+  test.AddInput<int64_t>("x", {num_elements}, x);
+  test.AddOutput<int64_t>("uniques", {static_cast<int64_t>(uniques.size())}, uniques);
+  test.AddOutput<int64_t>("idx", {num_elements}, idx);
+  test.AddOutput<int64_t>("counts", {static_cast<int64_t>(counts.size())}, counts);
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -126,5 +126,29 @@ TEST(ContribOpTest, WordConvEmbedding_char_embedding_shape_conv_shape_not_match)
   test.Run(OpTester::ExpectResult::kExpectFailure);
 }
 
+TEST(ContribOpTest, WordConvEmbedding_empty_and_short_words) {
+  OpTester test("WordConvEmbedding", 1, onnxruntime::kMSDomain);
+  // the first word is shorter than the conv window, the second one is empty
+  test.AddInput<int>("Sequence", {3, 4},
+                     {1, 2, 0, 0,
+                      0, 0, 0, 0,
+                      4, 3, 2, 1});
+  test.AddInput<float>("W", {2, 1, 3, 3},
+                       {0.1f, 0.2f, 0.3f, 0.2f, 0.3f, 0.1f, 0.3f, 0.1f, 0.2f,
+                        1.0f, 1.1f, 1.2f, -0.5f, 0.4f, -0.3f, 0.2f, -0.1f, 0.6f});
+  test.AddInput<float>("B", {2}, {0.1f, -0.2f});
+  test.AddInput<float>("C", {5, 3},
+                       {0.1f, 0.2f, 0.3f,
+                        0.2f, 0.3f, 0.1f,
+                        0.3f, 0.1f, 0.2f,
+                        0.4f, 0.5f, 0.6f,
+                        0.7f, 0.8f, 0.9f});
+  test.AddOutput<float>("Y", {3, 2},
+                        {0.405321309f, 0.430084211f,
+                         0.0f, 0.0f,
+                         0.77390834f, 0.985216917f});
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -3,8 +3,11 @@
 
 #include "core/common/make_unique.h"
 #include "core/framework/execution_frame.h"
+#include "core/framework/feeds_fetches_manager.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
+#include "core/framework/subgraph_execution_context.h"
+#include "core/framework/utils.h"
 #include "core/graph/model.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/inference_session.h"
@@ -339,5 +342,65 @@ TEST(ExecutionFrameTestInit, InitializerAsOutput) {
   }
 }
 
+// Loop and Scan execute their subgraph through a SubgraphExecutionContext, which keeps the frame of the previous
+// execution while the shapes of the feeds stay the same.
+TEST(SubgraphExecutionContextTest, ReusesFrameWhileFeedShapesMatch) {
+  onnxruntime::Model model("subgraph_execution_context", false, ModelMetaData(), PathString(),
+                           IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {},
+                           DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("N");
+  auto& x = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& t = graph.GetOrCreateNodeArg("T", &tensor_float);
+  auto& y = graph.GetOrCreateNodeArg("Y", &tensor_float);
+  graph.AddNode("relu", "Relu", "Relu operator", ArgMap{&x}, ArgMap{&t});
+  graph.AddNode("neg", "Neg", "Neg operator", ArgMap{&t}, ArgMap{&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+
+  // without the memory pattern the first frame is already reusable
+  SessionOptions so;
+  so.enable_mem_pattern = false;
+  so.graph_optimization_level = TransformerLevel::Default;
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(model_data.data(), static_cast<int>(model_data.size())));
+  ASSERT_STATUS_OK(session.Initialize());
+  const auto& session_state = session.GetSessionState();
+
+  std::unique_ptr<FeedsFetchesManager> ffm;
+  ASSERT_STATUS_OK(FeedsFetchesManager::Create({"X"}, {"Y"}, session_state.GetOrtValueNameIdxMap(), ffm));
+  ASSERT_STATUS_OK(utils::InitializeFeedFetchCopyInfo(session_state, *ffm));
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  utils::FinalizeFeedFetchCopyInfo(*ffm, {allocator->Info().device}, {&allocator->Info()});
+
+  const bool terminate_flag = false;
+  SubgraphExecutionContext context(session_state, *ffm, terminate_flag, DefaultLoggingManager().DefaultLogger());
+  auto execute = [&](const std::vector<float>& x_values, const std::vector<float>& expected_y_values) {
+    OrtValue x_value;
+    CreateMLValue<float>(allocator, {static_cast<int64_t>(x_values.size())}, x_values, &x_value);
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(context.Execute({x_value}, fetches));
+    ASSERT_EQ(fetches.size(), 1u);
+    EXPECT_THAT(fetches[0].Get<Tensor>().DataAsSpan<float>(),
+                ::testing::ContainerEq(gsl::make_span(expected_y_values)));
+  };
+
+  execute({-1.f, 2.f, 3.f}, {0.f, -2.f, -3.f});
+  EXPECT_EQ(context.NumFrameReuses(), 0u);
+  execute({4.f, -5.f, 6.f}, {-4.f, 0.f, -6.f});
+  execute({7.f, 8.f, -9.f}, {-7.f, -8.f, 0.f});
+  EXPECT_EQ(context.NumFrameReuses(), 2u);
+
+  // a new shape needs a new frame, which is then reused in turn
+  execute({1.f, -2.f}, {-1.f, 0.f});
+  EXPECT_EQ(context.NumFrameReuses(), 2u);
+  execute({-3.f, 4.f}, {0.f, -4.f});
+  EXPECT_EQ(context.NumFrameReuses(), 3u);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -7,6 +7,8 @@
 #include <cfloat>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <set>
 #include <thread>
 #include <fstream>
 
@@ -18,7 +20,11 @@
 #include "core/framework/compute_capability.h"
 #include "core/framework/data_transfer_manager.h"
 #include "core/framework/execution_provider.h"
+#include "core/framework/execution_providers.h"
+#include "core/framework/fuse_nodes_funcs.h"
+#include "core/framework/graph_partitioner.h"
 #include "core/framework/kernel_registry.h"
+#include "core/framework/kernel_registry_manager.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
 #include "core/framework/tensorprotoutils.h"
@@ -27,6 +33,7 @@
 #include "core/graph/op.h"
 #include "core/optimizer/rule_based_graph_transformer.h"
 #include "core/platform/env.h"
+#include "core/platform/path_lib.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/providers/cpu/math/element_wise_ops.h"
 #ifdef USE_CUDA
@@ -44,6 +51,7 @@
 #include "test/optimizer/dummy_graph_transformer.h"
 #include "test/util/include/default_providers.h"
 #include "test/util/include/inference_session_wrapper.h"
+#include "test/util/include/temp_dir.h"
 
 #include "gtest/gtest.h"
 
@@ -362,6 +370,22 @@ TEST(InferenceSessionTests, NoTimeout) {
   RunModel(session_object, run_options);
 }
 
+TEST(InferenceSessionTests, FarDeadline) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.FarDeadline";
+
+  InferenceSession session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  // A deadline this far away saturates instead of overflowing into the past.
+  RunOptions run_options;
+  run_options.run_tag = "far deadline";
+  run_options.run_deadline_ms = std::numeric_limits<int64_t>::max();
+  RunModel(session_object, run_options);
+}
+
 TEST(InferenceSessionTests, OnlyExecutePathToFetches) {
   SessionOptions so;
 
@@ -685,6 +709,42 @@ TEST(InferenceSessionTests, CheckRunProfilerStartTime) {
   ASSERT_TRUE(before_start_time <= profiling_start_time && profiling_start_time <= after_start_time);
 }
 
+TEST(InferenceSessionTests, CollectTensorStatistics) {
+  SessionOptions so;
+  so.session_logid = "CollectTensorStatistics";
+
+  InferenceSession session_object(so, GetEnvironment());
+  ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  std::unordered_map<std::string, TensorStatistics> statistics;
+  ASSERT_FALSE(session_object.EndCalibration(statistics).IsOK());
+  ASSERT_FALSE(session_object.StartCalibration({}, 6).IsOK());
+  ASSERT_STATUS_OK(session_object.StartCalibration({"X", "Y"}, 4));
+
+  RunOptions run_options;
+  RunModel(session_object, run_options);
+  RunModel(session_object, run_options);
+  ASSERT_STATUS_OK(session_object.EndCalibration(statistics));
+
+  // the graph input is observed as well as the node output.
+  ASSERT_EQ(statistics.size(), 2u);
+  const auto& x = statistics["X"];
+  EXPECT_EQ(x.min, 1.0f);
+  EXPECT_EQ(x.max, 6.0f);
+  EXPECT_EQ(x.num_values, 12);
+  const auto& y = statistics["Y"];
+  EXPECT_EQ(y.min, 1.0f);
+  EXPECT_EQ(y.max, 36.0f);
+  EXPECT_EQ(y.num_values, 12);
+  EXPECT_EQ(y.histogram_range, 36.0f);
+  EXPECT_EQ(y.histogram, std::vector<int64_t>({0, 0, 8, 4}));
+
+  // statistics are no longer collected after EndCalibration.
+  RunModel(session_object, run_options);
+  ASSERT_FALSE(session_object.EndCalibration(statistics).IsOK());
+}
+
 TEST(InferenceSessionTests, MultipleSessionsNoTimeout) {
   SessionOptions session_options;
 
@@ -1191,6 +1251,589 @@ TEST(ExecutionProviderTest, FunctionTest) {
   VerifyOutputs(fetches, expected_dims_mul_m, expected_values_mul_m);
 }
 
+// Fuses the 2 Add nodes like FuseExecutionProvider and estimates every node to be free to run.
+class FreeFuseExecutionProvider : public FuseExecutionProvider {
+ public:
+  bool GetNodeCostEstimate(const onnxruntime::GraphViewer& /*graph_viewer*/, const onnxruntime::Node& /*node*/,
+                           double& cost_us) const override {
+    cost_us = 0;
+    return true;
+  }
+};
+
+TEST(ExecutionProviderTest, CostBasedPartitioning) {
+  onnxruntime::Model model("graph_1", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  auto& input_arg_1 = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& input_arg_2 = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  auto& input_arg_3 = graph.GetOrCreateNodeArg("Z", &float_tensor);
+  auto& output_arg = graph.GetOrCreateNodeArg("node_1_out_1", &float_tensor);
+  auto& output_arg_2 = graph.GetOrCreateNodeArg("M", &float_tensor);
+  graph.AddNode("node_1", "Add", "node 1.", {&input_arg_1, &input_arg_2}, {&output_arg});
+  graph.AddNode("node_2", "Add", "node 2.", {&output_arg, &input_arg_3}, {&output_arg_2});
+  ASSERT_STATUS_OK(graph.Resolve());
+  std::string model_file_name = "cost_based_partitioning_test_graph.onnx";
+  ASSERT_STATUS_OK(onnxruntime::Model::Save(model, model_file_name));
+
+  // the Add nodes on the CPU EP take 1ms each in the profile
+  std::string profile_file_name = "cost_based_partitioning_test_profile.json";
+  {
+    std::ofstream profile(profile_file_name);
+    profile << R"([{"cat" : "Session", "name" : "model_run", "dur" : 5000, "args" : {}},)"
+            << R"({"cat" : "Node", "name" : "node_1_kernel_time", "dur" : 900, "args" : {"provider" : "CPUExecutionProvider"}},)"
+            << R"({"cat" : "Node", "name" : "node_1_kernel_time", "dur" : 1100, "args" : {"provider" : "CPUExecutionProvider"}},)"
+            << R"({"cat" : "Node", "name" : "node_2_kernel_time", "dur" : 1000, "args" : {"provider" : "CPUExecutionProvider"}}])";
+  }
+
+  CPUExecutionProviderInfo epi;
+  auto cpu_provider = onnxruntime::make_unique<::onnxruntime::CPUExecutionProvider>(epi);
+  std::vector<int64_t> dims_x = {3, 2};
+  std::vector<float> values_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  OrtValue ml_value;
+  CreateMLValue<float>(cpu_provider->GetAllocator(0, OrtMemTypeDefault), dims_x, values_x, &ml_value);
+  NameMLValMap feeds{{"X", ml_value}, {"Y", ml_value}, {"Z", ml_value}};
+  std::vector<float> expected_values_m = {3.0f, 6.0f, 9.0f, 12.0f, 15.0f, 18.0f};
+
+  auto run = [&](const SessionOptions& so, const std::string& expected_provider, int expected_num_nodes) {
+    InferenceSessionWrapper session_object{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session_object.RegisterExecutionProvider(onnxruntime::make_unique<FreeFuseExecutionProvider>()));
+    ASSERT_STATUS_OK(session_object.RegisterExecutionProvider(
+        onnxruntime::make_unique<::onnxruntime::CPUExecutionProvider>(epi)));
+    ASSERT_STATUS_OK(session_object.Load(model_file_name));
+    ASSERT_STATUS_OK(session_object.Initialize());
+
+    const auto& session_graph = session_object.GetGraph();
+    ASSERT_EQ(session_graph.NumberOfNodes(), expected_num_nodes);
+    for (const auto& node : session_graph.Nodes()) {
+      EXPECT_EQ(node.GetExecutionProviderType(), expected_provider);
+    }
+
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session_object.Run(RunOptions{}, feeds, {"M"}, &fetches));
+    VerifyOutputs(fetches, dims_x, expected_values_m);
+  };
+
+  // the fused node is claimed greedily by default
+  SessionOptions so;
+  so.session_logid = "ExecutionProviderTest.CostBasedPartitioning";
+  run(so, kFuseExecutionProvider, 1);
+
+  // with the default estimates of the CPU EP the fused node doesn't make up for its overhead
+  // and the cost of the values crossing the partition boundary
+  ASSERT_STATUS_OK(so.AddConfigEntry(kOrtSessionOptionsConfigCostBasedPartitioning, "1"));
+  run(so, kCpuExecutionProvider, 2);
+
+  ASSERT_STATUS_OK(so.AddConfigEntry(kOrtSessionOptionsConfigPartitioningProfileFile, profile_file_name.c_str()));
+  run(so, kFuseExecutionProvider, 1);
+}
+
+// A node of the small models built by SaveTestModel, whose values are all float tensors of shape [3].
+struct TestModelNode {
+  std::string name;
+  std::string op_type;
+  std::vector<std::string> inputs;
+  std::string output;
+};
+
+// S = X * X + X, M = S + Y
+static const std::vector<TestModelNode> kSquarePlusXPlusYNodes{
+    {"square", "Mul", {"X", "X"}, "x_squared"},
+    {"add_x", "Add", {"x_squared", "X"}, "S"},
+    {"add_y", "Add", {"S", "Y"}, "M"}};
+
+// Builds a model of the nodes, with the inputs and outputs inferred from them, and saves it to model_path.
+static void SaveTestModel(const std::string& graph_name, const std::vector<TestModelNode>& nodes,
+                          const PathString& model_path) {
+  onnxruntime::Model model(graph_name, false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  for (const auto& node : nodes) {
+    std::vector<NodeArg*> inputs;
+    for (const auto& input : node.inputs) {
+      inputs.push_back(&graph.GetOrCreateNodeArg(input, &float_tensor));
+    }
+    auto& output = graph.GetOrCreateNodeArg(node.output, &float_tensor);
+    graph.AddNode(node.name, node.op_type, node.name, inputs, {&output});
+  }
+  ASSERT_STATUS_OK(graph.Resolve());
+  ASSERT_STATUS_OK(onnxruntime::Model::Save(model, model_path));
+}
+
+TEST(InferenceSessionTests, NodeResultCache) {
+  // X is a stable input, so square and add_x are memoized, and add_y runs every time
+  TemporaryDirectory tmp_dir{ORT_TSTR("node_result_cache_test")};
+  const PathString model_file_name = ConcatPathComponent<PathChar>(tmp_dir.Path(), ORT_TSTR("model.onnx"));
+  ASSERT_NO_FATAL_FAILURE(SaveTestModel("node_result_cache", kSquarePlusXPlusYNodes, model_file_name));
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  auto run = [&](InferenceSession& session_object, const std::vector<float>& x_values, const std::vector<float>& y_values) {
+    OrtValue x_value, y_value;
+    CreateMLValue<float>(allocator, {3}, x_values, &x_value);
+    CreateMLValue<float>(allocator, {3}, y_values, &y_value);
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session_object.Run(NameMLValMap{{"X", x_value}, {"Y", y_value}}, {"M"}, &fetches));
+
+    std::vector<float> expected_values(3);
+    for (size_t i = 0; i < 3; ++i) {
+      expected_values[i] = x_values[i] * x_values[i] + x_values[i] + y_values[i];
+    }
+    VerifyOutputs(fetches, {3}, expected_values);
+  };
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.NodeResultCache";
+  ASSERT_STATUS_OK(so.AddConfigEntry(kOrtSessionOptionsConfigMemoizationStableInputs, "X"));
+  {
+    InferenceSessionWrapper session_object{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session_object.Load(model_file_name));
+    ASSERT_STATUS_OK(session_object.Initialize());
+    const auto* cache = session_object.GetSessionState().GetNodeResultCache();
+    ASSERT_NE(cache, nullptr);
+    EXPECT_EQ(cache->NumMemoizedNodes(), 2u);
+
+    run(session_object, {1.0f, 2.0f, 3.0f}, {1.0f, 1.0f, 1.0f});
+    run(session_object, {1.0f, 2.0f, 3.0f}, {2.0f, 2.0f, 2.0f});
+    run(session_object, {4.0f, 5.0f, 6.0f}, {1.0f, 1.0f, 1.0f});
+    run(session_object, {1.0f, 2.0f, 3.0f}, {3.0f, 3.0f, 3.0f});
+
+    const auto stats = cache->GetStats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 2u);
+    // the Mul is not run when add_x hits
+    EXPECT_EQ(stats.skipped_nodes, 2u);
+    EXPECT_EQ(stats.num_entries, 2u);
+  }
+
+  // nothing fits in the budget
+  ASSERT_STATUS_OK(so.AddConfigEntry(kOrtSessionOptionsConfigMemoizationByteBudget, "0"));
+  {
+    InferenceSessionWrapper session_object{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session_object.Load(model_file_name));
+    ASSERT_STATUS_OK(session_object.Initialize());
+    run(session_object, {1.0f, 2.0f, 3.0f}, {1.0f, 1.0f, 1.0f});
+    run(session_object, {1.0f, 2.0f, 3.0f}, {2.0f, 2.0f, 2.0f});
+
+    const auto stats = session_object.GetSessionState().GetNodeResultCache()->GetStats();
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.num_entries, 0u);
+  }
+
+  ASSERT_STATUS_OK(so.AddConfigEntry(kOrtSessionOptionsConfigMemoizationStableInputs, "not_an_input"));
+  InferenceSession session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(model_file_name));
+  ASSERT_FALSE(session_object.Initialize().IsOK());
+}
+
+TEST(InferenceSessionTests, RunIncremental) {
+  // square and add_x depend on X, add_y depends on X and Y
+  TemporaryDirectory tmp_dir{ORT_TSTR("run_incremental_test")};
+  const PathString model_file_name = ConcatPathComponent<PathChar>(tmp_dir.Path(), ORT_TSTR("model.onnx"));
+  ASSERT_NO_FATAL_FAILURE(SaveTestModel("run_incremental", kSquarePlusXPlusYNodes, model_file_name));
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunIncremental";
+  InferenceSession session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(model_file_name));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  auto run = [&](const std::vector<float>& x_values, const std::vector<float>& y_values,
+                 const std::vector<std::string>& changed_feed_names, std::vector<OrtValue>& fetches) {
+    OrtValue x_value, y_value;
+    CreateMLValue<float>(allocator, {3}, x_values, &x_value);
+    CreateMLValue<float>(allocator, {3}, y_values, &y_value);
+    fetches.clear();
+    ASSERT_STATUS_OK(session_object.RunIncremental(RunOptions(), {"X", "Y"}, {x_value, y_value}, changed_feed_names,
+                                                   {"S", "M"}, &fetches));
+
+    std::vector<float> expected_s(3);
+    std::vector<float> expected_m(3);
+    for (size_t i = 0; i < 3; ++i) {
+      expected_s[i] = x_values[i] * x_values[i] + x_values[i];
+      expected_m[i] = expected_s[i] + y_values[i];
+    }
+    VerifyOutputs({fetches[0]}, {3}, expected_s);
+    VerifyOutputs({fetches[1]}, {3}, expected_m);
+  };
+
+  std::vector<OrtValue> first_fetches;
+  run({1.0f, 2.0f, 3.0f}, {1.0f, 1.0f, 1.0f}, {}, first_fetches);
+
+  // only add_y runs, so S is the value of the first run
+  std::vector<OrtValue> y_changed_fetches;
+  run({1.0f, 2.0f, 3.0f}, {2.0f, 2.0f, 2.0f}, {"Y"}, y_changed_fetches);
+  EXPECT_EQ(y_changed_fetches[0].Get<Tensor>().DataRaw(), first_fetches[0].Get<Tensor>().DataRaw());
+  EXPECT_NE(y_changed_fetches[1].Get<Tensor>().DataRaw(), first_fetches[1].Get<Tensor>().DataRaw());
+
+  // the outputs of the previous runs are not overwritten by the nodes that run again
+  std::vector<OrtValue> x_changed_fetches;
+  run({4.0f, 5.0f, 6.0f}, {2.0f, 2.0f, 2.0f}, {"X"}, x_changed_fetches);
+  EXPECT_NE(x_changed_fetches[0].Get<Tensor>().DataRaw(), first_fetches[0].Get<Tensor>().DataRaw());
+  VerifyOutputs({first_fetches[0]}, {3}, {2.0f, 6.0f, 12.0f});
+
+  // a normal run is not affected by the values kept for the incremental runs
+  OrtValue x_value, y_value;
+  CreateMLValue<float>(allocator, {3}, {1.0f, 1.0f, 1.0f}, &x_value);
+  CreateMLValue<float>(allocator, {3}, {1.0f, 1.0f, 1.0f}, &y_value);
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(NameMLValMap{{"X", x_value}, {"Y", y_value}}, {"M"}, &fetches));
+  VerifyOutputs(fetches, {3}, {3.0f, 3.0f, 3.0f});
+
+  fetches.clear();
+  EXPECT_FALSE(session_object.RunIncremental(RunOptions(), {"X", "Y"}, {x_value, y_value}, {"not_a_feed"},
+                                             {"S", "M"}, &fetches)
+                   .IsOK());
+}
+
+TEST(InferenceSessionTests, LoadComposite) {
+  TemporaryDirectory tmp_dir{ORT_TSTR("load_composite_test")};
+  const PathString square_model = ConcatPathComponent<PathChar>(tmp_dir.Path(), ORT_TSTR("square.onnx"));
+  const PathString add_model = ConcatPathComponent<PathChar>(tmp_dir.Path(), ORT_TSTR("add.onnx"));
+
+  // Y = X * X
+  ASSERT_NO_FATAL_FAILURE(SaveTestModel("square", {{"mul", "Mul", {"X", "X"}, "Y"}}, square_model));
+  // Y = X + W, where X is linked to the output of the first stage
+  ASSERT_NO_FATAL_FAILURE(SaveTestModel("add", {{"add", "Add", {"X", "W"}, "Y"}}, add_model));
+
+  std::vector<CompositeModelStage> stages{
+      {"square", square_model, {}},
+      {"add", add_model, {{"X", "square/Y"}}}};
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.LoadComposite";
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.LoadComposite(stages));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  // the linked output is an internal value of the composite model
+  const auto& graph = session_object.GetGraph();
+  ASSERT_EQ(graph.GetInputs().size(), 2u);
+  EXPECT_EQ(graph.GetInputs()[0]->Name(), "square/X");
+  EXPECT_EQ(graph.GetInputs()[1]->Name(), "add/W");
+  ASSERT_EQ(graph.GetOutputs().size(), 1u);
+  EXPECT_EQ(graph.GetOutputs()[0]->Name(), "add/Y");
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  OrtValue x_value, w_value;
+  CreateMLValue<float>(allocator, {3}, {1.0f, 2.0f, 3.0f}, &x_value);
+  CreateMLValue<float>(allocator, {3}, {1.0f, 1.0f, 1.0f}, &w_value);
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(NameMLValMap{{"square/X", x_value}, {"add/W", w_value}}, {"add/Y"}, &fetches));
+  VerifyOutputs(fetches, {3}, {2.0f, 5.0f, 10.0f});
+
+  // a stage can only consume the outputs of earlier stages
+  std::reverse(stages.begin(), stages.end());
+  InferenceSession reversed_session_object{so, GetEnvironment()};
+  EXPECT_FALSE(reversed_session_object.LoadComposite(stages).IsOK());
+
+  stages = {{"square", square_model, {}},
+            {"square", square_model, {}}};
+  InferenceSession duplicate_session_object{so, GetEnvironment()};
+  EXPECT_FALSE(duplicate_session_object.LoadComposite(stages).IsOK());
+}
+
+// Celu is a function op the CPU provider has no kernel for, so its body is inlined before the graph is optimized
+TEST(InferenceSessionTests, InlineFunctionWithoutKernel) {
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  onnxruntime::Model model("celu", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("celu", "Celu", "celu", {&x}, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+  ASSERT_STATUS_OK(onnxruntime::Model::Save(model, "inline_celu.onnx"));
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.InlineFunctionWithoutKernel";
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(ORT_TSTR("inline_celu.onnx")));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(session_object.GetGraph());
+  EXPECT_EQ(op_to_count.count("Celu"), 0u);
+  EXPECT_GT(op_to_count.size(), 0u);
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  OrtValue x_value;
+  CreateMLValue<float>(allocator, {3}, {0.0f, 1.0f, 2.0f}, &x_value);
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(NameMLValMap{{"X", x_value}}, {"Y"}, &fetches));
+  VerifyOutputs(fetches, {3}, {0.0f, 1.0f, 2.0f});
+}
+
+// Claims no nodes, and records the op types it was offered, as an execution provider that compiles would.
+class OpTypeRecordingExecutionProvider : public IExecutionProvider {
+ public:
+  OpTypeRecordingExecutionProvider() : IExecutionProvider{"OpTypeRecordingExecutionProvider"} {}
+
+  std::vector<std::unique_ptr<ComputeCapability>>
+  GetCapability(const onnxruntime::GraphViewer& graph,
+                const std::vector<const KernelRegistry*>& /*kernel_registries*/) const override {
+    for (auto& node : graph.Nodes()) {
+      op_types_.insert(node.OpType());
+    }
+    return {};
+  }
+
+  const std::set<std::string>& OpTypes() const { return op_types_; }
+
+ private:
+  mutable std::set<std::string> op_types_;
+};
+
+// Function ops are only inlined before the partitioning when all the execution providers are static kernel ones,
+// so that the others can still claim the function nodes.
+TEST(InferenceSessionTests, FunctionNodeIsOfferedToOtherProviders) {
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  onnxruntime::Model model("celu", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("celu", "Celu", "celu", {&x}, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.FunctionNodeIsOfferedToOtherProviders";
+  so.graph_optimization_level = TransformerLevel::Level1;
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  auto provider = onnxruntime::make_unique<OpTypeRecordingExecutionProvider>();
+  const auto* recording_provider = provider.get();
+  ASSERT_STATUS_OK(session_object.RegisterExecutionProvider(std::move(provider)));
+  ASSERT_STATUS_OK(session_object.Load(model_data.data(), static_cast<int>(model_data.size())));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  EXPECT_EQ(recording_provider->OpTypes().count("Celu"), 1u);
+  EXPECT_EQ(CountOpsInGraph(session_object.GetGraph()).count("Celu"), 0u);
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  OrtValue x_value;
+  CreateMLValue<float>(allocator, {3}, {0.0f, 1.0f, 2.0f}, &x_value);
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(NameMLValMap{{"X", x_value}}, {"Y"}, &fetches));
+  VerifyOutputs(fetches, {3}, {0.0f, 1.0f, 2.0f});
+}
+
+#if defined(ENABLE_ORT_FORMAT_LOAD)
+static std::vector<PathString> GetCompilationCacheEntries(const PathString& cache_dir) {
+  const PathString extension = ORT_TSTR(".ort");
+  std::vector<PathString> entries;
+  LoopDir(cache_dir, [&](const PathChar* filename, OrtFileType) {
+    const PathString name{filename};
+    if (name.size() > extension.size() &&
+        name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+      entries.push_back(name);
+    }
+    return true;
+  });
+  std::sort(entries.begin(), entries.end());
+  return entries;
+}
+
+static bool HasMessage(const std::vector<std::string>& messages, const std::string& text) {
+  return std::any_of(messages.cbegin(), messages.cend(),
+                     [&text](const std::string& message) { return message.find(text) != std::string::npos; });
+}
+
+TEST(InferenceSessionTests, CompilationCache) {
+  const PathString cache_dir = ORT_TSTR("compilation_cache_test");
+  if (Env::Default().FolderExists(cache_dir)) {
+    ASSERT_STATUS_OK(Env::Default().DeleteFolder(cache_dir));
+  }
+  TemporaryDirectory tmp_dir{ORT_TSTR("compilation_cache_test_model")};
+  const PathString model_file_name = ConcatPathComponent<PathChar>(tmp_dir.Path(), ORT_TSTR("model.onnx"));
+  ASSERT_NO_FATAL_FAILURE(SaveTestModel("compilation_cache", kSquarePlusXPlusYNodes, model_file_name));
+
+  // returns what the session logged, which tells whether it was loaded from the cache
+  auto run_session = [&model_file_name](const SessionOptions& so, std::vector<std::string>& messages) {
+    // LoggingManager owns the sink, but as long as the logging_manager is around our pointer stays valid.
+    auto capturing_sink = new CapturingSink();
+    auto logging_manager = onnxruntime::make_unique<logging::LoggingManager>(
+        std::unique_ptr<ISink>(capturing_sink), logging::Severity::kINFO, false,
+        LoggingManager::InstanceType::Temporal);
+    std::unique_ptr<Environment> env;
+    ASSERT_STATUS_OK(Environment::Create(std::move(logging_manager), env));
+
+    InferenceSession session_object{so, *env};
+    ASSERT_STATUS_OK(session_object.Load(model_file_name));
+    ASSERT_STATUS_OK(session_object.Initialize());
+    auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+    OrtValue x_value, y_value;
+    CreateMLValue<float>(allocator, {3}, {1.0f, 2.0f, 3.0f}, &x_value);
+    CreateMLValue<float>(allocator, {3}, {1.0f, 1.0f, 1.0f}, &y_value);
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session_object.Run(NameMLValMap{{"X", x_value}, {"Y", y_value}}, {"M"}, &fetches));
+    VerifyOutputs(fetches, {3}, {3.0f, 7.0f, 13.0f});
+    messages = capturing_sink->Messages();
+  };
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.CompilationCache";
+  so.session_log_severity_level = static_cast<int>(Severity::kINFO);
+  ASSERT_STATUS_OK(so.AddConfigEntry(kOrtSessionOptionsConfigCompilationCacheDir, "compilation_cache_test"));
+
+  // the first session adds the entry and the second one is loaded from it
+  std::vector<std::string> messages;
+  run_session(so, messages);
+  EXPECT_TRUE(HasMessage(messages, "Compilation cache miss"));
+  EXPECT_TRUE(HasMessage(messages, "to the compilation cache."));
+  const auto entries = GetCompilationCacheEntries(cache_dir);
+  ASSERT_EQ(entries.size(), 1u);
+  const PathString entry_path = ConcatPathComponent<PathChar>(cache_dir, entries[0]);
+
+  run_session(so, messages);
+  EXPECT_TRUE(HasMessage(messages, "Compilation cache hit"));
+  EXPECT_FALSE(HasMessage(messages, "to the compilation cache."));
+  EXPECT_EQ(GetCompilationCacheEntries(cache_dir), entries);
+
+  // a corrupted entry is ignored, and replaced once the model is compiled
+  const std::string corrupted_entry = "not an ORT format model";
+  {
+    std::ofstream entry_stream(entry_path, std::ios::binary | std::ios::trunc);
+    entry_stream << corrupted_entry;
+  }
+  run_session(so, messages);
+  EXPECT_TRUE(HasMessage(messages, "Failed to load entry"));
+  EXPECT_TRUE(HasMessage(messages, "to the compilation cache."));
+  size_t rewritten_entry_size = 0;
+  ASSERT_STATUS_OK(Env::Default().GetFileLength(entry_path.c_str(), rewritten_entry_size));
+  EXPECT_NE(rewritten_entry_size, corrupted_entry.size());
+
+  run_session(so, messages);
+  EXPECT_TRUE(HasMessage(messages, "Compilation cache hit"));
+  EXPECT_EQ(GetCompilationCacheEntries(cache_dir), entries);
+
+  // an entry written for another key, as if their hashes collided, is a miss and is replaced
+  SessionOptions other_so = so;
+  other_so.graph_optimization_level = TransformerLevel::Level1;
+  run_session(other_so, messages);
+  auto other_entries = GetCompilationCacheEntries(cache_dir);
+  ASSERT_EQ(other_entries.size(), 2u);
+  other_entries.erase(std::remove(other_entries.begin(), other_entries.end(), entries[0]), other_entries.end());
+  ASSERT_EQ(other_entries.size(), 1u);
+  const PathString other_entry_path = ConcatPathComponent<PathChar>(cache_dir, other_entries[0]);
+  {
+    std::ifstream entry_stream(entry_path, std::ios::binary);
+    std::ofstream other_entry_stream(other_entry_path, std::ios::binary | std::ios::trunc);
+    other_entry_stream << entry_stream.rdbuf();
+  }
+  run_session(other_so, messages);
+  EXPECT_TRUE(HasMessage(messages, "Compilation cache miss"));
+  EXPECT_TRUE(HasMessage(messages, "to the compilation cache."));
+  run_session(other_so, messages);
+  EXPECT_TRUE(HasMessage(messages, "Compilation cache hit"));
+
+  // the older entries are evicted beyond the budget
+  ASSERT_STATUS_OK(other_so.AddConfigEntry(kOrtSessionOptionsConfigCompilationCacheMaxBytes, "0"));
+  other_so.graph_optimization_level = TransformerLevel::Level2;
+  run_session(other_so, messages);
+  const auto new_entries = GetCompilationCacheEntries(cache_dir);
+  ASSERT_EQ(new_entries.size(), 1u);
+  EXPECT_NE(new_entries, entries);
+  EXPECT_NE(new_entries[0], other_entries[0]);
+
+  // the key doesn't cover the graph transformers registered by the application, so their sessions aren't cached
+  {
+    InferenceSession session_object{other_so, GetEnvironment()};
+    auto dummy_transformer_unique_ptr = onnxruntime::make_unique<DummyGraphTransformer>("DummyTransformer");
+    const auto* dummy_transformer = dummy_transformer_unique_ptr.get();
+    ASSERT_STATUS_OK(session_object.RegisterGraphTransformer(std::move(dummy_transformer_unique_ptr)));
+    ASSERT_STATUS_OK(session_object.Load(model_file_name));
+    ASSERT_STATUS_OK(session_object.Initialize());
+    EXPECT_TRUE(dummy_transformer->IsTransformerInvoked());
+  }
+  EXPECT_EQ(GetCompilationCacheEntries(cache_dir), new_entries);
+
+  ASSERT_STATUS_OK(Env::Default().DeleteFolder(cache_dir));
+}
+#endif  // defined(ENABLE_ORT_FORMAT_LOAD)
+
+// Claims every node as a single node capability and estimates each of them to be very slow to run.
+class SlowSingleNodeExecutionProvider : public IExecutionProvider {
+ public:
+  SlowSingleNodeExecutionProvider() : IExecutionProvider{"SlowSingleNodeExecutionProvider"} {}
+
+  std::vector<std::unique_ptr<ComputeCapability>>
+  GetCapability(const onnxruntime::GraphViewer& graph,
+                const std::vector<const KernelRegistry*>& /*kernel_registries*/) const override {
+    std::vector<std::unique_ptr<ComputeCapability>> result;
+    for (auto& node : graph.Nodes()) {
+      std::unique_ptr<IndexedSubGraph> sub_graph = onnxruntime::make_unique<IndexedSubGraph>();
+      sub_graph->nodes.push_back(node.Index());
+      result.push_back(onnxruntime::make_unique<ComputeCapability>(std::move(sub_graph)));
+    }
+    return result;
+  }
+
+  bool GetNodeCostEstimate(const onnxruntime::GraphViewer& /*graph_viewer*/, const onnxruntime::Node& /*node*/,
+                           double& cost_us) const override {
+    cost_us = 1e6;
+    return true;
+  }
+};
+
+// A costly capability is only declined if the CPU EP has a kernel for its nodes. The partitioner is run without
+// a report, which is what the sessions that don't log at INFO do.
+TEST(ExecutionProviderTest, CostBasedPartitioningKeepsNodesWithoutCpuKernel) {
+  onnxruntime::Model model("graph_1", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+  ONNX_NAMESPACE::TypeProto uint8_tensor;
+  uint8_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_UINT8);
+  uint8_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  // the CPU EP has no Add kernel for uint8
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  auto& float_sum = graph.GetOrCreateNodeArg("F", &float_tensor);
+  auto& u = graph.GetOrCreateNodeArg("U", &uint8_tensor);
+  auto& v = graph.GetOrCreateNodeArg("V", &uint8_tensor);
+  auto& uint8_sum = graph.GetOrCreateNodeArg("W", &uint8_tensor);
+  graph.AddNode("float_add", "Add", "float add", {&x, &y}, {&float_sum});
+  graph.AddNode("uint8_add", "Add", "uint8 add", {&u, &v}, {&uint8_sum});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  ExecutionProviders execution_providers;
+  ASSERT_STATUS_OK(execution_providers.Add("SlowSingleNodeExecutionProvider",
+                                           onnxruntime::make_unique<SlowSingleNodeExecutionProvider>()));
+  CPUExecutionProviderInfo epi;
+  ASSERT_STATUS_OK(execution_providers.Add(kCpuExecutionProvider,
+                                           onnxruntime::make_unique<::onnxruntime::CPUExecutionProvider>(epi)));
+  KernelRegistryManager kernel_registry_manager;
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+
+  PartitioningCostModel cost_model;
+  FuncManager func_mgr;
+  GraphPartitioner partitioner(kernel_registry_manager, execution_providers, &cost_model);
+  ASSERT_STATUS_OK(partitioner.Partition(graph, false, func_mgr));
+
+  for (const auto& node : graph.Nodes()) {
+    if (node.Name() == "float_add") {
+      EXPECT_EQ(node.GetExecutionProviderType(), kCpuExecutionProvider);
+    } else {
+      EXPECT_EQ(node.GetExecutionProviderType(), "SlowSingleNodeExecutionProvider");
+    }
+  }
+}
+
 TEST(InferenceSessionTests, Test3LayerNestedSubgraph) {
   // The main graph contains a 'If' node: 'graph_0__if_0'
   // Inside the then-branch of 'graph_0__if_0', there is a nested 'If' node: 'graph_0__if_0__else__if_0'
@@ -188,6 +188,32 @@ static void CompareGraphAndSessionState(const InferenceSessionWrapper& session_o
       }
     }
   }
+
+  // the execution plan loaded from the ORT format model should match the one created from the ONNX model
+  const auto& plan_1 = *session_state_1.GetExecutionPlan();
+  const auto& plan_2 = *session_state_2.GetExecutionPlan();
+  ASSERT_EQ(plan_1.allocation_plan.size(), plan_2.allocation_plan.size());
+  for (size_t i = 0, end = plan_1.allocation_plan.size(); i < end; ++i) {
+    const auto& left = plan_1.allocation_plan[i];
+    const auto& right = plan_2.allocation_plan[i];
+    EXPECT_EQ(left.alloc_kind, right.alloc_kind) << "OrtValue index:" << i;
+    EXPECT_EQ(left.value_type, right.value_type) << "OrtValue index:" << i;
+    EXPECT_EQ(left.location, right.location) << "OrtValue index:" << i;
+    EXPECT_EQ(left.reused_buffer, right.reused_buffer) << "OrtValue index:" << i;
+    EXPECT_EQ(left.create_fence_if_async, right.create_fence_if_async) << "OrtValue index:" << i;
+  }
+
+  ASSERT_EQ(plan_1.execution_plan.size(), plan_2.execution_plan.size());
+  for (size_t i = 0, end = plan_1.execution_plan.size(); i < end; ++i) {
+    const auto& left = plan_1.execution_plan[i];
+    const auto& right = plan_2.execution_plan[i];
+    EXPECT_EQ(left.node_index, right.node_index);
+    EXPECT_EQ(left.free_from_index, right.free_from_index);
+    EXPECT_EQ(left.free_to_index, right.free_to_index);
+  }
+
+  EXPECT_EQ(plan_1.to_be_freed, plan_2.to_be_freed);
+  EXPECT_EQ(plan_1.node_has_fence, plan_2.node_has_fence);
 }
 
 static void SaveAndCompareModels(const std::string& onnx_file, const std::basic_string<ORTCHAR_T>& ort_file) {
@@ -327,6 +353,79 @@ TEST(OrtModelOnlyTests, SerializeToOrtFormatMLOps) {
   RunOrtModel(test_info);
 }
 #endif  // #if !defined(DISABLE_ML_OPS)
+
+// the memory pattern for the declared input shapes is saved with the execution plan,
+// so it's available without tracing the allocations of a first run
+TEST(OrtModelOnlyTests, SerializeExecutionPlanWithMemoryPatterns) {
+  const std::string onnx_file = "ort_model_only_fixed_shapes.onnx";
+  const std::basic_string<ORTCHAR_T> ort_file = ORT_TSTR("ort_model_only_fixed_shapes.onnx.ort");
+
+  // X -> Relu -> Neg -> Relu -> Y. the outputs of the first two nodes are allocated from the memory pattern.
+  {
+    onnxruntime::Model model("fixed_shapes", false, ModelMetaData(), PathString(),
+                             IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {},
+                             DefaultLoggingManager().DefaultLogger());
+    auto& graph = model.MainGraph();
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+    auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+    auto& relu_out = graph.GetOrCreateNodeArg("relu_out", &float_tensor);
+    auto& neg_out = graph.GetOrCreateNodeArg("neg_out", &float_tensor);
+    auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+    graph.AddNode("relu_0", "Relu", "", {&x}, {&relu_out});
+    graph.AddNode("neg", "Neg", "", {&relu_out}, {&neg_out});
+    graph.AddNode("relu_1", "Relu", "", {&neg_out}, {&y});
+
+    ASSERT_STATUS_OK(graph.Resolve());
+    ASSERT_STATUS_OK(onnxruntime::Model::Save(model, onnx_file));
+  }
+
+  SaveAndCompareModels(onnx_file, ort_file);
+
+  SessionOptions so;
+  so.session_logid = "SerializeExecutionPlanWithMemoryPatterns";
+  so.AddConfigEntry(kOrtSessionOptionsConfigLoadModelFormat, "ORT");
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(ort_file));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  const auto& session_state = session_object.GetSessionState();
+  int x_idx, relu_out_idx;
+  ASSERT_STATUS_OK(session_state.GetOrtValueNameIdxMap().GetIdx("X", x_idx));
+  ASSERT_STATUS_OK(session_state.GetOrtValueNameIdxMap().GetIdx("relu_out", relu_out_idx));
+
+  const TensorShape input_shape({2, 3});
+  std::vector<std::reference_wrapper<const TensorShape>> input_shapes{input_shape};
+  std::unordered_map<int, TensorShape> inferred_shapes;
+  const auto* mem_patterns = session_state.GetMemoryPatternGroup(input_shapes, {x_idx}, inferred_shapes);
+  ASSERT_NE(mem_patterns, nullptr);
+
+  const auto* pattern = mem_patterns->GetPatterns(session_state.GetExecutionPlan()->GetLocation(relu_out_idx));
+  ASSERT_NE(pattern, nullptr);
+  const auto* block = pattern->GetBlock(relu_out_idx);
+  ASSERT_NE(block, nullptr);
+  size_t expected_size = 0;
+  ASSERT_TRUE(IAllocator::CalcMemSizeForArrayWithAlignment<64>(6, sizeof(float), &expected_size));
+  EXPECT_EQ(block->size_, expected_size);
+
+  OrtValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {2, 3},
+                       {-1.f, 2.f, -3.f, 4.f, -5.f, 6.f}, &ml_value);
+  NameMLValMap feeds{{"X", ml_value}};
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(feeds, {"Y"}, &fetches));
+
+  // Relu(-Relu(x)) is all zeros
+  const auto& output = fetches[0].Get<Tensor>();
+  ASSERT_EQ(output.Shape().Size(), 6);
+  for (int64_t i = 0; i < 6; ++i) {
+    EXPECT_EQ(output.Data<float>()[i], 0.f);
+  }
+}
 #endif  // #if !defined(ORT_MINIMAL_BUILD)
 
 // test loading ORT format model with sparse initializers
@@ -1,8 +1,11 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include "core/framework/philox_random.h"
 #include "core/framework/random_seed.h"
 #include "core/framework/random_generator.h"
+#include "core/platform/env.h"
+#include "core/platform/threadpool.h"
 #include "gtest/gtest.h"
 
 namespace onnxruntime {
@@ -54,5 +57,49 @@ TEST(RandomTest, PhiloxGeneratorTest) {
   ASSERT_EQ(seeds.second, 0);
 }
 
+// known answers of Philox4x32-10 from the Random123 library
+TEST(RandomTest, PhiloxRandomTest) {
+  PhiloxRandom zeros({{0, 0, 0, 0}}, {{0, 0}});
+  ASSERT_EQ(zeros(), (PhiloxRandom::ResultType{{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}}));
+
+  PhiloxRandom ones({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}}, {{0xffffffff, 0xffffffff}});
+  ASSERT_EQ(ones(), (PhiloxRandom::ResultType{{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}}));
+
+  PhiloxRandom pi({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}}, {{0xa4093822, 0x299f31d0}});
+  ASSERT_EQ(pi(), (PhiloxRandom::ResultType{{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}));
+
+  // the offset is the low 64 bits of the counter
+  PhiloxRandom stream(17, 0);
+  stream();
+  ASSERT_EQ(stream(), PhiloxRandom(17, 1)());
+}
+
+TEST(RandomTest, FillPhiloxRandomTest) {
+  // not a multiple of the values per block, so the last block is partially used
+  constexpr int64_t count = 100003;
+  const PhiloxNormalDistribution<float> distribution{0.f, 1.f};
+
+  PhiloxGenerator serial_generator(17);
+  std::vector<float> serial(count);
+  FillPhiloxRandom(serial_generator, distribution, serial.data(), count, nullptr);
+
+  // the values don't depend on the number of threads
+  auto tp = onnxruntime::make_unique<concurrency::ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions(),
+                                                              nullptr, 4, true);
+  PhiloxGenerator parallel_generator(17);
+  std::vector<float> parallel(count);
+  FillPhiloxRandom(parallel_generator, distribution, parallel.data(), count, tp.get());
+  ASSERT_EQ(serial, parallel);
+
+  // the next values continue the stream
+  ASSERT_EQ(serial_generator.NextPhiloxSeeds(0).second, PhiloxBlockCount<PhiloxNormalDistribution<float>>(count));
+
+  double sum = 0;
+  for (float value : serial) {
+    sum += value;
+  }
+  ASSERT_NEAR(sum / count, 0.0, 0.02);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
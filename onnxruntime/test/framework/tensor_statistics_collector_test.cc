@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/tensor_statistics_collector.h"
+
+#include "core/framework/tensor.h"
+#include "core/platform/env.h"
+#include "core/platform/threadpool.h"
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+static void Observe(TensorStatisticsCollector& collector, const std::string& name, std::vector<float> values,
+                    concurrency::ThreadPool* tp = nullptr) {
+  OrtMemoryInfo cpu_info(CPU, OrtDeviceAllocator);
+  Tensor tensor(DataTypeImpl::GetType<float>(), TensorShape({static_cast<int64_t>(values.size())}),
+                values.data(), cpu_info);
+  collector.Observe(name, tensor, tp);
+}
+
+TEST(TensorStatisticsCollectorTest, MinMaxAndHistogram) {
+  TensorStatisticsCollector collector({"a"}, 4);
+  Observe(collector, "a", {-1.0f, -0.5f, 0.0f, 0.5f, 1.0f});
+
+  // tensors that are not observed are ignored.
+  EXPECT_FALSE(collector.IsObserved("b"));
+
+  auto statistics = collector.GetStatistics();
+  ASSERT_EQ(statistics.size(), 1u);
+  const auto& a = statistics["a"];
+  EXPECT_EQ(a.min, -1.0f);
+  EXPECT_EQ(a.max, 1.0f);
+  EXPECT_EQ(a.num_values, 5);
+  EXPECT_EQ(a.histogram_range, 1.0f);
+  EXPECT_EQ(a.histogram, std::vector<int64_t>({1, 1, 1, 2}));
+}
+
+TEST(TensorStatisticsCollectorTest, WidensHistogram) {
+  TensorStatisticsCollector collector({}, 4);
+  Observe(collector, "a", {0.0f});
+  Observe(collector, "a", {-1.0f, 1.0f});
+
+  auto statistics = collector.GetStatistics();
+  EXPECT_EQ(statistics["a"].histogram_range, 1.0f);
+  EXPECT_EQ(statistics["a"].histogram, std::vector<int64_t>({1, 0, 1, 1}));
+
+  // the range doubles twice, merging pairs of bins into the middle of the histogram.
+  Observe(collector, "a", {3.0f});
+  statistics = collector.GetStatistics();
+  const auto& a = statistics["a"];
+  EXPECT_EQ(a.min, -1.0f);
+  EXPECT_EQ(a.max, 3.0f);
+  EXPECT_EQ(a.num_values, 4);
+  EXPECT_EQ(a.histogram_range, 4.0f);
+  EXPECT_EQ(a.histogram, std::vector<int64_t>({0, 1, 2, 1}));
+}
+
+TEST(TensorStatisticsCollectorTest, ParallelPercentile) {
+  constexpr int num_values = 100000;
+  std::vector<float> values(num_values);
+  for (int i = 0; i < num_values; ++i) {
+    values[i] = -1.0f + 2.0f * i / num_values;
+  }
+
+  TensorStatisticsCollector serial_collector({}, TensorStatisticsCollector::kDefaultNumBins);
+  TensorStatisticsCollector parallel_collector({}, TensorStatisticsCollector::kDefaultNumBins);
+  auto tp = onnxruntime::make_unique<concurrency::ThreadPool>(&Env::Default(), ThreadOptions(), nullptr, 4, true);
+  Observe(serial_collector, "a", values);
+  Observe(parallel_collector, "a", values, tp.get());
+
+  auto serial = serial_collector.GetStatistics()["a"];
+  auto parallel = parallel_collector.GetStatistics()["a"];
+  EXPECT_EQ(serial.histogram, parallel.histogram);
+  EXPECT_EQ(parallel.min, -1.0f);
+  EXPECT_EQ(parallel.num_values, num_values);
+
+  const float bin_width = 2.0f * parallel.histogram_range / TensorStatisticsCollector::kDefaultNumBins;
+  EXPECT_EQ(parallel.Percentile(0.0), -1.0f);
+  EXPECT_NEAR(parallel.Percentile(50.0), 0.0f, bin_width);
+  EXPECT_NEAR(parallel.Percentile(99.0), 0.98f, bin_width);
+  EXPECT_EQ(parallel.Percentile(100.0), parallel.max);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
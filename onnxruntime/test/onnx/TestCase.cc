@@ -23,6 +23,7 @@
 
 #include <cctype>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <map>
@@ -406,6 +407,21 @@ template <typename PATH_STRING_TYPE>
 static void LoadTensors(const std::vector<PATH_STRING_TYPE>& pb_files,
                         std::vector<ONNX_NAMESPACE::TensorProto>* input_pbs) {
   for (size_t i = 0; i != pb_files.size(); ++i) {
+    ONNX_NAMESPACE::TensorProto tensor;
+
+    // parse straight from a mapping of the file when possible, so loading the data doesn't need an extra copy
+    size_t file_length = 0;
+    Env::MappedMemoryPtr mapped_file;
+    if (Env::Default().GetFileLength(pb_files.at(i).c_str(), file_length).IsOK() && file_length > 0 &&
+        file_length <= static_cast<size_t>(std::numeric_limits<int>::max()) &&
+        Env::Default().MapFileIntoMemory(pb_files.at(i).c_str(), 0, file_length, mapped_file).IsOK()) {
+      if (!tensor.ParseFromArray(mapped_file.get(), static_cast<int>(file_length))) {
+        ORT_THROW("parse file '", ToMBString(pb_files.at(i)), "' failed");
+      }
+      input_pbs->emplace_back(std::move(tensor));
+      continue;
+    }
+
     int tensor_fd;
     auto st = Env::Default().FileOpenRd(pb_files.at(i), tensor_fd);
     if (!st.IsOK()) {
@@ -413,11 +429,10 @@ static void LoadTensors(const std::vector<PATH_STRING_TYPE>& pb_files,
     }
     google::protobuf::io::FileInputStream f(tensor_fd, protobuf_block_size_in_bytes);
     f.SetCloseOnDelete(true);
-    ONNX_NAMESPACE::TensorProto tensor;
     if (!tensor.ParseFromZeroCopyStream(&f)) {
       ORT_THROW("parse file '", ToMBString(pb_files.at(i)), "' failed");
     }
-    input_pbs->emplace_back(tensor);
+    input_pbs->emplace_back(std::move(tensor));
   }
 }
 
@@ -55,9 +55,41 @@ class TestCaseResult {
     return node_name;
   }
 
+  //Latency of a successful Session::Run. Data tasks may run concurrently, so this is thread safe.
+  void AddRunLatency(double latency_ms) {
+    std::lock_guard<std::mutex> l(run_latencies_mutex_);
+    run_latencies_ms_.push_back(latency_ms);
+  }
+
+  //Only call once all the data tasks have completed
+  const std::vector<double>& GetRunLatencies() const {
+    return run_latencies_ms_;
+  }
+
+  void SetSessionCreationTime(double ms) {
+    session_creation_ms_ = ms;
+  }
+
+  double GetSessionCreationTime() const {
+    return session_creation_ms_;
+  }
+
+  //Growth of the working set of the process while the session was alive
+  void SetSessionMemory(size_t bytes) {
+    session_memory_bytes_ = bytes;
+  }
+
+  size_t GetSessionMemory() const {
+    return session_memory_bytes_;
+  }
+
  private:
   //only valid for single node tests;
   std::string node_name;
   onnxruntime::TIME_SPEC spent_time_;
   std::vector<EXECUTE_RESULT> execution_result_;
+  std::mutex run_latencies_mutex_;
+  std::vector<double> run_latencies_ms_;
+  double session_creation_ms_ = 0;
+  size_t session_memory_bytes_ = 0;
 };
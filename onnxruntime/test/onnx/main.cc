@@ -13,6 +13,7 @@
 #include "TestResultStat.h"
 #include "TestCase.h"
 #include "testenv.h"
+#include "perf_report.h"
 #include "providers.h"
 #include <google/protobuf/stubs/common.h>
 #include "core/platform/path_lib.h"
@@ -43,6 +44,12 @@ void usage() {
       "\t-o [optimization level]: Default is 99. Valid values are 0 (disable), 1 (basic), 2 (extended), 99 (all).\n"
       "\t\tPlease see onnxruntime_c_api.h (enum GraphOptimizationLevel) for the full list of all optimization levels. "
       "\n"
+      "\t-w [baseline file]: Measures the performance of each model (session creation time, p50/p99 latency of "
+      "Session::Run() and the memory held by the session) and saves it to the baseline file.\n"
+      "\t-b [baseline file]: Measures the performance of each model and fails the run if it regressed compared to "
+      "the baseline file saved by an earlier run with -w. Use '-j 1' for the memory to be attributed to each model, "
+      "and '-c 1 -r [repeat]' for stable latency percentiles.\n"
+      "\t-t [tolerance]: Allowed regression compared to the baseline, in percent. Default: 10.\n"
       "\t-h: help\n"
       "\n"
       "onnxruntime version: %s\n",
@@ -106,6 +113,10 @@ int real_main(int argc, char* argv[], Ort::Env& env) {
   GraphOptimizationLevel graph_optimization_level = ORT_ENABLE_ALL;
   bool user_graph_optimization_level_set = false;
   bool set_denormal_as_zero = false;
+  std::basic_string<PATH_CHAR_TYPE> perf_baseline_to_write;
+  std::basic_string<PATH_CHAR_TYPE> perf_baseline_to_compare;
+  int perf_tolerance_percent = 10;
+  bool perf_regressed = false;
 
   OrtLoggingLevel logging_level = ORT_LOGGING_LEVEL_ERROR;
   bool verbose_logging_required = false;
@@ -113,7 +124,7 @@ int real_main(int argc, char* argv[], Ort::Env& env) {
   bool pause = false;
   {
     int ch;
-    while ((ch = getopt(argc, argv, ORT_TSTR("Ac:hj:Mn:r:e:xvo:d:pz"))) != -1) {
+    while ((ch = getopt(argc, argv, ORT_TSTR("Ac:hj:Mn:r:e:xvo:d:pzw:b:t:"))) != -1) {
       switch (ch) {
         case 'A':
           enable_cpu_mem_arena = false;
@@ -224,6 +235,19 @@ int real_main(int argc, char* argv[], Ort::Env& env) {
         case 'z':
           set_denormal_as_zero = true;
           break;
+        case 'w':
+          perf_baseline_to_write = optarg;
+          break;
+        case 'b':
+          perf_baseline_to_compare = optarg;
+          break;
+        case 't':
+          perf_tolerance_percent = static_cast<int>(OrtStrtol<PATH_CHAR_TYPE>(optarg, nullptr));
+          if (perf_tolerance_percent < 0) {
+            usage();
+            return -1;
+          }
+          break;
         case '?':
         case 'h':
         default:
@@ -495,6 +519,41 @@ int real_main(int argc, char* argv[], Ort::Env& env) {
     }
     std::string res = stat.ToString();
     fwrite(res.c_str(), 1, res.size(), stdout);
+
+    if (!perf_baseline_to_write.empty() || !perf_baseline_to_compare.empty()) {
+      onnxruntime::test::PerfReport perf_report;
+      for (const auto& result : test_env.GetResults()) {
+        if (result) {
+          perf_report.Add(*result);
+        }
+      }
+
+      std::string perf = perf_report.ToString();
+      printf("Performance:\n");
+      fwrite(perf.c_str(), 1, perf.size(), stdout);
+
+      if (!perf_baseline_to_write.empty()) {
+        st = perf_report.Save(perf_baseline_to_write);
+        if (!st.IsOK()) {
+          fprintf(stderr, "%s\n", st.ErrorMessage().c_str());
+          return -1;
+        }
+      }
+
+      if (!perf_baseline_to_compare.empty()) {
+        onnxruntime::test::PerfReport baseline;
+        st = onnxruntime::test::PerfReport::Load(perf_baseline_to_compare, baseline);
+        if (!st.IsOK()) {
+          fprintf(stderr, "%s\n", st.ErrorMessage().c_str());
+          return -1;
+        }
+
+        for (const auto& regression : perf_report.FindRegressions(baseline, perf_tolerance_percent / 100.0)) {
+          fprintf(stderr, "performance regression: %s\n", regression.c_str());
+          perf_regressed = true;
+        }
+      }
+    }
   }
 
   struct BrokenTest {
@@ -920,6 +979,10 @@ int real_main(int argc, char* argv[], Ort::Env& env) {
       result = -1;
     }
   }
+
+  if (perf_regressed) {
+    result = -1;
+  }
   return result;
 }
 #ifdef _WIN32
@@ -0,0 +1,198 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Runs the preprocessing part of a typical pipeline converted by skl2onnx:
+// Imputer -> Scaler -> Normalizer -> ArrayFeatureExtractor -> OneHotEncoder of a categorical column, combined by
+// FeatureVectorizer, and a ZipMap of the scaled features standing in for the probabilities of a classifier.
+
+#include <benchmark/benchmark.h>
+#include <core/graph/constants.h>
+#include <core/graph/onnx_protobuf.h>
+#include <core/session/onnxruntime_cxx_api.h>
+#include <core/session/ort_env.h>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+extern OrtEnv* env;
+
+namespace {
+
+constexpr int64_t kNumFeatures = 16;
+constexpr int64_t kNumCategories = 8;
+
+void AddTensorValueInfo(ONNX_NAMESPACE::ValueInfoProto& value_info, const std::string& name,
+                        ONNX_NAMESPACE::TensorProto_DataType type, int64_t num_features) {
+  value_info.set_name(name);
+  auto* tensor_type = value_info.mutable_type()->mutable_tensor_type();
+  tensor_type->set_elem_type(type);
+  tensor_type->mutable_shape()->add_dim()->set_dim_param("N");
+  tensor_type->mutable_shape()->add_dim()->set_dim_value(num_features);
+}
+
+ONNX_NAMESPACE::NodeProto& AddNode(ONNX_NAMESPACE::GraphProto& graph, const std::string& op_type,
+                                   const std::vector<std::string>& inputs, const std::vector<std::string>& outputs) {
+  auto& node = *graph.add_node();
+  node.set_op_type(op_type);
+  node.set_domain(onnxruntime::kMLDomain);
+  node.set_name(op_type + "_" + outputs[0]);
+  for (const auto& input : inputs) {
+    node.add_input(input);
+  }
+  for (const auto& output : outputs) {
+    node.add_output(output);
+  }
+  return node;
+}
+
+template <typename T>
+void AddAttribute(ONNX_NAMESPACE::NodeProto& node, const std::string& name, const std::vector<T>& values);
+
+template <>
+void AddAttribute(ONNX_NAMESPACE::NodeProto& node, const std::string& name, const std::vector<float>& values) {
+  auto& attr = *node.add_attribute();
+  attr.set_name(name);
+  attr.set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_FLOATS);
+  for (const auto value : values) {
+    attr.add_floats(value);
+  }
+}
+
+template <>
+void AddAttribute(ONNX_NAMESPACE::NodeProto& node, const std::string& name, const std::vector<int64_t>& values) {
+  auto& attr = *node.add_attribute();
+  attr.set_name(name);
+  attr.set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_INTS);
+  for (const auto value : values) {
+    attr.add_ints(value);
+  }
+}
+
+std::string CreatePipelineModel() {
+  ONNX_NAMESPACE::ModelProto model;
+  model.set_ir_version(ONNX_NAMESPACE::IR_VERSION);
+  auto* onnx_opset = model.add_opset_import();
+  onnx_opset->set_domain(onnxruntime::kOnnxDomain);
+  onnx_opset->set_version(12);
+  auto* ml_opset = model.add_opset_import();
+  ml_opset->set_domain(onnxruntime::kMLDomain);
+  ml_opset->set_version(2);
+
+  auto& graph = *model.mutable_graph();
+  graph.set_name("ml_pipeline");
+  AddTensorValueInfo(*graph.add_input(), "X", ONNX_NAMESPACE::TensorProto_DataType_FLOAT, kNumFeatures);
+
+  std::vector<float> imputed(kNumFeatures, 0.5f);
+  std::vector<float> offset(kNumFeatures), scale(kNumFeatures);
+  std::vector<int64_t> categories(kNumCategories);
+  for (int64_t i = 0; i < kNumFeatures; ++i) {
+    offset[i] = 0.1f * i;
+    scale[i] = 1.f + 0.01f * i;
+  }
+  for (int64_t i = 0; i < kNumCategories; ++i) {
+    categories[i] = i;
+  }
+
+  // the categorical column is the last feature
+  auto& column = *graph.add_initializer();
+  column.set_name("column");
+  column.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_INT64);
+  column.add_dims(1);
+  column.add_int64_data(kNumFeatures - 1);
+
+  auto& imputer = AddNode(graph, "Imputer", {"X"}, {"imputed"});
+  AddAttribute(imputer, "imputed_value_floats", imputed);
+  auto& replaced = *imputer.add_attribute();
+  replaced.set_name("replaced_value_float");
+  replaced.set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_FLOAT);
+  replaced.set_f(std::numeric_limits<float>::quiet_NaN());
+
+  auto& scaler = AddNode(graph, "Scaler", {"imputed"}, {"scaled"});
+  AddAttribute(scaler, "offset", offset);
+  AddAttribute(scaler, "scale", scale);
+
+  auto& normalizer = AddNode(graph, "Normalizer", {"scaled"}, {"normalized"});
+  auto& norm = *normalizer.add_attribute();
+  norm.set_name("norm");
+  norm.set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_STRING);
+  norm.set_s("L2");
+
+  AddNode(graph, "ArrayFeatureExtractor", {"imputed", "column"}, {"category"});
+  auto& one_hot = AddNode(graph, "OneHotEncoder", {"category"}, {"one_hot"});
+  AddAttribute(one_hot, "cats_int64s", categories);
+
+  auto& vectorizer = AddNode(graph, "FeatureVectorizer", {"normalized", "one_hot"}, {"features"});
+  AddAttribute(vectorizer, "inputdimensions", std::vector<int64_t>{kNumFeatures, kNumCategories});
+
+  std::vector<int64_t> labels(kNumFeatures);
+  for (int64_t i = 0; i < kNumFeatures; ++i) {
+    labels[i] = kNumFeatures - i;
+  }
+  auto& zip_map = AddNode(graph, "ZipMap", {"scaled"}, {"probabilities"});
+  AddAttribute(zip_map, "classlabels_int64s", labels);
+
+  AddTensorValueInfo(*graph.add_output(), "features", ONNX_NAMESPACE::TensorProto_DataType_FLOAT,
+                     kNumFeatures + kNumCategories);
+  auto& probabilities = *graph.add_output();
+  probabilities.set_name("probabilities");
+  auto* map_type = probabilities.mutable_type()->mutable_sequence_type()->mutable_elem_type()->mutable_map_type();
+  map_type->set_key_type(ONNX_NAMESPACE::TensorProto_DataType_INT64);
+  map_type->mutable_value_type()->mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+
+  return model.SerializeAsString();
+}
+
+}  // namespace
+
+static void BM_MLPreprocessingPipeline(benchmark::State& state) {
+  const int64_t batch_size = state.range(0);
+  const int intra_op_threads = static_cast<int>(state.range(1));
+  const std::string model_data = CreatePipelineModel();
+
+  Ort::SessionOptions session_options;
+  session_options.SetIntraOpNumThreads(intra_op_threads);
+  // the environment is owned by main, so the wrapper releases its ownership once the session is created
+  Ort::Env ort_env{env};
+  Ort::Session session(ort_env, model_data.data(), model_data.size(), session_options);
+  ort_env.release();
+
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(0.f, static_cast<float>(kNumCategories));
+  std::vector<float> input(batch_size * kNumFeatures);
+  for (auto& value : input) {
+    value = dist(gen);
+  }
+  // some missing values for the Imputer
+  for (size_t i = 0; i < input.size(); i += 7) {
+    input[i] = std::numeric_limits<float>::quiet_NaN();
+  }
+  // the categorical column has whole numbers
+  for (int64_t row = 0; row < batch_size; ++row) {
+    input[row * kNumFeatures + kNumFeatures - 1] = static_cast<float>(row % kNumCategories);
+  }
+
+  const std::vector<int64_t> input_shape{batch_size, kNumFeatures};
+  auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+  Ort::Value input_tensor = Ort::Value::CreateTensor<float>(memory_info, input.data(), input.size(),
+                                                            input_shape.data(), input_shape.size());
+  const char* input_names[] = {"X"};
+  const char* output_names[] = {"features", "probabilities"};
+
+  for (auto _ : state) {
+    auto outputs = session.Run(Ort::RunOptions{nullptr}, input_names, &input_tensor, 1, output_names, 2);
+    benchmark::DoNotOptimize(outputs);
+  }
+
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+BENCHMARK(BM_MLPreprocessingPipeline)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({1, 1})
+    ->Args({100, 1})
+    ->Args({10000, 1})
+    ->Args({10000, 4})
+    ->Args({100000, 4});
@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "perf_report.h"
+#include "TestCaseResult.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+// increases below these are treated as noise, so the tiny models of the node tests don't fail randomly
+constexpr double kLatencyNoiseFloorMs = 0.1;
+constexpr double kSessionCreationNoiseFloorMs = 1.0;
+constexpr double kMemoryNoiseFloorBytes = 1024.0 * 1024.0;
+
+// nearest-rank percentile of sorted values
+double Percentile(const std::vector<double>& sorted_values, double percentile) {
+  const auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted_values.size()));
+  return sorted_values[std::max<size_t>(rank, 1) - 1];
+}
+
+void CheckRegression(const std::string& model_name, const char* measurement, double value, double baseline_value,
+                     double tolerance, double noise_floor, std::vector<std::string>& regressions) {
+  if (value > baseline_value * (1.0 + tolerance) && value - baseline_value > noise_floor) {
+    std::ostringstream oss;
+    oss << model_name << ": " << measurement << " regressed from " << baseline_value << " to " << value;
+    regressions.push_back(oss.str());
+  }
+}
+}  // namespace
+
+void PerfReport::Add(const TestCaseResult& result) {
+  std::vector<double> latencies = result.GetRunLatencies();
+  if (latencies.empty()) {
+    return;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  ModelPerf& perf = models_[result.GetName()];
+  perf.session_creation_ms = result.GetSessionCreationTime();
+  perf.p50_ms = Percentile(latencies, 50);
+  perf.p99_ms = Percentile(latencies, 99);
+  perf.session_memory_bytes = result.GetSessionMemory();
+}
+
+std::string PerfReport::ToString() const {
+  std::ostringstream oss;
+  oss << "model\tsession_creation_ms\tp50_ms\tp99_ms\tsession_memory_bytes\n";
+  oss << std::fixed << std::setprecision(3);
+  for (const auto& entry : models_) {
+    const ModelPerf& perf = entry.second;
+    oss << entry.first << '\t' << perf.session_creation_ms << '\t' << perf.p50_ms << '\t' << perf.p99_ms << '\t'
+        << perf.session_memory_bytes << '\n';
+  }
+  return oss.str();
+}
+
+Status PerfReport::Save(const std::basic_string<PATH_CHAR_TYPE>& path) const {
+  std::ofstream file(path);
+  file << "# " << ToString();
+  file.close();
+  if (!file) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to write the perf baseline ", ToMBString(path));
+  }
+
+  return Status::OK();
+}
+
+Status PerfReport::Load(const std::basic_string<PATH_CHAR_TYPE>& path, PerfReport& report) {
+  std::ifstream file(path);
+  if (!file) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Failed to open the perf baseline ", ToMBString(path));
+  }
+
+  report.models_.clear();
+  std::string line;
+  for (size_t line_number = 1; std::getline(file, line); ++line_number) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    std::istringstream line_stream(line);
+    std::string model_name;
+    ModelPerf perf;
+    if (!(line_stream >> model_name >> perf.session_creation_ms >> perf.p50_ms >> perf.p99_ms >>
+          perf.session_memory_bytes)) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid line ", line_number, " in the perf baseline ",
+                             ToMBString(path), ": ", line);
+    }
+
+    report.models_[model_name] = perf;
+  }
+
+  return Status::OK();
+}
+
+std::vector<std::string> PerfReport::FindRegressions(const PerfReport& baseline, double tolerance) const {
+  std::vector<std::string> regressions;
+  for (const auto& entry : models_) {
+    auto baseline_entry = baseline.models_.find(entry.first);
+    if (baseline_entry == baseline.models_.cend()) {
+      continue;
+    }
+
+    const ModelPerf& perf = entry.second;
+    const ModelPerf& baseline_perf = baseline_entry->second;
+    CheckRegression(entry.first, "session creation time (ms)", perf.session_creation_ms,
+                    baseline_perf.session_creation_ms, tolerance, kSessionCreationNoiseFloorMs, regressions);
+    CheckRegression(entry.first, "p50 latency (ms)", perf.p50_ms, baseline_perf.p50_ms, tolerance,
+                    kLatencyNoiseFloorMs, regressions);
+    CheckRegression(entry.first, "p99 latency (ms)", perf.p99_ms, baseline_perf.p99_ms, tolerance,
+                    kLatencyNoiseFloorMs, regressions);
+    CheckRegression(entry.first, "session memory (bytes)", static_cast<double>(perf.session_memory_bytes),
+                    static_cast<double>(baseline_perf.session_memory_bytes), tolerance, kMemoryNoiseFloorBytes,
+                    regressions);
+  }
+
+  return regressions;
+}
+
+#ifdef _WIN32
+size_t GetCurrentWorkingSetSize() {
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+    return pmc.WorkingSetSize;
+  }
+
+  return 0;
+}
+#elif defined(__linux__)
+size_t GetCurrentWorkingSetSize() {
+  // the second field is the number of resident pages
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  if (statm >> total_pages >> resident_pages) {
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  }
+
+  return 0;
+}
+#else
+size_t GetCurrentWorkingSetSize() {
+  return 0;
+}
+#endif
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <core/common/common.h>
+#include <core/common/status.h>
+#include <core/platform/path_lib.h>
+
+class TestCaseResult;
+
+namespace onnxruntime {
+namespace test {
+
+// Performance of one model (test case)
+struct ModelPerf {
+  double session_creation_ms = 0;
+  double p50_ms = 0;
+  double p99_ms = 0;
+  // growth of the working set of the process while the session of the model was alive.
+  // only attributable to the model when models aren't run in parallel (-j 1).
+  size_t session_memory_bytes = 0;
+};
+
+/// <summary>
+/// Per model performance of a test run, which can be saved as the baseline of later runs
+/// so they fail on performance regressions.
+/// </summary>
+class PerfReport {
+ public:
+  /// <summary>
+  /// Adds the performance of a test case. Test cases without a successful run are skipped.
+  /// </summary>
+  void Add(const TestCaseResult& result);
+
+  std::string ToString() const;
+
+  /// <summary>
+  /// Saves the report as a baseline file: one line per model with its name, session creation time, p50 and p99
+  /// run latencies in milliseconds and session memory in bytes, separated by tabs.
+  /// </summary>
+  onnxruntime::common::Status Save(const std::basic_string<PATH_CHAR_TYPE>& path) const;
+
+  static onnxruntime::common::Status Load(const std::basic_string<PATH_CHAR_TYPE>& path, PerfReport& report);
+
+  /// <summary>
+  /// Compares the models present in both reports.
+  /// </summary>
+  /// <param name="baseline">the report of an earlier run</param>
+  /// <param name="tolerance">allowed relative increase of each measurement over the baseline, e.g. 0.1 for 10%
+  /// </param>
+  /// <returns>a description of each measurement that regressed beyond the tolerance</returns>
+  std::vector<std::string> FindRegressions(const PerfReport& baseline, double tolerance) const;
+
+ private:
+  std::map<std::string, ModelPerf> models_;
+};
+
+/// <summary>
+/// Current working set (resident memory) of the process in bytes, or 0 if it can't be queried on this platform.
+/// </summary>
+size_t GetCurrentWorkingSetSize();
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -4,6 +4,7 @@
 #include "testcase_request.h"
 #include "dataitem_request.h"
 #include "TestCase.h"
+#include "perf_report.h"
 
 #include "core/common/logging/logging.h"
 #include "core/common/logging/macros.h"
@@ -36,8 +37,18 @@ bool TestCaseRequestContext::SetupSession() {
   ORT_TRY {
     const auto* test_case_name = test_case_.GetTestCaseName().c_str();
     session_opts_.SetLogId(test_case_name);
+    working_set_before_session_ = GetCurrentWorkingSetSize();
+    TIME_SPEC start_time;
+    TIME_SPEC end_time;
+    GetMonotonicTimeCounter(&start_time);
     Ort::Session session{env_, test_case_.GetModelUrl(), session_opts_};
+    GetMonotonicTimeCounter(&end_time);
     session_ = std::move(session);
+
+    TIME_SPEC creation_time;
+    SetTimeSpecToZero(&creation_time);
+    AccumulateTimeSpec(&creation_time, &start_time, &end_time);
+    result_->SetSessionCreationTime(TimeSpecToSeconds(&creation_time) * 1000);
     LOGF_DEFAULT(INFO, "Testing %s\n", test_case_name);
     return true;
   }
@@ -124,6 +135,9 @@ void TestCaseRequestContext::OnDataTaskComplete(size_t task_id, EXECUTE_RESULT r
   SetTimeSpecToZero(&zero);
   AccumulateTimeSpec(&test_case_time_, &zero, &spent_time);
   result_->SetResult(task_id, result);
+  if (result == EXECUTE_RESULT::SUCCESS) {
+    result_->AddRunLatency(TimeSpecToSeconds(&spent_time) * 1000);
+  }
 
   auto next_to_run = data_tasks_started_.fetch_add(1, std::memory_order_relaxed);
   if (next_to_run < test_case_.GetDataCount()) {
@@ -168,6 +182,9 @@ void TestCaseRequestContext::RunSequentially(size_t repeat_count) {
       auto result = DataTaskRequestContext::Run(test_case_, session_, &allocator_, idx_data);
       result_->SetResult(idx_data, result.first);
       AccumulateTimeSpec(&test_case_time_, &zero, &result.second);
+      if (result.first == EXECUTE_RESULT::SUCCESS) {
+        result_->AddRunLatency(TimeSpecToSeconds(&result.second) * 1000);
+      }
     }
   }
 
@@ -183,6 +200,9 @@ void TestCaseRequestContext::Wait() const {
 
 void TestCaseRequestContext::CalculateAndLogStats() const {
   result_->SetSpentTime(test_case_time_);
+  // the session is still alive, so this is the memory it holds on top of what the process held before it
+  const size_t working_set = GetCurrentWorkingSetSize();
+  result_->SetSessionMemory(working_set > working_set_before_session_ ? working_set - working_set_before_session_ : 0);
   const auto& test_case_name = test_case_.GetTestCaseName();
   const std::vector<EXECUTE_RESULT>& er = result_->GetExcutionResult();
   for (size_t i = 0; i != er.size(); ++i) {
@@ -110,6 +110,7 @@ class TestCaseRequestContext {
   MockedOrtAllocator allocator_;
   std::shared_ptr<TestCaseResult> result_;
   TIME_SPEC test_case_time_;
+  size_t working_set_before_session_ = 0;
   Callable<void, size_t, EXECUTE_RESULT, const TIME_SPEC&> on_data_task_cb_;
 
   mutable std::atomic_size_t data_tasks_started_;
@@ -42,14 +42,13 @@ TestEnv::~TestEnv() {
 
 Status TestEnv::Run(size_t parallel_models, int concurrent_runs, size_t repeat_count) {
 
-  std::vector<std::shared_ptr<TestCaseResult>> results;
   if (parallel_models > 1U && tests_.size() > 1U) {
-    results = onnxruntime::test::TestCaseDriver::RunParallel(*this, parallel_models, concurrent_runs);
+    results_ = onnxruntime::test::TestCaseDriver::RunParallel(*this, parallel_models, concurrent_runs);
   } else {
-    results = onnxruntime::test::TestCaseDriver::Run(*this, concurrent_runs, repeat_count);
+    results_ = onnxruntime::test::TestCaseDriver::Run(*this, concurrent_runs, repeat_count);
   }
 
-  CalculateStats(results);
+  CalculateStats(results_);
 
   return Status::OK();
 }
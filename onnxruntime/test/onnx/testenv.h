@@ -3,6 +3,7 @@
 
 #pragma once
 #include <atomic>
+#include <memory>
 #include <vector>
 #include <core/common/common.h>
 
@@ -64,6 +65,14 @@ class TestEnv {
     return tests_;
   }
 
+  /// <summary>
+  /// Results of the test cases of the last Run, in the order of GetTests().
+  /// A result is null if the test case didn't complete.
+  /// </summary>
+  const std::vector<std::shared_ptr<TestCaseResult>>& GetResults() const {
+    return results_;
+  }
+
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(TestEnv);
 
  private:
@@ -73,5 +82,6 @@ class TestEnv {
   const Ort::SessionOptions& so_;
   PThreadPool tp_;
   std::vector<ITestCase*> tests_;
+  std::vector<std::shared_ptr<TestCaseResult>> results_;
   TestResultStat& stat_;
 };
@@ -10,6 +10,7 @@
 
 #include "asserts.h"
 #include "core/framework/data_types.h"
+#include "core/framework/execution_providers.h"
 #include "core/framework/ml_value.h"
 #include "core/graph/graph_utils.h"
 #include "core/graph/graph_viewer.h"
@@ -27,8 +28,10 @@
 #include "core/optimizer/dropout_elimination.h"
 #include "core/optimizer/dynamic_quantize_matmul_fusion.h"
 #include "core/optimizer/embed_layer_norm_fusion.h"
+#include "core/optimizer/embedding_table_compression.h"
 #include "core/optimizer/expand_elimination.h"
 #include "core/optimizer/fast_gelu_fusion.h"
+#include "core/optimizer/function_inliner.h"
 #include "core/optimizer/gelu_approximation.h"
 #include "core/optimizer/gelu_fusion.h"
 #include "core/optimizer/gemm_activation_fusion.h"
@@ -37,6 +40,7 @@
 #include "core/optimizer/identity_elimination.h"
 #include "core/optimizer/initializer.h"
 #include "core/optimizer/layer_norm_fusion.h"
+#include "core/optimizer/loop_invariant_code_motion.h"
 #include "core/optimizer/matmul_add_fusion.h"
 #include "core/optimizer/matmul_scale_fusion.h"
 #include "core/optimizer/matmul_transpose_fusion.h"
@@ -251,6 +255,238 @@ TEST_F(GraphTransformationTests, ConstantFoldingSubgraph) {
       << "Constant folding should have been able to remove the Add node in both subgraphs";
 }
 
+TEST_F(GraphTransformationTests, LoopInvariantCodeMotion) {
+  TypeProto float_tensor_type;
+  float_tensor_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  TypeProto int64_scalar_type;
+  int64_scalar_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+  int64_scalar_type.mutable_tensor_type()->mutable_shape();
+
+  TypeProto bool_scalar_type;
+  bool_scalar_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+  bool_scalar_type.mutable_tensor_type()->mutable_shape();
+
+  TensorProto value_tensor;
+  value_tensor.add_dims(2);
+  value_tensor.add_float_data(1.f);
+  value_tensor.add_float_data(2.f);
+  value_tensor.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+
+  // body: state_out = state_in + (X * W) * local_constant, where only the Add depends on the iteration.
+  auto create_body = [&](GraphProto& graph_proto) {
+    Model model("LoopInvariantCodeMotion_body", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, *logger_);
+    auto& graph = model.MainGraph();
+
+    TensorProto local_constant(value_tensor);
+    local_constant.set_name("local_constant");
+    graph.AddInitializedTensor(local_constant);
+
+    auto& iter_num = graph.GetOrCreateNodeArg("iter_num", &int64_scalar_type);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar_type);
+    auto& state_in = graph.GetOrCreateNodeArg("state_in", &float_tensor_type);
+    auto& x = graph.GetOrCreateNodeArg("X", &float_tensor_type);
+    auto& w = graph.GetOrCreateNodeArg("W", &float_tensor_type);
+    graph.AddOuterScopeNodeArg("X");
+    graph.AddOuterScopeNodeArg("W");
+    auto& local_constant_arg = graph.GetOrCreateNodeArg("local_constant", &float_tensor_type);
+
+    auto& projection = graph.GetOrCreateNodeArg("projection", &float_tensor_type);
+    auto& scaled = graph.GetOrCreateNodeArg("scaled", &float_tensor_type);
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar_type);
+    auto& state_out = graph.GetOrCreateNodeArg("state_out", &float_tensor_type);
+    graph.AddNode("projection", "Mul", "Invariant", {&x, &w}, {&projection});
+    graph.AddNode("scale", "Mul", "Invariant", {&projection, &local_constant_arg}, {&scaled});
+    graph.AddNode("accumulate", "Add", "Loop carried", {&state_in, &scaled}, {&state_out});
+    graph.AddNode("cond", "Identity", "Loop condition", {&cond_in}, {&cond_out});
+
+    graph.SetInputs({&iter_num, &cond_in, &state_in});
+    graph.SetOutputs({&cond_out, &state_out});
+
+    ASSERT_STATUS_OK(graph.Resolve());
+    graph_proto = graph.ToGraphProto();
+  };
+
+  Model model("LoopInvariantCodeMotion_main_graph", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, *logger_);
+  auto& graph = model.MainGraph();
+
+  TensorProto w_tensor(value_tensor);
+  w_tensor.set_name("W");
+  graph.AddInitializedTensor(w_tensor);
+
+  // the loop is known to run, so nodes that may fail can be hoisted.
+  TensorProto trip_count_tensor;
+  trip_count_tensor.set_name("M");
+  trip_count_tensor.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_INT64);
+  trip_count_tensor.add_int64_data(3);
+  graph.AddInitializedTensor(trip_count_tensor);
+  TensorProto cond_tensor;
+  cond_tensor.set_name("cond");
+  cond_tensor.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_BOOL);
+  cond_tensor.add_int32_data(1);
+  graph.AddInitializedTensor(cond_tensor);
+
+  auto& max_trip_count = graph.GetOrCreateNodeArg("M", &int64_scalar_type);
+  auto& cond = graph.GetOrCreateNodeArg("cond", &bool_scalar_type);
+  auto& state = graph.GetOrCreateNodeArg("state", &float_tensor_type);
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor_type);
+  graph.GetOrCreateNodeArg("W", &float_tensor_type);
+  auto& loop_out = graph.GetOrCreateNodeArg("loop_out", &float_tensor_type);
+  auto& consume_x = graph.GetOrCreateNodeArg("consume_x", &float_tensor_type);
+  graph.AddNode("consume_x", "Identity", "So X is a value of the main graph.", {&x}, {&consume_x});
+
+  GraphProto body;
+  create_body(body);
+  auto& loop_node = graph.AddNode("loop", "Loop", "Loop node", {&max_trip_count, &cond, &state}, {&loop_out});
+  loop_node.AddAttribute("body", body);
+
+  ASSERT_STATUS_OK(graph.Resolve());
+  ASSERT_EQ(CountOpsInGraph(graph, false)["Mul"], 0);
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  graph_transformation_mgr.Register(onnxruntime::make_unique<LoopInvariantCodeMotion>(), TransformerLevel::Level1);
+  ASSERT_STATUS_OK(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level1, *logger_));
+
+  // both Mul nodes move to the main graph along with the body's initializer.
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph, false);
+  EXPECT_EQ(op_to_count["Mul"], 2);
+  EXPECT_EQ(op_to_count["Add"], 0);
+  op_to_count = CountOpsInGraph(graph);
+  EXPECT_EQ(op_to_count["Mul"], 2);
+  EXPECT_EQ(op_to_count["Add"], 1);
+
+  const TensorProto* initializer = nullptr;
+  EXPECT_TRUE(graph.GetInitializedTensor("local_constant", initializer));
+
+  const Node* loop = graph.GetProducerNode("loop_out");
+  ASSERT_NE(loop, nullptr);
+  const Graph* loop_body = loop->GetGraphAttribute("body");
+  ASSERT_NE(loop_body, nullptr);
+  EXPECT_FALSE(loop_body->GetInitializedTensor("local_constant", initializer));
+  EXPECT_TRUE(loop_body->IsOuterScopeValue("scaled"));
+}
+
+// A Loop whose trip count is a graph input may not run at all, so only nodes that can't fail are hoisted.
+TEST_F(GraphTransformationTests, LoopInvariantCodeMotionUnknownTripCount) {
+  TypeProto float_tensor_type;
+  float_tensor_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  TypeProto int64_scalar_type;
+  int64_scalar_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+  int64_scalar_type.mutable_tensor_type()->mutable_shape();
+
+  TypeProto bool_scalar_type;
+  bool_scalar_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+  bool_scalar_type.mutable_tensor_type()->mutable_shape();
+
+  // body: state_out = state_in + Neg(X) * W. both Neg and Mul are invariant, but only Neg can't fail.
+  GraphProto body;
+  {
+    Model model("LoopInvariantCodeMotionUnknownTripCount_body", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, *logger_);
+    auto& graph = model.MainGraph();
+
+    auto& iter_num = graph.GetOrCreateNodeArg("iter_num", &int64_scalar_type);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar_type);
+    auto& state_in = graph.GetOrCreateNodeArg("state_in", &float_tensor_type);
+    auto& x = graph.GetOrCreateNodeArg("X", &float_tensor_type);
+    auto& w = graph.GetOrCreateNodeArg("W", &float_tensor_type);
+    graph.AddOuterScopeNodeArg("X");
+    graph.AddOuterScopeNodeArg("W");
+
+    auto& negated = graph.GetOrCreateNodeArg("negated", &float_tensor_type);
+    auto& projection = graph.GetOrCreateNodeArg("projection", &float_tensor_type);
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar_type);
+    auto& state_out = graph.GetOrCreateNodeArg("state_out", &float_tensor_type);
+    graph.AddNode("negate", "Neg", "Invariant and can't fail", {&x}, {&negated});
+    graph.AddNode("projection", "Mul", "Invariant", {&negated, &w}, {&projection});
+    graph.AddNode("accumulate", "Add", "Loop carried", {&state_in, &projection}, {&state_out});
+    graph.AddNode("cond", "Identity", "Loop condition", {&cond_in}, {&cond_out});
+
+    graph.SetInputs({&iter_num, &cond_in, &state_in});
+    graph.SetOutputs({&cond_out, &state_out});
+
+    ASSERT_STATUS_OK(graph.Resolve());
+    body = graph.ToGraphProto();
+  }
+
+  Model model("LoopInvariantCodeMotionUnknownTripCount_main_graph", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, *logger_);
+  auto& graph = model.MainGraph();
+
+  auto& max_trip_count = graph.GetOrCreateNodeArg("M", &int64_scalar_type);
+  auto& cond = graph.GetOrCreateNodeArg("cond", &bool_scalar_type);
+  auto& state = graph.GetOrCreateNodeArg("state", &float_tensor_type);
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor_type);
+  auto& w = graph.GetOrCreateNodeArg("W", &float_tensor_type);
+  auto& loop_out = graph.GetOrCreateNodeArg("loop_out", &float_tensor_type);
+  auto& consume_x = graph.GetOrCreateNodeArg("consume_x", &float_tensor_type);
+  auto& consume_w = graph.GetOrCreateNodeArg("consume_w", &float_tensor_type);
+  graph.AddNode("consume_x", "Identity", "So X is a value of the main graph.", {&x}, {&consume_x});
+  graph.AddNode("consume_w", "Identity", "So W is a value of the main graph.", {&w}, {&consume_w});
+
+  auto& loop_node = graph.AddNode("loop", "Loop", "Loop node", {&max_trip_count, &cond, &state}, {&loop_out});
+  loop_node.AddAttribute("body", body);
+
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  graph_transformation_mgr.Register(onnxruntime::make_unique<LoopInvariantCodeMotion>(), TransformerLevel::Level1);
+  ASSERT_STATUS_OK(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level1, *logger_));
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph, false);
+  EXPECT_EQ(op_to_count["Neg"], 1);
+  EXPECT_EQ(op_to_count["Mul"], 0);
+  op_to_count = CountOpsInGraph(graph);
+  EXPECT_EQ(op_to_count["Neg"], 1);
+  EXPECT_EQ(op_to_count["Mul"], 1);
+
+  const Node* loop = graph.GetProducerNode("loop_out");
+  ASSERT_NE(loop, nullptr);
+  const Graph* loop_body = loop->GetGraphAttribute("body");
+  ASSERT_NE(loop_body, nullptr);
+  EXPECT_TRUE(loop_body->IsOuterScopeValue("negated"));
+}
+
+// Celu is a function op the CPU provider has no kernel for, MeanVarianceNormalization is one it has a kernel for.
+TEST_F(GraphTransformationTests, FunctionInliner) {
+  TypeProto float_tensor_type;
+  float_tensor_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (auto dim : {1, 2, 1, 2}) {
+    float_tensor_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+
+  Model model("FunctionInliner", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {}, *logger_);
+  auto& graph = model.MainGraph();
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor_type);
+  auto& celu_out = graph.GetOrCreateNodeArg("celu_out", &float_tensor_type);
+  auto& mvn_out = graph.GetOrCreateNodeArg("mvn_out", &float_tensor_type);
+  graph.AddNode("celu", "Celu", "No kernel", {&x}, {&celu_out});
+  graph.AddNode("mvn", "MeanVarianceNormalization", "Has a kernel", {&x}, {&mvn_out});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  ExecutionProviders execution_providers;
+  ASSERT_STATUS_OK(execution_providers.Add(kCpuExecutionProvider,
+                                           onnxruntime::make_unique<CPUExecutionProvider>(CPUExecutionProviderInfo())));
+  KernelRegistryManager kernel_registry_manager;
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+
+  FunctionInliner function_inliner({kCpuExecutionProvider}, kernel_registry_manager);
+  bool modified = false;
+  ASSERT_STATUS_OK(function_inliner.Apply(graph, modified, *logger_));
+  EXPECT_TRUE(modified);
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  EXPECT_EQ(op_to_count["Celu"], 0);
+  EXPECT_EQ(op_to_count["Elu"], 1);
+  EXPECT_EQ(op_to_count["MeanVarianceNormalization"], 1);
+
+  // the body now produces the output of the Celu node
+  const Node* celu_body_output = graph.GetProducerNode("celu_out");
+  ASSERT_NE(celu_body_output, nullptr);
+  EXPECT_NE(celu_body_output->OpType(), "Celu");
+}
+
 TEST_F(GraphTransformationTests, ConstantFoldingWithShapeToInitializer) {
   auto model_uri = MODEL_FOLDER "fusion/constant_folding_with_shape_to_initializer.onnx";
   std::shared_ptr<Model> model;
@@ -3070,6 +3306,126 @@ TEST_F(GraphTransformationTests, MatMulIntegerToFloatTest) {
   EXPECT_EQ(op_to_count["Add"], 1);
 }
 
+TEST_F(GraphTransformationTests, EmbeddingTableCompressionEmbedLayerNorm) {
+  auto model_uri = MODEL_FOLDER "fusion/embed_layer_norm_format1.onnx";
+  std::shared_ptr<Model> p_model;
+  ASSERT_STATUS_OK(Model::Load(model_uri, p_model, nullptr, *logger_));
+  Graph& graph = p_model->MainGraph();
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  ASSERT_STATUS_OK(graph_transformation_mgr.Register(onnxruntime::make_unique<EmbedLayerNormFusion>(),
+                                                     TransformerLevel::Level2));
+  ASSERT_STATUS_OK(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level2, *logger_));
+
+  for (auto& node : graph.Nodes()) {
+    node.SetExecutionProviderType(kCpuExecutionProvider);
+  }
+
+  EmbeddingTableCompression compression(EmbeddingTableCompression::Format::Int8, {kCpuExecutionProvider});
+  bool modified = false;
+  ASSERT_STATUS_OK(compression.Apply(graph, modified, *logger_));
+  ASSERT_TRUE(modified);
+
+  const Node* embed_layer_norm = nullptr;
+  for (const auto& node : graph.Nodes()) {
+    if (node.OpType() == "EmbedLayerNormalization") {
+      embed_layer_norm = &node;
+    }
+  }
+
+  ASSERT_NE(embed_layer_norm, nullptr);
+  const auto& input_defs = embed_layer_norm->InputDefs();
+  ASSERT_EQ(input_defs.size(), 10u);
+  EXPECT_EQ(*input_defs[2]->Type(), "tensor(int8)");
+  EXPECT_EQ(*input_defs[8]->Type(), "tensor(float)");
+  EXPECT_EQ(*input_defs[9]->Type(), "tensor(int8)");
+
+  // only the word embedding is compressed
+  EXPECT_EQ(*input_defs[3]->Type(), "tensor(float)");
+  EXPECT_EQ(*embed_layer_norm->OutputDefs()[0]->Type(), "tensor(float)");
+}
+
+// Gather (table, ids) -> output, where the table may also be used by a MatMul.
+static void BuildEmbeddingGatherGraph(Graph& graph, bool table_used_by_matmul) {
+  TensorProto table;
+  table.set_name("table");
+  table.set_data_type(TensorProto_DataType_FLOAT);
+  table.add_dims(3);
+  table.add_dims(2);
+  for (float value : {0.5f, -1.0f, 2.0f, 0.25f, -4.0f, 8.0f}) {
+    table.add_float_data(value);
+  }
+  graph.AddInitializedTensor(table);
+
+  TypeProto float_tensor_type;
+  float_tensor_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  TypeProto int64_tensor_type;
+  int64_tensor_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+
+  auto& table_arg = graph.GetOrCreateNodeArg("table", &float_tensor_type);
+  auto& ids = graph.GetOrCreateNodeArg("ids", &int64_tensor_type);
+  auto& gather_out = graph.GetOrCreateNodeArg("gather_out", &float_tensor_type);
+  graph.AddNode("gather", "Gather", "Embedding lookup", {&table_arg, &ids}, {&gather_out});
+
+  if (table_used_by_matmul) {
+    auto& x = graph.GetOrCreateNodeArg("X", &float_tensor_type);
+    auto& matmul_out = graph.GetOrCreateNodeArg("matmul_out", &float_tensor_type);
+    graph.AddNode("matmul", "MatMul", "Tied output projection", {&table_arg, &x}, {&matmul_out});
+  }
+
+  ASSERT_STATUS_OK(graph.Resolve());
+  for (auto& node : graph.Nodes()) {
+    node.SetExecutionProviderType(kCpuExecutionProvider);
+  }
+}
+
+TEST_F(GraphTransformationTests, EmbeddingTableCompressionGather) {
+  Model model("EmbeddingTableCompressionGather", false, ModelMetaData(), PathString(),
+              IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}, {kMSDomain, 1}}, {}, *logger_);
+  auto& graph = model.MainGraph();
+  BuildEmbeddingGatherGraph(graph, false);
+
+  EmbeddingTableCompression compression(EmbeddingTableCompression::Format::Float16, {kCpuExecutionProvider});
+  bool modified = false;
+  ASSERT_STATUS_OK(compression.Apply(graph, modified, *logger_));
+  ASSERT_TRUE(modified);
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  EXPECT_EQ(op_to_count["Gather"], 0);
+  EXPECT_EQ(op_to_count["com.microsoft.DequantizeGather"], 1);
+
+  const TensorProto* initializer = nullptr;
+  EXPECT_FALSE(graph.GetInitializedTensor("table", initializer));
+  const Node* dequantize_gather = graph.GetProducerNode("gather_out");
+  ASSERT_NE(dequantize_gather, nullptr);
+  ASSERT_TRUE(graph.GetInitializedTensor(dequantize_gather->InputDefs()[0]->Name(), initializer));
+  EXPECT_EQ(initializer->data_type(), TensorProto_DataType_FLOAT16);
+  EXPECT_EQ(dequantize_gather->GetExecutionProviderType(), kCpuExecutionProvider);
+}
+
+TEST_F(GraphTransformationTests, EmbeddingTableCompressionSharedTable) {
+  Model model("EmbeddingTableCompressionSharedTable", false, ModelMetaData(), PathString(),
+              IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}, {kMSDomain, 1}}, {}, *logger_);
+  auto& graph = model.MainGraph();
+  BuildEmbeddingGatherGraph(graph, true);
+
+  EmbeddingTableCompression compression(EmbeddingTableCompression::Format::Int8, {kCpuExecutionProvider});
+  bool modified = false;
+  ASSERT_STATUS_OK(compression.Apply(graph, modified, *logger_));
+  EXPECT_FALSE(modified);
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  EXPECT_EQ(op_to_count["Gather"], 1);
+  EXPECT_EQ(op_to_count["com.microsoft.DequantizeGather"], 0);
+}
+
+TEST_F(GraphTransformationTests, EmbeddingTableCompressionParseFormat) {
+  EmbeddingTableCompression::Format format;
+  ASSERT_STATUS_OK(EmbeddingTableCompression::ParseFormat("bfloat16", format));
+  EXPECT_EQ(format, EmbeddingTableCompression::Format::BFloat16);
+  EXPECT_FALSE(EmbeddingTableCompression::ParseFormat("int4", format).IsOK());
+}
+
 #endif
 
 // LayerNormalization implementation is in contrib namespace (OnnxDomain 1), so
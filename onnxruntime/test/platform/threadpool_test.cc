@@ -3,6 +3,7 @@
 
 #include "core/platform/threadpool.h"
 #include "core/platform/EigenNonBlockingThreadPool.h"
+#include "core/common/threadpool_governor.h"
 #include "core/platform/ort_mutex.h"
 
 #include <core/common/make_unique.h>
@@ -11,6 +12,7 @@
 #include <algorithm>
 #include <memory>
 #include <functional>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -161,6 +163,114 @@ void TestPoolCreation(const std::string&, int iter) {
   ASSERT_EQ(ctr, iter * per_iter);
 }
 
+void TestSchedulingHintPropagation(int num_threads, WorkPriority priority) {
+  // Work scheduled while a hint is installed should run with that hint, and should be
+  // accounted for in the queueing statistics of the matching priority class.
+  CreateThreadPoolAndTest("TestSchedulingHintPropagation", num_threads, [&](ThreadPool* tp) {
+    auto before = ThreadPool::GetQueueingDelayStats(tp, priority);
+    std::atomic<int> mismatches{0};
+    onnxruntime::Barrier b(1);
+    {
+      SchedulingHint hint;
+      hint.priority = priority;
+      ScopedSchedulingHint scoped_hint(hint);
+      ThreadPool::Schedule(tp, [&]() {
+        if (SchedulingHint::Current().priority != priority) {
+          mismatches++;
+        }
+        b.Notify();
+      });
+    }
+    b.Wait();
+    ASSERT_EQ(SchedulingHint::Current().priority, WorkPriority::Normal);
+    ASSERT_EQ(mismatches, 0);
+    auto after = ThreadPool::GetQueueingDelayStats(tp, priority);
+    if (num_threads > 1) {
+      ASSERT_EQ(after.num_tasks, before.num_tasks + 1);
+      ASSERT_GE(after.total_delay_ns, before.total_delay_ns);
+    } else {
+      ASSERT_EQ(after.num_tasks, 0u);
+    }
+  });
+}
+
+void TestDefaultSchedulingHint(int num_threads) {
+  // Work scheduled under the default hint runs with the default hint, and is not timed.
+  CreateThreadPoolAndTest("TestDefaultSchedulingHint", num_threads, [&](ThreadPool* tp) {
+    auto before = ThreadPool::GetQueueingDelayStats(tp, WorkPriority::Normal);
+    std::atomic<int> mismatches{0};
+    onnxruntime::Barrier b(1);
+    ThreadPool::Schedule(tp, [&]() {
+      if (SchedulingHint::Current().priority != WorkPriority::Normal ||
+          SchedulingHint::Current().deadline_ns != 0) {
+        mismatches++;
+      }
+      b.Notify();
+    });
+    b.Wait();
+    ASSERT_EQ(mismatches, 0);
+    auto after = ThreadPool::GetQueueingDelayStats(tp, WorkPriority::Normal);
+    ASSERT_EQ(after.num_tasks, before.num_tasks);
+  });
+}
+
+void TestMixedPriorityParallelFor(int num_threads, int num_tasks) {
+  // Concurrent loops from threads with different priorities must all complete.
+  CreateThreadPoolAndTest("TestMixedPriorityParallelFor", num_threads, [&](ThreadPool* tp) {
+    std::vector<std::unique_ptr<TestData>> td;
+    for (int p = 0; p < kNumWorkPriorities; p++) {
+      td.push_back(CreateTestData(num_tasks));
+    }
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kNumWorkPriorities; p++) {
+      threads.emplace_back([&, p]() {
+        SchedulingHint hint;
+        hint.priority = static_cast<WorkPriority>(p);
+        ScopedSchedulingHint scoped_hint(hint);
+        ThreadPool::TrySimpleParallelFor(tp, num_tasks, [&](std::ptrdiff_t i) {
+          IncrementElement(*td[p], i);
+        });
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    for (int p = 0; p < kNumWorkPriorities; p++) {
+      ValidateTestData(*td[p]);
+    }
+  });
+}
+
+void TestAdaptiveSpinning(int num_threads, int num_loops) {
+  // Run a sequence of short loops over a pool using adaptive spinning, checking that every
+  // loop completes and that the pool accounts for the time its threads spent working.
+  onnxruntime::ThreadOptions to;
+  to.adaptive_spinning = true;
+  to.collect_stats = true;
+  auto tp = onnxruntime::make_unique<ThreadPool>(&onnxruntime::Env::Default(), to, nullptr, num_threads, true);
+  for (int loop = 0; loop < num_loops; loop++) {
+    auto test_data = CreateTestData(1000);
+    ThreadPool::TrySimpleParallelFor(tp.get(), 1000, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+    ValidateTestData(*test_data);
+  }
+  auto stats = ThreadPool::GetSpinStats(tp.get());
+  ASSERT_LE(stats.num_productive_spin_episodes, stats.num_spin_episodes);
+  ASSERT_LE(stats.productive_spin_ns, stats.spin_ns);
+}
+
+void TestSpinStatsOffByDefault(int num_threads) {
+  // Without ThreadOptions::collect_stats the pool does not time its threads.
+  CreateThreadPoolAndTest("TestSpinStatsOffByDefault", num_threads, [&](ThreadPool* tp) {
+    auto test_data = CreateTestData(1000);
+    ThreadPool::TrySimpleParallelFor(tp, 1000, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+    ValidateTestData(*test_data);
+    auto stats = ThreadPool::GetSpinStats(tp);
+    ASSERT_EQ(stats.num_spin_episodes, 0u);
+    ASSERT_EQ(stats.spin_ns, 0u);
+    ASSERT_EQ(stats.busy_ns, 0u);
+  });
+}
+
 }  // namespace
 
 namespace onnxruntime {
@@ -290,6 +400,206 @@ TEST(ThreadPoolTest, TestPoolCreation_100Iter) {
   TestPoolCreation("TestPoolCreation_100Iter", 100);
 }
 
+TEST(ThreadPoolTest, TestSchedulingHint_1Thread) {
+  TestSchedulingHintPropagation(1, WorkPriority::High);
+}
+
+TEST(ThreadPoolTest, TestSchedulingHint_4Thread_High) {
+  TestSchedulingHintPropagation(4, WorkPriority::High);
+}
+
+TEST(ThreadPoolTest, TestSchedulingHint_4Thread_Low) {
+  TestSchedulingHintPropagation(4, WorkPriority::Low);
+}
+
+TEST(ThreadPoolTest, TestDefaultSchedulingHint_4Thread) {
+  TestDefaultSchedulingHint(4);
+}
+
+TEST(ThreadPoolTest, TestMixedPriorityParallelFor_4Thread_1MTasks) {
+  TestMixedPriorityParallelFor(4, 1000000);
+}
+
+TEST(ThreadPoolTest, TestDeadlinePromotion) {
+  // Work from a run whose deadline has passed is queued as high priority.
+  CreateThreadPoolAndTest("TestDeadlinePromotion", 4, [&](ThreadPool* tp) {
+    auto before = ThreadPool::GetQueueingDelayStats(tp, WorkPriority::High);
+    onnxruntime::Barrier b(1);
+    {
+      SchedulingHint hint;
+      hint.priority = WorkPriority::Low;
+      hint.deadline_ns = SchedulingHint::NowNs();
+      ScopedSchedulingHint scoped_hint(hint);
+      ThreadPool::Schedule(tp, [&]() { b.Notify(); });
+    }
+    b.Wait();
+    auto after = ThreadPool::GetQueueingDelayStats(tp, WorkPriority::High);
+    ASSERT_EQ(after.num_tasks, before.num_tasks + 1);
+  });
+}
+
+TEST(ThreadPoolTest, TestAdaptiveSpinning_4Thread_100Loops) {
+  TestAdaptiveSpinning(4, 100);
+}
+
+TEST(ThreadPoolTest, TestSpinStatsOffByDefault_4Thread) {
+  TestSpinStatsOffByDefault(4);
+}
+
+TEST(ThreadPoolTest, TestSpinLimiter) {
+  int saved_limit = SpinLimiter::GetMaxSpinningThreads();
+  SpinLimiter::SetMaxSpinningThreads(1);
+  // Other pools in the process may hold a slot, so we can only check that the limit is enforced.
+  bool slot_taken = false;
+  if (SpinLimiter::TryAcquire(slot_taken)) {
+    ASSERT_TRUE(slot_taken);
+    bool second_slot_taken = false;
+    ASSERT_FALSE(SpinLimiter::TryAcquire(second_slot_taken));
+    ASSERT_FALSE(second_slot_taken);
+    // the slot is returned even though the limit is lifted in the meantime
+    SpinLimiter::SetMaxSpinningThreads(0);
+    SpinLimiter::Release();
+  }
+  // without a limit, no slot is counted
+  SpinLimiter::SetMaxSpinningThreads(0);
+  ASSERT_TRUE(SpinLimiter::TryAcquire(slot_taken));
+  ASSERT_FALSE(slot_taken);
+  SpinLimiter::SetMaxSpinningThreads(saved_limit);
+}
+
+TEST(ThreadPoolTest, TestSpinLimitWithPool) {
+  // Pools must continue to make progress when most of their threads are not allowed to spin.
+  int saved_limit = SpinLimiter::GetMaxSpinningThreads();
+  SpinLimiter::SetMaxSpinningThreads(1);
+  TestMultipleParallelFor("TestSpinLimitWithPool", 4, 4, 1000);
+  SpinLimiter::SetMaxSpinningThreads(saved_limit);
+}
+
+#ifndef _OPENMP
+TEST(ThreadPoolTest, TestExpiredDeadlineAbandonsLoop) {
+  // Once the deadline of the issuing request has passed, threads stop claiming iterations.
+  // The loop returns without throwing, and the caller finds the deadline expired.
+  CreateThreadPoolAndTest("TestExpiredDeadlineAbandonsLoop", 4, [&](ThreadPool* tp) {
+    std::atomic<std::ptrdiff_t> ctr{0};
+    SchedulingHint hint;
+    hint.deadline_ns = SchedulingHint::NowNs() - 1;
+    ScopedSchedulingHint scoped_hint(hint);
+    ASSERT_TRUE(hint.DeadlineExpired());
+    ThreadPool::TrySimpleParallelFor(tp, 100000, [&](std::ptrdiff_t) { ctr++; });
+    ASSERT_LT(ctr, 100000);
+    ASSERT_TRUE(SchedulingHint::Current().DeadlineExpired());
+  });
+}
+
+TEST(ThreadPoolTest, TestFutureDeadlineCompletesLoop) {
+  TestData test_data(1000);
+  CreateThreadPoolAndTest("TestFutureDeadlineCompletesLoop", 4, [&](ThreadPool* tp) {
+    SchedulingHint hint;
+    hint.deadline_ns = SchedulingHint::NowNs() + 60ll * 1000 * 1000 * 1000;
+    ScopedSchedulingHint scoped_hint(hint);
+    ThreadPool::TrySimpleParallelFor(tp, 1000, [&](std::ptrdiff_t i) { IncrementElement(test_data, i); });
+  });
+  ValidateTestData(test_data);
+}
+
+TEST(ThreadPoolTest, TestSetDegreeOfParallelism) {
+  TestData test_data(1000);
+  CreateThreadPoolAndTest("TestSetDegreeOfParallelism", 4, [&](ThreadPool* tp) {
+    ASSERT_EQ(ThreadPool::MaxDegreeOfParallelism(tp), 4);
+    tp->SetDegreeOfParallelism(2);
+    ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), 2);
+    ThreadPool::TrySimpleParallelFor(tp, 500, [&](std::ptrdiff_t i) { IncrementElement(test_data, i); });
+
+    // Shrinking to 1 runs loops inline on the calling thread; growing is capped at the threads in the pool.
+    tp->SetDegreeOfParallelism(1);
+    ASSERT_FALSE(ThreadPool::ShouldParallelize(tp));
+    ThreadPool::TrySimpleParallelFor(tp, 250, [&](std::ptrdiff_t i) { IncrementElement(test_data, 500 + i); });
+    tp->SetDegreeOfParallelism(100);
+    ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), 4);
+    ThreadPool::TrySimpleParallelFor(tp, 250, [&](std::ptrdiff_t i) { IncrementElement(test_data, 750 + i); });
+  });
+  ValidateTestData(test_data);
+}
+
+TEST(ThreadPoolTest, TestThreadPoolGovernor) {
+  auto tp1 = onnxruntime::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions(), nullptr,
+                                                  4, true);
+  auto tp2 = onnxruntime::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions(), nullptr,
+                                                  4, true);
+  {
+    ThreadPoolGovernor governor(5, std::chrono::milliseconds(0));
+    governor.Register(tp1.get());
+    governor.Register(tp2.get());
+    for (int i = 0; i < 4; i++) {
+      governor.Rebalance();
+      int dop1 = ThreadPool::DegreeOfParallelism(tp1.get());
+      int dop2 = ThreadPool::DegreeOfParallelism(tp2.get());
+      ASSERT_GE(dop1, 1);
+      ASSERT_GE(dop2, 1);
+      ASSERT_LE(dop1 + dop2, governor.CoreBudget());
+    }
+
+    // Pools keep running work correctly while their size is being changed underneath them.
+    TestData test_data(2000);
+    ThreadPool::TrySimpleParallelFor(tp1.get(), 1000, [&](std::ptrdiff_t i) { IncrementElement(test_data, i); });
+    governor.Rebalance();
+    ThreadPool::TrySimpleParallelFor(tp2.get(), 1000, [&](std::ptrdiff_t i) {
+      IncrementElement(test_data, 1000 + i);
+    });
+    ValidateTestData(test_data);
+
+    // Unregistering hands a pool back all of its threads.
+    governor.Unregister(tp1.get());
+    ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp1.get()), 4);
+    governor.Unregister(tp2.get());
+  }
+}
+
+TEST(ThreadPoolTest, TestThreadPoolGovernorMorePoolsThanBudget) {
+  std::vector<std::unique_ptr<ThreadPool>> pools;
+  for (int i = 0; i < 4; i++) {
+    pools.push_back(onnxruntime::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions(),
+                                                         nullptr, 4, true));
+  }
+  ThreadPoolGovernor governor(3, std::chrono::milliseconds(0));
+  for (auto& tp : pools) {
+    governor.Register(tp.get());
+  }
+
+  // Idle pools share one core, so none of them gets threads beyond its caller.
+  governor.Rebalance();
+  for (auto& tp : pools) {
+    ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp.get()), 1);
+  }
+
+  // Keep the threads of the first pool busy, with more work queued behind them.  That pool keeps a
+  // core for its caller and gets what is left of the budget after the core shared by the idle pools.
+  constexpr int num_tasks = 6;
+  onnxruntime::Notification release;
+  onnxruntime::Barrier done(num_tasks);
+  for (int i = 0; i < num_tasks; i++) {
+    ThreadPool::Schedule(pools[0].get(), [&]() {
+      release.Wait();
+      done.Notify();
+    });
+  }
+  for (int i = 0; i < 8; i++) {
+    governor.Rebalance();
+  }
+  int busy_dop = ThreadPool::DegreeOfParallelism(pools[0].get());
+  for (size_t i = 1; i < pools.size(); i++) {
+    ASSERT_EQ(ThreadPool::DegreeOfParallelism(pools[i].get()), 1);
+  }
+  release.Notify();
+  done.Wait();
+  ASSERT_EQ(busy_dop, governor.CoreBudget() - 1);
+
+  for (auto& tp : pools) {
+    governor.Unregister(tp.get());
+  }
+}
+#endif
+
 #ifdef _WIN32
 TEST(ThreadPoolTest, TestStackSize) {
   ThreadOptions to;
@@ -1038,6 +1038,70 @@ TEST(Loop, IterationCountAsOutput) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
 }
 
+// the buffers of the loop carried vars are alternated between iterations, and the execution frame of the subgraph is
+// reused. check the values produced by earlier iterations are not overwritten by later ones.
+TEST(Loop, LoopCarriedVarBuffersReused) {
+  auto create_subgraph = []() {
+    Model model("Loop carried var doubled in subgraph", false, DefaultLoggingManager().DefaultLogger());
+    auto& graph = model.MainGraph();
+
+    /* Inputs: iter_num, cond_in, loop carried state variable.
+
+         cond_in          a_in
+            |         +-----+-----+
+            |         |           |
+       [Identity]   [Add]       [Add]
+            |         |           |
+        cond_out    a_out      scan_out
+    */
+
+    TypeProto int64_scalar;
+    int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+    int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto bool_scalar;
+    bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+    bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+    auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+    auto& a_in = graph.GetOrCreateNodeArg("a_in", &float_tensor);
+
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+    auto& a_out = graph.GetOrCreateNodeArg("a_out", &float_tensor);
+    auto& scan_out = graph.GetOrCreateNodeArg("scan_out", &float_tensor);
+
+    graph.AddNode("cond_in_identity", "Identity", "Forward cond_in to cond_out", {&cond_in}, {&cond_out});
+    graph.AddNode("double_a", "Add", "Double a", {&a_in, &a_in}, {&a_out});
+    graph.AddNode("double_a_for_scan", "Add", "Double a for the loop output", {&a_in, &a_in}, {&scan_out});
+
+    graph.SetInputs({&iter_num_in, &cond_in, &a_in});
+    graph.SetOutputs({&cond_out, &a_out, &scan_out});
+
+    auto status = graph.Resolve();
+    EXPECT_EQ(status, Status::OK());
+
+    return graph.ToGraphProto();
+  };
+
+  OpTester test("Loop", 11);
+  auto body = create_subgraph();
+  test.AddAttribute<GraphProto>("body", body);
+  test.AddInput<int64_t>("M", {1}, {5});
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("a", {2}, {1.f, 2.f});
+
+  test.AddOutput<float>("a_final", {2}, {32.f, 64.f});
+  test.AddOutput<float>("scan_final", {5, 2}, {2.f, 4.f, 4.f, 8.f, 8.f, 16.f, 16.f, 32.f, 32.f, 64.f});
+
+  // Disable TensorRT on unsupported data type BOOL
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+}
+
 #ifdef USE_CUDA
 // test that when part of the subgraph run on CUDA it executes successfully
 TEST(Loop, MixedExecutionProviders) {
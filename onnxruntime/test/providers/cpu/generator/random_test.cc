@@ -2,10 +2,8 @@
 // Licensed under the MIT License.
 
 #include "gtest/gtest.h"
+#include "core/framework/philox_random.h"
 #include "test/providers/provider_test_utils.h"
-
-#include <algorithm>
-#include <random>
 using namespace ONNX_NAMESPACE;
 namespace onnxruntime {
 namespace test {
@@ -25,12 +23,11 @@ TEST(Random, RandomNormal2DDouble) {
   test.AddAttribute<int64_t>("dtype", TensorProto::DOUBLE);
   test.AddAttribute("shape", dims);
 
-  std::default_random_engine generator{gsl::narrow_cast<uint32_t>(seed)};
-  std::normal_distribution<double> distribution{mean, scale};
+  PhiloxGenerator generator{gsl::narrow_cast<uint32_t>(seed)};
 
   std::vector<double> expected_output(TensorShape(dims).Size());
-  std::for_each(expected_output.begin(), expected_output.end(),
-                [&generator, &distribution](double& value) { value = distribution(generator); });
+  FillPhiloxRandom(generator, PhiloxNormalDistribution<double>{mean, scale}, expected_output.data(),
+                   TensorShape(dims).Size(), nullptr);
 
   test.AddOutput<double>("Y", dims, expected_output);
   test.Run();
@@ -59,12 +56,11 @@ void RunRandomNormalLike3DFloat(bool infer_dtype = false) {
                         0.f, 0.f, 0.f,
                         0.f, 0.f, 0.f});
 
-  std::default_random_engine generator{gsl::narrow_cast<uint32_t>(seed)};
-  std::normal_distribution<float> distribution{mean, scale};
+  PhiloxGenerator generator{gsl::narrow_cast<uint32_t>(seed)};
 
   std::vector<float> expected_output(TensorShape(dims).Size());
-  std::for_each(expected_output.begin(), expected_output.end(),
-                [&generator, &distribution](float& value) { value = distribution(generator); });
+  FillPhiloxRandom(generator, PhiloxNormalDistribution<float>{mean, scale}, expected_output.data(),
+                   TensorShape(dims).Size(), nullptr);
 
   test.AddOutput<float>("Y", dims, expected_output);
 
@@ -95,12 +91,11 @@ TEST(Random, RandomUniform1DFloat) {
   test.AddAttribute<int64_t>("dtype", TensorProto::FLOAT);
   test.AddAttribute("shape", dims);
 
-  std::default_random_engine generator{gsl::narrow_cast<uint32_t>(seed)};
-  std::uniform_real_distribution<float> distribution{low, high};
+  PhiloxGenerator generator{gsl::narrow_cast<uint32_t>(seed)};
 
   std::vector<float> expected_output(TensorShape(dims).Size());
-  std::for_each(expected_output.begin(), expected_output.end(),
-                [&generator, &distribution](float& value) { value = distribution(generator); });
+  FillPhiloxRandom(generator, PhiloxUniformDistribution<float>{low, high}, expected_output.data(),
+                   TensorShape(dims).Size(), nullptr);
 
   test.AddOutput<float>("Y", dims, expected_output);
 
@@ -128,12 +123,11 @@ void RunRandomUniformLikeTest(bool infer_dtype = false) {
                         {0., 0., 0., 0., 0., 0.,
                          0., 0., 0., 0., 0., 0.});
 
-  std::default_random_engine generator{gsl::narrow_cast<uint32_t>(seed)};
-  std::uniform_real_distribution<double> distribution{low, high};
+  PhiloxGenerator generator{gsl::narrow_cast<uint32_t>(seed)};
 
   std::vector<double> expected_output(TensorShape(dims).Size());
-  std::for_each(expected_output.begin(), expected_output.end(),
-                [&generator, &distribution](double& value) { value = distribution(generator); });
+  FillPhiloxRandom(generator, PhiloxUniformDistribution<double>{low, high}, expected_output.data(),
+                   TensorShape(dims).Size(), nullptr);
 
   test.AddOutput<double>("Y", dims, expected_output);
 
@@ -222,10 +216,10 @@ TEST(Random, InvalidDType) {
 }
 
 /*
-Note: There are no reference tests that can be reused in this case. I tried to use the tensorflow
-test cases but they use a different RNG (Philox) and hence the test results differ. Since the implementation
-of the op is same as tensorflow, for now I've just relied on the output generated by this code as ground truth
-for verification.
+Note: There are no reference tests that can be reused in this case. The tensorflow test cases also use
+Philox, but the values are drawn from the stream in a different way and hence the test results differ.
+Since the implementation of the op is same as tensorflow, for now I've just relied on the output generated
+by this code as ground truth for verification.
 */
 TEST(Random, MultinomialGoodCase) {
   OpTester test("Multinomial");
@@ -245,13 +239,7 @@ TEST(Random, MultinomialGoodCase) {
   test.AddAttribute<int64_t>("dtype", TensorProto::INT64);
 
   const std::vector<int64_t> output_dims{batch_size, num_samples};
-#ifdef _WIN32
-  const std::vector<int64_t> expected_output{2, 0, 0, 2, 2, 2, 0, 2, 2, 1, 1, 2, 1, 1, 1, 1, 2, 1, 2, 0};
-#elif defined(__MACH__) || defined(__ANDROID__) || defined(__FreeBSD__)
-  const std::vector<int64_t> expected_output{1, 1, 2, 2, 0, 2, 2, 2, 0, 2, 1, 1, 2, 0, 2, 2, 0, 2, 1, 1};
-#else
-  const std::vector<int64_t> expected_output{2, 0, 0, 1, 0, 1, 2, 0, 1, 0, 0, 1, 1, 0, 1, 0, 2, 0, 2, 0};
-#endif
+  const std::vector<int64_t> expected_output{1, 2, 0, 2, 0, 0, 2, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0};
   test.AddOutput<int64_t>("Y", output_dims, expected_output);
 
   test.Run();
@@ -282,16 +270,9 @@ TEST(Random, MultinomialDefaultDType) {
     test.Run();
   };
 
-#ifdef _WIN32
-  const std::vector<int32_t> expected_output_1{2, 0, 0, 2, 2, 2, 0, 2, 2, 1, 1, 2, 1, 1, 1, 1, 2, 1, 2, 0};
-  const std::vector<int32_t> expected_output_2{0, 0, 1, 0, 2, 2, 2, 0, 2, 1, 2, 1, 0, 2, 0, 2, 2, 1, 2, 1};
-#elif defined(__MACH__) || defined(__ANDROID__) || defined(__FreeBSD__)
-  const std::vector<int32_t> expected_output_1{1, 1, 2, 2, 0, 2, 2, 2, 0, 2, 1, 1, 2, 0, 2, 2, 0, 2, 1, 1};
-  const std::vector<int32_t> expected_output_2{1, 0, 1, 1, 1, 1, 0, 0, 1, 1, 0, 2, 0, 1, 1, 0, 2, 2, 2, 1};
-#else
-  const std::vector<int32_t> expected_output_1{2, 0, 0, 1, 0, 1, 2, 0, 1, 0, 0, 1, 1, 0, 1, 0, 2, 0, 2, 0};
-  const std::vector<int32_t> expected_output_2{2, 2, 1, 1, 0, 2, 2, 1, 1, 2, 0, 0, 0, 2, 0, 1, 1, 1, 0, 0};
-#endif
+  // the values come from a Philox stream, so they're the same on all platforms
+  const std::vector<int32_t> expected_output_1{1, 2, 0, 2, 0, 0, 2, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0};
+  const std::vector<int32_t> expected_output_2{2, 0, 0, 2, 0, 1, 2, 1, 1, 0, 0, 2, 0, 2, 2, 0, 2, 2, 1, 2};
 
   // Test output from a single call to Multinomial::Compute
   run_test(1, expected_output_1);
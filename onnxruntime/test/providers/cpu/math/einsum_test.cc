@@ -350,6 +350,14 @@ TEST(Einsum, ExplicitEinsumAsDiagonalOpWithTranspose) {
   test.Run();
 }
 
+TEST(Einsum, ExplicitEinsumAsDiagonalOpOnOuterAxes) {
+  OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
+  test.AddAttribute<std::string>("equation", "ijkj->ik");
+  test.AddInput<float>("x", {2, 2, 2, 2}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f, 16.f});
+  test.AddOutput<float>("o", {2, 2}, {7.f, 11.f, 23.f, 27.f});
+  test.Run();
+}
+
 TEST(Einsum, ExplicitEinsumAsDiagonalOpWithTranspose_double) {
   OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
   test.AddAttribute<std::string>("equation", "iji->ji");
@@ -519,5 +527,56 @@ TEST(Einsum, ImplicitEinsumAsTensorContraction) {
   test.Run();
 }
 
+// Theme: Contraction order
+
+// Contracting the last 2 inputs first is much cheaper than contracting left to right here
+TEST(Einsum, ExplicitEinsumAsChainedMatmul_Multi_Input) {
+  const int64_t I = 8, J = 2, K = 8, L = 2;
+  std::vector<float> a(I * J), b(J * K), c(K * L);
+  for (size_t n = 0; n < a.size(); ++n) a[n] = static_cast<float>(n % 5) - 2.f;
+  for (size_t n = 0; n < b.size(); ++n) b[n] = static_cast<float>(n % 3) + 1.f;
+  for (size_t n = 0; n < c.size(); ++n) c[n] = static_cast<float>(n % 4) - 1.f;
+
+  std::vector<float> expected(I * L, 0.f);
+  for (int64_t i = 0; i < I; ++i)
+    for (int64_t j = 0; j < J; ++j)
+      for (int64_t k = 0; k < K; ++k)
+        for (int64_t l = 0; l < L; ++l)
+          expected[i * L + l] += a[i * J + j] * b[j * K + k] * c[k * L + l];
+
+  OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
+  test.AddAttribute<std::string>("equation", "ij,jk,kl->il");
+  test.AddInput<float>("x", {I, J}, a);
+  test.AddInput<float>("y", {J, K}, b);
+  test.AddInput<float>("z", {K, L}, c);
+  test.AddOutput<float>("o", {I, L}, expected);
+  test.Run();
+}
+
+// The last input has a dim that only it has, which is reduced before the contraction order is chosen
+TEST(Einsum, ExplicitEinsumAsChainedMatmulWithReduction_Multi_Input) {
+  const int64_t I = 2, J = 6, K = 2, L = 3, M = 4;
+  std::vector<float> a(I * J), b(J * K), c(K * L * M);
+  for (size_t n = 0; n < a.size(); ++n) a[n] = static_cast<float>(n % 4) + 1.f;
+  for (size_t n = 0; n < b.size(); ++n) b[n] = static_cast<float>(n % 3) - 1.f;
+  for (size_t n = 0; n < c.size(); ++n) c[n] = static_cast<float>(n % 5) - 2.f;
+
+  std::vector<float> expected(L * I, 0.f);
+  for (int64_t i = 0; i < I; ++i)
+    for (int64_t j = 0; j < J; ++j)
+      for (int64_t k = 0; k < K; ++k)
+        for (int64_t l = 0; l < L; ++l)
+          for (int64_t m = 0; m < M; ++m)
+            expected[l * I + i] += a[i * J + j] * b[j * K + k] * c[(k * L + l) * M + m];
+
+  OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
+  test.AddAttribute<std::string>("equation", "ij,jk,klm->li");
+  test.AddInput<float>("x", {I, J}, a);
+  test.AddInput<float>("y", {J, K}, b);
+  test.AddInput<float>("z", {K, L, M}, c);
+  test.AddOutput<float>("o", {L, I}, expected);
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -3,6 +3,7 @@
 
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
+#include <limits>
 using namespace std;
 namespace onnxruntime {
 namespace test {
@@ -25,5 +26,15 @@ TEST(MLOpTest, BinarizerOp) {
   test.Run();
 }
 
+TEST(MLOpTest, BinarizerOpNaNInput) {
+  OpTester test("Binarizer", 1, onnxruntime::kMLDomain);
+  test.AddAttribute("threshold", 0.3f);
+  vector<int64_t> dims{2, 3};
+  test.AddInput<float>("X", dims, {0.8f, -0.5f, std::numeric_limits<float>::quiet_NaN(), 0.8f,
+                                   std::numeric_limits<float>::quiet_NaN(), 0.1f});
+  test.AddOutput<float>("Y", dims, {1.f, 0.f, 0.f, 1.f, 0.f, 0.f});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "Input data with index: 2 is NaN");
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -42,5 +42,22 @@ TEST(MLOpTest, DictVectorizerInt64Input) {
   test.Run();
 }
 
+TEST(MLOpTest, DictVectorizerDuplicateVocabulary) {
+  OpTester test("DictVectorizer", 1, onnxruntime::kMLDomain);
+
+  test.AddAttribute("string_vocabulary", std::vector<std::string>{"a", "b", "a", "e"});
+
+  std::map<std::string, float> map;
+  map["a"] = 1.f;
+  map["c"] = 2.f;
+  map["e"] = 3.f;
+
+  test.AddInput<std::string, float>("X", map);
+
+  std::vector<int64_t> dims{1, 4};
+  test.AddOutput<float>("Y", dims, {1.f, 0.f, 1.f, 3.f});
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -179,6 +179,47 @@ TEST(Normalizer, TwoDimensionInt) {
 }
 #endif
 
+// Runs Normalizer between two Neg nodes, so its input and output are intermediate values and the allocation planner
+// lets it write its output into the buffer of its input.
+class InPlaceNormalizerTester : public OpTester {
+ public:
+  InPlaceNormalizerTester() : OpTester("Normalizer", 1, onnxruntime::kMLDomain) {}
+
+ protected:
+  void AddNodes(onnxruntime::Graph& graph,
+                std::vector<onnxruntime::NodeArg*>& graph_input_defs,
+                std::vector<onnxruntime::NodeArg*>& graph_output_defs,
+                std::vector<std::function<void(onnxruntime::Node& node)>>& add_attribute_funcs) override {
+    auto& normalizer_input = graph.GetOrCreateNodeArg("normalizer_input", graph_input_defs[0]->TypeAsProto());
+    auto& normalizer_output = graph.GetOrCreateNodeArg("normalizer_output", graph_output_defs[0]->TypeAsProto());
+
+    graph.AddNode("negate_input", "Neg", "Neg", {graph_input_defs[0]}, {&normalizer_input});
+    auto& node = graph.AddNode("node1", "Normalizer", "Normalizer", {&normalizer_input}, {&normalizer_output},
+                               nullptr, onnxruntime::kMLDomain);
+    for (auto& add_attribute_fn : add_attribute_funcs) {
+      add_attribute_fn(node);
+    }
+
+    graph.AddNode("negate_output", "Neg", "Neg", {&normalizer_output}, {graph_output_defs[0]});
+  }
+};
+
+// L2 used to store the squares in the output before reading the signs of the input, so running in place made
+// every output positive.
+TEST(Normalizer, L2InPlace) {
+  InPlaceNormalizerTester test;
+  test.AddAttribute("norm", "L2");
+
+  // the Normalizer sees -X
+  test.AddInput<float>("X", {2, 3},
+                       {1.f, -2.f, 2.f,
+                        -3.f, 0.f, 4.f});
+  test.AddOutput<float>("Y", {2, 3},
+                        {0.33333334f, -0.6666667f, 0.6666667f,
+                         -0.6f, 0.f, 0.8f});
+  test.Run();
+}
+
 TEST(Normalizer, InvalidNorm) {
   std::vector<int64_t> dims = {3};
   std::vector<float> input = {-1.f, 0.f, 1.f};
@@ -55,6 +55,36 @@ TEST(MLOpTest, ZipMapOpInt64Float1D) {
   TestHelper<int64_t>({10, 20, 30, 40, 50, 60}, "int64_t", {6});
 }
 
+// The labels don't need to be sorted. With duplicate labels the value of the last one is kept.
+TEST(MLOpTest, ZipMapOpStringFloatUnsortedDuplicateLabels) {
+  OpTester test("ZipMap", 1, onnxruntime::kMLDomain);
+  test.AddAttribute("classlabels_strings", std::vector<std::string>{"c", "a", "c"});
+  test.AddInput<float>("X", {2, 3}, {1.f, 0.f, 3.f, 44.f, 23.f, 11.3f});
+  test.AddOutput<std::string, float>("Z", {{{"a", 0.f}, {"c", 3.f}}, {{"a", 23.f}, {"c", 11.3f}}});
+  test.Run();
+}
+
+TEST(MLOpTest, ZipMapOpInt64FloatLargeBatch) {
+  const std::vector<int64_t> classes{30, 10, 20};
+  const int64_t batch_size = 1000;
+  std::vector<float> input;
+  std::vector<std::map<int64_t, float>> expected_output;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    std::map<int64_t, float> var_map;
+    for (size_t j = 0; j < classes.size(); ++j) {
+      input.push_back(static_cast<float>(i) + 0.25f * j);
+      var_map.emplace(classes[j], input.back());
+    }
+    expected_output.push_back(var_map);
+  }
+
+  OpTester test("ZipMap", 1, onnxruntime::kMLDomain);
+  test.AddAttribute("classlabels_int64s", classes);
+  test.AddInput<float>("X", {batch_size, 3}, input);
+  test.AddOutput<int64_t, float>("Z", expected_output);
+  test.Run();
+}
+
 // Negative test cases
 TEST(MLOpTest, ZipMapOpStringFloatStrideMoreThanNumLabels) {
   TestHelper<string>({"class1", "class2", "class3"}, "string", {1, 6}, OpTester::ExpectResult::kExpectFailure);
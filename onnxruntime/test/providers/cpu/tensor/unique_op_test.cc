@@ -1,6 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <limits>
+#include <map>
+#include <unordered_map>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -375,5 +379,62 @@ TEST(Unique, EmptyInput) {
   test.Run();
 }
 
+// -0.0 is the same value as 0.0 and all the NaNs are the same value, sorted last
+TEST(Unique, Flatten_Sorted_NegativeZeroAndNaN) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const std::vector<int64_t> X_dims{7};
+  const std::vector<float> X{nan, 0.f, -1.f, -0.f, nan, 2.f, -1.f};
+  const int64_t* axis = nullptr;
+  bool sorted = true;
+  const std::vector<int64_t> Y_dims{4};
+  const std::vector<float> Y{-1.f, 0.f, 2.f, nan};
+
+  const std::vector<int64_t> indices_dims{4};
+  const std::vector<int64_t> indices{2, 1, 5, 0};
+  const std::vector<int64_t> inverse_indices_dims{7};
+  const std::vector<int64_t> inverse_indices{3, 1, 0, 1, 3, 2, 0};
+  const std::vector<int64_t> counts_dims{4};
+  const std::vector<int64_t> counts{2, 2, 1, 2};
+
+  RunUniqueTest<float>(X_dims, X, axis, sorted, Y_dims, Y, indices_dims, indices,
+                       inverse_indices_dims, inverse_indices, counts_dims, counts);
+}
+
+// large enough to be split between threads and radix sorted
+TEST(Unique, Flatten_Sorted_LargeInput) {
+  const int64_t num_elements = 200000;
+  std::vector<int64_t> X(num_elements);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    X[i] = ((i * 7919) % 30011 - 15000) * 1000003;
+  }
+
+  // sorted value -> index of first occurrence and count
+  std::map<int64_t, std::pair<int64_t, int64_t>> expected;
+  for (int64_t i = 0; i < num_elements; ++i) {
+    auto entry = expected.emplace(X[i], std::make_pair(i, int64_t{0}));
+    ++entry.first->second.second;
+  }
+
+  std::vector<int64_t> Y;
+  std::vector<int64_t> indices;
+  std::vector<int64_t> counts;
+  std::unordered_map<int64_t, int64_t> sorted_ids;
+  for (const auto& entry : expected) {
+    sorted_ids[entry.first] = static_cast<int64_t>(Y.size());
+    Y.push_back(entry.first);
+    indices.push_back(entry.second.first);
+    counts.push_back(entry.second.second);
+  }
+
+  std::vector<int64_t> inverse_indices(num_elements);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    inverse_indices[i] = sorted_ids[X[i]];
+  }
+
+  const int64_t num_unique = static_cast<int64_t>(Y.size());
+  RunUniqueTest<int64_t>({num_elements}, X, nullptr, true, {num_unique}, Y, {num_unique}, indices,
+                         {num_elements}, inverse_indices, {num_unique}, counts);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
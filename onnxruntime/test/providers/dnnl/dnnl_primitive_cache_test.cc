@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/make_unique.h"
+#include "core/providers/dnnl/dnnl_primitive_cache.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace ort_dnnl {
+namespace test {
+
+class TestPrimitive : public PrimitiveBase {
+ public:
+  TestPrimitive(int id, int& num_destroyed) : id_(id), num_destroyed_(num_destroyed) {}
+  ~TestPrimitive() override { ++num_destroyed_; }
+
+  int Id() const { return id_; }
+
+ private:
+  int id_;
+  int& num_destroyed_;
+};
+
+static int IdOf(const std::unique_ptr<PrimitiveBase>& primitive) {
+  return primitive == nullptr ? -1 : static_cast<const TestPrimitive&>(*primitive).Id();
+}
+
+TEST(DnnlPrimitiveCacheTest, TakeReturnsWhatWasReturned) {
+  int num_destroyed = 0;
+  PrimitiveCache cache;
+  EXPECT_EQ(cache.Take("a"), nullptr);
+
+  cache.Return("a", onnxruntime::make_unique<TestPrimitive>(1, num_destroyed));
+  cache.Return("b", onnxruntime::make_unique<TestPrimitive>(2, num_destroyed));
+  EXPECT_EQ(cache.GetStats().size, 2u);
+
+  auto a = cache.Take("a");
+  EXPECT_EQ(IdOf(a), 1);
+  // a primitive in use isn't available to other runs
+  EXPECT_EQ(cache.Take("a"), nullptr);
+  EXPECT_EQ(IdOf(cache.Take("b")), 2);
+
+  const auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.evictions, 0u);
+  EXPECT_EQ(stats.size, 0u);
+}
+
+TEST(DnnlPrimitiveCacheTest, SameKeyHoldsSeveralPrimitives) {
+  int num_destroyed = 0;
+  PrimitiveCache cache;
+  cache.Return("a", onnxruntime::make_unique<TestPrimitive>(1, num_destroyed));
+  cache.Return("a", onnxruntime::make_unique<TestPrimitive>(2, num_destroyed));
+  EXPECT_EQ(cache.GetStats().size, 2u);
+
+  auto first = cache.Take("a");
+  auto second = cache.Take("a");
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(IdOf(first) + IdOf(second), 3);
+  EXPECT_EQ(cache.Take("a"), nullptr);
+}
+
+TEST(DnnlPrimitiveCacheTest, EvictsLeastRecentlyReturned) {
+  int num_destroyed = 0;
+  PrimitiveCache cache;
+  cache.SetCapacity(2);
+  cache.Return("a", onnxruntime::make_unique<TestPrimitive>(1, num_destroyed));
+  cache.Return("b", onnxruntime::make_unique<TestPrimitive>(2, num_destroyed));
+
+  // using "a" makes "b" the least recently returned
+  auto a = cache.Take("a");
+  cache.Return("a", std::move(a));
+  cache.Return("c", onnxruntime::make_unique<TestPrimitive>(3, num_destroyed));
+
+  EXPECT_EQ(num_destroyed, 1);
+  EXPECT_EQ(cache.GetStats().evictions, 1u);
+  EXPECT_EQ(cache.GetStats().size, 2u);
+  EXPECT_EQ(cache.Take("b"), nullptr);
+  EXPECT_EQ(IdOf(cache.Take("a")), 1);
+  EXPECT_EQ(IdOf(cache.Take("c")), 3);
+}
+
+TEST(DnnlPrimitiveCacheTest, ShrinkingEvictsOldestFirst) {
+  int num_destroyed = 0;
+  PrimitiveCache cache;
+  for (int i = 0; i < 4; ++i) {
+    cache.Return(std::to_string(i), onnxruntime::make_unique<TestPrimitive>(i, num_destroyed));
+  }
+
+  cache.SetCapacity(1);
+  EXPECT_EQ(num_destroyed, 3);
+  EXPECT_EQ(cache.GetStats().evictions, 3u);
+  EXPECT_EQ(cache.Take("0"), nullptr);
+  EXPECT_EQ(cache.Take("1"), nullptr);
+  EXPECT_EQ(cache.Take("2"), nullptr);
+  EXPECT_EQ(IdOf(cache.Take("3")), 3);
+}
+
+TEST(DnnlPrimitiveCacheTest, ZeroCapacityDisablesCaching) {
+  int num_destroyed = 0;
+  PrimitiveCache cache;
+  cache.SetCapacity(0);
+  cache.Return("a", onnxruntime::make_unique<TestPrimitive>(1, num_destroyed));
+
+  EXPECT_EQ(num_destroyed, 1);
+  EXPECT_EQ(cache.Take("a"), nullptr);
+  const auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 0u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.size, 0u);
+}
+
+}  // namespace test
+}  // namespace ort_dnnl
+}  // namespace onnxruntime
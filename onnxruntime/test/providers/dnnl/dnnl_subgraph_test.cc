@@ -0,0 +1,202 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/graph/model.h"
+#include "core/session/inference_session.h"
+#include "test/framework/test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/default_providers.h"
+#include "test/util/include/inference_session_wrapper.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+static void AddFloatInitializer(Graph& graph, const std::string& name, const std::vector<int64_t>& dims,
+                                const std::vector<float>& values) {
+  ONNX_NAMESPACE::TensorProto tensor;
+  tensor.set_name(name);
+  tensor.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  for (auto dim : dims) {
+    tensor.add_dims(dim);
+  }
+  for (auto value : values) {
+    tensor.add_float_data(value);
+  }
+  graph.AddInitializedTensor(tensor);
+}
+
+static ONNX_NAMESPACE::TypeProto FloatTensorType(const std::vector<int64_t>& dims) {
+  ONNX_NAMESPACE::TypeProto type;
+  type.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  for (auto dim : dims) {
+    type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+  return type;
+}
+
+// MatMul -> Gemm -> Relu -> Softmax with constant weights, which is the pattern of the projections of
+// transformer models. The whole graph has to become a single DNNL subgraph, with the Relu fused into the Gemm.
+TEST(DnnlSubgraphTest, MatMulGemmReluSoftmax) {
+  onnxruntime::Model model("dnnl_matmul_gemm_softmax", false, ModelMetaData(), PathString(),
+                           IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {},
+                           DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  auto a_type = FloatTensorType({2, 3});
+  auto b1_type = FloatTensorType({3, 4});
+  auto b2_type = FloatTensorType({4, 3});
+  auto c_type = FloatTensorType({3});
+  auto matmul_type = FloatTensorType({2, 4});
+  auto output_type = FloatTensorType({2, 3});
+
+  auto& a = graph.GetOrCreateNodeArg("A", &a_type);
+  auto& b1 = graph.GetOrCreateNodeArg("B1", &b1_type);
+  auto& b2 = graph.GetOrCreateNodeArg("B2", &b2_type);
+  auto& c = graph.GetOrCreateNodeArg("C", &c_type);
+  auto& matmul_out = graph.GetOrCreateNodeArg("matmul_out", &matmul_type);
+  auto& gemm_out = graph.GetOrCreateNodeArg("gemm_out", &output_type);
+  auto& relu_out = graph.GetOrCreateNodeArg("relu_out", &output_type);
+  auto& y = graph.GetOrCreateNodeArg("Y", &output_type);
+
+  graph.AddNode("matmul", "MatMul", "", {&a, &b1}, {&matmul_out});
+  graph.AddNode("gemm", "Gemm", "", {&matmul_out, &b2, &c}, {&gemm_out});
+  graph.AddNode("relu", "Relu", "", {&gemm_out}, {&relu_out});
+  graph.AddNode("softmax", "Softmax", "", {&relu_out}, {&y});
+
+  AddFloatInitializer(graph, "B1", {3, 4},
+                      {0.5f, -1.0f, 0.25f, 1.0f,
+                       0.75f, 0.5f, -0.5f, 0.0f,
+                       -0.25f, 1.0f, 0.5f, -1.5f});
+  AddFloatInitializer(graph, "B2", {4, 3},
+                      {1.0f, 0.0f, -0.5f,
+                       0.5f, -1.0f, 0.25f,
+                       -0.75f, 0.5f, 1.0f,
+                       0.25f, 0.25f, -0.25f});
+  AddFloatInitializer(graph, "C", {3}, {0.1f, -0.2f, 0.3f});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+
+  SessionOptions so;
+  so.session_logid = "DnnlSubgraphTest.MatMulGemmReluSoftmax";
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.RegisterExecutionProvider(DefaultDnnlExecutionProvider()));
+  ASSERT_STATUS_OK(session_object.Load(model_data.data(), static_cast<int>(model_data.size())));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  const auto& session_graph = session_object.GetGraph();
+  ASSERT_EQ(session_graph.NumberOfNodes(), 1);
+  for (const auto& node : session_graph.Nodes()) {
+    EXPECT_EQ(node.GetExecutionProviderType(), kDnnlExecutionProvider);
+  }
+
+  OrtValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {2, 3},
+                       {1.0f, -2.0f, 0.5f,
+                        0.25f, 1.5f, -1.0f},
+                       &ml_value);
+  NameMLValMap feeds{{"A", ml_value}};
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(RunOptions{}, feeds, {"Y"}, &fetches));
+
+  const std::vector<float> expected_values{0.06201921f, 0.5128299f, 0.4251509f,
+                                           0.8710778f, 0.06908629f, 0.05983593f};
+  const auto& output = fetches[0].Get<Tensor>();
+  ASSERT_EQ(output.Shape(), TensorShape({2, 3}));
+  const float* output_values = output.Data<float>();
+  for (size_t i = 0; i < expected_values.size(); ++i) {
+    EXPECT_NEAR(output_values[i], expected_values[i], 1e-5f) << "at " << i;
+  }
+}
+
+// A MatMul whose B isn't a constant can't be cached in the DNNL primitive, so it's left to the CPU EP.
+TEST(DnnlSubgraphTest, MatMulWithNonConstantBIsNotClaimed) {
+  onnxruntime::Model model("dnnl_matmul_non_constant_b", false, ModelMetaData(), PathString(),
+                           IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {},
+                           DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  auto a_type = FloatTensorType({2, 3});
+  auto b_type = FloatTensorType({3, 2});
+  auto y_type = FloatTensorType({2, 2});
+  auto& a = graph.GetOrCreateNodeArg("A", &a_type);
+  auto& b = graph.GetOrCreateNodeArg("B", &b_type);
+  auto& y = graph.GetOrCreateNodeArg("Y", &y_type);
+  graph.AddNode("matmul", "MatMul", "", {&a, &b}, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+
+  SessionOptions so;
+  so.session_logid = "DnnlSubgraphTest.MatMulWithNonConstantBIsNotClaimed";
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.RegisterExecutionProvider(DefaultDnnlExecutionProvider()));
+  ASSERT_STATUS_OK(session_object.Load(model_data.data(), static_cast<int>(model_data.size())));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  for (const auto& node : session_object.GetGraph().Nodes()) {
+    EXPECT_EQ(node.GetExecutionProviderType(), kCpuExecutionProvider);
+  }
+}
+
+// The DNNL Gemm adds C as a [1, N] bias, so a C that relies on broadcasting a single value is left to the CPU EP.
+TEST(DnnlSubgraphTest, GemmWithScalarBiasIsNotClaimed) {
+  onnxruntime::Model model("dnnl_gemm_scalar_bias", false, ModelMetaData(), PathString(),
+                           IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {},
+                           DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  auto a_type = FloatTensorType({2, 3});
+  auto b_type = FloatTensorType({3, 2});
+  auto c_type = FloatTensorType({1});
+  auto y_type = FloatTensorType({2, 2});
+  auto& a = graph.GetOrCreateNodeArg("A", &a_type);
+  auto& b = graph.GetOrCreateNodeArg("B", &b_type);
+  auto& c = graph.GetOrCreateNodeArg("C", &c_type);
+  auto& y = graph.GetOrCreateNodeArg("Y", &y_type);
+  graph.AddNode("gemm", "Gemm", "", {&a, &b, &c}, {&y});
+
+  AddFloatInitializer(graph, "B", {3, 2},
+                      {1.0f, 0.0f,
+                       0.0f, 1.0f,
+                       1.0f, 1.0f});
+  AddFloatInitializer(graph, "C", {1}, {0.5f});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+
+  SessionOptions so;
+  so.session_logid = "DnnlSubgraphTest.GemmWithScalarBiasIsNotClaimed";
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.RegisterExecutionProvider(DefaultDnnlExecutionProvider()));
+  ASSERT_STATUS_OK(session_object.Load(model_data.data(), static_cast<int>(model_data.size())));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  for (const auto& node : session_object.GetGraph().Nodes()) {
+    EXPECT_EQ(node.GetExecutionProviderType(), kCpuExecutionProvider);
+  }
+
+  OrtValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {2, 3},
+                       {1.0f, 2.0f, 3.0f,
+                        4.0f, 5.0f, 6.0f},
+                       &ml_value);
+  NameMLValMap feeds{{"A", ml_value}};
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(RunOptions{}, feeds, {"Y"}, &fetches));
+
+  const std::vector<float> expected_values{4.5f, 5.5f, 10.5f, 11.5f};
+  const auto& output = fetches[0].Get<Tensor>();
+  ASSERT_EQ(output.Shape(), TensorShape({2, 2}));
+  const float* output_values = output.Data<float>();
+  for (size_t i = 0; i < expected_values.size(); ++i) {
+    EXPECT_NEAR(output_values[i], expected_values[i], 1e-5f) << "at " << i;
+  }
+}
+
+}  // namespace test
+}  // namespace onnxruntime
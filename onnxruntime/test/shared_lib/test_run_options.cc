@@ -12,3 +12,14 @@ TEST(CApiTest, run_options) {
   ASSERT_STREQ(options.GetRunTag(), "abc");
   ASSERT_EQ(options.GetRunLogVerbosityLevel(), 1);
 }
+
+TEST(CApiTest, run_options_priority_and_deadline) {
+  Ort::RunOptions options;
+  ASSERT_EQ(options.GetRunPriority(), ORT_RUN_PRIORITY_NORMAL);
+  ASSERT_EQ(options.GetRunDeadline(), 0);
+  options.SetRunPriority(ORT_RUN_PRIORITY_HIGH);
+  options.SetRunDeadline(20);
+  ASSERT_EQ(options.GetRunPriority(), ORT_RUN_PRIORITY_HIGH);
+  ASSERT_EQ(options.GetRunDeadline(), 20);
+  ASSERT_THROW(options.SetRunDeadline(-1), Ort::Exception);
+}
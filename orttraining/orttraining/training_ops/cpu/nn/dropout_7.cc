@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "orttraining/training_ops/cpu/nn/dropout_7.h"
+#include "core/framework/philox_random.h"
 #include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
@@ -42,11 +43,8 @@ Status Dropout_7::Compute(OpKernelContext* context) const {
     Tensor& mask = *context->Output(1, shape);
     bool* mask_data = mask.template MutableData<bool>();
 
-    // TODO: Compute is a const function, generator cannot be a private meber
-    float seed = gsl::narrow_cast<float>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-    std::default_random_engine generator{gsl::narrow_cast<uint32_t>(seed)};
-    std::bernoulli_distribution distribution(keep_prob_);
-    std::generate_n(mask_data, shape.Size(), [&] { return distribution(generator); });
+    FillPhiloxRandom(PhiloxGenerator::Default(), PhiloxBernoulliDistribution{keep_prob_}, mask_data, shape.Size(),
+                     context->GetOperatorThreadPool());
 
     EigenMap<float>(Y) = scale * EigenMap<float>(X).cwiseProduct(EigenMap<bool>(mask).cast<float>());
   }